@@ -0,0 +1,45 @@
+// bench_duplicates.cpp — вычисление контрольных сумм для поиска дубликатов
+
+#include "bench_fixtures.h"
+#include "familyvault/DuplicateFinder.h"
+#include "familyvault/IndexManager.h"
+#include <benchmark/benchmark.h>
+#include <algorithm>
+
+using namespace FamilyVault;
+using namespace FamilyVault::Bench;
+
+// ═══════════════════════════════════════════════════════════
+// DuplicateFinder::computeMissingChecksums
+// Аргументы: количество файлов, размер файла в байтах
+// ═══════════════════════════════════════════════════════════
+
+static void BM_DuplicateFinder_ComputeChecksums(benchmark::State& state) {
+    const int files = static_cast<int>(state.range(0));
+    const auto fileSize = static_cast<size_t>(state.range(1));
+    const int perDir = std::min(files, 50);
+
+    TempDir dir("checksums");
+    auto tree = dir.path() / "files";
+    makeTree(tree, files / perDir, perDir, fileSize);
+
+    auto db = std::make_shared<Database>((dir.path() / "index.db").string());
+    db->initialize();
+    IndexManager manager(db);
+    manager.scanFolder(manager.addFolder(tree.string(), "bench"));
+    DuplicateFinder finder(db, &manager);
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        db->execute("UPDATE files SET checksum = NULL");
+        state.ResumeTiming();
+
+        finder.computeMissingChecksums();
+    }
+    state.SetItemsProcessed(state.iterations() * files);
+    state.SetBytesProcessed(state.iterations() * files * static_cast<int64_t>(fileSize));
+}
+BENCHMARK(BM_DuplicateFinder_ComputeChecksums)
+    ->Args({1000, 4 * 1024})
+    ->Args({50, 4 * 1024 * 1024})
+    ->Unit(benchmark::kMillisecond);
@@ -0,0 +1,229 @@
+// bench_extraction.cpp — извлечение текста: каждый экстрактор отдельно
+// и полный путь ContentIndexer::processFile (извлечение + запись в FTS)
+
+#include "bench_fixtures.h"
+#include "familyvault/ContentIndexer.h"
+#include "familyvault/TextExtractor.h"
+#include <benchmark/benchmark.h>
+#include <zip.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <sstream>
+
+using namespace FamilyVault;
+using namespace FamilyVault::Bench;
+
+namespace {
+
+constexpr size_t kTextBytes = 256 * 1024;
+constexpr int kPdfPages = 20;
+constexpr int kParagraphs = 400;
+
+struct Fixture {
+    std::string fileName;
+    std::string mimeType;
+};
+
+const std::map<std::string, Fixture> kFixtures = {
+    {"txt", {"document.txt", "text/plain"}},
+    {"html", {"document.html", "text/html"}},
+    {"markdown", {"document.md", "text/markdown"}},
+    {"pdf", {"document.pdf", "application/pdf"}},
+    {"docx", {"document.docx",
+              "application/vnd.openxmlformats-officedocument.wordprocessingml.document"}},
+};
+
+void writeFile(const fs::path& path, const std::string& content) {
+    std::ofstream out(path, std::ios::binary);
+    out.write(content.data(), static_cast<std::streamsize>(content.size()));
+}
+
+std::string makeHtml() {
+    std::string html = "<!DOCTYPE html><html><head><title>Bench</title>"
+                       "<style>p { margin: 0 }</style><script>var x = 1;</script></head><body>";
+    for (int i = 0; i < kParagraphs; ++i) {
+        html += "<div class=\"section\"><h2>Section " + std::to_string(i) + "</h2><p>";
+        html += syntheticWords(kTextBytes / kParagraphs, static_cast<uint32_t>(i));
+        html += " <a href=\"#\">link</a> &amp; <b>bold</b></p></div>\n";
+    }
+    return html + "</body></html>";
+}
+
+std::string makeMarkdown() {
+    std::string md = "# Benchmark document\n\n";
+    for (int i = 0; i < kParagraphs; ++i) {
+        md += "## Section " + std::to_string(i) + "\n\n";
+        md += syntheticWords(kTextBytes / kParagraphs, static_cast<uint32_t>(i));
+        md += " **bold** and [link](http://example.com)\n\n";
+    }
+    return md;
+}
+
+/// Минимальный PDF: страницы с текстом Helvetica и корректной таблицей xref
+std::string makePdf() {
+    std::vector<std::string> objects;
+    objects.push_back("<< /Type /Catalog /Pages 2 0 R >>");
+
+    std::string kids;
+    for (int page = 0; page < kPdfPages; ++page) {
+        kids += std::to_string(4 + page * 2) + " 0 R ";
+    }
+    objects.push_back("<< /Type /Pages /Kids [" + kids + "] /Count " +
+                      std::to_string(kPdfPages) + " >>");
+    objects.push_back("<< /Type /Font /Subtype /Type1 /BaseFont /Helvetica >>");
+
+    for (int page = 0; page < kPdfPages; ++page) {
+        std::string stream = "BT /F1 10 Tf 40 800 Td 12 TL\n";
+        std::istringstream lines(syntheticWords(kTextBytes / kPdfPages, static_cast<uint32_t>(page)));
+        std::string line;
+        while (std::getline(lines, line)) {
+            stream += "(" + line + ") '\n";
+        }
+        stream += "ET";
+
+        objects.push_back("<< /Type /Page /Parent 2 0 R /MediaBox [0 0 595 842] "
+                          "/Resources << /Font << /F1 3 0 R >> >> /Contents " +
+                          std::to_string(5 + page * 2) + " 0 R >>");
+        objects.push_back("<< /Length " + std::to_string(stream.size()) + " >>\nstream\n" +
+                          stream + "\nendstream");
+    }
+
+    std::string pdf = "%PDF-1.4\n";
+    std::vector<size_t> offsets;
+    for (size_t i = 0; i < objects.size(); ++i) {
+        offsets.push_back(pdf.size());
+        pdf += std::to_string(i + 1) + " 0 obj\n" + objects[i] + "\nendobj\n";
+    }
+
+    size_t xref = pdf.size();
+    pdf += "xref\n0 " + std::to_string(objects.size() + 1) + "\n0000000000 65535 f \n";
+    for (size_t offset : offsets) {
+        char entry[21];
+        std::snprintf(entry, sizeof(entry), "%010zu 00000 n \n", offset);
+        pdf += entry;
+    }
+    pdf += "trailer\n<< /Size " + std::to_string(objects.size() + 1) +
+           " /Root 1 0 R >>\nstartxref\n" + std::to_string(xref) + "\n%%EOF\n";
+    return pdf;
+}
+
+bool addZipEntry(zip_t* archive, const char* name, const std::string& content) {
+    // Буфер должен жить до zip_close — libzip читает его при записи архива
+    auto* copy = static_cast<char*>(std::malloc(content.size()));
+    std::memcpy(copy, content.data(), content.size());
+    zip_source_t* source = zip_source_buffer(archive, copy, content.size(), 1);
+    if (!source) {
+        std::free(copy);
+        return false;
+    }
+    if (zip_file_add(archive, name, source, ZIP_FL_OVERWRITE) < 0) {
+        zip_source_free(source);
+        return false;
+    }
+    return true;
+}
+
+void makeDocx(const fs::path& path) {
+    std::string body;
+    for (int i = 0; i < kParagraphs; ++i) {
+        body += "<w:p><w:r><w:rPr><w:b/></w:rPr><w:t>Section " + std::to_string(i) +
+                "</w:t></w:r><w:r><w:t xml:space=\"preserve\"> " +
+                syntheticWords(kTextBytes / kParagraphs, static_cast<uint32_t>(i)) +
+                "</w:t></w:r></w:p>";
+    }
+
+    int err = 0;
+    zip_t* archive = zip_open(path.c_str(), ZIP_CREATE | ZIP_TRUNCATE, &err);
+    if (!archive) return;
+    addZipEntry(archive, "[Content_Types].xml",
+                "<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+                "<Types xmlns=\"http://schemas.openxmlformats.org/package/2006/content-types\">"
+                "<Default Extension=\"xml\" ContentType=\"application/xml\"/>"
+                "<Override PartName=\"/word/document.xml\" ContentType=\"application/"
+                "vnd.openxmlformats-officedocument.wordprocessingml.document.main+xml\"/></Types>");
+    addZipEntry(archive, "word/document.xml",
+                "<?xml version=\"1.0\" encoding=\"UTF-8\"?><w:document xmlns:w=\""
+                "http://schemas.openxmlformats.org/wordprocessingml/2006/main\"><w:body>" +
+                body + "</w:body></w:document>");
+    zip_close(archive);
+}
+
+/// Каталог с документами всех форматов, создаётся один раз на процесс
+const fs::path& fixturesDir() {
+    static TempDir dir("extraction");
+    static bool created = [] {
+        writeFile(dir.path() / "document.txt", syntheticWords(kTextBytes, 1));
+        writeFile(dir.path() / "document.html", makeHtml());
+        writeFile(dir.path() / "document.md", makeMarkdown());
+        writeFile(dir.path() / "document.pdf", makePdf());
+        makeDocx(dir.path() / "document.docx");
+        return true;
+    }();
+    (void)created;
+    return dir.path();
+}
+
+} // namespace
+
+// ═══════════════════════════════════════════════════════════
+// TextExtractorRegistry::extract — чистое извлечение
+// ═══════════════════════════════════════════════════════════
+
+static void BM_Extract(benchmark::State& state, const std::string& format) {
+    const auto& fixture = kFixtures.at(format);
+    auto path = (fixturesDir() / fixture.fileName).string();
+    auto registry = TextExtractorRegistry::createDefault();
+
+    size_t textSize = 0;
+    for (auto _ : state) {
+        auto result = registry->extract(path, fixture.mimeType);
+        if (!result || result->isEmpty()) {
+            state.SkipWithError("Extraction returned no text");
+            break;
+        }
+        textSize = result->text.size();
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(fs::file_size(path)));
+    state.counters["text_bytes"] = static_cast<double>(textSize);
+}
+BENCHMARK_CAPTURE(BM_Extract, txt, std::string("txt"))->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_Extract, html, std::string("html"))->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_Extract, markdown, std::string("markdown"))->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_Extract, pdf, std::string("pdf"))->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_Extract, docx, std::string("docx"))->Unit(benchmark::kMillisecond);
+
+// ═══════════════════════════════════════════════════════════
+// ContentIndexer::processFile — извлечение + запись в file_content/FTS
+// ═══════════════════════════════════════════════════════════
+
+static void BM_ContentIndexer_ProcessFile(benchmark::State& state, const std::string& format) {
+    const auto& fixture = kFixtures.at(format);
+    TempDir dir("content_indexer");
+    auto db = std::make_shared<Database>((dir.path() / "index.db").string());
+    db->initialize();
+    db->execute("INSERT INTO watched_folders (path, name) VALUES (?, 'bench')",
+                fixturesDir().string());
+    int64_t folderId = db->lastInsertId();
+    db->execute("INSERT INTO files (folder_id, relative_path, name, size, mime_type, content_type, "
+                "modified_at) VALUES (?, ?, ?, ?, ?, ?, 0)",
+                folderId, fixture.fileName, fixture.fileName,
+                static_cast<int64_t>(fs::file_size(fixturesDir() / fixture.fileName)),
+                fixture.mimeType, static_cast<int>(ContentType::Document));
+    int64_t fileId = db->lastInsertId();
+
+    ContentIndexer indexer(db);
+    for (auto _ : state) {
+        if (!indexer.processFile(fileId)) {
+            state.SkipWithError("processFile failed");
+            break;
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_CAPTURE(BM_ContentIndexer_ProcessFile, txt, std::string("txt"))->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_ContentIndexer_ProcessFile, html, std::string("html"))->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_ContentIndexer_ProcessFile, pdf, std::string("pdf"))->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_ContentIndexer_ProcessFile, docx, std::string("docx"))->Unit(benchmark::kMillisecond);
@@ -0,0 +1,160 @@
+#include "bench_fixtures.h"
+#include <array>
+#include <atomic>
+#include <fstream>
+#include <map>
+#include <mutex>
+
+#ifdef _WIN32
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
+
+namespace FamilyVault::Bench {
+
+namespace {
+
+constexpr std::array<const char*, 32> kWords = {
+    "report", "holiday", "invoice", "family", "photo", "summer", "budget", "draft",
+    "contract", "birthday", "scan", "receipt", "letter", "notes", "project", "school",
+    "garden", "travel", "medical", "insurance", "recipe", "music", "video", "archive",
+    "wedding", "tax", "bank", "car", "house", "backup", "meeting", "plan"
+};
+
+struct ExtensionInfo {
+    const char* extension;
+    const char* mimeType;
+    ContentType contentType;
+};
+
+constexpr std::array<ExtensionInfo, 8> kExtensions = {{
+    {"jpg", "image/jpeg", ContentType::Image},
+    {"png", "image/png", ContentType::Image},
+    {"mp4", "video/mp4", ContentType::Video},
+    {"mp3", "audio/mpeg", ContentType::Audio},
+    {"pdf", "application/pdf", ContentType::Document},
+    {"docx", "application/vnd.openxmlformats-officedocument.wordprocessingml.document",
+     ContentType::Document},
+    {"txt", "text/plain", ContentType::Document},
+    {"zip", "application/zip", ContentType::Archive},
+}};
+
+/// Линейный конгруэнтный генератор: одинаковые данные при каждом запуске
+uint32_t nextRandom(uint32_t& state) {
+    state = state * 1664525u + 1013904223u;
+    return state >> 8;
+}
+
+} // namespace
+
+// ═══════════════════════════════════════════════════════════
+// TempDir
+// ═══════════════════════════════════════════════════════════
+
+fs::path benchRoot() {
+    return fs::temp_directory_path() / ("familyvault_bench_" + std::to_string(getpid()));
+}
+
+TempDir::TempDir(const std::string& name) {
+    static std::atomic<int> counter{0};
+    m_path = benchRoot() / (name + "_" + std::to_string(counter++));
+    fs::remove_all(m_path);
+    fs::create_directories(m_path);
+}
+
+TempDir::~TempDir() {
+    std::error_code ec;
+    fs::remove_all(m_path, ec);
+}
+
+// ═══════════════════════════════════════════════════════════
+// Генераторы
+// ═══════════════════════════════════════════════════════════
+
+std::string syntheticWords(size_t bytes, uint32_t seed) {
+    std::string text;
+    text.reserve(bytes + 16);
+    uint32_t state = seed;
+    int wordsInLine = 0;
+    while (text.size() < bytes) {
+        text += kWords[nextRandom(state) % kWords.size()];
+        text += ++wordsInLine % 12 == 0 ? '\n' : ' ';
+    }
+    text.resize(bytes);
+    return text;
+}
+
+std::string syntheticFileName(int64_t n) {
+    uint32_t state = static_cast<uint32_t>(n) * 2654435761u;
+    std::string name = kWords[nextRandom(state) % kWords.size()];
+    name += '_';
+    name += kWords[nextRandom(state) % kWords.size()];
+    name += '_';
+    name += std::to_string(n);
+    name += '.';
+    name += kExtensions[static_cast<size_t>(n) % kExtensions.size()].extension;
+    return name;
+}
+
+int64_t makeTree(const fs::path& root, int dirs, int filesPerDir, size_t fileSize) {
+    std::string content = syntheticWords(fileSize, 7);
+    int64_t created = 0;
+
+    for (int d = 0; d < dirs; ++d) {
+        // Вложенность до 3 уровней: a/b/c, как в реальных фотоархивах
+        fs::path dir = root / ("dir_" + std::to_string(d % 8));
+        if (d >= 8) dir /= "sub_" + std::to_string(d % 64);
+        if (d >= 64) dir /= "leaf_" + std::to_string(d);
+        fs::create_directories(dir);
+
+        for (int f = 0; f < filesPerDir; ++f) {
+            std::ofstream out(dir / syntheticFileName(created), std::ios::binary);
+            out.write(content.data(), static_cast<std::streamsize>(content.size()));
+            ++created;
+        }
+    }
+    return created;
+}
+
+std::shared_ptr<Database> makeIndex(const fs::path& dbPath, int64_t rows) {
+    auto db = std::make_shared<Database>(dbPath.string());
+    db->initialize();
+    db->execute("INSERT INTO watched_folders (path, name) VALUES (?, 'bench')",
+                (dbPath.parent_path() / "files").string());
+    int64_t folderId = db->lastInsertId();
+
+    constexpr int64_t kBatch = 50000;
+    for (int64_t start = 0; start < rows; start += kBatch) {
+        Database::Transaction tx(*db);
+        for (int64_t n = start; n < std::min(rows, start + kBatch); ++n) {
+            const auto& ext = kExtensions[static_cast<size_t>(n) % kExtensions.size()];
+            std::string name = syntheticFileName(n);
+            int64_t modified = 1600000000 + n * 37;
+            db->execute(
+                "INSERT INTO files (folder_id, relative_path, name, extension, size, mime_type, "
+                "content_type, created_at, modified_at) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?)",
+                folderId, "d" + std::to_string(n % 100) + "/" + name, name,
+                std::string(ext.extension), 1024 + (n % 4096) * 512, std::string(ext.mimeType),
+                static_cast<int>(ext.contentType), modified, modified);
+        }
+        tx.commit();
+    }
+    return db;
+}
+
+std::shared_ptr<Database> sharedIndex(int64_t rows) {
+    static std::mutex mutex;
+    static std::map<int64_t, std::shared_ptr<Database>> indexes;
+    static TempDir dir("shared_index");
+
+    std::lock_guard lock(mutex);
+    auto& db = indexes[rows];
+    if (!db) {
+        db = makeIndex(dir.path() / ("index_" + std::to_string(rows) + ".db"), rows);
+    }
+    return db;
+}
+
+} // namespace FamilyVault::Bench
@@ -0,0 +1,53 @@
+// bench_fixtures.h — Синтетические данные для бенчмарков
+// Всё генерируется на лету во временной директории: дерево файлов,
+// индекс на N строк, документы для извлечения текста
+
+#pragma once
+
+#include "familyvault/Database.h"
+#include "familyvault/Types.h"
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+
+namespace FamilyVault::Bench {
+
+namespace fs = std::filesystem;
+
+/// Уникальная временная директория, удаляется в деструкторе
+class TempDir {
+public:
+    explicit TempDir(const std::string& name);
+    ~TempDir();
+
+    TempDir(const TempDir&) = delete;
+    TempDir& operator=(const TempDir&) = delete;
+
+    const fs::path& path() const { return m_path; }
+
+private:
+    fs::path m_path;
+};
+
+/// Корень всех временных данных бенчмарков (внутри системного temp)
+fs::path benchRoot();
+
+/// Детерминированный текст из словаря (seed задаёт последовательность слов)
+std::string syntheticWords(size_t bytes, uint32_t seed);
+
+/// Детерминированное имя файла: "<слово>_<слово>_<n>.<ext>"
+std::string syntheticFileName(int64_t n);
+
+/// Дерево: dirs каталогов (вложенность до 3) по filesPerDir файлов размером fileSize
+/// @return Количество созданных файлов
+int64_t makeTree(const fs::path& root, int dirs, int filesPerDir, size_t fileSize);
+
+/// Новый индекс на rows файлов в одной папке (строки пишутся напрямую, одной транзакцией)
+std::shared_ptr<Database> makeIndex(const fs::path& dbPath, int64_t rows);
+
+/// Индекс на rows файлов, общий для всех бенчмарков процесса: 1M строк
+/// строятся минуты, повторять это для каждого бенчмарка нельзя
+std::shared_ptr<Database> sharedIndex(int64_t rows);
+
+} // namespace FamilyVault::Bench
@@ -0,0 +1,36 @@
+// bench_main.cpp — точка входа familyvault_bench
+
+#include "bench_fixtures.h"
+#include <benchmark/benchmark.h>
+#include <spdlog/spdlog.h>
+#include <csignal>
+#include <cstdlib>
+
+int main(int argc, char** argv) {
+    namespace Bench = FamilyVault::Bench;
+
+    // Логи info/debug на горячих путях искажают замеры
+    spdlog::set_level(spdlog::level::err);
+
+#ifndef _WIN32
+    // Оба пира при закрытии loopback-соединения шлют Disconnect —
+    // запись в уже закрытый сокет не должна завершать процесс
+    std::signal(SIGPIPE, SIG_IGN);
+
+    // SecureStorage пишет в $HOME/.config — изолируем ключи сетевых бенчмарков
+    auto home = Bench::benchRoot() / "home";
+    Bench::fs::create_directories(home);
+    ::setenv("HOME", home.c_str(), 1);
+#endif
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+
+    std::error_code ec;
+    Bench::fs::remove_all(Bench::benchRoot(), ec);
+    return 0;
+}
@@ -0,0 +1,192 @@
+// bench_network.cpp — сериализация протокола и передача файлов через loopback
+
+#include "bench_fixtures.h"
+#include "familyvault/FamilyPairing.h"
+#include "familyvault/SecureStorage.h"
+#include "familyvault/Network/NetworkProtocol.h"
+#include "familyvault/Network/PeerConnection.h"
+#include "familyvault/Network/RemoteFileAccess.h"
+#include "familyvault/Network/TlsPsk.h"
+#include <benchmark/benchmark.h>
+#include <condition_variable>
+#include <fstream>
+#include <future>
+#include <mutex>
+
+using namespace FamilyVault;
+using namespace FamilyVault::Bench;
+
+// ═══════════════════════════════════════════════════════════
+// MessageSerializer — round-trip без сети
+// ═══════════════════════════════════════════════════════════
+
+static void BM_Serializer_FileChunk(benchmark::State& state) {
+    std::string data = syntheticWords(FILE_CHUNK_SIZE, 3);
+    Message msg(MessageType::FileChunk, "bench-request-id");
+    msg.setBinaryPayload(reinterpret_cast<const uint8_t*>(data.data()), data.size());
+
+    for (auto _ : state) {
+        auto bytes = MessageSerializer::serialize(msg);
+        auto decoded = MessageSerializer::deserialize(bytes);
+        benchmark::DoNotOptimize(decoded);
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(data.size()));
+}
+BENCHMARK(BM_Serializer_FileChunk);
+
+static void BM_Serializer_IndexDelta(benchmark::State& state) {
+    IndexDeltaPayload delta{};
+    delta.fileId = 42;
+    delta.path = "Photos/2024/summer/" + syntheticFileName(42);
+    delta.name = syntheticFileName(42);
+    delta.mimeType = "image/jpeg";
+    delta.size = 3 * 1024 * 1024;
+    delta.modifiedAt = 1700000000;
+    delta.checksum = std::string(64, 'a');
+    delta.extractedText = syntheticWords(static_cast<size_t>(state.range(0)), 5);
+    delta.isDeleted = false;
+    delta.deviceId = "bench-device";
+    delta.syncTimestamp = 1700000000;
+
+    for (auto _ : state) {
+        Message msg(MessageType::IndexDelta, "bench-request-id");
+        msg.setJsonPayload(delta.toJson());
+        auto bytes = MessageSerializer::serialize(msg);
+        auto decoded = MessageSerializer::deserialize(bytes);
+        auto payload = IndexDeltaPayload::fromJson(decoded->getJsonPayload());
+        benchmark::DoNotOptimize(payload);
+    }
+}
+BENCHMARK(BM_Serializer_IndexDelta)->Arg(0)->Arg(16 * 1024);
+
+// ═══════════════════════════════════════════════════════════
+// RemoteFileAccess — полный цикл запроса файла через TLS-PSK на 127.0.0.1
+// ═══════════════════════════════════════════════════════════
+
+namespace {
+
+/// Семья создаётся один раз на процесс и не разрушается: createFamily
+/// запускает PairingServer, а его остановка ждёт выхода из блокирующего accept()
+std::shared_ptr<FamilyPairing> benchFamily() {
+    static auto* pairing = [] {
+        auto* p = new std::shared_ptr<FamilyPairing>(
+            std::make_shared<FamilyPairing>(std::make_shared<SecureStorage>()));
+        if (!(*p)->createFamily()) p->reset();
+        return p;
+    }();
+    return *pairing;
+}
+
+/// Два PeerConnection одной семьи, соединённые через loopback
+struct LoopbackPeers {
+    std::shared_ptr<FamilyPairing> pairing;
+    TlsPskServer server;
+    std::shared_ptr<PeerConnection> serverPeer;
+    std::shared_ptr<PeerConnection> clientPeer;
+
+    bool connect() {
+        pairing = benchFamily();
+        if (!pairing) return false;
+        auto psk = pairing->derivePsk();
+        if (!psk) return false;
+
+        server.setPsk(*psk, pairing->getDeviceId());
+        if (!server.start(0)) return false;
+
+        serverPeer = std::make_shared<PeerConnection>(pairing);
+        auto accepted = std::async(std::launch::async, [this] {
+            return serverPeer->acceptConnection(server.accept());
+        });
+
+        clientPeer = std::make_shared<PeerConnection>(pairing);
+        bool connected = clientPeer->connect("127.0.0.1", server.getPort());
+        return accepted.get() && connected;
+    }
+
+    /// Остановить потоки приёма до разрушения обработчиков сообщений
+    void close() {
+        if (clientPeer) clientPeer->disconnect();
+        if (serverPeer) serverPeer->disconnect();
+        server.stop();
+    }
+
+    ~LoopbackPeers() { close(); }
+};
+
+} // namespace
+
+static void BM_RemoteFileAccess_Loopback(benchmark::State& state) {
+    TempDir dir("remote_file");
+    auto source = dir.path() / "source.bin";
+    auto fileSize = static_cast<int64_t>(state.range(0));
+    {
+        std::ofstream out(source, std::ios::binary);
+        std::string data = syntheticWords(static_cast<size_t>(fileSize), 11);
+        out.write(data.data(), static_cast<std::streamsize>(data.size()));
+    }
+
+    LoopbackPeers peers;
+    if (!peers.connect()) {
+        state.SkipWithError("Loopback connection failed");
+        return;
+    }
+
+    RemoteFileAccess serverAccess((dir.path() / "server_cache").string());
+    RemoteFileAccess clientAccess((dir.path() / "client_cache").string());
+
+    peers.serverPeer->onMessage([&](const Message& msg) {
+        if (msg.type == MessageType::FileRequest) {
+            serverAccess.handleFileRequest(peers.serverPeer, msg,
+                                           [&source](int64_t) { return source.string(); });
+        }
+    });
+    peers.clientPeer->onMessage([&](const Message& msg) {
+        switch (msg.type) {
+            case MessageType::FileResponse: clientAccess.handleFileResponse(msg); break;
+            case MessageType::FileChunk: clientAccess.handleFileChunk(msg); break;
+            case MessageType::FileNotFound: clientAccess.handleFileNotFound(msg); break;
+            default: break;
+        }
+    });
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool done = false;
+    bool failed = false;
+    clientAccess.onComplete([&](const FileTransferProgress&) {
+        std::lock_guard lock(mutex);
+        done = true;
+        cv.notify_all();
+    });
+    clientAccess.onError([&](const FileTransferProgress&) {
+        std::lock_guard lock(mutex);
+        done = failed = true;
+        cv.notify_all();
+    });
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        clientAccess.clearCache();
+        {
+            std::lock_guard lock(mutex);
+            done = false;
+        }
+        state.ResumeTiming();
+
+        clientAccess.requestFile(peers.clientPeer, "bench-device", 1, "source.bin", fileSize);
+
+        std::unique_lock lock(mutex);
+        if (!cv.wait_for(lock, std::chrono::seconds(FILE_REQUEST_TIMEOUT_SEC), [&] { return done; }) ||
+            failed) {
+            state.SkipWithError("File transfer failed");
+            break;
+        }
+    }
+    peers.close();
+    state.SetBytesProcessed(state.iterations() * fileSize);
+}
+BENCHMARK(BM_RemoteFileAccess_Loopback)
+    ->Arg(64 * 1024)
+    ->Arg(8 * 1024 * 1024)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
@@ -0,0 +1,59 @@
+// bench_scan.cpp — обход файловой системы и запись в индекс
+
+#include "bench_fixtures.h"
+#include "familyvault/FileScanner.h"
+#include "familyvault/IndexManager.h"
+#include <benchmark/benchmark.h>
+
+using namespace FamilyVault;
+using namespace FamilyVault::Bench;
+
+namespace {
+
+constexpr int kFilesPerDir = 50;
+
+} // namespace
+
+// ═══════════════════════════════════════════════════════════
+// FileScanner::scan — только обход и определение MIME, без БД
+// ═══════════════════════════════════════════════════════════
+
+static void BM_FileScanner_Scan(benchmark::State& state) {
+    TempDir dir("scan");
+    int64_t files = makeTree(dir.path(), static_cast<int>(state.range(0)) / kFilesPerDir,
+                             kFilesPerDir, 256);
+    FileScanner scanner;
+
+    for (auto _ : state) {
+        int64_t found = 0;
+        scanner.scan(dir.path().string(), [&found](const ScannedFile&) { ++found; });
+        benchmark::DoNotOptimize(found);
+    }
+    state.SetItemsProcessed(state.iterations() * files);
+}
+BENCHMARK(BM_FileScanner_Scan)->Arg(1000)->Arg(10000)->Unit(benchmark::kMillisecond);
+
+// ═══════════════════════════════════════════════════════════
+// IndexManager — полный ingest N файлов в пустой индекс
+// ═══════════════════════════════════════════════════════════
+
+static void BM_IndexManager_Ingest(benchmark::State& state) {
+    TempDir dir("ingest");
+    auto tree = dir.path() / "files";
+    int64_t files = makeTree(tree, static_cast<int>(state.range(0)) / kFilesPerDir,
+                             kFilesPerDir, 256);
+    int run = 0;
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto db = std::make_shared<Database>((dir.path() / ("ingest_" + std::to_string(run++) + ".db")).string());
+        db->initialize();
+        IndexManager manager(db);
+        int64_t folderId = manager.addFolder(tree.string(), "bench");
+        state.ResumeTiming();
+
+        manager.scanFolder(folderId);
+    }
+    state.SetItemsProcessed(state.iterations() * files);
+}
+BENCHMARK(BM_IndexManager_Ingest)->Arg(1000)->Arg(10000)->Unit(benchmark::kMillisecond);
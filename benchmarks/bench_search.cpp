@@ -0,0 +1,95 @@
+// bench_search.cpp — поиск и автодополнение на индексах 10k/100k/1M строк
+
+#include "bench_fixtures.h"
+#include "familyvault/SearchEngine.h"
+#include "familyvault/SuggestIndex.h"
+#include <benchmark/benchmark.h>
+
+using namespace FamilyVault;
+using namespace FamilyVault::Bench;
+
+namespace {
+
+void indexSizes(benchmark::internal::Benchmark* b) {
+    b->Arg(10000)->Arg(100000)->Arg(1000000)->Unit(benchmark::kMicrosecond);
+}
+
+void runSearch(benchmark::State& state, const SearchQuery& query) {
+    SearchEngine engine(sharedIndex(state.range(0)));
+    size_t found = 0;
+    for (auto _ : state) {
+        auto results = engine.search(query);
+        found = results.size();
+        benchmark::DoNotOptimize(results.data());
+    }
+    state.counters["results"] = static_cast<double>(found);
+}
+
+} // namespace
+
+// ═══════════════════════════════════════════════════════════
+// SearchEngine::search
+// ═══════════════════════════════════════════════════════════
+
+static void BM_Search_Prefix(benchmark::State& state) {
+    SearchQuery query;
+    query.text = "holi";
+    query.matchMode = TextMatchMode::Prefix;
+    query.limit = 50;
+    runSearch(state, query);
+}
+BENCHMARK(BM_Search_Prefix)->Apply(indexSizes);
+
+static void BM_Search_Substring(benchmark::State& state) {
+    SearchQuery query;
+    query.text = "olida";
+    query.matchMode = TextMatchMode::Substring;
+    query.limit = 50;
+    runSearch(state, query);
+}
+BENCHMARK(BM_Search_Substring)->Apply(indexSizes);
+
+static void BM_Search_FilteredByDate(benchmark::State& state) {
+    SearchQuery query;
+    query.contentType = ContentType::Image;
+    query.sortBy = SortBy::Date;
+    query.limit = 100;
+    runSearch(state, query);
+}
+BENCHMARK(BM_Search_FilteredByDate)->Apply(indexSizes);
+
+static void BM_Search_Count(benchmark::State& state) {
+    SearchEngine engine(sharedIndex(state.range(0)));
+    SearchQuery query;
+    query.text = "invoice";
+    query.matchMode = TextMatchMode::Prefix;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(engine.countResults(query));
+    }
+}
+BENCHMARK(BM_Search_Count)->Apply(indexSizes);
+
+// ═══════════════════════════════════════════════════════════
+// SearchEngine::suggest — через FTS и через SuggestIndex
+// ═══════════════════════════════════════════════════════════
+
+static void BM_Suggest_Fts(benchmark::State& state) {
+    SearchEngine engine(sharedIndex(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(engine.suggest("ho", 10));
+    }
+}
+BENCHMARK(BM_Suggest_Fts)->Apply(indexSizes);
+
+static void BM_Suggest_Index(benchmark::State& state) {
+    auto db = sharedIndex(state.range(0));
+    auto suggest = std::make_shared<SuggestIndex>(db);
+    suggest->rebuild();
+    SearchEngine engine(db);
+    engine.setSuggestIndex(suggest);
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(engine.suggest("ho", 10));
+    }
+}
+BENCHMARK(BM_Suggest_Index)->Apply(indexSizes);
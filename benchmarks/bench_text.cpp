@@ -0,0 +1,394 @@
+// bench_text.cpp — нормализация пробелов (прежний std::regex против SIMD-ядер)
+// и перекодировка UTF-16/CP1251 → UTF-8 (прежние побайтовые циклы против блочных ядер),
+// удаление HTML-разметки (прежние копии строк против потокового MarkupStripper),
+// потоковый разбор XML документа Word порциями распаковки
+
+#include "bench_fixtures.h"
+#include "familyvault/EncodingConverter.h"
+#include "familyvault/MarkupStripper.h"
+#include "familyvault/TextNormalizer.h"
+#include "familyvault/XmlStreamReader.h"
+#include <benchmark/benchmark.h>
+#include <regex>
+
+using namespace FamilyVault;
+using namespace FamilyVault::Bench;
+
+namespace {
+
+constexpr size_t kCorpusBytes = 1024 * 1024;
+
+enum Corpus { Log, Csv, Cyrillic };
+
+/// Корпуса ~1 MB: лог с отступами, CSV, русский текст (не-ASCII блоки)
+const std::string& corpus(int kind) {
+    static const std::string log = [] {
+        std::string text;
+        for (int line = 0; text.size() < kCorpusBytes; ++line) {
+            text += "2024-05-01 12:00:" + std::to_string(line % 60) + "  INFO   [scanner]    ";
+            text += syntheticWords(80, static_cast<uint32_t>(line));
+            text += "\r\n\t\t";
+        }
+        return text;
+    }();
+    static const std::string csv = [] {
+        std::string text;
+        for (int row = 0; text.size() < kCorpusBytes; ++row) {
+            text += std::to_string(row) + ",\"" + syntheticFileName(row) + "\", 1024 ,  " +
+                    std::to_string(row * 37) + "\n";
+        }
+        return text;
+    }();
+    static const std::string cyrillic = [] {
+        static const char* words[] = {"семейный", "архив", "фотографии", "отпуск", "документы",
+                                      "счёт", "договор", "лето"};
+        std::string text;
+        for (int i = 0; text.size() < kCorpusBytes; ++i) {
+            text += words[(i * 7) % std::size(words)];
+            text += i % 9 == 0 ? "\n\n" : " ";
+        }
+        return text;
+    }();
+
+    switch (kind) {
+        case Log: return log;
+        case Csv: return csv;
+        default: return cyrillic;
+    }
+}
+
+void corpora(benchmark::internal::Benchmark* b) {
+    b->ArgNames({"corpus"})->Arg(Log)->Arg(Csv)->Arg(Cyrillic)->Unit(benchmark::kMicrosecond);
+}
+
+/// Прежний путь PlainTextExtractor
+std::string regexNormalize(const std::string& text) {
+    static const std::regex multiSpace(R"(\s+)");
+    std::string result = std::regex_replace(text, multiSpace, " ");
+    auto start = result.find_first_not_of(" \t\n\r");
+    auto end = result.find_last_not_of(" \t\n\r");
+    if (start != std::string::npos && end != std::string::npos) {
+        result = result.substr(start, end - start + 1);
+    }
+    return result;
+}
+
+/// Кодовые точки русского корпуса (в нём только ASCII и 2-байтные символы)
+std::vector<uint16_t> cyrillicUnits() {
+    const std::string& text = corpus(Cyrillic);
+    std::vector<uint16_t> units;
+    for (size_t i = 0; i < text.size();) {
+        auto c = static_cast<unsigned char>(text[i]);
+        if (c < 0x80) {
+            units.push_back(c);
+            i += 1;
+        } else {
+            units.push_back(static_cast<uint16_t>(((c & 0x1F) << 6) | (text[i + 1] & 0x3F)));
+            i += 2;
+        }
+    }
+    return units;
+}
+
+enum Encoded { Utf16, Cp1251 };
+
+/// Русский корпус в UTF-16LE (с BOM) и в CP1251
+const std::string& encodedCorpus(int kind) {
+    static const std::string utf16 = [] {
+        std::string bytes = "\xFF\xFE";
+        for (uint16_t unit : cyrillicUnits()) {
+            bytes += static_cast<char>(unit & 0xFF);
+            bytes += static_cast<char>(unit >> 8);
+        }
+        return bytes;
+    }();
+    static const std::string cp1251 = [] {
+        std::string bytes;
+        for (uint16_t unit : cyrillicUnits()) {
+            if (unit < 0x80) bytes += static_cast<char>(unit);
+            else if (unit == 0x451) bytes += '\xB8';  // ё
+            else bytes += static_cast<char>(unit - 0x350);
+        }
+        return bytes;
+    }();
+    return kind == Utf16 ? utf16 : cp1251;
+}
+
+void encodings(benchmark::internal::Benchmark* b) {
+    b->ArgNames({"encoding"})->Arg(Utf16)->Arg(Cp1251)->Unit(benchmark::kMicrosecond);
+}
+
+/// Прежний путь PlainTextExtractor::convertToUtf8: по символу через operator+=
+std::string legacyToUtf8(const std::string& data, int kind) {
+    std::string result;
+    result.reserve(data.size() * 2);
+    auto append = [&result](uint32_t cp) {
+        if (cp < 0x80) {
+            result += static_cast<char>(cp);
+        } else if (cp < 0x800) {
+            result += static_cast<char>(0xC0 | (cp >> 6));
+            result += static_cast<char>(0x80 | (cp & 0x3F));
+        } else {
+            result += static_cast<char>(0xE0 | (cp >> 12));
+            result += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            result += static_cast<char>(0x80 | (cp & 0x3F));
+        }
+    };
+    if (kind == Utf16) {
+        for (size_t i = 2; i + 1 < data.size(); i += 2) {
+            append(static_cast<unsigned char>(data[i]) |
+                   (static_cast<unsigned char>(data[i + 1]) << 8));
+        }
+    } else {
+        for (char c : data) {
+            auto uc = static_cast<unsigned char>(c);
+            // Для корпуса достаточно букв и ё; таблица — как в прежнем коде
+            append(uc < 0x80 ? uc : uc == 0xB8 ? 0x451 : uc + 0x350u);
+        }
+    }
+    return result;
+}
+
+/// HTML ~1 MB: абзацы текста, ссылки, сущности, встроенный скрипт
+const std::string& htmlCorpus() {
+    static const std::string html = [] {
+        std::string text = "<!DOCTYPE html><html><head><title>Bench</title>"
+                           "<style>p { margin: 0 }</style></head><body>\n";
+        for (int i = 0; text.size() < kCorpusBytes; ++i) {
+            text += "<div class=\"section\"><h2>Section " + std::to_string(i) + "</h2><p>";
+            text += syntheticWords(400, static_cast<uint32_t>(i));
+            text += " <a href=\"#\">link</a> &amp; <b>bold</b>&nbsp;</p></div>\n";
+            if (i % 50 == 0) text += "<script>var x = 1 < 2 && 3 > 2;</script>\n";
+        }
+        return text + "</body></html>";
+    }();
+    return html;
+}
+
+/// word/document.xml ~1 MB: абзацы из нескольких прогонов с атрибутами
+const std::string& docxCorpus() {
+    static const std::string xml = [] {
+        std::string text = "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>"
+                           "<w:document xmlns:w=\"http://schemas.openxmlformats.org/"
+                           "wordprocessingml/2006/main\"><w:body>";
+        for (int i = 0; text.size() < kCorpusBytes; ++i) {
+            text += "<w:p w:rsidR=\"00A1B2C3\"><w:pPr><w:pStyle w:val=\"Normal\"/></w:pPr>";
+            for (int run = 0; run < 4; ++run) {
+                text += "<w:r><w:rPr><w:b/><w:sz w:val=\"24\"/></w:rPr><w:t xml:space=\"preserve\">";
+                text += syntheticWords(100, static_cast<uint32_t>(i * 4 + run));
+                text += " </w:t></w:r>";
+            }
+            text += "</w:p>";
+        }
+        return text + "</w:body></w:document>";
+    }();
+    return xml;
+}
+
+/// Текст <w:t> с разделителем после абзаца, как в OfficeTextExtractor
+class DocxTextHandler final : public XmlStreamReader::Handler {
+public:
+    explicit DocxTextHandler(NormalizingSink& sink) : m_sink(sink) {}
+
+    void startElement(int id, const XmlStreamReader&) override {
+        if (id == 0) m_inText = true;
+    }
+    void endElement(int id) override {
+        if (id == 0) m_inText = false;
+        else m_sink.separator();
+    }
+    void text(std::string_view text) override {
+        if (m_inText) m_sink.append(text);
+    }
+
+private:
+    NormalizingSink& m_sink;
+    bool m_inText = false;
+};
+
+/// Прежний PlainTextExtractor::stripHtml (после него — отдельный проход normalize)
+std::string legacyStripHtml(const std::string& html) {
+    std::string result;
+    result.reserve(html.size());
+
+    bool inTag = false;
+    bool inScript = false;
+    bool inStyle = false;
+
+    size_t i = 0;
+    while (i < html.size()) {
+        char c = html[i];
+
+        if (c == '<') {
+            // Проверяем на script/style
+            std::string tagName;
+            size_t j = i + 1;
+            while (j < html.size() && j < i + 10 && html[j] != '>' && html[j] != ' ') {
+                tagName += static_cast<char>(std::tolower(html[j]));
+                j++;
+            }
+
+            if (tagName == "script") {
+                inScript = true;
+            } else if (tagName == "/script") {
+                inScript = false;
+            } else if (tagName == "style") {
+                inStyle = true;
+            } else if (tagName == "/style") {
+                inStyle = false;
+            }
+
+            inTag = true;
+        } else if (c == '>') {
+            inTag = false;
+            // Добавляем пробел после закрывающего тега
+            if (!result.empty() && result.back() != ' ') {
+                result += ' ';
+            }
+        } else if (!inTag && !inScript && !inStyle) {
+            // Декодируем HTML entities
+            if (c == '&') {
+                std::string entity;
+                size_t j = i + 1;
+                while (j < html.size() && j < i + 10 && html[j] != ';' && html[j] != ' ') {
+                    entity += html[j];
+                    j++;
+                }
+                if (j < html.size() && html[j] == ';') {
+                    if (entity == "nbsp" || entity == "#160") {
+                        result += ' ';
+                    } else if (entity == "lt") {
+                        result += '<';
+                    } else if (entity == "gt") {
+                        result += '>';
+                    } else if (entity == "amp") {
+                        result += '&';
+                    } else if (entity == "quot") {
+                        result += '"';
+                    } else if (entity == "apos") {
+                        result += '\'';
+                    } else {
+                        // Неизвестная entity - пропускаем или оставляем как есть
+                        result += ' ';
+                    }
+                    i = j;
+                } else {
+                    result += c;
+                }
+            } else {
+                result += c;
+            }
+        }
+
+        i++;
+    }
+
+    return result;
+}
+
+
+} // namespace
+
+static void BM_Normalize_Regex(benchmark::State& state) {
+    const auto& text = corpus(static_cast<int>(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(regexNormalize(text));
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(text.size()));
+}
+BENCHMARK(BM_Normalize_Regex)->Apply(corpora);
+
+static void BM_Normalize(benchmark::State& state, SimdLevel level) {
+    if (static_cast<int>(level) > static_cast<int>(TextNormalizer::detectedLevel())) {
+        state.SkipWithError("CPU does not support this kernel");
+        return;
+    }
+    const auto& text = corpus(static_cast<int>(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(TextNormalizer::normalize(text, level));
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(text.size()));
+}
+BENCHMARK_CAPTURE(BM_Normalize, scalar, SimdLevel::Scalar)->Apply(corpora);
+BENCHMARK_CAPTURE(BM_Normalize, sse2, SimdLevel::Sse2)->Apply(corpora);
+BENCHMARK_CAPTURE(BM_Normalize, avx2, SimdLevel::Avx2)->Apply(corpora);
+
+static void BM_Transcode_Legacy(benchmark::State& state) {
+    int kind = static_cast<int>(state.range(0));
+    const auto& data = encodedCorpus(kind);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(legacyToUtf8(data, kind));
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(data.size()));
+}
+BENCHMARK(BM_Transcode_Legacy)->Apply(encodings);
+
+static void BM_Transcode(benchmark::State& state, SimdLevel level) {
+    if (static_cast<int>(level) > static_cast<int>(TextNormalizer::detectedLevel())) {
+        state.SkipWithError("CPU does not support this kernel");
+        return;
+    }
+    int kind = static_cast<int>(state.range(0));
+    const auto& data = encodedCorpus(kind);
+    auto encoding = kind == Utf16 ? TextEncoding::Utf16Le : TextEncoding::Cp1251;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(EncodingConverter::toUtf8(data, encoding, level));
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(data.size()));
+}
+BENCHMARK_CAPTURE(BM_Transcode, scalar, SimdLevel::Scalar)->Apply(encodings);
+BENCHMARK_CAPTURE(BM_Transcode, sse2, SimdLevel::Sse2)->Apply(encodings);
+BENCHMARK_CAPTURE(BM_Transcode, avx2, SimdLevel::Avx2)->Apply(encodings);
+
+/// Определение кодировки большого UTF-8 файла: прежде — посимвольная проверка
+/// и копия в новую строку, теперь — проверка фрагмента и без копии
+static void BM_DetectAndConvert_Utf8(benchmark::State& state) {
+    const auto& text = corpus(Cyrillic);
+    for (auto _ : state) {
+        std::string data = text;
+        EncodingConverter::convertInPlace(data, EncodingConverter::detect(data));
+        benchmark::DoNotOptimize(data);
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(text.size()));
+}
+BENCHMARK(BM_DetectAndConvert_Utf8)->Unit(benchmark::kMicrosecond);
+
+static void BM_StripHtml_Legacy(benchmark::State& state) {
+    const auto& html = htmlCorpus();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(TextNormalizer::normalize(legacyStripHtml(html)));
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(html.size()));
+}
+BENCHMARK(BM_StripHtml_Legacy)->Unit(benchmark::kMicrosecond);
+
+static void BM_StripHtml_Streaming(benchmark::State& state) {
+    const auto& html = htmlCorpus();
+    for (auto _ : state) {
+        NormalizingSink sink(html.size());
+        MarkupStripper stripper(MarkupStripper::Mode::Html, sink);
+        stripper.feed(html);
+        stripper.finish();
+        benchmark::DoNotOptimize(sink.finish());
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(html.size()));
+}
+BENCHMARK(BM_StripHtml_Streaming)->Unit(benchmark::kMicrosecond);
+
+/// Разбор document.xml порциями по 64 KB (как при распаковке из ZIP)
+static void BM_XmlStream_Docx(benchmark::State& state) {
+    const auto& xml = docxCorpus();
+    constexpr size_t kChunk = 64 * 1024;
+    for (auto _ : state) {
+        NormalizingSink sink(xml.size());
+        DocxTextHandler handler(sink);
+        XmlStreamReader reader({"t", "p"}, handler);
+        for (size_t i = 0; i < xml.size(); i += kChunk) {
+            reader.feed(std::string_view(xml).substr(i, kChunk));
+        }
+        reader.finish();
+        benchmark::DoNotOptimize(sink.finish());
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(xml.size()));
+}
+BENCHMARK(BM_XmlStream_Docx)->Unit(benchmark::kMicrosecond);
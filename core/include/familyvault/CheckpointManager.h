@@ -0,0 +1,118 @@
+// CheckpointManager.h — WAL checkpoint вне пишущего потока
+// Во время массовой записи (сканирование, извлечение текста) автоматический
+// checkpoint выключен; фоновый поток переносит WAL в простое (PASSIVE) и
+// усекает файл (TRUNCATE), когда читатели не мешают. Размер файла WAL без
+// TRUNCATE не уменьшается, поэтому повторный checkpoint — только если прошлый
+// оставил кадры или с тех пор была запись. Метрики — stats()
+
+#pragma once
+
+#include "Database.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace FamilyVault {
+
+struct CheckpointOptions {
+    std::chrono::milliseconds pollInterval{1000};   // Как часто проверять размер WAL
+    std::chrono::milliseconds idleDelay{2000};      // Тишина после последней записи
+    int64_t passiveThresholdBytes = 4LL << 20;      // В простое: PASSIVE если WAL больше
+    int64_t truncateThresholdBytes = 16LL << 20;    // После полного PASSIVE — TRUNCATE
+    int64_t forceThresholdBytes = 64LL << 20;       // PASSIVE даже во время массовой записи
+    int autocheckpointPages = 1000;                 // Восстанавливается после массовой записи
+};
+
+struct CheckpointStats {
+    int64_t walBytes = 0;           // Текущий размер файла WAL
+    int64_t checkpoints = 0;        // Выполнено checkpoint (любых)
+    int64_t truncations = 0;        // Из них успешных TRUNCATE
+    int64_t incomplete = 0;         // PASSIVE перенёс не весь WAL (мешали читатели)
+    int64_t lastLatencyUs = 0;
+    int64_t maxLatencyUs = 0;
+    int64_t totalLatencyUs = 0;
+    int64_t lastCheckpointAt = 0;   // Unix timestamp
+    bool bulkActive = false;
+};
+
+class CheckpointManager {
+public:
+    /// Массовая запись: пока жив хотя бы один объект, autocheckpoint выключен
+    class BulkWrite {
+    public:
+        BulkWrite() = default;
+        explicit BulkWrite(CheckpointManager* manager);
+        ~BulkWrite();
+        BulkWrite(BulkWrite&& other) noexcept;
+        BulkWrite& operator=(BulkWrite&& other) noexcept;
+        BulkWrite(const BulkWrite&) = delete;
+        BulkWrite& operator=(const BulkWrite&) = delete;
+
+        bool active() const { return m_manager != nullptr; }
+
+    private:
+        CheckpointManager* m_manager = nullptr;
+    };
+
+    explicit CheckpointManager(std::shared_ptr<Database> db, CheckpointOptions options = {});
+
+    /// Останавливает поток. BulkWrite не должны переживать менеджер
+    ~CheckpointManager();
+
+    CheckpointManager(const CheckpointManager&) = delete;
+    CheckpointManager& operator=(const CheckpointManager&) = delete;
+
+    void start();
+    void stop();
+    bool isRunning() const;
+
+    /// Начать массовую запись (вложенные и параллельные — со счётчиком)
+    [[nodiscard]] BulkWrite beginBulkWrite();
+
+    /// Была запись — фоновый checkpoint откладывается на idleDelay
+    void noteWrite();
+
+    /// Checkpoint сейчас: PASSIVE, затем TRUNCATE если WAL перенесён целиком
+    /// @return true если WAL перенесён целиком
+    bool checkpointNow(bool truncate = true);
+
+    /// Размер файла WAL (0 если нет файла или БД в памяти)
+    int64_t walSizeBytes() const;
+
+    CheckpointStats stats() const;
+
+private:
+    std::shared_ptr<Database> m_db;
+    CheckpointOptions m_options;
+
+    std::thread m_worker;
+    bool m_stopRequested = false;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_condition;
+
+    std::mutex m_bulkMutex;                     // Переключение autocheckpoint
+    int m_bulkCount = 0;
+    std::atomic<int64_t> m_lastWrite{0};        // steady_clock, мс
+
+    mutable std::mutex m_statsMutex;
+    CheckpointStats m_stats;
+    int m_framesLeft = -1;              // Кадров после последнего PASSIVE (-1 — не было)
+    uint32_t m_checkpointedVersion = 0; // Database::dataVersion() перед ним
+
+    /// Есть ли в WAL кадры, не перенесённые последним checkpoint
+    bool hasPendingFrames() const;
+
+    void workerThread();
+    void endBulkWrite();
+
+    /// Один checkpoint с замером задержки
+    WalCheckpointResult runCheckpoint(WalCheckpointMode mode);
+
+    static int64_t nowMs();
+};
+
+} // namespace FamilyVault
@@ -2,6 +2,7 @@
 
 #include "Database.h"
 #include "Models.h"
+#include "SuggestIndex.h"
 #include <memory>
 #include <optional>
 #include <string>
@@ -14,6 +15,9 @@ public:
     explicit CloudAccountManager(std::shared_ptr<Database> db);
     ~CloudAccountManager();
 
+    /// Подключить индекс автодополнения (имена облачных файлов)
+    void setSuggestIndex(std::shared_ptr<SuggestIndex> suggest);
+
     CloudAccount addAccount(const std::string& type,
                             const std::string& email,
                             const std::optional<std::string>& displayName = std::nullopt,
@@ -44,6 +48,13 @@ public:
 
 private:
     std::shared_ptr<Database> m_db;
+    std::shared_ptr<SuggestIndex> m_suggest;
+
+    /// (id, name) файлов аккаунта (или одного файла) — читаются до удаления,
+    /// чтобы уменьшить счётчики в индексе автодополнения
+    std::vector<std::pair<int64_t, std::string>> cloudFileNames(
+        int64_t accountId, const std::optional<std::string>& cloudId = std::nullopt) const;
+    void forgetCloudFiles(const std::vector<std::pair<int64_t, std::string>>& files);
 
     bool ensureAccountExists(int64_t accountId) const;
 
@@ -4,16 +4,21 @@
 #pragma once
 
 #include "export.h"
+#include "IngestSignal.h"
 
 #include <memory>
 #include <functional>
 #include <atomic>
 #include <thread>
 #include <mutex>
+#include <compare>
 #include <condition_variable>
-#include <queue>
+#include <set>
+#include <unordered_map>
 #include <optional>
 #include <string>
+#include <vector>
+#include <cstdint>
 
 #if ENABLE_TEXT_EXTRACTION
 #include "TextExtractor.h"
@@ -25,7 +30,9 @@ namespace FamilyVault {
         std::string method;
         std::string language;
         double confidence = 0.0;
+        int failedPages = 0;
         bool isEmpty() const { return text.empty(); }
+        bool isPartial() const { return failedPages > 0; }
     };
     
     /// No-op registry that never extracts anything
@@ -36,6 +43,7 @@ namespace FamilyVault {
         }
         bool canExtract(const std::string&) const { return false; }
         std::optional<ExtractionResult> extract(const std::string&, const std::string&) { return std::nullopt; }
+        void setMaxTextSize(size_t) {}
     };
 }
 #endif
@@ -44,6 +52,8 @@ namespace FamilyVault {
 
 // Forward declarations
 class Database;
+class CheckpointManager;
+class MaintenanceScheduler;
 
 // ═══════════════════════════════════════════════════════════
 // Статус индексации контента
@@ -57,6 +67,12 @@ struct ContentIndexerStatus {
     std::string currentFile; // Текущий обрабатываемый файл
 };
 
+/// Приоритет файла в очереди извлечения
+enum class ContentPriority : int32_t {
+    Interactive = 0,    // Файл открыт или найден пользователем — раньше фоновых
+    Background = 1      // Фоновая индексация: дешёвые файлы раньше дорогих
+};
+
 // ═══════════════════════════════════════════════════════════
 // ContentIndexer — фоновое извлечение текста
 // ═══════════════════════════════════════════════════════════
@@ -98,12 +114,20 @@ public:
     bool processFile(int64_t fileId);
     
     /// Добавить файл в очередь обработки
-    void enqueueFile(int64_t fileId);
+    /// @note Файл, уже стоящий в очереди, не дублируется — только повышается приоритет
+    void enqueueFile(int64_t fileId, ContentPriority priority = ContentPriority::Background);
+    
+    /// Пользователь открыл или нашёл файл — извлечь текст раньше фоновой очереди
+    void prioritizeFile(int64_t fileId) { enqueueFile(fileId, ContentPriority::Interactive); }
     
     /// Добавить все файлы без извлечённого текста в очередь
-    /// @return Количество добавленных файлов
+    /// @return Количество добавленных файлов (уже стоящие в очереди не считаются)
     int enqueueUnprocessed();
     
+    /// Оценка стоимости извлечения: размер с поправкой на формат
+    /// (байт PDF или офисного архива дороже байта обычного текста)
+    static int64_t estimateCost(const std::string& mimeType, int64_t size);
+    
     /// Переиндексировать все файлы
     /// @param onProgress Callback для прогресса
     /// @note Блокирует до завершения
@@ -122,6 +146,17 @@ public:
     void setProgressCallback(ProgressCallback cb);
     void setFileProcessedCallback(FileProcessedCallback cb);
     
+    /// Подключить менеджер WAL checkpoint (до start): очередь — массовая запись
+    void setCheckpointManager(std::shared_ptr<CheckpointManager> checkpoints);
+    
+    /// Подключить планировщик обслуживания (до start): обработка файлов —
+    /// активность, фоновые порции ждут простоя
+    void setMaintenanceScheduler(std::shared_ptr<MaintenanceScheduler> maintenance);
+    
+    /// Подключить сигнал IndexManager (до start): после сканирования рабочий
+    /// поток сам забирает новые файлы, в простое БД не опрашивается
+    void setIngestSignal(std::shared_ptr<IngestSignal> ingest);
+    
     // ═══════════════════════════════════════════════════════════
     // Настройки
     // ═══════════════════════════════════════════════════════════
@@ -132,8 +167,9 @@ public:
     /// Установить задержку между файлами (мс)
     void setDelayBetweenFiles(int ms) { m_delayBetweenFiles = ms; }
     
-    /// Установить максимальный размер текста для индексации (KB)
-    void setMaxTextSizeKB(int sizeKB) { m_maxTextSizeKB.store(sizeKB); }
+    /// Установить максимальный размер текста для индексации (KB);
+    /// экстракторы перестают читать файл, набрав столько текста
+    void setMaxTextSizeKB(int sizeKB);
     
     /// Получить максимальный размер текста (KB)
     int getMaxTextSizeKB() const { return m_maxTextSizeKB.load(); }
@@ -142,12 +178,35 @@ private:
     /// Рабочая функция потока
     void workerThread();
     
+    /// Сигнал IngestSignal: разбудить поток для выборки новых файлов
+    void onIngest();
+    
+    /// Поставить файл в очередь (m_queueMutex захвачен)
+    /// @return true если файла в очереди ещё не было
+    bool pushLocked(int64_t fileId, ContentPriority priority, int64_t cost);
+    
     /// Обработать файл и сохранить результат в БД
     bool processFileInternal(int64_t fileId);
     
     /// Сохранить извлечённый контент в БД
     void saveContent(int64_t fileId, const ExtractionResult& result);
     
+    /// Текст, уже извлечённый из файла с тем же checksum: локальная копия
+    /// (files_fts) или текст пира (content_cache). nullopt — такого нет или
+    /// копия сохранена с меньшим лимитом и обрезана
+    std::optional<ExtractionResult> loadCachedContent(const std::string& checksum) const;
+    
+    /// Удалить из content_cache давние записи, checksum которых нет среди файлов
+    void pruneContentCache();
+    
+    /// Сверить флаг extractable новых строк mime_types с реестром экстракторов
+    /// и связать их номера с экстракторами (bindMimeIds); файлы типа, ставшего
+    /// (не)поддерживаемым, ставятся в ожидание или снимаются
+    void classifyMimeTypes();
+    
+    /// Номер типа уже связан с реестром (иначе — сначала classifyMimeTypes)
+    bool isMimeClassified(int64_t mimeId) const;
+    
     /// Обновить FTS индекс
     void updateFts(int64_t fileId, const std::string& content);
     
@@ -156,21 +215,38 @@ private:
         int64_t id = 0;
         std::string fullPath;
         std::string mimeType;
+        int64_t mimeId = 0;     // 0 — без mime_id (записи пиров): выбор по строке
         int64_t size = 0;
+        std::string checksum;   // Пусто — ещё не вычислен
     };
     std::optional<FileInfo> getFileInfo(int64_t fileId) const;
     
     // Database и extractors
     std::shared_ptr<Database> m_db;
     std::shared_ptr<TextExtractorRegistry> m_extractors;
+    std::shared_ptr<CheckpointManager> m_checkpoints;
+    std::shared_ptr<MaintenanceScheduler> m_maintenance;
+    std::shared_ptr<IngestSignal> m_ingest;
     
     // Worker thread
     std::thread m_worker;
     std::atomic<bool> m_running{false};
     std::atomic<bool> m_stopRequested{false};
     
-    // Queue
-    std::queue<int64_t> m_queue;
+    // Queue: приоритет, затем класс стоимости (log2), внутри класса — порядок поступления
+    struct QueueEntry {
+        ContentPriority priority = ContentPriority::Background;
+        int costClass = 0;
+        uint64_t seq = 0;
+        int64_t fileId = 0;
+        auto operator<=>(const QueueEntry&) const = default;
+    };
+    std::set<QueueEntry> m_queue;
+    std::unordered_map<int64_t, std::set<QueueEntry>::iterator> m_queued;  // fileId → позиция
+    uint64_t m_queueSeq = 0;
+    int64_t m_activeFileId = 0;         // Файл, который сейчас обрабатывает рабочий поток
+    bool m_workAvailable = false;       // Есть файлы с extraction_pending вне очереди
+    bool m_morePending = false;         // Последняя выборка упёрлась в лимит
     mutable std::mutex m_queueMutex;
     std::condition_variable m_queueCondition;
     
@@ -185,6 +261,11 @@ private:
     FileProcessedCallback m_fileProcessedCallback;
     mutable std::mutex m_callbackMutex;
     
+    // Строки mime_types с id <= m_classifiedMimeId уже сверены с реестром;
+    // читается без блокировки, m_mimeMutex — только для сверки
+    std::atomic<int64_t> m_classifiedMimeId{0};
+    std::mutex m_mimeMutex;
+    
     // Settings
     int m_maxFilesPerSession = 1000;
     int m_delayBetweenFiles = 10;          // ms
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <optional>
 #include <functional>
@@ -11,6 +12,8 @@
 
 #include <sqlite3.h>
 
+#include "QueryMetrics.h"
+
 struct sqlite3;
 struct sqlite3_stmt;
 
@@ -26,6 +29,22 @@ public:
         : std::runtime_error(message) {}
 };
 
+/// Режим checkpoint (sqlite3_wal_checkpoint_v2)
+enum class WalCheckpointMode {
+    Passive,    // Без ожидания: переносит то, что не мешает читателям
+    Full,       // Ждёт писателей, затем переносит весь WAL
+    Restart,    // Как Full + ждёт читателей, WAL пишется с начала
+    Truncate    // Как Restart + усекает файл WAL до нуля
+};
+
+struct WalCheckpointResult {
+    bool busy = false;          // Не удалось получить блокировку (Full/Restart/Truncate)
+    int logFrames = 0;          // Кадров в WAL
+    int checkpointedFrames = 0; // Перенесено в основной файл
+
+    bool complete() const { return !busy && checkpointedFrames >= logFrames; }
+};
+
 /// RAII обёртка над SQLite соединением
 class Database {
 public:
@@ -129,12 +148,73 @@ public:
         return result;
     }
 
+    /// Типизированный запрос (типы запросов — в TypedQuery.h): колонки и маппер из схемы,
+    /// число аргументов проверяется при компиляции, statement кэшируется
+    template<typename Query, typename... Args>
+    std::vector<typename Query::Row> select(Args&&... args) {
+        static_assert(sizeof...(Args) == Query::paramCount,
+                      "Argument count does not match '?' placeholders in query");
+        CachedStatement stmt(*this, Query::sql());
+        bindAll(stmt.get(), 1, std::forward<Args>(args)...);
+
+        std::vector<typename Query::Row> results;
+        while (stepRow(stmt.get())) {
+            results.push_back(Query::Schema::read(stmt.get()));
+        }
+        return results;
+    }
+
+    /// Типизированный запрос одной записи
+    template<typename Query, typename... Args>
+    std::optional<typename Query::Row> selectOne(Args&&... args) {
+        static_assert(sizeof...(Args) == Query::paramCount,
+                      "Argument count does not match '?' placeholders in query");
+        CachedStatement stmt(*this, Query::sql());
+        bindAll(stmt.get(), 1, std::forward<Args>(args)...);
+
+        std::optional<typename Query::Row> result;
+        if (stepRow(stmt.get())) {
+            result = Query::Schema::read(stmt.get());
+        }
+        return result;
+    }
+
+    /// Количество statement'ов в кэше
+    size_t cachedStatementCount() const;
+
     /// ID последней вставленной записи
     int64_t lastInsertId() const;
 
     /// Количество изменённых строк
     int changesCount() const;
 
+    /// Всего изменений с открытия соединения (включая триггеры и FTS merge)
+    int64_t totalChangesCount() const;
+
+    /// Checkpoint WAL. Блокирующие режимы ждут не дольше
+    /// busyTimeoutMs (а не общего busy_timeout соединения)
+    WalCheckpointResult walCheckpoint(WalCheckpointMode mode = WalCheckpointMode::Passive,
+                                      int busyTimeoutMs = 100);
+
+    /// Версия данных main: меняется после каждой записи этого соединения
+    /// и после замеченных им коммитов других соединений (SQLITE_FCNTL_DATA_VERSION)
+    uint32_t dataVersion() const;
+
+    /// Автоматический checkpoint после pages страниц WAL (0 — выключить)
+    void setWalAutocheckpoint(int pages);
+
+    /// Путь к файлу БД
+    const std::string& path() const { return m_dbPath; }
+
+    /// Метрики запросов этого соединения (время, строки, кэш, блокировки, медленные)
+    QueryMetrics& queryMetrics() const { return *m_metrics; }
+
+    /// Прерывание долгих запросов: shouldAbort() вызывается каждые
+    /// instructions инструкций VM; true — текущий запрос завершается с ошибкой
+    /// SQLITE_INTERRUPT (DatabaseException). Действует на всё соединение.
+    /// nullptr — снять обработчик
+    void setProgressHandler(int instructions, std::function<bool()> shouldAbort);
+
     /// Транзакции
     void beginTransaction();
     void commit();
@@ -158,6 +238,8 @@ public:
     static int64_t getInt64(sqlite3_stmt* stmt, int col);
     static double getDouble(sqlite3_stmt* stmt, int col);
     static std::string getString(sqlite3_stmt* stmt, int col);
+    /// Без копирования: view валиден до следующего step/finalize
+    static std::string_view getStringView(sqlite3_stmt* stmt, int col);
     static std::optional<std::string> getStringOpt(sqlite3_stmt* stmt, int col);
     static std::optional<int64_t> getInt64Opt(sqlite3_stmt* stmt, int col);
     static std::optional<double> getDoubleOpt(sqlite3_stmt* stmt, int col);
@@ -167,6 +249,40 @@ private:
     sqlite3* m_db = nullptr;
     std::string m_dbPath;
 
+    // В куче — адрес, переданный в SQLite, не меняется при перемещении Database
+    std::unique_ptr<std::function<bool()>> m_progressHandler;
+
+    // Кэш prepared statements для select<>(); ключ — адрес SQL текста запроса
+    struct StatementCache;
+    std::unique_ptr<StatementCache> m_statementCache;
+
+    // Метрики и busy handler — в куче по той же причине, что и m_progressHandler
+    std::unique_ptr<QueryMetrics> m_metrics;
+    struct BusyHandler;
+    std::unique_ptr<BusyHandler> m_busyHandler;
+
+    /// Взять statement из кэша (или подготовить) и вернуть после использования.
+    /// Занятый statement в кэше отсутствует — параллельный вызов подготовит свой
+    class CachedStatement {
+    public:
+        CachedStatement(Database& db, std::string_view sql);
+        ~CachedStatement();
+        CachedStatement(const CachedStatement&) = delete;
+        CachedStatement& operator=(const CachedStatement&) = delete;
+        sqlite3_stmt* get() const { return m_stmt; }
+
+    private:
+        Database& m_db;
+        const char* m_key;
+        sqlite3_stmt* m_stmt;
+    };
+
+    void finalizeCachedStatements();
+
+    /// Учёт выполнения для m_metrics: от prepare/выдачи из кэша до finalize/возврата
+    void beginStatement(sqlite3_stmt* stmt, int64_t prepareNs);
+    void endStatement(sqlite3_stmt* stmt);
+
     // Миграции
     void applyMigrations();
     int getCurrentVersion();
@@ -176,6 +292,7 @@ private:
     sqlite3_stmt* prepare(const std::string& sql);
     void step(sqlite3_stmt* stmt);
     bool stepRow(sqlite3_stmt* stmt);
+    int timedStep(sqlite3_stmt* stmt);
     void finalize(sqlite3_stmt* stmt);
 
     // Привязка параметров
@@ -0,0 +1,68 @@
+// DirectoryTree.h — Дерево каталогов отслеживаемых папок (таблица directories)
+// Файл ссылается на свой каталог (files.directory_id), каталог — на родителя.
+// Пути каталогов восстанавливаются по цепочке родителей и кэшируются в памяти
+
+#pragma once
+
+#include "Database.h"
+#include "Models.h"
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace FamilyVault {
+
+/// Потокобезопасный кэш над таблицей directories.
+/// ID 0 — корень отслеживаемой папки (строки в таблице нет)
+class DirectoryTree {
+public:
+    explicit DirectoryTree(std::shared_ptr<Database> db);
+    ~DirectoryTree();
+
+    DirectoryTree(const DirectoryTree&) = delete;
+    DirectoryTree& operator=(const DirectoryTree&) = delete;
+
+    /// ID каталога по пути относительно папки ("2023/Отпуск"), недостающие создаются
+    /// @return 0 для пустого пути
+    int64_t resolve(int64_t folderId, std::string_view directoryPath);
+
+    /// ID существующего каталога (без создания)
+    std::optional<int64_t> find(int64_t folderId, std::string_view directoryPath) const;
+
+    /// Путь каталога относительно папки; "" для 0 и неизвестных ID
+    std::string path(int64_t directoryId) const;
+
+    /// Непосредственные подкаталоги, по имени
+    std::vector<DirectoryEntry> children(int64_t folderId, int64_t parentId) const;
+
+    /// Удалить каталоги без файлов и подкаталогов
+    /// @return Количество удалённых каталогов
+    int prune(int64_t folderId);
+
+    /// Сбросить кэш папки (папка удалена — строки ушли каскадом)
+    void forgetFolder(int64_t folderId);
+
+    /// Каталог относительного пути файла: "a/b/c.jpg" → "a/b", "c.jpg" → ""
+    static std::string_view parentOf(std::string_view relativePath);
+
+private:
+    std::shared_ptr<Database> m_db;
+
+    // "folderId/путь" → ID и обратно; заполняются по мере обращений
+    mutable std::mutex m_mutex;
+    mutable std::unordered_map<std::string, int64_t> m_ids;
+    mutable std::unordered_map<int64_t, std::pair<int64_t, std::string>> m_paths;  // ID → (папка, путь)
+
+    static std::string cacheKey(int64_t folderId, std::string_view path);
+
+    /// Путь по цепочке родителей из БД (вызывается под m_mutex)
+    std::string loadPathLocked(int64_t directoryId) const;
+
+    void rememberLocked(int64_t folderId, int64_t directoryId, std::string path) const;
+};
+
+} // namespace FamilyVault
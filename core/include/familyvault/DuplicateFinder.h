@@ -78,13 +78,14 @@ public:
     /// Вычислить checksum для конкретного файла
     void computeChecksumForFile(int64_t fileId);
 
+    /// Вычислить SHA-256 checksum (hex) файла на диске
+    /// @throws std::runtime_error если файл не читается
+    static std::string computeChecksum(const std::string& filePath);
+
 private:
     std::shared_ptr<Database> m_db;
     IndexManager* m_indexMgr;  // Optional, not owned
 
-    /// Вычислить SHA-256 checksum
-    std::string computeChecksum(const std::string& filePath);
-
     /// Получить полный путь к файлу
     std::string getFilePath(int64_t fileId);
 
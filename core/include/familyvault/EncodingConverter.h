@@ -0,0 +1,54 @@
+// EncodingConverter.h — Определение кодировки текстовых файлов и перекодировка в UTF-8
+// UTF-8 без BOM не копируется; UTF-16 и CP1251 перекодируются блоками (SSE2/AVX2)
+
+#pragma once
+
+#include "TextNormalizer.h"
+#include <string>
+#include <string_view>
+
+namespace FamilyVault {
+
+/// Кодировки, которые распознаёт PlainTextExtractor
+enum class TextEncoding {
+    Utf8,
+    Utf8Bom,
+    Utf16Le,    // С BOM FF FE
+    Utf16Be,    // С BOM FE FF
+    Cp1251      // Windows-1251, без BOM — по эвристике
+};
+
+class EncodingConverter {
+public:
+    /// Определить кодировку: BOM, затем проверка UTF-8 на начальном фрагменте,
+    /// затем эвристика CP1251 (много байтов кириллицы 0xC0–0xFF)
+    static TextEncoding detect(std::string_view data);
+
+    /// Перекодировать в UTF-8. BOM отбрасывается; непарные суррогаты UTF-16
+    /// заменяются на U+FFFD, пары кодируются 4 байтами
+    static std::string toUtf8(std::string_view data, TextEncoding encoding);
+
+    /// То же с явным выбором ядра (тесты и бенчмарки)
+    static std::string toUtf8(std::string_view data, TextEncoding encoding, SimdLevel level);
+
+    /// Перекодировать на месте: для UTF-8 только отрезается BOM, без копии буфера
+    static void convertInPlace(std::string& data, TextEncoding encoding);
+
+    /// Потоковая перекодировка фрагмента (без BOM) в out, буфер out переиспользуется.
+    /// Возвращает число использованных байтов: старший суррогат UTF-16 в конце
+    /// фрагмента остаётся для следующего; last — фрагмент последний
+    static size_t decodeChunk(std::string_view data, TextEncoding encoding, bool last,
+                              std::string& out);
+
+    /// То же с явным выбором ядра (тесты и бенчмарки)
+    static size_t decodeChunk(std::string_view data, TextEncoding encoding, bool last,
+                              std::string& out, SimdLevel level);
+
+    /// Длина BOM в начале данных этой кодировки
+    static size_t bomLength(TextEncoding encoding);
+
+    /// Имя кодировки для логов ("utf-8", "utf-16le", "cp1251", ...)
+    static const char* name(TextEncoding encoding);
+};
+
+} // namespace FamilyVault
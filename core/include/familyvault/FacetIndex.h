@@ -0,0 +1,150 @@
+// FacetIndex.h — In-memory индекс фасетов (теги, тип, расширение, год, папка)
+// Хранит битмапы ID файлов для каждого значения фасета, чтобы счётчики
+// для любого набора результатов считались пересечением битмапов, а не SQL агрегатом
+
+#pragma once
+
+#include "Database.h"
+#include "Models.h"
+#include "RoaringBitmap.h"
+#include <memory>
+#include <vector>
+#include <string>
+#include <optional>
+#include <unordered_map>
+#include <shared_mutex>
+
+namespace FamilyVault {
+
+// ═══════════════════════════════════════════════════════════
+// Типы фасетов
+// ═══════════════════════════════════════════════════════════
+
+enum class FacetKind : int32_t {
+    Tag = 0,
+    ContentType = 1,
+    Extension = 2,
+    Year = 3,
+    Folder = 4
+};
+
+struct FacetCount {
+    std::string value;      // Имя тега, "image", "jpg", "2024", ID папки
+    int64_t count = 0;
+};
+
+// ═══════════════════════════════════════════════════════════
+// FacetIndex
+// ═══════════════════════════════════════════════════════════
+
+/// Потокобезопасный индекс: строится один раз при старте (rebuild),
+/// затем поддерживается инкрементально через IndexManager и TagManager.
+class FacetIndex {
+public:
+    explicit FacetIndex(std::shared_ptr<Database> db);
+    ~FacetIndex();
+
+    FacetIndex(const FacetIndex&) = delete;
+    FacetIndex& operator=(const FacetIndex&) = delete;
+
+    /// Полная перестройка из БД (files, tags, file_tags)
+    void rebuild();
+
+    /// Построен ли индекс (до rebuild() менеджеры используют SQL)
+    bool isBuilt() const;
+
+    // ═══════════════════════════════════════════════════════════
+    // Инкрементальное обновление
+    // ═══════════════════════════════════════════════════════════
+
+    /// Добавить или обновить файл (теги файла сохраняются)
+    void upsertFile(int64_t fileId, int64_t folderId, ContentType contentType,
+                    const std::string& extension, int64_t modifiedAt);
+
+    /// Удалить файл из всех фасетов, включая теги
+    void removeFile(int64_t fileId);
+
+    /// Удалить набор файлов (пакетное удаление при сканировании)
+    void removeFiles(const RoaringBitmap& fileIds);
+
+    /// Удалить все файлы папки
+    void removeFolder(int64_t folderId);
+
+    /// Зарегистрировать тег в каталоге
+    void registerTag(int64_t tagId, const std::string& name, TagSource source);
+
+    void addFileTag(int64_t fileId, int64_t tagId);
+    void removeFileTag(int64_t fileId, const std::string& tagName);
+
+    // ═══════════════════════════════════════════════════════════
+    // Запросы
+    // ═══════════════════════════════════════════════════════════
+
+    /// Все теги с количеством файлов (по имени)
+    std::vector<Tag> getAllTags() const;
+
+    /// Популярные теги (по количеству файлов)
+    std::vector<Tag> getPopularTags(int limit) const;
+
+    /// Количество файлов с тегом (0 если тег не найден)
+    int64_t countFilesByTag(const std::string& tagName) const;
+
+    /// Счётчики значений фасета
+    /// @param within Ограничить набором файлов (nullptr = все файлы)
+    /// @param limit Максимум значений (0 = без ограничения)
+    std::vector<FacetCount> facetCounts(FacetKind kind,
+                                        const RoaringBitmap* within = nullptr,
+                                        int limit = 0) const;
+
+    /// Битмап файлов с данным значением фасета
+    RoaringBitmap filesWith(FacetKind kind, const std::string& value) const;
+
+    /// Количество проиндексированных файлов
+    int64_t fileCount() const;
+
+private:
+    struct TagEntry {
+        std::string name;
+        TagSource source = TagSource::User;
+        RoaringBitmap files;
+    };
+
+    using ValueMap = std::unordered_map<std::string, RoaringBitmap>;
+
+    std::shared_ptr<Database> m_db;
+    mutable std::shared_mutex m_mutex;
+    bool m_built = false;
+
+    RoaringBitmap m_allFiles;
+    std::unordered_map<int64_t, TagEntry> m_tags;
+    std::unordered_map<std::string, int64_t> m_tagIdsByName;
+    ValueMap m_contentTypes;
+    ValueMap m_extensions;
+    ValueMap m_years;
+    ValueMap m_folders;
+
+    /// Значения не-теговых фасетов файла — указатели на элементы ValueMap
+    /// (адреса элементов unordered_map стабильны), nullptr — значения нет.
+    /// Удаление файла трогает только его битмапы, а не все значения фасета
+    struct FileFacets {
+        ValueMap::value_type* contentType = nullptr;
+        ValueMap::value_type* extension = nullptr;
+        ValueMap::value_type* year = nullptr;
+        ValueMap::value_type* folder = nullptr;
+    };
+    std::unordered_map<uint32_t, FileFacets> m_fileFacets;
+
+    /// Удалить файл из не-теговых фасетов (под эксклюзивной блокировкой)
+    void removeFileAttributesLocked(uint32_t fileId);
+
+    /// Добавить файл в не-теговые фасеты (под эксклюзивной блокировкой)
+    void addFileAttributesLocked(uint32_t fileId, int64_t folderId, ContentType contentType,
+                                 const std::string& extension, int64_t modifiedAt);
+
+    const ValueMap* valueMap(FacetKind kind) const;
+
+    static std::string yearOf(int64_t timestamp);
+    static Tag makeTag(int64_t id, const TagEntry& entry);
+};
+
+} // namespace FamilyVault
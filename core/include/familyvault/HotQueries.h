@@ -0,0 +1,197 @@
+// HotQueries.h — SQL горячих запросов IndexManager, DuplicateFinder,
+// IndexSyncManager и ContentIndexer
+// Вынесены из реализаций, чтобы регрессия планов (test_query_plans.cpp)
+// делала EXPLAIN QUERY PLAN ровно тех строк, что выполняются в коде
+
+#pragma once
+
+#include "RowSchemas.h"
+
+namespace FamilyVault::queries {
+
+// ═══════════════════════════════════════════════════════════
+// IndexManager: списки файлов
+// ═══════════════════════════════════════════════════════════
+
+using RecentFiles = sql::Select<schema::LocalFile,
+    "FROM files f JOIN watched_folders wf ON f.folder_id = wf.id "
+    "ORDER BY f.indexed_at DESC LIMIT ?">;
+using FilesByFolder = sql::Select<schema::LocalFile,
+    "FROM files f JOIN watched_folders wf ON f.folder_id = wf.id "
+    "WHERE f.folder_id = ? ORDER BY f.name LIMIT ? OFFSET ?">;
+using FilesByDirectory = sql::Select<schema::LocalFile,
+    "FROM files f JOIN watched_folders wf ON f.folder_id = wf.id "
+    "WHERE f.folder_id = ? AND f.directory_id = ? ORDER BY f.name LIMIT ? OFFSET ?">;
+
+/// Компактные строки (FileRecordCompactView): параметр limit
+inline constexpr const char* RECENT_FILES_COMPACT_SQL = R"SQL(
+    SELECT f.id, f.folder_id, f.relative_path, wf.path, f.name, f.extension,
+           f.size, f.content_type, f.modified_at, f.is_remote
+    FROM files f
+    JOIN watched_folders wf ON f.folder_id = wf.id
+    ORDER BY f.indexed_at DESC
+    LIMIT ?
+)SQL";
+
+/// Параметры: folder_id, limit, offset
+inline constexpr const char* FILES_BY_FOLDER_COMPACT_SQL = R"SQL(
+    SELECT f.id, f.folder_id, f.relative_path, wf.path, f.name, f.extension,
+           f.size, f.content_type, f.modified_at, f.is_remote
+    FROM files f
+    JOIN watched_folders wf ON f.folder_id = wf.id
+    WHERE f.folder_id = ?
+    ORDER BY f.name
+    LIMIT ? OFFSET ?
+)SQL";
+
+/// Параметры: folder_id, directory_id, limit, offset
+inline constexpr const char* FILES_BY_DIRECTORY_COMPACT_SQL = R"SQL(
+    SELECT f.id, f.folder_id, f.relative_path, wf.path, f.name, f.extension,
+           f.size, f.content_type, f.modified_at, f.is_remote
+    FROM files f
+    JOIN watched_folders wf ON f.folder_id = wf.id
+    WHERE f.folder_id = ? AND f.directory_id = ?
+    ORDER BY f.name
+    LIMIT ? OFFSET ?
+)SQL";
+
+// ═══════════════════════════════════════════════════════════
+// DuplicateFinder
+// ═══════════════════════════════════════════════════════════
+
+/// Группы локальных дубликатов, крупнейшая экономия первой
+inline constexpr const char* LOCAL_DUPLICATE_GROUPS_SQL = R"SQL(
+    SELECT checksum, size
+    FROM files
+    WHERE checksum IS NOT NULL
+      AND source_device_id IS NULL
+    GROUP BY checksum
+    HAVING COUNT(*) > 1
+    ORDER BY size * (COUNT(*) - 1) DESC
+)SQL";
+
+/// Локальные копии группы (mapFileRecord); параметр checksum
+inline constexpr const char* LOCAL_DUPLICATE_COPIES_SQL = R"SQL(
+    SELECT f.id, f.folder_id, f.relative_path, f.name, f.extension, f.size,
+           f.mime_type, f.content_type, f.checksum, f.created_at, f.modified_at,
+           f.indexed_at, COALESCE(f.visibility, wf.visibility) as visibility,
+           f.source_device_id, f.is_remote, f.sync_version, f.last_modified_by
+    FROM files f
+    JOIN watched_folders wf ON f.folder_id = wf.id
+    WHERE f.checksum = ? AND f.source_device_id IS NULL
+    ORDER BY f.indexed_at
+)SQL";
+
+/// Копии группы на других устройствах (mapFileRecord); параметр checksum
+inline constexpr const char* REMOTE_DUPLICATE_COPIES_SQL = R"SQL(
+    SELECT f.id, f.folder_id, f.relative_path, f.name, f.extension, f.size,
+           f.mime_type, f.content_type, f.checksum, f.created_at, f.modified_at,
+           f.indexed_at, COALESCE(f.visibility, wf.visibility) as visibility,
+           f.source_device_id, f.is_remote, f.sync_version, f.last_modified_by
+    FROM files f
+    JOIN watched_folders wf ON f.folder_id = wf.id
+    WHERE f.checksum = ? AND f.source_device_id IS NOT NULL
+)SQL";
+
+// ═══════════════════════════════════════════════════════════
+// IndexSyncManager: локальные изменения для пиров
+// ═══════════════════════════════════════════════════════════
+
+// Только Family (Private файлы не покидают устройство); visibility
+// наследуется от папки через COALESCE
+
+/// Параметры: since, limit, offset
+inline constexpr const char* LOCAL_CHANGES_PAGE_SQL = R"SQL(
+    SELECT f.id, f.folder_id, f.relative_path, f.name, f.extension, f.size, f.mime_type,
+           f.content_type, f.checksum, f.created_at, f.modified_at, f.indexed_at,
+           COALESCE(f.visibility, wf.visibility) as visibility,
+           f.source_device_id, f.is_remote, f.sync_version
+    FROM files f
+    JOIN watched_folders wf ON f.folder_id = wf.id
+    WHERE COALESCE(f.visibility, wf.visibility) = 1
+      AND f.is_remote = 0
+      AND f.indexed_at > ?
+    ORDER BY f.indexed_at ASC
+    LIMIT ? OFFSET ?
+)SQL";
+
+/// Без лимита (внутреннее использование); параметр since
+inline constexpr const char* LOCAL_CHANGES_SQL = R"SQL(
+    SELECT f.id, f.folder_id, f.relative_path, f.name, f.extension, f.size, f.mime_type,
+           f.content_type, f.checksum, f.created_at, f.modified_at, f.indexed_at,
+           COALESCE(f.visibility, wf.visibility) as visibility,
+           f.source_device_id, f.is_remote, f.sync_version
+    FROM files f
+    JOIN watched_folders wf ON f.folder_id = wf.id
+    WHERE COALESCE(f.visibility, wf.visibility) = 1
+      AND f.is_remote = 0
+      AND f.indexed_at > ?
+    ORDER BY f.indexed_at ASC
+)SQL";
+
+/// Параметр since
+inline constexpr const char* LOCAL_CHANGES_COUNT_SQL = R"SQL(
+    SELECT COUNT(*)
+    FROM files f
+    JOIN watched_folders wf ON f.folder_id = wf.id
+    WHERE COALESCE(f.visibility, wf.visibility) = 1
+      AND f.is_remote = 0
+      AND f.indexed_at > ?
+)SQL";
+
+/// Текст Family-файла для пира, запросившего его по checksum (пустой,
+/// неполный и ошибочный не отдаются); параметр checksum
+inline constexpr const char* SHARED_TEXT_SQL = R"SQL(
+    SELECT fts.content
+    FROM files f
+    JOIN watched_folders wf ON f.folder_id = wf.id
+    JOIN file_content fc ON fc.file_id = f.id
+    JOIN files_fts fts ON fts.rowid = f.id
+    WHERE f.checksum = ? AND f.source_device_id IS NULL
+      AND COALESCE(f.visibility, wf.visibility) = 1
+      AND f.extraction_pending = 0
+      AND fc.extraction_method NOT IN ('unsupported', 'error', 'empty')
+      AND fc.extraction_method NOT GLOB '*_partial'
+    LIMIT 1
+)SQL";
+
+// ═══════════════════════════════════════════════════════════
+// ContentIndexer: очередь извлечения текста
+// ═══════════════════════════════════════════════════════════
+
+/// Помеченные триггерами файлы (частичный индекс); параметр limit
+inline constexpr const char* PENDING_EXTRACTION_SQL = R"SQL(
+    SELECT id, mime_type, size FROM files
+    WHERE extraction_pending = 1
+    ORDER BY indexed_at DESC
+    LIMIT ?
+)SQL";
+
+inline constexpr const char* PENDING_EXTRACTION_COUNT_SQL =
+    "SELECT COUNT(*) FROM files WHERE extraction_pending = 1";
+
+/// Текст уже извлечённой локальной копии (files_fts по rowid): копии с
+/// неполным, ошибочным или обрезанным меньшим лимитом текстом не годятся.
+/// Параметры checksum, текущий лимит текста (байт)
+inline constexpr const char* EXTRACTED_COPY_SQL = R"SQL(
+    SELECT fts.content, fc.extraction_method, fc.language
+    FROM files f
+    JOIN file_content fc ON fc.file_id = f.id
+    JOIN files_fts fts ON fts.rowid = f.id
+    WHERE f.checksum = ? AND f.source_device_id IS NULL
+      AND f.extraction_pending = 0
+      AND fc.extraction_method NOT IN ('unsupported', 'error')
+      AND fc.extraction_method NOT GLOB '*_partial'
+      AND (fc.max_bytes = 0 OR fc.max_bytes >= ?
+           OR length(CAST(fts.content AS BLOB)) < fc.max_bytes)
+    LIMIT 1
+)SQL";
+
+/// Все файлы пригодных для извлечения типов (по idx_files_mime)
+inline constexpr const char* EXTRACTABLE_FILES_SQL = R"SQL(
+    SELECT id FROM files
+    WHERE mime_id IN (SELECT id FROM mime_types WHERE extractable = 1)
+    ORDER BY indexed_at DESC
+)SQL";
+
+} // namespace FamilyVault::queries
@@ -3,6 +3,13 @@
 #include "Database.h"
 #include "Models.h"
 #include "FileScanner.h"
+#include "FacetIndex.h"
+#include "SuggestIndex.h"
+#include "DirectoryTree.h"
+#include "MimeTypeTable.h"
+#include "MaintenanceScheduler.h"
+#include "CheckpointManager.h"
+#include "IngestSignal.h"
 #include <memory>
 #include <vector>
 
@@ -33,6 +40,21 @@ public:
     explicit IndexManager(std::shared_ptr<Database> db);
     ~IndexManager();
 
+    /// Подключить in-memory индекс фасетов (обновляется при сканировании и удалении)
+    void setFacetIndex(std::shared_ptr<FacetIndex> facets);
+
+    /// Подключить индекс автодополнения
+    void setSuggestIndex(std::shared_ptr<SuggestIndex> suggest);
+
+    /// Подключить фоновое обслуживание БД (сканирование откладывает его порции)
+    void setMaintenanceScheduler(std::shared_ptr<MaintenanceScheduler> maintenance);
+
+    /// Подключить менеджер WAL checkpoint (сканирование — массовая запись)
+    void setCheckpointManager(std::shared_ptr<CheckpointManager> checkpoints);
+
+    /// Подключить сигнал для ContentIndexer (подаётся после каждого сканирования)
+    void setIngestSignal(std::shared_ptr<IngestSignal> ingest);
+
     // ═══════════════════════════════════════════════════════════
     // Управление папками
     // ═══════════════════════════════════════════════════════════
@@ -44,8 +66,10 @@ public:
     /// Удалить папку и все её файлы из индекса
     void removeFolder(int64_t folderId);
     
-    /// Оптимизация БД (rebuild FTS + VACUUM)
-    void optimizeDatabase();
+    /// Оптимизация БД: пересчёт счётчиков и полный проход обслуживания
+    /// (FTS merge, incremental_vacuum, optimize, checkpoint) порциями.
+    /// Полный VACUUM не выполняется никогда
+    void optimizeDatabase(MaintenanceScheduler::ProgressCallback onProgress = nullptr);
     
     // ═══════════════════════════════════════════════════════════
     // Настройки
@@ -113,6 +137,30 @@ public:
     /// Получить файлы папки (компактная версия)
     std::vector<FileRecordCompact> getFilesByFolderCompact(int64_t folderId, int limit = 1000, int offset = 0) const;
 
+    /// Недавние файлы одним пакетом строк (без аллокаций на запись, для FFI)
+    FileRecordCompactBatch getRecentFilesCompactBatch(int limit = 50) const;
+
+    /// Файлы папки одним пакетом строк
+    FileRecordCompactBatch getFilesByFolderCompactBatch(int64_t folderId, int limit = 1000, int offset = 0) const;
+
+    // ═══════════════════════════════════════════════════════════
+    // Каталоги
+    // ═══════════════════════════════════════════════════════════
+
+    /// Подкаталоги (parentId = 0 — верхний уровень папки)
+    std::vector<DirectoryEntry> getSubdirectories(int64_t folderId, int64_t parentId = 0) const;
+
+    /// ID каталога по пути относительно папки ("" → 0)
+    std::optional<int64_t> findDirectory(int64_t folderId, const std::string& directoryPath) const;
+
+    /// Файлы непосредственно в каталоге (без подкаталогов), по имени
+    std::vector<FileRecord> getFilesByDirectory(int64_t folderId, int64_t directoryId,
+                                                int limit = 1000, int offset = 0) const;
+
+    /// Файлы каталога одним пакетом строк
+    FileRecordCompactBatch getFilesByDirectoryCompactBatch(int64_t folderId, int64_t directoryId,
+                                                           int limit = 1000, int offset = 0) const;
+
     /// Изменить видимость файла
     void setFileVisibility(int64_t fileId, std::optional<Visibility> visibility);
 
@@ -131,6 +179,13 @@ private:
     std::shared_ptr<Database> m_db;
     std::unique_ptr<FileScanner> m_scanner;
     CancellationToken m_cancelToken;
+    std::shared_ptr<FacetIndex> m_facets;
+    std::shared_ptr<SuggestIndex> m_suggest;
+    std::unique_ptr<DirectoryTree> m_directories;
+    std::unique_ptr<MimeTypeTable> m_mimeTypes;
+    std::shared_ptr<MaintenanceScheduler> m_maintenance;
+    std::shared_ptr<CheckpointManager> m_checkpoints;
+    std::shared_ptr<IngestSignal> m_ingest;
 
     /// Добавить или обновить файл в индексе
     int64_t upsertFile(int64_t folderId, const ScannedFile& file);
@@ -141,14 +196,8 @@ private:
     /// Обновить статистику папки
     void updateFolderStats(int64_t folderId);
 
-    /// Маппер для FileRecord
-    static FileRecord mapFileRecord(sqlite3_stmt* stmt);
-
-    /// Маппер для FileRecordCompact
-    static FileRecordCompact mapFileRecordCompact(sqlite3_stmt* stmt);
-
-    /// Маппер для WatchedFolder
-    static WatchedFolder mapWatchedFolder(sqlite3_stmt* stmt);
+    /// Маппер для FileRecordCompactView (строки — в арену пакета)
+    static FileRecordCompactView mapFileRecordCompactView(sqlite3_stmt* stmt, StringArena& arena);
 };
 
 } // namespace FamilyVault
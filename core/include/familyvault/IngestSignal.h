@@ -0,0 +1,35 @@
+// IngestSignal.h — Сигнал о новых и изменённых файлах в индексе
+// IndexManager подаёт его после сканирования, ContentIndexer просыпается
+// по нему вместо периодического опроса БД. Объект общий для обеих сторон
+// (shared_ptr), поэтому их время жизни не связано
+
+#pragma once
+
+#include <functional>
+#include <mutex>
+
+namespace FamilyVault {
+
+class IngestSignal {
+public:
+    using Listener = std::function<void()>;
+
+    /// В индекс попали файлы, которые могут ждать обработки
+    void notify() {
+        std::lock_guard lock(m_mutex);
+        if (m_listener) m_listener();
+    }
+
+    /// Подписать обработчик (один на БД); nullptr — отписать.
+    /// После возврата из отписки старый обработчик больше не вызывается
+    void setListener(Listener listener) {
+        std::lock_guard lock(m_mutex);
+        m_listener = std::move(listener);
+    }
+
+private:
+    std::mutex m_mutex;
+    Listener m_listener;
+};
+
+} // namespace FamilyVault
@@ -0,0 +1,114 @@
+// MaintenanceScheduler.h — Фоновое обслуживание БД маленькими порциями
+// Вместо rebuild FTS + VACUUM, блокирующих соединение на минуты:
+// FTS5 'merge' с ограниченным объёмом работы, incremental_vacuum,
+// PRAGMA optimize и WAL checkpoint — только когда приложение простаивает
+
+#pragma once
+
+#include "Database.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace FamilyVault {
+
+/// Шаг обслуживания (порядок выполнения в проходе)
+enum class MaintenanceStep : int32_t {
+    FtsMerge = 0,           // Слияние сегментов files_fts / cloud_files_fts / files_trigram
+    IncrementalVacuum = 1,  // Возврат свободных страниц файловой системе
+    Optimize = 2,           // PRAGMA optimize (статистика планировщика)
+    Checkpoint = 3          // Перенос WAL в основной файл
+};
+
+struct MaintenanceProgress {
+    MaintenanceStep step = MaintenanceStep::FtsMerge;
+    int64_t slicesDone = 0;     // Порций выполнено в этом проходе
+    int64_t remaining = -1;     // Оценка оставшейся работы шага (страниц), -1 — неизвестно
+    bool passComplete = false;  // Проход завершён целиком
+};
+
+struct MaintenanceOptions {
+    int mergePages = 64;                    // Страниц FTS на одну порцию merge
+    int vacuumPages = 256;                  // Страниц на одну порцию incremental_vacuum
+    std::chrono::milliseconds idleDelay{30000};     // Тишина до начала фоновой работы
+    std::chrono::milliseconds slicePause{50};       // Пауза между порциями (окно для запросов)
+    std::chrono::milliseconds passInterval{3600000};  // Как часто повторять проход
+};
+
+/// Потокобезопасный планировщик. Каждая порция — одна короткая операция
+/// на общем соединении, поэтому поиск и индексация ждут не дольше порции
+class MaintenanceScheduler {
+public:
+    using ProgressCallback = std::function<void(const MaintenanceProgress& progress)>;
+
+    explicit MaintenanceScheduler(std::shared_ptr<Database> db,
+                                  MaintenanceOptions options = {});
+
+    /// Останавливает фоновый поток (текущая порция доделывается)
+    ~MaintenanceScheduler();
+
+    MaintenanceScheduler(const MaintenanceScheduler&) = delete;
+    MaintenanceScheduler& operator=(const MaintenanceScheduler&) = delete;
+
+    /// Запустить фоновый поток
+    void start();
+
+    /// Остановить фоновый поток
+    void stop();
+
+    bool isRunning() const;
+
+    /// Пользователь/индексация активны — отложить фоновые порции на idleDelay.
+    /// Вызывают IndexManager (сканирование), ContentIndexer (каждый файл)
+    /// и SearchEngine (каждый запрос)
+    void noteActivity();
+
+    /// Запросить внеочередной проход (например, после удаления папки)
+    void requestPass();
+
+    /// Прогресс фоновых проходов (вызывается в потоке планировщика)
+    void setProgressCallback(ProgressCallback callback);
+
+    /// Выполнить одну порцию текущего прохода
+    /// @return true если в проходе осталась работа
+    bool runSlice();
+
+    /// Выполнить проход целиком синхронно (без ожидания простоя)
+    void runPass(ProgressCallback onProgress = nullptr);
+
+private:
+    std::shared_ptr<Database> m_db;
+    MaintenanceOptions m_options;
+
+    // Состояние прохода; порции выполняются под m_sliceMutex
+    std::mutex m_sliceMutex;
+    MaintenanceStep m_step = MaintenanceStep::FtsMerge;
+    size_t m_ftsTable = 0;
+    int64_t m_slicesDone = 0;
+
+    std::thread m_worker;
+    std::atomic<bool> m_stopRequested{false};
+    std::atomic<bool> m_passRequested{false};
+    std::atomic<int64_t> m_lastActivity{0};     // steady_clock, мс
+    mutable std::mutex m_mutex;
+    std::condition_variable m_condition;
+    ProgressCallback m_callback;
+
+    void workerThread();
+
+    /// Одна порция под m_sliceMutex; onProgress получает итог порции
+    bool runSliceLocked(const ProgressCallback& onProgress);
+
+    bool mergeSlice(int64_t& remaining);
+    bool vacuumSlice(int64_t& remaining);
+    void advance();
+
+    static int64_t nowMs();
+};
+
+} // namespace FamilyVault
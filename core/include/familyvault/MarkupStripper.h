@@ -0,0 +1,65 @@
+// MarkupStripper.h — Потоковое удаление разметки HTML/XML
+// Текст между тегами передаётся в NormalizingSink без промежуточных строк,
+// поэтому удаление тегов, декодирование сущностей и нормализация пробелов
+// выполняются за один проход по файлу
+
+#pragma once
+
+#include "TextNormalizer.h"
+#include <string>
+#include <string_view>
+
+namespace FamilyVault {
+
+class MarkupStripper {
+public:
+    enum class Mode {
+        Html,   // + содержимое <script> и <style> пропускается
+        Xml
+    };
+
+    MarkupStripper(Mode mode, NormalizingSink& sink);
+
+    /// Обработать фрагмент UTF-8. Тег, сущность или маркер комментария
+    /// может быть разрезан границей фрагментов
+    void feed(std::string_view chunk);
+
+    /// Конец входа: незакрытый тег отбрасывается, незавершённая сущность
+    /// выводится как текст
+    void finish();
+
+private:
+    enum class State {
+        Text,
+        Tag,        // Имя тега, затем атрибуты до '>'
+        Entity,     // &name; или &#code;
+        Comment,    // <!-- ... -->
+        CData,      // <![CDATA[ ... ]]> — содержимое выводится
+        RawText     // <script>/<style> до закрывающего тега
+    };
+
+    size_t feedText(const char* data, size_t size);
+    size_t feedTag(const char* data, size_t size);
+    size_t feedEntity(const char* data, size_t size);
+    size_t feedUntil(const char* data, size_t size, bool emit);
+
+    /// Тег закрыт символом '>'
+    void closeTag();
+
+    /// Вывести завершённую сущность (m_buffer без '&' и ';')
+    void emitEntity();
+
+    /// Ждать терминатор (закрытие комментария, CDATA, raw-текста)
+    void expect(State state, std::string_view terminator);
+
+    Mode m_mode;
+    NormalizingSink& m_sink;
+    State m_state = State::Text;
+
+    std::string m_buffer;           // Имя тега или сущности (не длиннее kMaxName)
+    bool m_nameDone = false;        // Имя тега прочитано, дальше атрибуты
+    std::string_view m_terminator;  // Чего ждём в Comment/CData/RawText
+    size_t m_matched = 0;           // Сколько байт терминатора уже совпало
+};
+
+} // namespace FamilyVault
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "Types.h"
+#include <cstddef>
+#include <cstdint>
 #include <string>
 
 namespace FamilyVault {
@@ -14,6 +16,9 @@ public:
     /// Определение по содержимому файла (magic bytes)
     static std::string detectByContent(const std::string& filePath);
 
+    /// Определение по уже прочитанным первым байтам файла
+    static std::string detectByHeader(const uint8_t* data, size_t size);
+
     /// Комбинированное определение (сначала по расширению, затем по содержимому)
     static std::string detect(const std::string& filePath, const std::string& extension);
 
@@ -0,0 +1,37 @@
+// MimeTypeTable.h — Справочник MIME-типов (таблица mime_types)
+// Файл хранит номер типа (files.mime_id) вместо сравнения строк: условия
+// вроде «тип пригоден для извлечения текста» — это флаг строки справочника.
+// Типов десятки, поэтому соответствие строка → номер целиком кэшируется
+
+#pragma once
+
+#include "Database.h"
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace FamilyVault {
+
+/// Потокобезопасный кэш над таблицей mime_types
+class MimeTypeTable {
+public:
+    explicit MimeTypeTable(std::shared_ptr<Database> db);
+    ~MimeTypeTable();
+
+    MimeTypeTable(const MimeTypeTable&) = delete;
+    MimeTypeTable& operator=(const MimeTypeTable&) = delete;
+
+    /// Номер типа; неизвестный тип добавляется в справочник
+    /// @return 0 для пустой строки (files.mime_id = NULL)
+    int64_t intern(std::string_view mimeType);
+
+private:
+    std::shared_ptr<Database> m_db;
+
+    std::mutex m_mutex;
+    std::unordered_map<std::string, int64_t> m_ids;
+};
+
+} // namespace FamilyVault
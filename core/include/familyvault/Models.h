@@ -1,7 +1,9 @@
 #pragma once
 
 #include "Types.h"
+#include "StringArena.h"
 #include <string>
+#include <string_view>
 #include <vector>
 #include <optional>
 #include <cstdint>
@@ -48,6 +50,7 @@ struct FileRecordCompact {
 struct FileRecord {
     int64_t id = 0;
     int64_t folderId = 0;
+    int64_t directoryId = 0;  // directories.id, 0 — корень папки
     std::string relativePath;
     std::string folderPath;  // Путь к папке для построения полного пути
     std::string name;
@@ -109,6 +112,18 @@ struct WatchedFolder {
     Visibility defaultVisibility = Visibility::Family;
 };
 
+// ═══════════════════════════════════════════════════════════
+// Каталог внутри отслеживаемой папки
+// ═══════════════════════════════════════════════════════════
+
+struct DirectoryEntry {
+    int64_t id = 0;
+    int64_t folderId = 0;
+    int64_t parentId = 0;       // 0 — верхний уровень папки
+    std::string name;
+    std::string path;           // Относительно папки: "2023/Отпуск"
+};
+
 // ═══════════════════════════════════════════════════════════
 // Облачный аккаунт
 // ═══════════════════════════════════════════════════════════
@@ -195,6 +210,8 @@ struct SearchQuery {
 
     SortBy sortBy = SortBy::Relevance;
     bool sortAsc = false;
+
+    TextMatchMode matchMode = TextMatchMode::Auto;
 };
 
 // ═══════════════════════════════════════════════════════════
@@ -213,6 +230,62 @@ struct SearchResultCompact {
     double score = 0.0;
 };
 
+// ═══════════════════════════════════════════════════════════
+// Компактные записи без аллокаций на строку (для FFI списков)
+// ═══════════════════════════════════════════════════════════
+
+/// FileRecordCompact, строки которого указывают в арену пакета
+struct FileRecordCompactView {
+    int64_t id = 0;
+    int64_t folderId = 0;
+    std::string_view relativePath;
+    std::string_view folderPath;    // Интернирован: один на папку
+    std::string_view name;
+    std::string_view extension;     // Интернирован
+    int64_t size = 0;
+    ContentType contentType = ContentType::Unknown;
+    int64_t modifiedAt = 0;
+    bool isRemote = false;
+    bool hasThumbnail = false;
+
+    /// Копия с собственными строками
+    FileRecordCompact toRecord() const {
+        FileRecordCompact r;
+        r.id = id;
+        r.folderId = folderId;
+        r.relativePath = relativePath;
+        r.folderPath = folderPath;
+        r.name = name;
+        r.extension = extension;
+        r.size = size;
+        r.contentType = contentType;
+        r.modifiedAt = modifiedAt;
+        r.isRemote = isRemote;
+        r.hasThumbnail = hasThumbnail;
+        return r;
+    }
+};
+
+/// Результат запроса: строки всех записей в одной арене.
+/// Move-only; записи валидны, пока жив пакет
+struct FileRecordCompactBatch {
+    StringArena arena;
+    std::vector<FileRecordCompactView> rows;
+    std::vector<double> scores;     // Только для поиска, иначе пусто
+
+    size_t size() const { return rows.size(); }
+    bool empty() const { return rows.empty(); }
+
+    std::vector<FileRecordCompact> toRecords() const {
+        std::vector<FileRecordCompact> records;
+        records.reserve(rows.size());
+        for (const auto& row : rows) {
+            records.push_back(row.toRecord());
+        }
+        return records;
+    }
+};
+
 // ═══════════════════════════════════════════════════════════
 // Информация об устройстве (P2P)
 // ═══════════════════════════════════════════════════════════
@@ -61,7 +61,6 @@ struct FV_API RemoteFileRecord {
     int64_t size;
     int64_t modifiedAt;
     std::string checksum;
-    std::string extractedText;
     
     int64_t syncedAt;           // Когда получена запись
     bool isDeleted;             // Помечен как удалённый
@@ -101,6 +100,31 @@ public:
     /// Обработать delta (одну запись)
     void handleIndexDelta(std::shared_ptr<PeerConnection> peer, const Message& delta);
 
+    // ═══════════════════════════════════════════════════════════
+    // Извлечённый текст по checksum
+    // ═══════════════════════════════════════════════════════════
+    // Delta несёт только checksum. После синхронизации получатель запрашивает
+    // текст тех checksum, что совпали с его ещё не извлечёнными файлами
+
+    /// Обработать запрос текста (ответ — ContentTextResponse на каждый найденный)
+    void handleContentTextRequest(std::shared_ptr<PeerConnection> peer, const Message& request);
+
+    /// Обработать полученный текст
+    void handleContentTextResponse(std::shared_ptr<PeerConnection> peer, const Message& response);
+
+    /// Checksum файлов пира, совпавшие с локальными файлами, которые ждут
+    /// извлечения и текста пира для которых ещё нет
+    std::vector<std::string> getWantedTextChecksums(const std::string& deviceId) const;
+
+    /// Текст Family-файла с данным checksum (пусто — нет или не извлекался)
+    std::string getSharedText(const std::string& checksum) const;
+
+    /// Сохранить текст пира в content_cache, если есть локальный файл с тем же
+    /// checksum, ждущий извлечения
+    /// @return true если текст сохранён
+    bool storeReceivedText(const std::string& checksum, const std::string& text,
+                           const std::string& deviceId);
+
     // ═══════════════════════════════════════════════════════════
     // Локальные данные для отправки
     // ═══════════════════════════════════════════════════════════
@@ -45,6 +45,8 @@ enum class MessageType : uint8_t {
     IndexSyncResponse = 0x21,
     IndexDelta = 0x22,
     IndexDeltaAck = 0x23,
+    ContentTextRequest = 0x24,
+    ContentTextResponse = 0x25,
 
     // File operations
     FileRequest = 0x30,
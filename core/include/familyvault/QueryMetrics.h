@@ -0,0 +1,136 @@
+// QueryMetrics.h — Метрики запросов Database
+// Время выполнения (гистограмма), строки, полные сканы и сортировки по
+// нормализованному SQL; попадания в кэш statements; ожидание блокировок;
+// журнал медленных запросов. Заполняется обёртками Database (prepare/step/finalize)
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace FamilyVault {
+
+struct QueryMetricsOptions {
+    bool enabled = true;
+    std::chrono::milliseconds slowQueryThreshold{100};  // 0 — журнал выключен
+    size_t slowLogCapacity = 32;        // Последние медленные запросы в снимке
+    size_t maxStatements = 256;         // Разных нормализованных SQL (остальные — "<other>")
+};
+
+/// Счётчики sqlite3_stmt_status за одно выполнение
+struct StatementCounters {
+    int64_t fullScanSteps = 0;  // Шаги полного сканирования таблицы
+    int64_t sorts = 0;          // Сортировки без индекса
+    int64_t autoIndexes = 0;    // Временные автоиндексы
+};
+
+/// Верхние границы корзин гистограммы (мкс); последняя корзина — всё, что больше
+inline constexpr std::array<int64_t, 14> kLatencyBucketsUs = {
+    50, 100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000,
+    100000, 250000, 500000, 1000000
+};
+
+struct StatementMetrics {
+    std::string sql;                // Нормализованный текст
+    int64_t count = 0;
+    int64_t errors = 0;
+    int64_t rows = 0;
+    int64_t totalUs = 0;
+    int64_t maxUs = 0;
+    std::array<int64_t, kLatencyBucketsUs.size() + 1> histogram{};
+    StatementCounters counters;     // Суммы за все выполнения
+
+    /// Верхняя граница корзины, в которую попадает перцентиль (maxUs для последней)
+    int64_t percentileUs(double p) const;
+};
+
+struct SlowQuery {
+    std::string sql;                // Нормализованный текст (без значений параметров)
+    int64_t elapsedUs = 0;
+    int64_t rows = 0;
+    int64_t at = 0;                 // Unix timestamp
+};
+
+struct QueryMetricsSnapshot {
+    int64_t statements = 0;         // Выполнений всего
+    int64_t cacheHits = 0;          // select<>() взял готовый statement
+    int64_t cacheMisses = 0;
+    int64_t lockWaits = 0;          // Сколько раз сработал busy handler
+    int64_t lockWaitUs = 0;
+    int64_t maxLockWaitUs = 0;
+    int64_t slowQueries = 0;
+    std::vector<StatementMetrics> byStatement;  // По убыванию totalUs
+    std::vector<SlowQuery> slowLog;             // Старые первыми
+};
+
+/// Потокобезопасный накопитель. Сам SQLite не вызывает
+class QueryMetrics {
+public:
+    explicit QueryMetrics(QueryMetricsOptions options = {});
+
+    QueryMetrics(const QueryMetrics&) = delete;
+    QueryMetrics& operator=(const QueryMetrics&) = delete;
+
+    bool enabled() const { return m_enabled.load(std::memory_order_relaxed); }
+    QueryMetricsOptions options() const;
+    void setOptions(const QueryMetricsOptions& options);
+
+    /// Выполнение statement завершено (finalize / возврат в кэш)
+    void record(std::string_view sql, int64_t elapsedUs, int64_t rows,
+                const StatementCounters& counters, bool failed);
+
+    void recordCacheLookup(bool hit);
+
+    /// Busy handler поспал sleptUs; newWait — первый вызов для этой блокировки
+    void recordLockWait(int64_t sleptUs, int64_t waitSoFarUs, bool newWait);
+
+    QueryMetricsSnapshot snapshot() const;
+    void reset();
+
+    /// Литералы → ?, списки "?, ?, ?" → "?, ...", пробелы схлопнуты
+    static std::string normalizeSql(std::string_view sql);
+
+private:
+    /// Хэш для поиска по string_view без создания std::string
+    struct SqlHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view sql) const { return std::hash<std::string_view>{}(sql); }
+    };
+    using SqlIndex = std::unordered_map<std::string, size_t, SqlHash, std::equal_to<>>;
+
+    std::atomic<bool> m_enabled{true};
+
+    mutable std::mutex m_mutex;
+    QueryMetricsOptions m_options;
+    SqlIndex m_byRawSql;            // Исходный SQL → индекс
+    SqlIndex m_byNormalized;        // Нормализованный → индекс
+    std::vector<StatementMetrics> m_statements;
+    std::deque<SlowQuery> m_slowLog;
+    int64_t m_total = 0;
+    int64_t m_slowQueries = 0;
+    int64_t m_lockWaits = 0;
+    int64_t m_lockWaitUs = 0;
+    int64_t m_maxLockWaitUs = 0;
+
+    std::atomic<int64_t> m_cacheHits{0};
+    std::atomic<int64_t> m_cacheMisses{0};
+
+    /// Учесть выполнение (под m_mutex); медленный запрос — для журнала вне блокировки
+    std::optional<SlowQuery> recordLocked(StatementMetrics& entry, int64_t elapsedUs, int64_t rows,
+                                          const StatementCounters& counters, bool failed);
+
+    /// Запись для уже нормализованного SQL (под m_mutex)
+    StatementMetrics& entryForLocked(std::string_view sql, std::string normalized);
+};
+
+} // namespace FamilyVault
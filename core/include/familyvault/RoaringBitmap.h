@@ -0,0 +1,83 @@
+// RoaringBitmap.h — Сжатый битмап для множеств ID файлов
+// Roaring-схема: значения группируются по старшим 16 битам, каждый контейнер
+// хранится либо как отсортированный массив (разреженный), либо как битсет (плотный)
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace FamilyVault {
+
+class RoaringBitmap {
+public:
+    RoaringBitmap() = default;
+
+    /// Помещается ли ID в битмап (поддерживаются 32-битные неотрицательные ID)
+    static bool fits(int64_t value) { return value >= 0 && value <= UINT32_MAX; }
+
+    /// Построить из списка значений (порядок не важен)
+    static RoaringBitmap fromValues(const std::vector<uint32_t>& values);
+
+    void add(uint32_t value);
+    bool remove(uint32_t value);
+    bool contains(uint32_t value) const;
+    void clear() { m_containers.clear(); }
+
+    bool isEmpty() const { return m_containers.empty(); }
+    uint64_t cardinality() const;
+
+    /// |this ∩ other| без материализации пересечения
+    uint64_t andCardinality(const RoaringBitmap& other) const;
+
+    RoaringBitmap& operator|=(const RoaringBitmap& other);
+    RoaringBitmap& operator&=(const RoaringBitmap& other);
+    /// Разность множеств (andNot)
+    RoaringBitmap& operator-=(const RoaringBitmap& other);
+
+    friend RoaringBitmap operator&(RoaringBitmap a, const RoaringBitmap& b) { return a &= b; }
+    friend RoaringBitmap operator|(RoaringBitmap a, const RoaringBitmap& b) { return a |= b; }
+    friend RoaringBitmap operator-(RoaringBitmap a, const RoaringBitmap& b) { return a -= b; }
+
+    bool operator==(const RoaringBitmap& other) const;
+
+    /// Все значения по возрастанию
+    std::vector<uint32_t> toVector() const;
+
+    /// Приблизительный объём памяти (байт)
+    size_t memoryUsage() const;
+
+private:
+    /// Максимальная мощность контейнера-массива (дальше битсет выгоднее по памяти)
+    static constexpr uint32_t kArrayMaxSize = 4096;
+    static constexpr size_t kBitsetWords = 1024;  // 65536 бит
+
+    struct Container {
+        Container() = default;
+        explicit Container(uint16_t k) : key(k) {}
+
+        uint16_t key = 0;
+        uint32_t cardinality = 0;
+        std::vector<uint16_t> array;  // Отсортированные младшие 16 бит
+        std::vector<uint64_t> bits;   // Непустой только в режиме битсета
+
+        bool isBitset() const { return !bits.empty(); }
+        bool contains(uint16_t low) const;
+        bool add(uint16_t low);
+        bool remove(uint16_t low);
+        void normalize();
+    };
+
+    std::vector<Container> m_containers;  // Отсортированы по key
+
+    std::vector<Container>::iterator findContainer(uint16_t key);
+    std::vector<Container>::const_iterator findContainer(uint16_t key) const;
+
+    static uint64_t andCardinality(const Container& a, const Container& b);
+    static Container intersect(const Container& a, const Container& b);
+    static Container unite(const Container& a, const Container& b);
+    static Container subtract(const Container& a, const Container& b);
+};
+
+} // namespace FamilyVault
@@ -0,0 +1,47 @@
+// RowSchemas.h — Схемы строк для типизированных запросов (sql::Select)
+// Выражения колонок предполагают алиасы: files f, watched_folders wf
+
+#pragma once
+
+#include "familyvault/Models.h"
+#include "familyvault/TypedQuery.h"
+
+namespace FamilyVault::schema {
+
+/// Локальный файл (files f JOIN watched_folders wf) без облачных полей
+using LocalFile = sql::Schema<FileRecord,
+    sql::Column<"f.id", &FileRecord::id>,
+    sql::Column<"f.folder_id", &FileRecord::folderId>,
+    sql::Column<"f.directory_id", &FileRecord::directoryId>,
+    sql::Column<"f.relative_path", &FileRecord::relativePath>,
+    sql::Column<"wf.path", &FileRecord::folderPath>,
+    sql::Column<"f.name", &FileRecord::name>,
+    sql::Column<"f.extension", &FileRecord::extension>,
+    sql::Column<"f.size", &FileRecord::size>,
+    sql::Column<"f.mime_type", &FileRecord::mimeType>,
+    sql::Column<"f.content_type", &FileRecord::contentType>,
+    sql::Column<"f.checksum", &FileRecord::checksum>,
+    sql::Column<"f.created_at", &FileRecord::createdAt>,
+    sql::Column<"f.modified_at", &FileRecord::modifiedAt>,
+    sql::Column<"f.indexed_at", &FileRecord::indexedAt>,
+    sql::Column<"COALESCE(f.visibility, wf.visibility)", &FileRecord::visibility>,
+    sql::Column<"f.source_device_id", &FileRecord::sourceDeviceId>,
+    sql::Column<"f.is_remote", &FileRecord::isRemote>,
+    sql::Column<"f.sync_version", &FileRecord::syncVersion>,
+    sql::Column<"f.last_modified_by", &FileRecord::lastModifiedBy>
+>;
+
+/// Отслеживаемая папка (watched_folders без алиаса)
+using Folder = sql::Schema<WatchedFolder,
+    sql::Column<"id", &WatchedFolder::id>,
+    sql::Column<"path", &WatchedFolder::path>,
+    sql::Column<"name", &WatchedFolder::name>,
+    sql::Column<"enabled", &WatchedFolder::enabled>,
+    sql::Column<"last_scan_at", &WatchedFolder::lastScanAt>,
+    sql::Column<"file_count", &WatchedFolder::fileCount>,
+    sql::Column<"total_size", &WatchedFolder::totalSize>,
+    sql::Column<"created_at", &WatchedFolder::createdAt>,
+    sql::Column<"visibility", &WatchedFolder::defaultVisibility>
+>;
+
+} // namespace FamilyVault::schema
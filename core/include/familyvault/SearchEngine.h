@@ -2,33 +2,62 @@
 
 #include "Database.h"
 #include "Models.h"
+#include "FacetIndex.h"
+#include "SuggestIndex.h"
 #include <memory>
 #include <vector>
 #include <utility>
+#include <unordered_map>
 
 namespace FamilyVault {
 
+class MaintenanceScheduler;
+
 /// Результат построения SQL запроса: SQL строка + параметры для binding
 struct SearchQueryBuilt {
     std::string sql;
     std::vector<SqlParam> params;
 };
 
+/// Форма результата построенного запроса
+enum class SearchQueryMode {
+    Rows,       // Полные строки с сортировкой и LIMIT/OFFSET
+    Count,      // SELECT COUNT(*)
+    LocalIds    // Только ID локальных файлов (для фасетов), без LIMIT
+};
+
 class SearchEngine {
 public:
     explicit SearchEngine(std::shared_ptr<Database> db);
     ~SearchEngine();
 
+    /// Подключить in-memory индекс фасетов
+    void setFacetIndex(std::shared_ptr<FacetIndex> facets);
+
+    /// Подключить in-memory индекс автодополнения
+    void setSuggestIndex(std::shared_ptr<SuggestIndex> suggest);
+
+    /// Подключить планировщик обслуживания: каждый запрос — активность
+    void setMaintenanceScheduler(std::shared_ptr<MaintenanceScheduler> maintenance);
+
     /// Поиск файлов по запросу
     std::vector<SearchResult> search(const SearchQuery& query);
 
     /// Поиск с компактными результатами (для UI списков)
     std::vector<SearchResultCompact> searchCompact(const SearchQuery& query);
 
+    /// Компактный поиск одним пакетом строк (без аллокаций на запись, для FFI)
+    FileRecordCompactBatch searchCompactBatch(const SearchQuery& query);
+
     /// Подсчёт результатов без получения данных
     int64_t countResults(const SearchQuery& query);
 
-    /// Автодополнение для поиска
+    /// Счётчики фасета для всех результатов запроса (limit/offset игнорируются)
+    /// @note Требует построенного FacetIndex, иначе пустой результат
+    std::vector<FacetCount> facetCounts(const SearchQuery& query, FacetKind kind, int limit = 0);
+
+    /// Автодополнение последнего слова запроса (по терминам имён файлов)
+    /// @note Без построенного SuggestIndex — медленный запасной путь через FTS
     std::vector<std::string> suggest(const std::string& prefix, int limit = 10);
 
     /// Быстрые фильтры
@@ -38,19 +67,39 @@ public:
 
 private:
     std::shared_ptr<Database> m_db;
+    std::shared_ptr<FacetIndex> m_facets;
+    std::shared_ptr<SuggestIndex> m_suggest;
+    std::shared_ptr<MaintenanceScheduler> m_maintenance;
+
+    /// Отложить фоновое обслуживание, пока пользователь ищет
+    void noteActivity();
 
     /// Построение SQL запроса с параметрами (безопасно от SQL injection)
-    SearchQueryBuilt buildSearchQuery(const SearchQuery& query, bool countOnly = false);
+    SearchQueryBuilt buildSearchQuery(const SearchQuery& query,
+                                      SearchQueryMode mode = SearchQueryMode::Rows);
+
+    /// Нет ли в запросе фильтров (результат = все локальные файлы)
+    static bool isUnfiltered(const SearchQuery& query);
 
     /// Экранирование FTS запроса (для специальных символов FTS5)
     std::string escapeFtsQuery(const std::string& text);
 
+    /// Запрос к files_trigram: весь текст как одна фраза
+    static std::string trigramPhrase(const std::string& text);
+
+    /// Добавлять ли подстрочную ветку (trigram) к префиксному поиску
+    static bool useSubstringMatch(const SearchQuery& query);
+
     /// Генерация snippet'а
     std::string generateSnippet(int64_t fileId, const std::string& query);
 
+    /// Snippet'ы для набора файлов одним FTS запросом (файлы без совпадения в содержимом пропускаются)
+    std::unordered_map<int64_t, std::string> generateSnippets(const std::vector<int64_t>& fileIds,
+                                                              const std::string& query);
+
     /// Маппер результатов
     static SearchResult mapSearchResult(sqlite3_stmt* stmt);
-    static SearchResultCompact mapSearchResultCompact(sqlite3_stmt* stmt);
+    static FileRecordCompactView mapFileRecordCompactView(sqlite3_stmt* stmt, StringArena& arena);
     static FileRecord mapFileRecord(sqlite3_stmt* stmt);
 };
 
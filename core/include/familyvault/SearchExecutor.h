@@ -0,0 +1,101 @@
+// SearchExecutor.h — Асинхронный поиск с отменой
+// Запросы выполняются в собственном потоке на отдельном соединении с БД,
+// чтобы отмена (progress handler) не затрагивала индексацию и другие менеджеры
+
+#pragma once
+
+#include "Database.h"
+#include "Models.h"
+#include "SearchEngine.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace FamilyVault {
+
+/// Итог асинхронного запроса
+enum class SearchRequestStatus {
+    Completed,
+    Cancelled,
+    Failed
+};
+
+/// Страница результатов, доставляемая в callback
+struct SearchPage {
+    uint64_t requestId = 0;
+    SearchRequestStatus status = SearchRequestStatus::Completed;
+    std::vector<SearchResultCompact> results;
+    std::string error;                  // Только для Failed
+};
+
+class SearchExecutor {
+public:
+    /// Вызывается ровно один раз на каждый submit(), в потоке исполнителя
+    using PageCallback = std::function<void(const SearchPage& page)>;
+
+    /// @param dbPath Путь к уже инициализированной БД (не ":memory:" —
+    ///               исполнитель открывает своё соединение)
+    /// @param maintenance Планировщик обслуживания основной БД: запросы
+    ///                    откладывают его фоновые порции
+    explicit SearchExecutor(const std::string& dbPath,
+                            std::shared_ptr<FacetIndex> facets = nullptr,
+                            std::shared_ptr<SuggestIndex> suggest = nullptr,
+                            std::shared_ptr<MaintenanceScheduler> maintenance = nullptr);
+
+    /// Отменяет все запросы (их callback получит Cancelled) и ждёт поток
+    ~SearchExecutor();
+
+    SearchExecutor(const SearchExecutor&) = delete;
+    SearchExecutor& operator=(const SearchExecutor&) = delete;
+
+    /// Поставить запрос в очередь
+    /// @return ID запроса (> 0) для cancel()
+    uint64_t submit(const SearchQuery& query, PageCallback callback);
+
+    /// Отменить запрос: из очереди — сразу, выполняющийся — прерывается SQLite
+    /// @return false если запрос уже завершён или не найден
+    bool cancel(uint64_t requestId);
+
+    /// Отменить все запросы (новый ввод делает старые результаты ненужными)
+    void cancelAll();
+
+    /// Запросов в очереди, включая выполняющийся
+    size_t pendingCount() const;
+
+private:
+    struct Request {
+        uint64_t id = 0;
+        SearchQuery query;
+        PageCallback callback;
+        std::shared_ptr<std::atomic<bool>> cancelled;
+    };
+
+    std::shared_ptr<Database> m_db;
+    SearchEngine m_engine;
+
+    std::thread m_worker;
+    std::atomic<bool> m_stopRequested{false};
+
+    std::deque<Request> m_queue;
+    std::shared_ptr<std::atomic<bool>> m_activeCancelled;   // Флаг выполняющегося запроса
+    uint64_t m_activeId = 0;
+    uint64_t m_nextId = 1;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_condition;
+
+    /// Рабочая функция потока
+    void workerThread();
+
+    /// Выполнить запрос (отменённый в очереди — сразу Cancelled)
+    SearchPage run(const Request& request);
+
+    static void deliver(const Request& request, SearchPage page);
+};
+
+} // namespace FamilyVault
@@ -0,0 +1,51 @@
+// StringArena.h — Арена строк для результатов запросов
+// Строки копируются в крупные блоки вместо отдельных std::string на каждое поле;
+// повторяющиеся значения (пути папок, расширения) хранятся один раз
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+namespace FamilyVault {
+
+/// Владеет памятью строк; string_view, выданные store()/intern(),
+/// валидны до clear() или уничтожения арены (перемещение их не инвалидирует)
+class StringArena {
+public:
+    StringArena() = default;
+
+    StringArena(const StringArena&) = delete;
+    StringArena& operator=(const StringArena&) = delete;
+    StringArena(StringArena&&) noexcept = default;
+    StringArena& operator=(StringArena&&) noexcept = default;
+
+    /// Скопировать строку в арену
+    std::string_view store(std::string_view text);
+
+    /// Скопировать строку один раз: одинаковые значения получают один и тот же view
+    std::string_view intern(std::string_view text);
+
+    /// Освободить всё
+    void clear();
+
+    /// Байт строк в арене (без учёта хвостов блоков)
+    size_t bytesUsed() const { return m_bytesUsed; }
+
+    /// Количество выделенных блоков
+    size_t blockCount() const { return m_blocks.size(); }
+
+private:
+    static constexpr size_t kBlockSize = 16 * 1024;
+
+    std::vector<std::unique_ptr<char[]>> m_blocks;
+    char* m_cursor = nullptr;
+    size_t m_remaining = 0;
+    size_t m_bytesUsed = 0;
+    std::unordered_set<std::string_view> m_interned;
+};
+
+} // namespace FamilyVault
@@ -0,0 +1,104 @@
+// SuggestIndex.h — In-memory индекс автодополнения по терминам имён файлов
+// Термины (слова из имени без расширения) хранятся в упорядоченном словаре,
+// префикс — это диапазон словаря; ранжирование по частоте и свежести.
+// Для коротких префиксов (1–2 символа) диапазон огромен — для них термины
+// дополнительно упорядочены по частоте, и обход останавливается, как только
+// оставшиеся термины не могут попасть в результат
+
+#pragma once
+
+#include "Database.h"
+#include "RoaringBitmap.h"
+#include <map>
+#include <memory>
+#include <shared_mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace FamilyVault {
+
+/// Источник файла: у локальных и облачных файлов независимые ID
+enum class SuggestSource {
+    Local,
+    Cloud
+};
+
+/// Потокобезопасный индекс: строится при старте (rebuild),
+/// затем поддерживается IndexManager и CloudAccountManager.
+class SuggestIndex {
+public:
+    explicit SuggestIndex(std::shared_ptr<Database> db);
+    ~SuggestIndex();
+
+    SuggestIndex(const SuggestIndex&) = delete;
+    SuggestIndex& operator=(const SuggestIndex&) = delete;
+
+    /// Полная перестройка из files и cloud_files
+    void rebuild();
+
+    /// Построен ли индекс (до rebuild() SearchEngine использует FTS)
+    bool isBuilt() const;
+
+    /// Добавить файл; повторный вызов для того же ID только обновляет свежесть
+    void addFile(SuggestSource source, int64_t fileId, const std::string& name, int64_t timestamp);
+
+    /// Удалить файл (имя нужно, чтобы уменьшить счётчики его терминов)
+    void removeFile(SuggestSource source, int64_t fileId, const std::string& name);
+
+    /// Дополнение последнего слова префикса
+    /// "vacation ph" → ["vacation photo", "vacation phone", ...]
+    std::vector<std::string> suggest(const std::string& prefix, int limit) const;
+
+    /// Количество уникальных терминов
+    size_t termCount() const;
+
+    /// Термины имени файла: без расширения, в нижнем регистре, без повторов
+    static std::vector<std::string> tokenize(const std::string& name);
+
+private:
+    struct TermStats {
+        uint32_t fileCount = 0;
+        int64_t lastSeen = 0;   // Самый свежий modified_at среди файлов с термином
+    };
+
+    std::shared_ptr<Database> m_db;
+    mutable std::shared_mutex m_mutex;
+    bool m_built = false;
+
+    /// Термин в списке короткого префикса; term указывает на ключ m_terms
+    struct RankedTerm {
+        uint32_t fileCount = 0;
+        const std::string* term = nullptr;
+    };
+    struct ByCountDesc {
+        bool operator()(const RankedTerm& a, const RankedTerm& b) const {
+            if (a.fileCount != b.fileCount) return a.fileCount > b.fileCount;
+            return *a.term < *b.term;
+        }
+    };
+
+    std::map<std::string, TermStats, std::less<>> m_terms;
+    // Префикс из 1–2 кодовых точек → его термины по убыванию частоты
+    std::unordered_map<std::string, std::set<RankedTerm, ByCountDesc>> m_byPrefix;
+    RoaringBitmap m_localFiles;
+    RoaringBitmap m_cloudFiles;
+
+    RoaringBitmap& filesOf(SuggestSource source);
+
+    /// Добавить термины файла (под эксклюзивной блокировкой)
+    void addTermsLocked(const std::string& name, int64_t timestamp);
+
+    /// Переставить термин в списках его коротких префиксов после смены
+    /// частоты; 0 — термина не было / больше нет
+    void rerankLocked(const std::string& term, uint32_t oldCount, uint32_t newCount);
+
+    /// Ранг: частота с бонусом до x2 для терминов недавних файлов
+    static double score(const TermStats& stats, int64_t now);
+
+    /// Нижний регистр для ASCII и кириллицы (UTF-8)
+    static std::string toLowerUtf8(const std::string& text);
+};
+
+} // namespace FamilyVault
@@ -2,6 +2,7 @@
 
 #include "Database.h"
 #include "Models.h"
+#include "FacetIndex.h"
 #include <memory>
 #include <vector>
 
@@ -12,6 +13,10 @@ public:
     explicit TagManager(std::shared_ptr<Database> db);
     ~TagManager();
 
+    /// Подключить in-memory индекс фасетов
+    /// @note Счётчики тегов берутся из индекса, если он построен
+    void setFacetIndex(std::shared_ptr<FacetIndex> facets);
+
     // ═══════════════════════════════════════════════════════════
     // Управление тегами файла
     // ═══════════════════════════════════════════════════════════
@@ -59,10 +64,18 @@ public:
 
 private:
     std::shared_ptr<Database> m_db;
+    std::shared_ptr<FacetIndex> m_facets;
+
+    /// Индекс фасетов, если подключён и построен
+    const FacetIndex* builtFacets() const;
 
-    /// Получить или создать тег
+    /// Получить или создать тег (и зарегистрировать новый в индексе фасетов)
     int64_t getOrCreateTag(const std::string& name, TagSource source = TagSource::User);
 
+    /// Найти или вставить строку тега, не трогая индекс фасетов
+    /// @param created true если тег вставлен сейчас
+    int64_t findOrInsertTag(const std::string& name, TagSource source, bool& created);
+
     /// Генерация автотегов
     std::vector<std::pair<std::string, TagSource>> generateAutoTagsForFile(const FileRecord& file);
 
@@ -10,6 +10,10 @@
 #include <vector>
 #include <functional>
 #include <mutex>
+#include <atomic>
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
 
 namespace FamilyVault {
 
@@ -22,8 +26,10 @@ struct ExtractionResult {
     std::string method;         // "plain_text", "pdf", "docx", etc.
     std::string language;       // Определённый или указанный язык
     double confidence = 1.0;    // Уверенность (для OCR)
+    int failedPages = 0;        // Страниц, текст которых не удалось извлечь (PDF)
     
     bool isEmpty() const { return text.empty(); }
+    bool isPartial() const { return failedPages > 0; }
     bool isLowConfidence() const { return confidence < 0.5; }
 };
 
@@ -49,18 +55,27 @@ public:
     /// Приоритет экстрактора (выше = предпочтительнее)
     /// Используется когда несколько экстракторов могут обработать один тип
     virtual int priority() const { return 0; }
+    
+    /// Лимит извлечённого текста (байт); экстракторы без потокового вывода его не учитывают
+    virtual void setMaxTextSize(size_t /*bytes*/) {}
 };
 
 // ═══════════════════════════════════════════════════════════
 // Реестр экстракторов
 // ═══════════════════════════════════════════════════════════
 
+/// Экстракторы регистрируются при создании реестра, до первого извлечения:
+/// поиск экстрактора идёт по заранее построенной таблице без блокировок.
+/// Для файлов из индекса тип задаётся номером mime_types.id: ContentIndexer
+/// при создании связывает с экстракторами все номера справочника (bindMimeIds).
+/// Таблица номеров неизменяема и публикуется атомарным указателем: выбор —
+/// индекс в массиве без блокировок, неподдерживаемые типы хранятся как nullptr
 class FV_API TextExtractorRegistry {
 public:
     TextExtractorRegistry();
     ~TextExtractorRegistry();
     
-    /// Зарегистрировать экстрактор
+    /// Зарегистрировать экстрактор (только до использования реестра)
     void registerExtractor(std::shared_ptr<ITextExtractor> extractor);
     
     /// Извлечь текст из файла (синхронно)
@@ -71,9 +86,27 @@ public:
     std::optional<ExtractionResult> extract(const std::string& filePath, 
                                             const std::string& mimeType);
     
+    /// Извлечь текст файла, тип которого связан через bindMimeId
+    std::optional<ExtractionResult> extract(const std::string& filePath, int64_t mimeId);
+    
     /// Проверить, есть ли экстрактор для данного MIME типа
     bool canExtract(const std::string& mimeType) const;
     
+    /// Проверить по номеру типа (несвязанный номер — нет)
+    bool canExtract(int64_t mimeId) const;
+    
+    /// Связать номера mime_types.id с экстракторами их типов
+    /// Новая таблица публикуется целиком; прежние живут до уничтожения реестра,
+    /// чтобы читатели без блокировок не остались с висячим указателем
+    /// @return Для каждого типа — поддерживается ли он
+    std::vector<bool> bindMimeIds(const std::vector<std::pair<int64_t, std::string>>& types);
+    
+    /// Связать один номер (см. bindMimeIds)
+    bool bindMimeId(int64_t mimeId, const std::string& mimeType);
+    
+    /// Лимит извлечённого текста (байт) для всех экстракторов
+    void setMaxTextSize(size_t bytes);
+    
     /// Получить список поддерживаемых MIME типов
     std::vector<std::string> getSupportedMimeTypes() const;
     
@@ -85,10 +118,28 @@ public:
     
 private:
     /// Найти лучший экстрактор для MIME типа
-    std::shared_ptr<ITextExtractor> findExtractor(const std::string& mimeType) const;
+    ITextExtractor* findExtractor(const std::string& mimeType) const;
     
+    /// Экстрактор по номеру типа (nullptr — не связан или не поддерживается)
+    ITextExtractor* findExtractor(int64_t mimeId) const;
+    
+    /// Извлечение выбранным экстрактором (с логированием и перехватом исключений)
+    static std::optional<ExtractionResult> extractWith(ITextExtractor* extractor,
+                                                       const std::string& filePath);
+    
+    /// Перестроить m_dispatch (m_mutex захвачен)
+    void rebuildDispatchLocked();
+    
+    // По убыванию приоритета: первый подходящий — лучший
     std::vector<std::shared_ptr<ITextExtractor>> m_extractors;
-    mutable std::mutex m_mutex;
+    // Известный MIME тип → экстрактор; остальные типы — перебором canHandle
+    std::unordered_map<std::string, ITextExtractor*> m_dispatch;
+    std::mutex m_mutex;     // Регистрация и связывание номеров
+    // mime_types.id → экстрактор (nullptr — не поддерживается); номер за
+    // пределами таблицы ещё не связан
+    using MimeIdTable = std::vector<ITextExtractor*>;
+    std::atomic<const MimeIdTable*> m_byMimeId{nullptr};
+    std::vector<std::unique_ptr<const MimeIdTable>> m_mimeIdTables;  // Все опубликованные
 };
 
 // ═══════════════════════════════════════════════════════════
@@ -109,24 +160,16 @@ public:
     /// Установить максимальный размер файла (по умолчанию 10MB)
     void setMaxFileSize(size_t bytes) { m_maxFileSize = bytes; }
     
-private:
-    /// Определить кодировку файла (UTF-8, UTF-16, CP1251)
-    std::string detectEncoding(const std::vector<char>& data) const;
-    
-    /// Конвертировать из указанной кодировки в UTF-8
-    std::string convertToUtf8(const std::vector<char>& data, 
-                              const std::string& encoding) const;
-    
-    /// Удалить HTML теги, оставив текст
-    std::string stripHtml(const std::string& html) const;
-    
-    /// Удалить XML теги, оставив текст
-    std::string stripXml(const std::string& xml) const;
+    /// Установить максимальный размер извлечённого текста (по умолчанию 1MB):
+    /// после лимита файл дальше не читается
+    void setMaxTextSize(size_t bytes) override { m_maxTextSize = bytes; }
     
+private:
     /// Проверить, нужно ли удалять теги для данного MIME типа
     bool shouldStripTags(const std::string& mimeType) const;
     
     size_t m_maxFileSize = 10 * 1024 * 1024;  // 10MB
+    std::atomic<size_t> m_maxTextSize{1024 * 1024};  // ContentIndexer задаёт свой лимит
 };
 
 /// Экстрактор для PDF документов (требует Poppler)
@@ -146,9 +189,13 @@ public:
     /// Установить минимальное количество символов на страницу для определения скана
     void setMinCharsPerPage(int chars) { m_minCharsPerPage = chars; }
     
+    /// Установить максимальное количество потоков на документ (1 = последовательно)
+    void setMaxThreads(int threads) { m_maxThreads = threads; }
+    
 private:
     int m_maxPages = 100;
     int m_minCharsPerPage = 100;  // Меньше = возможно скан
+    int m_maxThreads = 4;
 };
 
 /// Экстрактор для Office документов (DOCX, XLSX, PPTX, ODF)
@@ -162,32 +209,15 @@ public:
     std::optional<ExtractionResult> extract(const std::string& filePath) override;
     int priority() const override { return 20; }
     
-private:
-    /// Извлечь текст из DOCX
-    std::optional<ExtractionResult> extractDocx(const std::string& filePath);
-    
-    /// Извлечь текст из XLSX
-    std::optional<ExtractionResult> extractXlsx(const std::string& filePath);
-    
-    /// Извлечь текст из PPTX
-    std::optional<ExtractionResult> extractPptx(const std::string& filePath);
-    
-    /// Извлечь текст из ODT
-    std::optional<ExtractionResult> extractOdt(const std::string& filePath);
-    
-    /// Извлечь текст из ODS
-    std::optional<ExtractionResult> extractOds(const std::string& filePath);
+    /// Установить максимальный размер извлечённого текста (по умолчанию 1MB):
+    /// после лимита архив дальше не распаковывается
+    void setMaxTextSize(size_t bytes) override { m_maxTextSize = bytes; }
     
+private:
     /// Получить расширение файла (lowercase)
     std::string getExtension(const std::string& filePath) const;
     
-    /// Прочитать содержимое файла из ZIP архива
-    std::string readZipEntry(const std::string& archivePath, 
-                            const std::string& entryName);
-    
-    /// Извлечь текст из XML, собрав содержимое указанных тегов
-    std::string extractTextFromXml(const std::string& xml,
-                                   const std::vector<std::string>& textTags);
+    std::atomic<size_t> m_maxTextSize{1024 * 1024};  // ContentIndexer задаёт свой лимит
 };
 
 } // namespace FamilyVault
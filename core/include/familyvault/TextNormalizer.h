@@ -0,0 +1,90 @@
+// TextNormalizer.h — Нормализация извлечённого текста перед индексацией
+// Один проход: схлопывание пробелов, trim и проверка UTF-8.
+// Ядро векторизовано (SSE2/AVX2), реализация выбирается по CPU при первом вызове.
+// NormalizingSink — то же правило для текста, поступающего фрагментами
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace FamilyVault {
+
+/// Набор инструкций, которым обрабатываются блоки текста
+enum class SimdLevel {
+    Scalar,     // Побайтовый цикл (ARM, x86 без SSE2)
+    Sse2,       // Блоки по 16 байт
+    Avx2        // Блоки по 32 байта
+};
+
+class TextNormalizer {
+public:
+    /// Нормализовать текст:
+    ///  - последовательности ASCII-пробелов (пробел, \t, \n, \v, \f, \r) → один пробел;
+    ///  - пробелы в начале и в конце удаляются;
+    ///  - невалидные UTF-8 последовательности (обрыв, overlong, суррогаты,
+    ///    > U+10FFFF) заменяются на U+FFFD — FTS5 получает только валидный UTF-8;
+    ///  - символ, обрезанный концом текста (файл прочитан не целиком), отбрасывается
+    static std::string normalize(std::string_view text);
+
+    /// То же с явным выбором ядра (тесты и бенчмарки); уровень выше
+    /// поддерживаемого процессором понижается до доступного
+    static std::string normalize(std::string_view text, SimdLevel level);
+
+    /// Лучшее ядро для текущего процессора
+    static SimdLevel detectedLevel();
+
+    /// Текст целиком валидный UTF-8
+    static bool isValidUtf8(std::string_view text);
+};
+
+/// Потоковая нормализация с ограничением размера результата.
+/// Текст подаётся фрагментами любой длины (граница может разрезать символ
+/// UTF-8), результат совпадает с TextNormalizer::normalize от склеенного текста.
+/// Результат не длиннее maxBytes: после заполнения full() и остальной ввод
+/// игнорируется, поэтому источник может прекратить чтение
+class NormalizingSink {
+public:
+    explicit NormalizingSink(size_t maxBytes, SimdLevel level = TextNormalizer::detectedLevel());
+
+    /// Добавить фрагмент текста
+    void append(std::string_view text);
+
+    /// Граница слова (тег разметки, ячейка таблицы): пробел, если дальше будет текст
+    void separator();
+
+    /// Лимит достигнут
+    bool full() const { return m_full; }
+
+    /// Завершить: незаконченный символ в конце отбрасывается,
+    /// результат обрезается до maxBytes по границе символа
+    std::string finish();
+
+private:
+    /// Нормализовать целые символы
+    void run(const unsigned char* data, size_t size);
+
+    /// Дописать к перенесённому началу символа байты продолжения; возвращает
+    /// число использованных байтов
+    size_t completeCarry(const unsigned char* data, size_t size);
+
+    /// Перенесённое начало символа не продолжилось: заменить на U+FFFD
+    void dropCarry();
+
+    /// count байт битой последовательности → count × U+FFFD
+    void emitReplacements(size_t count);
+
+    std::string m_result;
+    size_t m_length = 0;
+    size_t m_maxBytes;
+    SimdLevel m_level;
+    bool m_pendingSpace = false;
+    bool m_full = false;
+
+    // Начало символа, разрезанного границей фрагментов
+    unsigned char m_carry[4] = {};
+    size_t m_carryLength = 0;
+};
+
+} // namespace FamilyVault
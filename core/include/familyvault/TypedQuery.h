@@ -0,0 +1,175 @@
+// TypedQuery.h — Типизированные запросы: схема строки описывается на этапе компиляции
+// Список колонок SELECT генерируется из схемы, маппер — из указателей на поля,
+// число параметров сверяется с числом '?' в запросе. Ошибка схемы — ошибка компиляции
+
+#pragma once
+
+#include "Database.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+namespace FamilyVault::sql {
+
+/// Строковый литерал как параметр шаблона
+template<size_t N>
+struct FixedString {
+    char value[N]{};
+
+    consteval FixedString(const char (&text)[N]) {
+        for (size_t i = 0; i < N; ++i) value[i] = text[i];
+    }
+
+    constexpr std::string_view view() const { return {value, N - 1}; }
+};
+
+namespace detail {
+
+template<typename T>
+struct MemberTraits;
+
+template<typename Owner_, typename Value_>
+struct MemberTraits<Value_ Owner_::*> {
+    using Owner = Owner_;
+    using Value = Value_;
+};
+
+template<typename T>
+struct IsOptional : std::false_type {};
+
+template<typename T>
+struct IsOptional<std::optional<T>> : std::true_type {};
+
+template<typename T>
+inline constexpr bool kAlwaysFalse = false;
+
+/// Чтение значения колонки в тип поля
+template<typename T>
+T readValue(sqlite3_stmt* stmt, int col) {
+    if constexpr (std::is_same_v<T, bool>) {
+        return Database::getInt(stmt, col) != 0;
+    } else if constexpr (std::is_enum_v<T>) {
+        return static_cast<T>(Database::getInt(stmt, col));
+    } else if constexpr (std::is_integral_v<T>) {
+        return static_cast<T>(Database::getInt64(stmt, col));
+    } else if constexpr (std::is_floating_point_v<T>) {
+        return static_cast<T>(Database::getDouble(stmt, col));
+    } else if constexpr (std::is_same_v<T, std::string>) {
+        return Database::getString(stmt, col);
+    } else if constexpr (IsOptional<T>::value) {
+        if (Database::isNull(stmt, col)) return std::nullopt;
+        return readValue<typename T::value_type>(stmt, col);
+    } else {
+        static_assert(kAlwaysFalse<T>, "Unsupported column type");
+    }
+}
+
+/// Число параметров '?' вне строковых литералов
+consteval size_t countParams(std::string_view sql) {
+    size_t count = 0;
+    char quote = 0;
+    for (char c : sql) {
+        if (quote) {
+            if (c == quote) quote = 0;
+        } else if (c == '\'' || c == '"') {
+            quote = c;
+        } else if (c == '?') {
+            ++count;
+        }
+    }
+    return count;
+}
+
+/// Склейка строк в массив с завершающим нулём
+template<size_t N>
+struct Text {
+    std::array<char, N + 1> data{};
+
+    constexpr std::string_view view() const { return {data.data(), N}; }
+};
+
+} // namespace detail
+
+/// Колонка: SQL выражение → поле структуры
+/// Column<"f.name", &FileRecord::name>
+template<FixedString Expr, auto Member>
+struct Column {
+    using Owner = typename detail::MemberTraits<decltype(Member)>::Owner;
+    using Value = typename detail::MemberTraits<decltype(Member)>::Value;
+
+    static constexpr std::string_view expr = Expr.view();
+
+    static void read(sqlite3_stmt* stmt, int col, Owner& row) {
+        row.*Member = detail::readValue<Value>(stmt, col);
+    }
+};
+
+/// Схема строки: тип результата и упорядоченный набор колонок
+template<typename RowT, typename... Columns>
+struct Schema {
+    using Row = RowT;
+
+    static_assert(sizeof...(Columns) > 0, "Schema needs at least one column");
+    static_assert((std::is_same_v<typename Columns::Owner, RowT> && ...),
+                  "Column maps into a field of another row type");
+
+    static constexpr int columnCount = static_cast<int>(sizeof...(Columns));
+
+    /// "expr1, expr2, ..." для SELECT
+    static constexpr auto selectList = [] {
+        constexpr size_t length = (Columns::expr.size() + ...) + 2 * (sizeof...(Columns) - 1);
+        detail::Text<length> text;
+        size_t pos = 0;
+        bool first = true;
+        auto append = [&](std::string_view part) {
+            for (char c : part) text.data[pos++] = c;
+        };
+        ((first ? void(first = false) : append(", "), append(Columns::expr)), ...);
+        return text;
+    }();
+
+    static Row read(sqlite3_stmt* stmt) {
+        Row row{};
+        readColumns(stmt, row, std::index_sequence_for<Columns...>{});
+        return row;
+    }
+
+private:
+    template<size_t... I>
+    static void readColumns(sqlite3_stmt* stmt, Row& row, std::index_sequence<I...>) {
+        (Columns::read(stmt, static_cast<int>(I), row), ...);
+    }
+};
+
+/// Запрос: "SELECT <колонки схемы> <Tail>"
+/// using RecentFiles = sql::Select<FileSchema, "FROM files f ORDER BY f.indexed_at DESC LIMIT ?">;
+/// db.select<RecentFiles>(limit);
+template<typename SchemaT, FixedString Tail>
+struct Select {
+    using Schema = SchemaT;
+    using Row = typename SchemaT::Row;
+
+    static constexpr size_t paramCount = detail::countParams(Tail.view());
+
+    static constexpr auto text = [] {
+        constexpr std::string_view head = "SELECT ";
+        constexpr std::string_view columns = SchemaT::selectList.view();
+        constexpr std::string_view tail = Tail.view();
+        detail::Text<head.size() + columns.size() + 1 + tail.size()> result;
+        size_t pos = 0;
+        for (char c : head) result.data[pos++] = c;
+        for (char c : columns) result.data[pos++] = c;
+        result.data[pos++] = ' ';
+        for (char c : tail) result.data[pos++] = c;
+        return result;
+    }();
+
+    static constexpr std::string_view sql() { return text.view(); }
+};
+
+} // namespace FamilyVault::sql
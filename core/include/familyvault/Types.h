@@ -82,5 +82,15 @@ enum class SortBy : int32_t {
     Size = 3
 };
 
+// ═══════════════════════════════════════════════════════════
+// Режим текстового поиска
+// ═══════════════════════════════════════════════════════════
+
+enum class TextMatchMode : int32_t {
+    Auto = 0,       // Substring для одного термина от 3 символов, иначе Prefix
+    Prefix = 1,     // Префиксы токенов (unicode61): имя, путь, содержимое
+    Substring = 2   // Prefix + подстрока в имени/пути (trigram)
+};
+
 } // namespace FamilyVault
 
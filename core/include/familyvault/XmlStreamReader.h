@@ -0,0 +1,85 @@
+// XmlStreamReader.h — Потоковый SAX-разбор XML без построения дерева
+// Документ подаётся фрагментами (например, по мере распаковки из ZIP),
+// память не зависит от размера документа. Имена элементов без префикса
+// пространства имён сравниваются с заранее заданным списком, обработчик
+// получает номер элемента вместо строки
+
+#pragma once
+
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace FamilyVault {
+
+class XmlStreamReader {
+public:
+    /// События разбора. startElement/endElement приходят только
+    /// для элементов из списка имён
+    class Handler {
+    public:
+        virtual ~Handler() = default;
+
+        /// Открывающий тег (за <a/> сразу следует endElement).
+        /// Атрибуты доступны через reader.attribute() только внутри вызова
+        virtual void startElement(int id, const XmlStreamReader& reader) = 0;
+
+        virtual void endElement(int id) = 0;
+
+        /// Символьные данные с раскрытыми сущностями (включая CDATA и пробелы
+        /// между тегами). Текстовый узел может прийти несколькими частями
+        virtual void text(std::string_view text) = 0;
+    };
+
+    /// names — локальные имена элементов (w:t и a:t — это "t");
+    /// номер элемента в событиях — индекс в списке
+    XmlStreamReader(std::initializer_list<std::string_view> names, Handler& handler);
+
+    /// Обработать фрагмент UTF-8. Тег или сущность может быть разрезан
+    /// границей фрагментов
+    void feed(std::string_view chunk);
+
+    /// Конец документа: незакрытый тег отбрасывается
+    void finish();
+
+    /// Значение атрибута текущего открывающего тега по локальному имени
+    /// (сущности не раскрываются); пусто, если атрибута нет
+    std::string_view attribute(std::string_view localName) const;
+
+private:
+    enum class State {
+        Text,
+        Tag,        // От '<' до '>' вне кавычек
+        Entity,     // &name; или &#code;
+        Comment,    // <!-- ... -->
+        CData       // <![CDATA[ ... ]]> — содержимое передаётся как текст
+    };
+
+    size_t feedText(const char* data, size_t size);
+    size_t feedTag(const char* data, size_t size);
+    size_t feedEntity(const char* data, size_t size);
+    size_t feedUntil(const char* data, size_t size);
+
+    /// Дописать к m_tag не больше kMaxTag байт
+    void appendTag(const char* data, size_t size);
+
+    /// Тег закрыт символом '>': разобрать имя и сообщить обработчику
+    void closeTag(std::string_view tag);
+
+    /// Номер элемента по имени с префиксом; -1 — не из списка
+    int lookup(std::string_view name) const;
+
+    std::vector<std::string> m_names;
+    Handler& m_handler;
+    State m_state = State::Text;
+
+    std::string m_tag;                  // Содержимое тега между '<' и '>'
+    char m_quote = 0;                   // Открытая кавычка значения атрибута
+    std::string_view m_attributes;      // Атрибуты тега внутри startElement
+    std::string m_buffer;               // Имя сущности; текст CDATA текущего фрагмента
+    char m_terminator = 0;              // '-' для "-->", ']' для "]]>"
+    size_t m_matched = 0;               // Сколько символов терминатора подряд (0..2)
+};
+
+} // namespace FamilyVault
@@ -38,6 +38,7 @@ typedef enum {
     FV_ERROR_AUTH_FAILED = 6,
     FV_ERROR_NETWORK = 7,
     FV_ERROR_BUSY = 8,              // Resource busy (e.g., DB has active managers)
+    FV_ERROR_CANCELLED = 9,         // Operation cancelled (async search)
     FV_ERROR_INTERNAL = 99
 } FVError;
 
@@ -63,6 +64,43 @@ FV_API void fv_clear_error(void);
 /// Освобождает строку, выделенную библиотекой
 FV_API void fv_free_string(char* str);
 
+// ═══════════════════════════════════════════════════════════
+// Колоночный буфер (compact списки без JSON)
+// ═══════════════════════════════════════════════════════════
+
+/// Результат списка FileRecordCompact одним блоком памяти:
+/// заголовок, колонки фиксированной ширины и арена строк.
+/// Все указатели ведут внутрь того же блока, освобождается через fv_free_columns.
+///
+/// Строковая колонка X: строка i — UTF-8 байты
+/// strings[X_offsets[i] .. X_offsets[i + 1]), без завершающего нуля.
+typedef struct FVFileColumns {
+    uint32_t version;                   // FV_FILE_COLUMNS_VERSION
+    uint32_t row_count;
+    uint64_t total_bytes;               // Размер всего блока
+
+    const int64_t* id;
+    const int64_t* folder_id;
+    const int64_t* size;
+    const int64_t* modified_at;
+    const double* score;                // 0 вне поиска
+    const int32_t* content_type;
+    const uint8_t* flags;               // FV_FILE_FLAG_*
+
+    const uint32_t* relative_path_offsets;  // row_count + 1 элементов
+    const uint32_t* folder_path_offsets;
+    const uint32_t* name_offsets;
+    const uint32_t* extension_offsets;
+    const char* strings;
+} FVFileColumns;
+
+#define FV_FILE_COLUMNS_VERSION 1
+#define FV_FILE_FLAG_REMOTE 0x01
+#define FV_FILE_FLAG_HAS_THUMBNAIL 0x02
+
+/// Освобождает колоночный буфер
+FV_API void fv_free_columns(FVFileColumns* columns);
+
 // ═══════════════════════════════════════════════════════════
 // Database
 // ═══════════════════════════════════════════════════════════
@@ -83,6 +121,31 @@ FV_API FVError fv_database_initialize(FVDatabase db);
 /// Проверить, инициализирована ли БД
 FV_API int32_t fv_database_is_initialized(FVDatabase db);
 
+/// Callback прогресса обслуживания БД
+/// @param step 0 — FTS merge, 1 — incremental vacuum, 2 — optimize, 3 — WAL checkpoint
+/// @param remaining Оценка оставшихся страниц шага, -1 если неизвестно
+typedef void (*FVMaintenanceCallback)(int32_t step, int64_t slices_done, int64_t remaining,
+                                      int32_t pass_complete, void* user_data);
+
+/// Выполнить проход обслуживания синхронно, порциями (FTS merge, incremental_vacuum,
+/// PRAGMA optimize, WAL checkpoint). Фоновый планировщик делает то же в простое
+/// @param cb Прогресс после каждой порции (может быть NULL)
+FV_API FVError fv_database_run_maintenance(FVDatabase db, FVMaintenanceCallback cb, void* user_data);
+
+/// Метрики WAL: размер файла и задержки checkpoint
+/// @return JSON {walBytes, checkpoints, truncations, incomplete, lastLatencyUs,
+///         maxLatencyUs, avgLatencyUs, lastCheckpointAt, bulkActive}; освободить fv_free_string
+FV_API char* fv_database_wal_stats(FVDatabase db);
+
+/// Метрики запросов общего соединения: время (гистограмма, p50/p95), строки,
+/// полные сканы и сортировки по нормализованному SQL, кэш statements, ожидание
+/// блокировок, журнал медленных запросов. Освободить fv_free_string
+/// @param reset Ненулевой — обнулить метрики после снимка
+FV_API char* fv_database_query_metrics(FVDatabase db, int32_t reset);
+
+/// Порог журнала медленных запросов (мс, по умолчанию 100; 0 — выключить)
+FV_API FVError fv_database_set_slow_query_threshold(FVDatabase db, int32_t threshold_ms);
+
 // ═══════════════════════════════════════════════════════════
 // Cloud Accounts & Watched Folders
 // ═══════════════════════════════════════════════════════════
@@ -156,7 +219,8 @@ FV_API int64_t fv_index_add_folder(FVIndexManager mgr, const char* path,
 /// Удалить папку из отслеживания
 FV_API FVError fv_index_remove_folder(FVIndexManager mgr, int64_t folder_id);
 
-/// Оптимизация БД (rebuild FTS + VACUUM)
+/// Оптимизация БД: пересчёт счётчиков + проход обслуживания порциями
+/// (без rebuild FTS и полного VACUUM)
 FV_API FVError fv_index_optimize_database(FVIndexManager mgr);
 
 /// Получить максимальный размер текста для индексации (KB)
@@ -205,6 +269,26 @@ FV_API char* fv_index_get_recent_compact(FVIndexManager mgr, int32_t limit);
 FV_API char* fv_index_get_by_folder_compact(FVIndexManager mgr, int64_t folder_id,
                                              int32_t limit, int32_t offset);
 
+/// Подкаталоги папки
+/// @param parent_id ID родительского каталога, 0 — верхний уровень папки
+/// @return JSON array [{id, folderId, parentId, name, path}], по имени
+FV_API char* fv_index_get_directories(FVIndexManager mgr, int64_t folder_id, int64_t parent_id);
+
+/// Файлы непосредственно в каталоге (JSON array FileRecordCompact)
+/// @param directory_id ID каталога, 0 — корень папки
+FV_API char* fv_index_get_by_directory_compact(FVIndexManager mgr, int64_t folder_id,
+                                               int64_t directory_id,
+                                               int32_t limit, int32_t offset);
+
+/// Недавние файлы в колоночном буфере (без JSON)
+/// @return Буфер (освободить через fv_free_columns) или nullptr при ошибке
+FV_API FVFileColumns* fv_index_get_recent_columns(FVIndexManager mgr, int32_t limit);
+
+/// Файлы папки в колоночном буфере (без JSON)
+/// @return Буфер (освободить через fv_free_columns) или nullptr при ошибке
+FV_API FVFileColumns* fv_index_get_by_folder_columns(FVIndexManager mgr, int64_t folder_id,
+                                                      int32_t limit, int32_t offset);
+
 /// Получить статистику индекса (JSON)
 FV_API char* fv_index_get_stats(FVIndexManager mgr);
 
@@ -227,6 +311,7 @@ FV_API FVSearchEngine fv_search_create(FVDatabase db);
 
 /// Уничтожить SearchEngine
 /// @note Автоматически уменьшает reference count базы данных
+/// @note Ждёт поток асинхронного поиска; незавершённые запросы получат FV_ERROR_CANCELLED
 FV_API void fv_search_destroy(FVSearchEngine engine);
 
 /// Поиск (JSON query -> JSON array SearchResult)
@@ -237,14 +322,48 @@ FV_API char* fv_search_query(FVSearchEngine engine, const char* query_json);
 /// @return JSON строка или nullptr при ошибке
 FV_API char* fv_search_query_compact(FVSearchEngine engine, const char* query_json);
 
+/// Поиск (компактная версия) в колоночном буфере, score заполнен
+/// @return Буфер (освободить через fv_free_columns) или nullptr при ошибке
+FV_API FVFileColumns* fv_search_query_columns(FVSearchEngine engine, const char* query_json);
+
+/// Callback асинхронного поиска. Вызывается ровно один раз на запрос,
+/// в потоке исполнителя ядра (в Dart — NativeCallable.listener)
+/// @param status FV_OK, FV_ERROR_CANCELLED или FV_ERROR_DATABASE
+/// @param results_json FV_OK: JSON array (как fv_search_query_compact);
+///                     ошибка: текст ошибки; отмена: nullptr.
+///                     Валиден только во время callback
+typedef void (*FVSearchResultCallback)(int64_t request_id, FVError status,
+                                       const char* results_json, void* user_data);
+
+/// Асинхронный поиск (компактная версия)
+/// Запросы выполняются по очереди на отдельном соединении с БД
+/// @return ID запроса (> 0) или -1 при ошибке разбора запроса
+FV_API int64_t fv_search_query_async(FVSearchEngine engine, const char* query_json,
+                                     FVSearchResultCallback cb, void* user_data);
+
+/// Отменить запрос: ожидающий не выполнится, выполняющийся прерывается
+/// @return FV_ERROR_NOT_FOUND если запрос уже завершён
+FV_API FVError fv_search_cancel(FVSearchEngine engine, int64_t request_id);
+
+/// Отменить все запросы (например, перед запросом для нового ввода)
+FV_API void fv_search_cancel_all(FVSearchEngine engine);
+
 /// Подсчёт результатов
 /// @return Количество результатов или -1 при ошибке
 FV_API int64_t fv_search_count(FVSearchEngine engine, const char* query_json);
 
-/// Автодополнение
-/// @return JSON строка или nullptr при ошибке
+/// Автодополнение последнего слова (термины имён файлов по частоте и свежести)
+/// @return JSON массив строк или nullptr при ошибке
 FV_API char* fv_search_suggest(FVSearchEngine engine, const char* prefix, int32_t limit);
 
+/// Счётчики фасета для всех результатов запроса (JSON array {value, count})
+/// @param kind 0=Tag, 1=ContentType, 2=Extension, 3=Year, 4=Folder
+/// @param limit Максимум значений (0 = все)
+/// @return JSON строка или nullptr при ошибке
+/// @note Использует in-memory индекс, построенный в fv_database_initialize
+FV_API char* fv_search_facets(FVSearchEngine engine, const char* query_json,
+                              int32_t kind, int32_t limit);
+
 // ═══════════════════════════════════════════════════════════
 // Tag Manager
 // ═══════════════════════════════════════════════════════════
@@ -340,6 +459,10 @@ FV_API FVError fv_content_indexer_process_file(FVContentIndexer indexer, int64_t
 /// @return Количество добавленных файлов или -1 при ошибке
 FV_API int32_t fv_content_indexer_enqueue_unprocessed(FVContentIndexer indexer);
 
+/// Файл открыт или найден пользователем — извлечь текст раньше фоновой очереди
+/// @note Файл, уже стоящий в очереди, не дублируется
+FV_API FVError fv_content_indexer_prioritize_file(FVContentIndexer indexer, int64_t file_id);
+
 /// Получить статус (JSON)
 /// @return JSON с полями: pending, processed, failed, isRunning, currentFile
 FV_API char* fv_content_indexer_get_status(FVContentIndexer indexer);
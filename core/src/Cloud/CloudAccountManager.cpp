@@ -35,6 +35,10 @@ CloudAccountManager::CloudAccountManager(std::shared_ptr<Database> db)
 
 CloudAccountManager::~CloudAccountManager() = default;
 
+void CloudAccountManager::setSuggestIndex(std::shared_ptr<SuggestIndex> suggest) {
+    m_suggest = std::move(suggest);
+}
+
 CloudAccount CloudAccountManager::addAccount(const std::string& type,
                                              const std::string& email,
                                              const std::optional<std::string>& displayName,
@@ -89,8 +93,11 @@ std::vector<CloudAccount> CloudAccountManager::getAccounts() const {
 }
 
 bool CloudAccountManager::removeAccount(int64_t accountId) {
+    // CASCADE удалит cloud_files аккаунта
+    auto removedFiles = cloudFileNames(accountId);
     m_db->execute("DELETE FROM cloud_accounts WHERE id = ?", accountId);
     bool removed = m_db->changesCount() > 0;
+    forgetCloudFiles(removedFiles);
     if (removed) {
         spdlog::info("Cloud account {} removed", accountId);
     }
@@ -199,6 +206,13 @@ bool CloudAccountManager::upsertCloudFile(int64_t accountId, const CloudFile& fi
     std::string extension = MimeTypeDetector::extractExtension(file.name);
     ContentType contentType = MimeTypeDetector::mimeToContentType(file.mimeType);
 
+    // Файл могли переименовать в облаке — старые термины нужно убрать
+    std::optional<std::pair<int64_t, std::string>> previous;
+    if (m_suggest) {
+        auto existing = cloudFileNames(accountId, file.cloudId);
+        if (!existing.empty()) previous = existing.front();
+    }
+
     m_db->execute(
         R"SQL(
         INSERT INTO cloud_files (
@@ -240,23 +254,62 @@ bool CloudAccountManager::upsertCloudFile(int64_t accountId, const CloudFile& fi
         static_cast<int>(contentType)
     );
 
+    if (m_suggest) {
+        int64_t fileId = previous ? previous->first : m_db->lastInsertId();
+        if (previous && previous->second != file.name) {
+            m_suggest->removeFile(SuggestSource::Cloud, fileId, previous->second);
+        }
+        m_suggest->addFile(SuggestSource::Cloud, fileId, file.name, file.modifiedAt);
+    }
+
     return true;
 }
 
 bool CloudAccountManager::removeCloudFile(int64_t accountId, const std::string& cloudId) {
+    auto removedFiles = cloudFileNames(accountId, cloudId);
     m_db->execute(
         "DELETE FROM cloud_files WHERE account_id = ? AND cloud_id = ?",
         accountId, cloudId
     );
-    return m_db->changesCount() > 0;
+    bool removed = m_db->changesCount() > 0;
+    forgetCloudFiles(removedFiles);
+    return removed;
 }
 
 bool CloudAccountManager::removeAllCloudFiles(int64_t accountId) {
+    auto removedFiles = cloudFileNames(accountId);
     m_db->execute(
         "DELETE FROM cloud_files WHERE account_id = ?",
         accountId
     );
-    return m_db->changesCount() > 0;
+    bool removed = m_db->changesCount() > 0;
+    forgetCloudFiles(removedFiles);
+    return removed;
+}
+
+std::vector<std::pair<int64_t, std::string>> CloudAccountManager::cloudFileNames(
+    int64_t accountId, const std::optional<std::string>& cloudId) const {
+    if (!m_suggest) {
+        return {};
+    }
+
+    auto mapRow = [](sqlite3_stmt* stmt) {
+        return std::make_pair(Database::getInt64(stmt, 0), Database::getString(stmt, 1));
+    };
+    if (cloudId) {
+        return m_db->query<std::pair<int64_t, std::string>>(
+            "SELECT id, name FROM cloud_files WHERE account_id = ? AND cloud_id = ?",
+            mapRow, accountId, *cloudId);
+    }
+    return m_db->query<std::pair<int64_t, std::string>>(
+        "SELECT id, name FROM cloud_files WHERE account_id = ?",
+        mapRow, accountId);
+}
+
+void CloudAccountManager::forgetCloudFiles(const std::vector<std::pair<int64_t, std::string>>& files) {
+    for (const auto& [fileId, name] : files) {
+        m_suggest->removeFile(SuggestSource::Cloud, fileId, name);
+    }
 }
 
 bool CloudAccountManager::ensureAccountExists(int64_t accountId) const {
@@ -0,0 +1,223 @@
+#include "familyvault/CheckpointManager.h"
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <filesystem>
+#include <system_error>
+
+namespace fs = std::filesystem;
+
+namespace FamilyVault {
+
+// ═══════════════════════════════════════════════════════════
+// BulkWrite
+// ═══════════════════════════════════════════════════════════
+
+CheckpointManager::BulkWrite::BulkWrite(CheckpointManager* manager)
+    : m_manager(manager) {
+}
+
+CheckpointManager::BulkWrite::~BulkWrite() {
+    if (m_manager) {
+        m_manager->endBulkWrite();
+    }
+}
+
+CheckpointManager::BulkWrite::BulkWrite(BulkWrite&& other) noexcept
+    : m_manager(other.m_manager) {
+    other.m_manager = nullptr;
+}
+
+CheckpointManager::BulkWrite& CheckpointManager::BulkWrite::operator=(BulkWrite&& other) noexcept {
+    if (this != &other) {
+        if (m_manager) {
+            m_manager->endBulkWrite();
+        }
+        m_manager = other.m_manager;
+        other.m_manager = nullptr;
+    }
+    return *this;
+}
+
+// ═══════════════════════════════════════════════════════════
+// CheckpointManager
+// ═══════════════════════════════════════════════════════════
+
+CheckpointManager::CheckpointManager(std::shared_ptr<Database> db, CheckpointOptions options)
+    : m_db(std::move(db))
+    , m_options(options) {
+    m_lastWrite = nowMs();
+}
+
+CheckpointManager::~CheckpointManager() {
+    stop();
+}
+
+void CheckpointManager::start() {
+    std::lock_guard lock(m_mutex);
+    if (m_worker.joinable()) return;
+
+    m_stopRequested = false;
+    m_worker = std::thread(&CheckpointManager::workerThread, this);
+}
+
+void CheckpointManager::stop() {
+    {
+        std::lock_guard lock(m_mutex);
+        m_stopRequested = true;
+    }
+    m_condition.notify_all();
+    if (m_worker.joinable()) {
+        m_worker.join();
+    }
+}
+
+bool CheckpointManager::isRunning() const {
+    std::lock_guard lock(m_mutex);
+    return m_worker.joinable() && !m_stopRequested;
+}
+
+CheckpointManager::BulkWrite CheckpointManager::beginBulkWrite() {
+    std::lock_guard lock(m_bulkMutex);
+    if (m_bulkCount++ == 0) {
+        // Писатель больше не делает checkpoint синхронно после каждой 1000 страниц
+        m_db->setWalAutocheckpoint(0);
+        std::lock_guard statsLock(m_statsMutex);
+        m_stats.bulkActive = true;
+    }
+    noteWrite();
+    return BulkWrite(this);
+}
+
+void CheckpointManager::endBulkWrite() {
+    {
+        std::lock_guard lock(m_bulkMutex);
+        if (--m_bulkCount > 0) return;
+
+        m_db->setWalAutocheckpoint(m_options.autocheckpointPages);
+        std::lock_guard statsLock(m_statsMutex);
+        m_stats.bulkActive = false;
+    }
+    noteWrite();
+    m_condition.notify_all();
+}
+
+void CheckpointManager::noteWrite() {
+    m_lastWrite = nowMs();
+}
+
+// ═══════════════════════════════════════════════════════════
+// Checkpoint
+// ═══════════════════════════════════════════════════════════
+
+bool CheckpointManager::checkpointNow(bool truncate) {
+    // Версия до checkpoint: запись во время него будет замечена следующим опросом
+    uint32_t version = m_db->dataVersion();
+    auto passive = runCheckpoint(WalCheckpointMode::Passive);
+    {
+        std::lock_guard lock(m_statsMutex);
+        m_framesLeft = passive.complete() ? 0 : std::max(1, passive.logFrames - passive.checkpointedFrames);
+        m_checkpointedVersion = version;
+        if (!passive.complete()) {
+            // Читатель держит старый снимок — остаток перенесём в следующий раз
+            ++m_stats.incomplete;
+            return false;
+        }
+    }
+
+    // После полного PASSIVE TRUNCATE ждёт только новых читателей, и то недолго
+    if (truncate && walSizeBytes() > 0) {
+        auto truncated = runCheckpoint(WalCheckpointMode::Truncate);
+        if (truncated.complete()) {
+            std::lock_guard lock(m_statsMutex);
+            ++m_stats.truncations;
+        }
+    }
+    return true;
+}
+
+WalCheckpointResult CheckpointManager::runCheckpoint(WalCheckpointMode mode) {
+    auto startTime = std::chrono::steady_clock::now();
+    auto result = m_db->walCheckpoint(mode);
+    auto latencyUs = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - startTime).count();
+
+    std::lock_guard lock(m_statsMutex);
+    ++m_stats.checkpoints;
+    m_stats.lastLatencyUs = latencyUs;
+    m_stats.maxLatencyUs = std::max(m_stats.maxLatencyUs, static_cast<int64_t>(latencyUs));
+    m_stats.totalLatencyUs += latencyUs;
+    m_stats.lastCheckpointAt = std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    return result;
+}
+
+bool CheckpointManager::hasPendingFrames() const {
+    uint32_t version = m_db->dataVersion();
+    std::lock_guard lock(m_statsMutex);
+    return m_framesLeft != 0 || version != m_checkpointedVersion;
+}
+
+int64_t CheckpointManager::walSizeBytes() const {
+    const auto& path = m_db->path();
+    if (path.empty() || path == ":memory:") return 0;
+
+    std::error_code ec;
+    auto size = fs::file_size(path + "-wal", ec);
+    return ec ? 0 : static_cast<int64_t>(size);
+}
+
+CheckpointStats CheckpointManager::stats() const {
+    CheckpointStats result;
+    {
+        std::lock_guard lock(m_statsMutex);
+        result = m_stats;
+    }
+    result.walBytes = walSizeBytes();
+    return result;
+}
+
+// ═══════════════════════════════════════════════════════════
+// Фоновый поток
+// ═══════════════════════════════════════════════════════════
+
+void CheckpointManager::workerThread() {
+    while (true) {
+        {
+            std::unique_lock lock(m_mutex);
+            m_condition.wait_for(lock, m_options.pollInterval, [this] { return m_stopRequested; });
+            if (m_stopRequested) return;
+        }
+
+        int64_t walBytes = walSizeBytes();
+        bool bulk;
+        {
+            std::lock_guard lock(m_bulkMutex);
+            bulk = m_bulkCount > 0;
+        }
+        bool idle = nowMs() - m_lastWrite.load() >= m_options.idleDelay.count();
+
+        // Массовая запись или читатели не дают WAL уменьшиться — переносим хотя бы часть
+        bool force = walBytes >= m_options.forceThresholdBytes;
+        bool idleLarge = !bulk && idle && walBytes >= m_options.passiveThresholdBytes;
+
+        try {
+            // Файл без TRUNCATE остаётся большим: если прошлый checkpoint перенёс
+            // всё и записи не было, PASSIVE ничего бы не сделал
+            if ((force || idleLarge) && hasPendingFrames()) {
+                checkpointNow(force ? !bulk : walBytes >= m_options.truncateThresholdBytes);
+            }
+        } catch (const std::exception& e) {
+            spdlog::warn("Background checkpoint failed: {}", e.what());
+        }
+
+        std::lock_guard lock(m_statsMutex);
+        m_stats.walBytes = walBytes;
+    }
+}
+
+int64_t CheckpointManager::nowMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace FamilyVault
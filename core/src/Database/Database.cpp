@@ -1,11 +1,109 @@
 #include "familyvault/Database.h"
 #include <sqlite3.h>
 #include <spdlog/spdlog.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
 #include <stdexcept>
+#include <thread>
+#include <unordered_map>
 
 namespace FamilyVault {
 
-Database::Database(const std::string& dbPath) : m_dbPath(dbPath) {
+namespace {
+
+/// busy_timeout соединения: 30 секунд для больших папок
+constexpr int kBusyTimeoutMs = 30000;
+
+/// Паузы busy handler (мс), как у sqlite3_busy_timeout
+constexpr int kBusyDelaysMs[] = {1, 2, 5, 10, 15, 20, 25, 25, 25, 50, 50, 100};
+
+using Clock = std::chrono::steady_clock;
+
+int64_t elapsedNs(Clock::time_point since) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - since).count();
+}
+
+/// Выполняемый statement. Запрос целиком выполняется в одном потоке
+/// (prepare → step → finalize), поэтому учёт — thread_local, без блокировок
+struct ActiveStatement {
+    sqlite3_stmt* stmt = nullptr;
+    int64_t elapsedNs = 0;      // prepare + все sqlite3_step
+    int64_t rows = 0;
+    bool failed = false;
+};
+
+thread_local std::vector<ActiveStatement> t_activeStatements;
+
+/// Свой срок ожидания блокировок для вызовов этого потока (0 — общий
+/// kBusyTimeoutMs). busy handler вызывается в потоке, выполняющем вызов SQLite,
+/// поэтому короткий срок checkpoint не достаётся запросам других потоков
+thread_local int t_busyTimeoutMs = 0;
+
+/// Срок ожидания на время области видимости
+class ScopedBusyTimeout {
+public:
+    explicit ScopedBusyTimeout(int timeoutMs) : m_previous(t_busyTimeoutMs) {
+        t_busyTimeoutMs = timeoutMs;
+    }
+    ~ScopedBusyTimeout() { t_busyTimeoutMs = m_previous; }
+
+    ScopedBusyTimeout(const ScopedBusyTimeout&) = delete;
+    ScopedBusyTimeout& operator=(const ScopedBusyTimeout&) = delete;
+
+private:
+    int m_previous;
+};
+
+ActiveStatement* findActive(sqlite3_stmt* stmt) {
+    for (auto it = t_activeStatements.rbegin(); it != t_activeStatements.rend(); ++it) {
+        if (it->stmt == stmt) return &*it;
+    }
+    return nullptr;
+}
+
+} // namespace
+
+struct Database::StatementCache {
+    std::mutex mutex;
+    std::unordered_map<const char*, sqlite3_stmt*> statements;
+};
+
+/// Свой busy handler вместо sqlite3_busy_timeout: та же стратегия пауз,
+/// но время ожидания блокировок попадает в метрики
+struct Database::BusyHandler {
+    QueryMetrics* metrics = nullptr;
+    int64_t waitUs = 0;         // Текущее ожидание (вызовы сериализованы мьютексом соединения)
+
+    static int callback(void* arg, int count) {
+        auto* self = static_cast<BusyHandler*>(arg);
+        if (count == 0) self->waitUs = 0;
+
+        int timeoutMs = t_busyTimeoutMs > 0 ? t_busyTimeoutMs : kBusyTimeoutMs;
+        int64_t remainingUs = int64_t{timeoutMs} * 1000 - self->waitUs;
+        if (remainingUs <= 0) return 0;
+
+        constexpr int lastDelay = static_cast<int>(std::size(kBusyDelaysMs)) - 1;
+        int64_t delayUs = int64_t{kBusyDelaysMs[std::min(count, lastDelay)]} * 1000;
+        auto start = Clock::now();
+        std::this_thread::sleep_for(std::chrono::microseconds(std::min(delayUs, remainingUs)));
+        int64_t sleptUs = elapsedNs(start) / 1000;
+
+        self->waitUs += sleptUs;
+        if (self->metrics->enabled()) {
+            self->metrics->recordLockWait(sleptUs, self->waitUs, count == 0);
+        }
+        return 1;
+    }
+};
+
+Database::Database(const std::string& dbPath)
+    : m_dbPath(dbPath), m_statementCache(std::make_unique<StatementCache>())
+    , m_metrics(std::make_unique<QueryMetrics>())
+    , m_busyHandler(std::make_unique<BusyHandler>()) {
+    m_busyHandler->metrics = m_metrics.get();
+
     int flags = SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_FULLMUTEX;
     int rc = sqlite3_open_v2(dbPath.c_str(), &m_db, flags, nullptr);
 
@@ -16,9 +114,14 @@ Database::Database(const std::string& dbPath) : m_dbPath(dbPath) {
         throw DatabaseException("Failed to open database: " + error);
     }
 
-    // Настройки для производительности и надёжности
+    // Настройки для производительности и надёжности.
+    // auto_vacuum — только для нового файла (до WAL: переход в WAL создаёт файл БД);
+    // у существующей БД режим меняет лишь полный VACUUM
+    if (queryScalar("PRAGMA page_count") == 0) {
+        execute("PRAGMA auto_vacuum = INCREMENTAL");
+    }
     execute("PRAGMA journal_mode = WAL");     // WAL режим — лучше для concurrent access
-    execute("PRAGMA busy_timeout = 30000");   // 30 seconds for large folders
+    sqlite3_busy_handler(m_db, &BusyHandler::callback, m_busyHandler.get());
     execute("PRAGMA foreign_keys = ON");
     execute("PRAGMA synchronous = NORMAL");
     execute("PRAGMA cache_size = -64000");    // 64MB cache
@@ -29,23 +132,34 @@ Database::Database(const std::string& dbPath) : m_dbPath(dbPath) {
 
 Database::~Database() {
     if (m_db) {
+        // Незавершённые statements не дают закрыть соединение
+        finalizeCachedStatements();
         sqlite3_close(m_db);
         spdlog::debug("Database closed: {}", m_dbPath);
     }
 }
 
 Database::Database(Database&& other) noexcept
-    : m_db(other.m_db), m_dbPath(std::move(other.m_dbPath)) {
+    : m_db(other.m_db), m_dbPath(std::move(other.m_dbPath))
+    , m_progressHandler(std::move(other.m_progressHandler))
+    , m_statementCache(std::move(other.m_statementCache))
+    , m_metrics(std::move(other.m_metrics))
+    , m_busyHandler(std::move(other.m_busyHandler)) {
     other.m_db = nullptr;
 }
 
 Database& Database::operator=(Database&& other) noexcept {
     if (this != &other) {
         if (m_db) {
+            finalizeCachedStatements();
             sqlite3_close(m_db);
         }
         m_db = other.m_db;
         m_dbPath = std::move(other.m_dbPath);
+        m_progressHandler = std::move(other.m_progressHandler);
+        m_statementCache = std::move(other.m_statementCache);
+        m_metrics = std::move(other.m_metrics);
+        m_busyHandler = std::move(other.m_busyHandler);
         other.m_db = nullptr;
     }
     return *this;
@@ -56,9 +170,14 @@ void Database::initialize() {
 }
 
 void Database::execute(const std::string& sql) {
+    auto start = Clock::now();
     char* errorMsg = nullptr;
     int rc = sqlite3_exec(m_db, sql.c_str(), nullptr, nullptr, &errorMsg);
 
+    if (m_metrics->enabled()) {
+        m_metrics->record(sql, elapsedNs(start) / 1000, 0, {}, rc != SQLITE_OK);
+    }
+
     if (rc != SQLITE_OK) {
         std::string error = errorMsg ? errorMsg : "Unknown error";
         sqlite3_free(errorMsg);
@@ -67,6 +186,7 @@ void Database::execute(const std::string& sql) {
 }
 
 sqlite3_stmt* Database::prepare(const std::string& sql) {
+    auto start = Clock::now();
     sqlite3_stmt* stmt = nullptr;
     int rc = sqlite3_prepare_v2(m_db, sql.c_str(), -1, &stmt, nullptr);
 
@@ -74,11 +194,12 @@ sqlite3_stmt* Database::prepare(const std::string& sql) {
         throw DatabaseException("Failed to prepare statement: " +
                                 std::string(sqlite3_errmsg(m_db)) + "\nSQL: " + sql);
     }
+    beginStatement(stmt, elapsedNs(start));
     return stmt;
 }
 
 void Database::step(sqlite3_stmt* stmt) {
-    int rc = sqlite3_step(stmt);
+    int rc = timedStep(stmt);
     if (rc != SQLITE_DONE && rc != SQLITE_ROW) {
         throw DatabaseException("Failed to execute statement: " +
                                 std::string(sqlite3_errmsg(m_db)));
@@ -86,7 +207,7 @@ void Database::step(sqlite3_stmt* stmt) {
 }
 
 bool Database::stepRow(sqlite3_stmt* stmt) {
-    int rc = sqlite3_step(stmt);
+    int rc = timedStep(stmt);
     if (rc == SQLITE_ROW) {
         return true;
     } else if (rc == SQLITE_DONE) {
@@ -96,12 +217,116 @@ bool Database::stepRow(sqlite3_stmt* stmt) {
                             std::string(sqlite3_errmsg(m_db)));
 }
 
+int Database::timedStep(sqlite3_stmt* stmt) {
+    ActiveStatement* active = m_metrics->enabled() ? findActive(stmt) : nullptr;
+    if (!active) {
+        return sqlite3_step(stmt);
+    }
+
+    auto start = Clock::now();
+    int rc = sqlite3_step(stmt);
+    active->elapsedNs += elapsedNs(start);
+    if (rc == SQLITE_ROW) {
+        ++active->rows;
+    } else if (rc != SQLITE_DONE) {
+        active->failed = true;
+    }
+    return rc;
+}
+
 void Database::finalize(sqlite3_stmt* stmt) {
     if (stmt) {
+        endStatement(stmt);
         sqlite3_finalize(stmt);
     }
 }
 
+// ═══════════════════════════════════════════════════════════
+// Метрики запросов
+// ═══════════════════════════════════════════════════════════
+
+void Database::beginStatement(sqlite3_stmt* stmt, int64_t prepareNs) {
+    if (!stmt || !m_metrics->enabled()) return;  // Пустой SQL — statement не создаётся
+    t_activeStatements.push_back({stmt, prepareNs, 0, false});
+}
+
+void Database::endStatement(sqlite3_stmt* stmt) {
+    auto it = std::find_if(t_activeStatements.rbegin(), t_activeStatements.rend(),
+                           [stmt](const ActiveStatement& a) { return a.stmt == stmt; });
+    if (it == t_activeStatements.rend()) return;
+
+    ActiveStatement active = *it;
+    t_activeStatements.erase(std::next(it).base());
+
+    // С флагом сброса: кэшированный statement начинает следующее выполнение с нуля
+    StatementCounters counters;
+    counters.fullScanSteps = sqlite3_stmt_status(stmt, SQLITE_STMTSTATUS_FULLSCAN_STEP, 1);
+    counters.sorts = sqlite3_stmt_status(stmt, SQLITE_STMTSTATUS_SORT, 1);
+    counters.autoIndexes = sqlite3_stmt_status(stmt, SQLITE_STMTSTATUS_AUTOINDEX, 1);
+
+    if (m_metrics->enabled()) {
+        m_metrics->record(sqlite3_sql(stmt), active.elapsedNs / 1000, active.rows,
+                          counters, active.failed);
+    }
+}
+
+// ═══════════════════════════════════════════════════════════
+// Кэш statements для типизированных запросов
+// ═══════════════════════════════════════════════════════════
+
+Database::CachedStatement::CachedStatement(Database& db, std::string_view sql)
+    : m_db(db), m_key(sql.data()), m_stmt(nullptr) {
+    {
+        std::lock_guard lock(db.m_statementCache->mutex);
+        auto it = db.m_statementCache->statements.find(m_key);
+        if (it != db.m_statementCache->statements.end()) {
+            m_stmt = it->second;
+            db.m_statementCache->statements.erase(it);
+        }
+    }
+    if (m_stmt) {
+        db.m_metrics->recordCacheLookup(true);
+        db.beginStatement(m_stmt, 0);
+        return;
+    }
+
+    auto start = Clock::now();
+    int rc = sqlite3_prepare_v3(db.m_db, sql.data(), static_cast<int>(sql.size()),
+                                SQLITE_PREPARE_PERSISTENT, &m_stmt, nullptr);
+    if (rc != SQLITE_OK) {
+        throw DatabaseException("Failed to prepare statement: " +
+                                std::string(sqlite3_errmsg(db.m_db)) + "\nSQL: " + std::string(sql));
+    }
+    db.m_metrics->recordCacheLookup(false);
+    db.beginStatement(m_stmt, elapsedNs(start));
+}
+
+Database::CachedStatement::~CachedStatement() {
+    m_db.endStatement(m_stmt);
+    sqlite3_reset(m_stmt);
+    sqlite3_clear_bindings(m_stmt);
+
+    std::lock_guard lock(m_db.m_statementCache->mutex);
+    auto [it, inserted] = m_db.m_statementCache->statements.emplace(m_key, m_stmt);
+    if (!inserted) {
+        sqlite3_finalize(m_stmt);  // Параллельный вызов уже вернул свой экземпляр
+    }
+}
+
+size_t Database::cachedStatementCount() const {
+    std::lock_guard lock(m_statementCache->mutex);
+    return m_statementCache->statements.size();
+}
+
+void Database::finalizeCachedStatements() {
+    if (!m_statementCache) return;
+    std::lock_guard lock(m_statementCache->mutex);
+    for (auto& [key, stmt] : m_statementCache->statements) {
+        sqlite3_finalize(stmt);
+    }
+    m_statementCache->statements.clear();
+}
+
 int64_t Database::lastInsertId() const {
     return sqlite3_last_insert_rowid(m_db);
 }
@@ -110,6 +335,64 @@ int Database::changesCount() const {
     return sqlite3_changes(m_db);
 }
 
+int64_t Database::totalChangesCount() const {
+    return sqlite3_total_changes64(m_db);
+}
+
+WalCheckpointResult Database::walCheckpoint(WalCheckpointMode mode, int busyTimeoutMs) {
+    int sqliteMode = SQLITE_CHECKPOINT_PASSIVE;
+    switch (mode) {
+        case WalCheckpointMode::Passive:  sqliteMode = SQLITE_CHECKPOINT_PASSIVE; break;
+        case WalCheckpointMode::Full:     sqliteMode = SQLITE_CHECKPOINT_FULL; break;
+        case WalCheckpointMode::Restart:  sqliteMode = SQLITE_CHECKPOINT_RESTART; break;
+        case WalCheckpointMode::Truncate: sqliteMode = SQLITE_CHECKPOINT_TRUNCATE; break;
+    }
+
+    // Блокирующие режимы вызывают busy handler: с общими 30 с соединение
+    // (FULLMUTEX) было бы занято, пока длинный запрос поиска держит снимок.
+    // Срок — только для этого потока и этого вызова
+    WalCheckpointResult result;
+    int rc;
+    {
+        ScopedBusyTimeout timeout(busyTimeoutMs);
+        rc = sqlite3_wal_checkpoint_v2(m_db, nullptr, sqliteMode,
+                                       &result.logFrames, &result.checkpointedFrames);
+    }
+
+    if (rc == SQLITE_BUSY) {
+        result.busy = true;
+    } else if (rc != SQLITE_OK) {
+        throw DatabaseException("WAL checkpoint failed: " + std::string(sqlite3_errmsg(m_db)));
+    }
+    return result;
+}
+
+uint32_t Database::dataVersion() const {
+    unsigned int version = 0;
+    if (sqlite3_file_control(m_db, "main", SQLITE_FCNTL_DATA_VERSION, &version) != SQLITE_OK) {
+        return 0;
+    }
+    return version;
+}
+
+void Database::setWalAutocheckpoint(int pages) {
+    sqlite3_wal_autocheckpoint(m_db, pages);
+}
+
+void Database::setProgressHandler(int instructions, std::function<bool()> shouldAbort) {
+    if (!shouldAbort) {
+        sqlite3_progress_handler(m_db, 0, nullptr, nullptr);
+        m_progressHandler.reset();
+        return;
+    }
+
+    m_progressHandler = std::make_unique<std::function<bool()>>(std::move(shouldAbort));
+    sqlite3_progress_handler(m_db, instructions, [](void* arg) -> int {
+        auto* handler = static_cast<std::function<bool()>*>(arg);
+        return (*handler)() ? 1 : 0;
+    }, m_progressHandler.get());
+}
+
 void Database::beginTransaction() {
     execute("BEGIN TRANSACTION");
 }
@@ -165,11 +448,17 @@ double Database::getDouble(sqlite3_stmt* stmt, int col) {
 }
 
 std::string Database::getString(sqlite3_stmt* stmt, int col) {
+    return std::string(getStringView(stmt, col));
+}
+
+std::string_view Database::getStringView(sqlite3_stmt* stmt, int col) {
+    // column_text до column_bytes: длина берётся уже после преобразования в текст
     const unsigned char* text = sqlite3_column_text(stmt, col);
     if (text) {
-        return std::string(reinterpret_cast<const char*>(text));
+        return {reinterpret_cast<const char*>(text),
+                static_cast<size_t>(sqlite3_column_bytes(stmt, col))};
     }
-    return "";
+    return {};
 }
 
 std::optional<std::string> Database::getStringOpt(sqlite3_stmt* stmt, int col) {
@@ -0,0 +1,246 @@
+#include "familyvault/MaintenanceScheduler.h"
+#include <spdlog/spdlog.h>
+#include <array>
+#include <algorithm>
+#include <string>
+
+namespace FamilyVault {
+
+namespace {
+
+/// FTS5 таблицы, сегменты которых сливаются шагом FtsMerge
+constexpr std::array<const char*, 3> kFtsTables = {"files_fts", "cloud_files_fts", "files_trigram"};
+
+/// PRAGMA auto_vacuum: 2 — INCREMENTAL
+constexpr int64_t kAutoVacuumIncremental = 2;
+
+} // namespace
+
+MaintenanceScheduler::MaintenanceScheduler(std::shared_ptr<Database> db, MaintenanceOptions options)
+    : m_db(std::move(db))
+    , m_options(options) {
+    m_lastActivity = nowMs();
+}
+
+MaintenanceScheduler::~MaintenanceScheduler() {
+    stop();
+}
+
+// ═══════════════════════════════════════════════════════════
+// Фоновый поток
+// ═══════════════════════════════════════════════════════════
+
+void MaintenanceScheduler::start() {
+    std::lock_guard lock(m_mutex);
+    if (m_worker.joinable()) return;
+
+    m_stopRequested = false;
+    m_worker = std::thread(&MaintenanceScheduler::workerThread, this);
+}
+
+void MaintenanceScheduler::stop() {
+    {
+        std::lock_guard lock(m_mutex);
+        m_stopRequested = true;
+    }
+    m_condition.notify_all();
+    if (m_worker.joinable()) {
+        m_worker.join();
+    }
+}
+
+bool MaintenanceScheduler::isRunning() const {
+    std::lock_guard lock(m_mutex);
+    return m_worker.joinable() && !m_stopRequested;
+}
+
+void MaintenanceScheduler::noteActivity() {
+    m_lastActivity = nowMs();
+}
+
+void MaintenanceScheduler::requestPass() {
+    m_passRequested = true;
+    m_condition.notify_all();
+}
+
+void MaintenanceScheduler::setProgressCallback(ProgressCallback callback) {
+    std::lock_guard lock(m_mutex);
+    m_callback = std::move(callback);
+}
+
+void MaintenanceScheduler::workerThread() {
+    auto nextPass = std::chrono::steady_clock::now() + m_options.passInterval;
+    bool inPass = false;
+
+    while (true) {
+        std::unique_lock lock(m_mutex);
+        if (m_stopRequested) return;
+
+        // Ждём простоя: idleDelay без noteActivity() от сканирования,
+        // извлечения текста и поиска
+        auto idleFor = std::chrono::milliseconds(nowMs() - m_lastActivity.load());
+        if (idleFor < m_options.idleDelay) {
+            m_condition.wait_for(lock, m_options.idleDelay - idleFor);
+            continue;
+        }
+
+        if (!inPass) {
+            if (!m_passRequested && std::chrono::steady_clock::now() < nextPass) {
+                m_condition.wait_until(lock, nextPass, [this] {
+                    return m_stopRequested || m_passRequested.load();
+                });
+                continue;
+            }
+            m_passRequested = false;
+            inPass = true;
+        }
+
+        auto callback = m_callback;
+        lock.unlock();
+
+        bool passHasMore;
+        {
+            std::lock_guard sliceLock(m_sliceMutex);
+            passHasMore = runSliceLocked(callback);
+        }
+        if (!passHasMore) {
+            inPass = false;
+            nextPass = std::chrono::steady_clock::now() + m_options.passInterval;
+            continue;
+        }
+
+        // Окно для запросов приложения между порциями
+        std::unique_lock pauseLock(m_mutex);
+        m_condition.wait_for(pauseLock, m_options.slicePause, [this] { return m_stopRequested.load(); });
+    }
+}
+
+// ═══════════════════════════════════════════════════════════
+// Порции
+// ═══════════════════════════════════════════════════════════
+
+bool MaintenanceScheduler::runSlice() {
+    std::lock_guard lock(m_sliceMutex);
+    return runSliceLocked(nullptr);
+}
+
+void MaintenanceScheduler::runPass(ProgressCallback onProgress) {
+    std::lock_guard lock(m_sliceMutex);
+    while (runSliceLocked(onProgress)) {
+    }
+}
+
+bool MaintenanceScheduler::runSliceLocked(const ProgressCallback& onProgress) {
+    MaintenanceProgress progress;
+    progress.step = m_step;
+
+    bool stepHasMore = false;
+    try {
+        switch (m_step) {
+            case MaintenanceStep::FtsMerge:
+                stepHasMore = mergeSlice(progress.remaining);
+                break;
+            case MaintenanceStep::IncrementalVacuum:
+                stepHasMore = vacuumSlice(progress.remaining);
+                break;
+            case MaintenanceStep::Optimize:
+                m_db->execute("PRAGMA optimize");
+                break;
+            case MaintenanceStep::Checkpoint: {
+                // PASSIVE не ждёт читателей; остаток WAL добирается в следующем проходе
+                auto result = m_db->walCheckpoint(WalCheckpointMode::Passive);
+                progress.remaining = std::max(0, result.logFrames - result.checkpointedFrames);
+                break;
+            }
+        }
+    } catch (const std::exception& e) {
+        // Ошибка шага не должна зациклить проход — переходим к следующему
+        spdlog::warn("Maintenance step {} failed: {}", static_cast<int>(m_step), e.what());
+        stepHasMore = false;
+    }
+
+    if (!stepHasMore) {
+        advance();
+    }
+
+    progress.slicesDone = ++m_slicesDone;
+    progress.passComplete = m_step == MaintenanceStep::FtsMerge && m_ftsTable == 0 && !stepHasMore;
+    if (progress.passComplete) {
+        m_slicesDone = 0;
+    }
+
+    if (onProgress) {
+        try {
+            onProgress(progress);
+        } catch (const std::exception& e) {
+            spdlog::error("Maintenance progress callback threw: {}", e.what());
+        }
+    }
+    return !progress.passComplete;
+}
+
+bool MaintenanceScheduler::mergeSlice(int64_t& remaining) {
+    remaining = -1;
+    const std::string table = kFtsTables[m_ftsTable];
+
+    // Отрицательное N — сливать все уровни (как 'optimize', но порциями по N страниц).
+    // По документации FTS5: разница total_changes < 2 — сливать было нечего
+    try {
+        int64_t before = m_db->totalChangesCount();
+        m_db->execute("INSERT INTO " + table + "(" + table + ", rank) VALUES('merge', ?)",
+                      -m_options.mergePages);
+        if (m_db->totalChangesCount() - before >= 2) {
+            return true;
+        }
+    } catch (const std::exception& e) {
+        // Ошибка одной таблицы не должна пропускать слияние остальных
+        spdlog::warn("FTS merge of {} failed: {}", table, e.what());
+    }
+
+    // Таблица слита — следующая таблица в рамках того же шага
+    ++m_ftsTable;
+    return m_ftsTable < kFtsTables.size();
+}
+
+bool MaintenanceScheduler::vacuumSlice(int64_t& remaining) {
+    if (m_db->queryScalar("PRAGMA auto_vacuum") != kAutoVacuumIncremental) {
+        // БД, созданная до миграции 6: без INCREMENTAL порциями не освободить
+        remaining = -1;
+        return false;
+    }
+
+    remaining = m_db->queryScalar("PRAGMA freelist_count");
+    if (remaining == 0) {
+        return false;
+    }
+
+    // sqlite3_exec доводит incremental_vacuum до конца (по странице на step)
+    m_db->execute("PRAGMA incremental_vacuum(" + std::to_string(m_options.vacuumPages) + ")");
+    remaining = m_db->queryScalar("PRAGMA freelist_count");
+    return remaining > 0;
+}
+
+void MaintenanceScheduler::advance() {
+    switch (m_step) {
+        case MaintenanceStep::FtsMerge:
+            m_step = MaintenanceStep::IncrementalVacuum;
+            break;
+        case MaintenanceStep::IncrementalVacuum:
+            m_step = MaintenanceStep::Optimize;
+            break;
+        case MaintenanceStep::Optimize:
+            m_step = MaintenanceStep::Checkpoint;
+            break;
+        case MaintenanceStep::Checkpoint:
+            m_step = MaintenanceStep::FtsMerge;
+            break;
+    }
+    m_ftsTable = 0;
+}
+
+int64_t MaintenanceScheduler::nowMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace FamilyVault
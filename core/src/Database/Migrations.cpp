@@ -243,6 +243,400 @@ CREATE TRIGGER IF NOT EXISTS cloud_files_fts_update AFTER UPDATE OF name, path O
     DELETE FROM cloud_files_fts WHERE rowid = old.id;
     INSERT INTO cloud_files_fts(rowid, name, path)
     VALUES (new.id, new.name, COALESCE(new.path, ''));
+END;
+    )SQL"},
+
+    Migration{2, "File stats counters", R"SQL(
+-- Материализованные счётчики: папка × тип контента
+-- Поддерживаются триггерами, getStats читает O(папок × типов) строк вместо агрегатов по files
+CREATE TABLE IF NOT EXISTS file_stats (
+    folder_id INTEGER NOT NULL,
+    content_type INTEGER NOT NULL,
+    file_count INTEGER NOT NULL DEFAULT 0,
+    total_size INTEGER NOT NULL DEFAULT 0,
+
+    PRIMARY KEY (folder_id, content_type)
+) WITHOUT ROWID;
+
+INSERT INTO file_stats (folder_id, content_type, file_count, total_size)
+SELECT folder_id, COALESCE(content_type, 0), COUNT(*), COALESCE(SUM(size), 0)
+FROM files
+GROUP BY folder_id, COALESCE(content_type, 0);
+
+-- Триггер: добавление файла → +1 к счётчику
+CREATE TRIGGER IF NOT EXISTS file_stats_insert AFTER INSERT ON files BEGIN
+    INSERT INTO file_stats (folder_id, content_type, file_count, total_size)
+    VALUES (new.folder_id, COALESCE(new.content_type, 0), 1, new.size)
+    ON CONFLICT(folder_id, content_type) DO UPDATE SET
+        file_count = file_count + 1,
+        total_size = total_size + excluded.total_size;
+END;
+
+-- Триггер: удаление файла (в т.ч. каскадное при удалении папки) → -1, пустые строки убираем
+CREATE TRIGGER IF NOT EXISTS file_stats_delete AFTER DELETE ON files BEGIN
+    UPDATE file_stats SET
+        file_count = file_count - 1,
+        total_size = total_size - old.size
+    WHERE folder_id = old.folder_id AND content_type = COALESCE(old.content_type, 0);
+    DELETE FROM file_stats
+    WHERE folder_id = old.folder_id AND content_type = COALESCE(old.content_type, 0)
+      AND file_count <= 0;
+END;
+
+-- Триггер: изменение размера/типа/папки → переносим файл между счётчиками
+-- WHEN отсекает no-op обновления из ON CONFLICT DO UPDATE при повторном сканировании
+CREATE TRIGGER IF NOT EXISTS file_stats_update AFTER UPDATE OF folder_id, content_type, size ON files
+WHEN old.folder_id IS NOT new.folder_id
+  OR old.content_type IS NOT new.content_type
+  OR old.size IS NOT new.size
+BEGIN
+    UPDATE file_stats SET
+        file_count = file_count - 1,
+        total_size = total_size - old.size
+    WHERE folder_id = old.folder_id AND content_type = COALESCE(old.content_type, 0);
+    DELETE FROM file_stats
+    WHERE folder_id = old.folder_id AND content_type = COALESCE(old.content_type, 0)
+      AND file_count <= 0;
+    INSERT INTO file_stats (folder_id, content_type, file_count, total_size)
+    VALUES (new.folder_id, COALESCE(new.content_type, 0), 1, new.size)
+    ON CONFLICT(folder_id, content_type) DO UPDATE SET
+        file_count = file_count + 1,
+        total_size = total_size + excluded.total_size;
+END;
+    )SQL"},
+
+    Migration{3, "Trigram filename index", R"SQL(
+-- Подстрочный поиск по имени и пути ("2023" в "IMG_20230514.jpg")
+-- External content: текст не дублируется, хранится только индекс триграмм
+CREATE VIRTUAL TABLE IF NOT EXISTS files_trigram USING fts5(
+    name,
+    relative_path,
+    content='files',
+    content_rowid='id',
+    tokenize='trigram'
+);
+
+INSERT INTO files_trigram(files_trigram) VALUES('rebuild');
+
+CREATE TRIGGER IF NOT EXISTS files_trigram_insert AFTER INSERT ON files BEGIN
+    INSERT INTO files_trigram(rowid, name, relative_path)
+    VALUES (new.id, new.name, new.relative_path);
+END;
+
+CREATE TRIGGER IF NOT EXISTS files_trigram_delete AFTER DELETE ON files BEGIN
+    INSERT INTO files_trigram(files_trigram, rowid, name, relative_path)
+    VALUES ('delete', old.id, old.name, old.relative_path);
+END;
+
+-- WHEN: повторное сканирование перезаписывает name тем же значением
+CREATE TRIGGER IF NOT EXISTS files_trigram_update AFTER UPDATE OF name, relative_path ON files
+WHEN old.name IS NOT new.name OR old.relative_path IS NOT new.relative_path
+BEGIN
+    INSERT INTO files_trigram(files_trigram, rowid, name, relative_path)
+    VALUES ('delete', old.id, old.name, old.relative_path);
+    INSERT INTO files_trigram(rowid, name, relative_path)
+    VALUES (new.id, new.name, new.relative_path);
+END;
+    )SQL"},
+
+    Migration{4, "Composite indexes for hot queries", R"SQL(
+-- Список папки: WHERE folder_id = ? ORDER BY name — без временного B-дерева для сортировки.
+-- Одиночный idx_files_folder — префикс этого индекса и UNIQUE(folder_id, relative_path)
+DROP INDEX IF EXISTS idx_files_folder;
+CREATE INDEX IF NOT EXISTS idx_files_folder_name ON files(folder_id, name);
+
+-- Дубликаты: поиск копий по checksum = ? AND source_device_id IS [NOT] NULL,
+-- EXISTS-подзапросы бэкапа читают только индекс
+DROP INDEX IF EXISTS idx_files_checksum;
+CREATE INDEX IF NOT EXISTS idx_files_checksum_source ON files(checksum, source_device_id);
+
+-- files.source_device_id фильтруется только IS NULL / IS NOT NULL: для локальных
+-- файлов (почти все строки) одиночный индекс лишь уводит планировщик от составных
+DROP INDEX IF EXISTS idx_files_source;
+
+-- Группы локальных дубликатов: GROUP BY checksum по уже упорядоченному индексу,
+-- size без чтения строк. Частичный — remote записи в него не попадают; source_device_id
+-- (всегда NULL) в конце нужен только чтобы индекс считался покрывающим
+CREATE INDEX IF NOT EXISTS idx_files_local_checksum ON files(checksum, size, source_device_id)
+    WHERE source_device_id IS NULL;
+
+-- Синхронизация: is_remote = 0 AND indexed_at > ? ORDER BY indexed_at.
+-- folder_id и visibility в индексе: COUNT(*) и проверка COALESCE(f.visibility, wf.visibility)
+-- обходятся без чтения строк files
+CREATE INDEX IF NOT EXISTS idx_files_sync ON files(is_remote, indexed_at, folder_id, visibility);
+    )SQL"},
+
+    Migration{5, "Directory tree", R"SQL(
+-- Каталоги внутри отслеживаемых папок: имя + ссылка на родителя, без повторения префиксов.
+-- parent_id = 0 — каталог верхнего уровня; files.directory_id = 0 — файл в корне папки
+CREATE TABLE IF NOT EXISTS directories (
+    id INTEGER PRIMARY KEY,
+    folder_id INTEGER NOT NULL,
+    parent_id INTEGER NOT NULL DEFAULT 0,
+    name TEXT NOT NULL,
+
+    UNIQUE(folder_id, parent_id, name),
+    FOREIGN KEY (folder_id) REFERENCES watched_folders(id) ON DELETE CASCADE
+);
+
+ALTER TABLE files ADD COLUMN directory_id INTEGER NOT NULL DEFAULT 0;
+
+-- Просмотр каталога — диапазон по (folder_id, directory_id), уже упорядоченный по имени
+CREATE INDEX IF NOT EXISTS idx_files_directory ON files(folder_id, directory_id, name);
+
+-- Заполнение из существующих relative_path. Полные пути каталогов живут
+-- только во временной таблице на время миграции
+CREATE TEMP TABLE directory_paths (
+    id INTEGER PRIMARY KEY,
+    folder_id INTEGER NOT NULL,
+    path TEXT NOT NULL,
+    parent_path TEXT NOT NULL,
+    name TEXT NOT NULL,
+
+    UNIQUE(folder_id, path)
+);
+
+INSERT INTO directory_paths (folder_id, path, parent_path, name)
+WITH RECURSIVE prefixes(folder_id, parent_path, path, name, rest) AS (
+    SELECT folder_id, '', '', '', relative_path
+    FROM files WHERE instr(relative_path, '/') > 0
+    UNION
+    SELECT folder_id,
+           path,
+           CASE WHEN path = '' THEN '' ELSE path || '/' END
+               || substr(rest, 1, instr(rest, '/') - 1),
+           substr(rest, 1, instr(rest, '/') - 1),
+           substr(rest, instr(rest, '/') + 1)
+    FROM prefixes WHERE instr(rest, '/') > 0
+)
+SELECT DISTINCT folder_id, path, parent_path, name
+FROM prefixes WHERE path != ''
+ORDER BY folder_id, length(path);
+
+INSERT INTO directories (id, folder_id, parent_id, name)
+SELECT d.id, d.folder_id, COALESCE(p.id, 0), d.name
+FROM directory_paths d
+LEFT JOIN directory_paths p ON p.folder_id = d.folder_id AND p.path = d.parent_path;
+
+-- Каталог файла: rtrim по всем символам пути кроме '/' отрезает имя файла
+UPDATE files SET directory_id = (
+    SELECT d.id FROM directory_paths d
+    WHERE d.folder_id = files.folder_id
+      AND d.path = rtrim(rtrim(files.relative_path, replace(files.relative_path, '/', '')), '/')
+)
+WHERE instr(relative_path, '/') > 0;
+
+DROP TABLE directory_paths;
+    )SQL"},
+
+    Migration{6, "Incremental auto-vacuum", R"SQL(
+-- Освобождённые страницы возвращаются порциями (PRAGMA incremental_vacuum) из
+-- MaintenanceScheduler вместо полного VACUUM. Новые БД получают режим при создании
+-- (конструктор Database, до перехода в WAL); существующие остаются в прежнем режиме,
+-- полный VACUUM автоматически не выполняется
+PRAGMA auto_vacuum = INCREMENTAL;
+    )SQL"},
+
+    Migration{7, "Page text hashes", R"SQL(
+-- Хеши текста страниц (PDF) в hex, по 16 символов на страницу: повторное
+-- извлечение с теми же хешами не переписывает запись FTS
+ALTER TABLE file_content ADD COLUMN page_hashes TEXT;
+    )SQL"},
+
+    Migration{8, "Extraction cache by checksum", R"SQL(
+-- Извлечённый текст по содержимому файла: дубликаты, переименования и
+-- переезды с тем же checksum не извлекаются заново. Текст пира с совпадающим
+-- checksum тоже попадает сюда (extraction_method = 'sync', max_bytes = 0).
+-- max_bytes — лимит текста при сохранении (0 — неизвестен, текст принимается)
+CREATE TABLE IF NOT EXISTS content_cache (
+    checksum TEXT PRIMARY KEY,
+    content TEXT NOT NULL,
+    extraction_method TEXT,
+    language TEXT,
+    page_hashes TEXT,
+    max_bytes INTEGER NOT NULL DEFAULT 0,
+    source_device_id TEXT DEFAULT NULL,
+    cached_at INTEGER DEFAULT (strftime('%s', 'now'))
+);
+    )SQL"},
+
+    Migration{9, "Extraction pending flag", R"SQL(
+-- Файл ждёт извлечения текста: новый или изменённый файл поддерживаемого типа.
+-- Флаг ставят триггеры, снимает ContentIndexer при сохранении результата.
+-- В частичном индексе только ожидающие файлы: поиск работы — обход
+-- этого индекса, а не LEFT JOIN files × file_content с LIKE по MIME
+ALTER TABLE files ADD COLUMN extraction_pending INTEGER NOT NULL DEFAULT 0;
+
+UPDATE files SET extraction_pending = 1
+WHERE mime_type IS NOT NULL
+  AND (
+      mime_type LIKE 'text/%'
+      OR mime_type = 'application/pdf'
+      OR mime_type = 'application/json'
+      OR mime_type LIKE 'application/vnd.openxmlformats%'
+      OR mime_type LIKE 'application/vnd.oasis.opendocument%'
+  )
+  AND NOT EXISTS (
+      SELECT 1 FROM file_content fc
+      WHERE fc.file_id = files.id AND fc.extracted_at >= files.modified_at
+  );
+
+CREATE INDEX IF NOT EXISTS idx_files_extraction_pending ON files(indexed_at DESC)
+WHERE extraction_pending = 1;
+
+CREATE TRIGGER IF NOT EXISTS files_extraction_insert AFTER INSERT ON files
+WHEN new.mime_type LIKE 'text/%'
+  OR new.mime_type = 'application/pdf'
+  OR new.mime_type = 'application/json'
+  OR new.mime_type LIKE 'application/vnd.openxmlformats%'
+  OR new.mime_type LIKE 'application/vnd.oasis.opendocument%'
+BEGIN
+    UPDATE files SET extraction_pending = 1 WHERE id = new.id;
+END;
+
+-- Повторное сканирование без изменений переписывает поля теми же значениями —
+-- WHEN отсекает такие обновления (размер — для правок в пределах секунды mtime)
+CREATE TRIGGER IF NOT EXISTS files_extraction_update AFTER UPDATE OF modified_at, size, mime_type ON files
+WHEN (old.modified_at IS NOT new.modified_at OR old.size IS NOT new.size
+      OR old.mime_type IS NOT new.mime_type)
+  AND (
+      new.mime_type LIKE 'text/%'
+      OR new.mime_type = 'application/pdf'
+      OR new.mime_type = 'application/json'
+      OR new.mime_type LIKE 'application/vnd.openxmlformats%'
+      OR new.mime_type LIKE 'application/vnd.oasis.opendocument%'
+  )
+BEGIN
+    UPDATE files SET extraction_pending = 1 WHERE id = new.id;
+END;
+    )SQL"},
+
+    Migration{10, "Interned MIME types", R"SQL(
+-- Справочник MIME-типов: файл хранит номер типа (files.mime_id), а пригодность
+-- к извлечению текста — флаг типа, а не LIKE по строке для каждого файла.
+-- Начальное значение флага — по шаблонам ниже; ContentIndexer сверяет его
+-- со своим реестром экстракторов
+CREATE TABLE IF NOT EXISTS mime_types (
+    id INTEGER PRIMARY KEY,
+    mime_type TEXT NOT NULL UNIQUE,
+    extractable INTEGER NOT NULL DEFAULT 0
+);
+
+CREATE TRIGGER IF NOT EXISTS mime_types_classify AFTER INSERT ON mime_types
+WHEN new.mime_type LIKE 'text/%'
+  OR new.mime_type = 'application/pdf'
+  OR new.mime_type = 'application/json'
+  OR new.mime_type LIKE 'application/vnd.openxmlformats%'
+  OR new.mime_type LIKE 'application/vnd.oasis.opendocument%'
+BEGIN
+    UPDATE mime_types SET extractable = 1 WHERE id = new.id;
+END;
+
+INSERT OR IGNORE INTO mime_types (mime_type)
+SELECT DISTINCT mime_type FROM files WHERE mime_type IS NOT NULL AND mime_type != '';
+
+ALTER TABLE files ADD COLUMN mime_id INTEGER REFERENCES mime_types(id);
+
+UPDATE files SET mime_id = (SELECT m.id FROM mime_types m WHERE m.mime_type = files.mime_type)
+WHERE mime_type IS NOT NULL AND mime_type != '';
+
+CREATE INDEX IF NOT EXISTS idx_files_mime ON files(mime_id);
+
+-- Триггеры флага extraction_pending проверяют флаг типа по номеру
+DROP TRIGGER IF EXISTS files_extraction_insert;
+DROP TRIGGER IF EXISTS files_extraction_update;
+
+CREATE TRIGGER IF NOT EXISTS files_extraction_insert AFTER INSERT ON files
+WHEN (SELECT extractable FROM mime_types WHERE id = new.mime_id) = 1
+BEGIN
+    UPDATE files SET extraction_pending = 1 WHERE id = new.id;
+END;
+
+CREATE TRIGGER IF NOT EXISTS files_extraction_update AFTER UPDATE OF modified_at, size, mime_id ON files
+WHEN (old.modified_at IS NOT new.modified_at OR old.size IS NOT new.size
+      OR old.mime_id IS NOT new.mime_id)
+  AND (SELECT extractable FROM mime_types WHERE id = new.mime_id) = 1
+BEGIN
+    UPDATE files SET extraction_pending = 1 WHERE id = new.id;
+END;
+    )SQL"},
+
+    Migration{11, "Single text hash", R"SQL(
+-- FTS5 хранит документ целиком: хеши отдельных страниц (миграция 7) не
+-- позволяют переписать меньше документа. Вместо них — хеш всего
+-- сохранённого текста; прежние хеши сбрасываются, первое повторное
+-- извлечение заполнит новый
+ALTER TABLE file_content ADD COLUMN text_hash INTEGER;
+ALTER TABLE file_content DROP COLUMN page_hashes;
+ALTER TABLE content_cache DROP COLUMN page_hashes;
+    )SQL"},
+
+    Migration{12, "Peer-only content cache", R"SQL(
+-- Локально извлечённый текст уже лежит в files_fts: копия с тем же checksum
+-- берёт его оттуда через file_content, второй экземпляр текста не хранится.
+-- content_cache остаётся только для текста пиров — до извлечения локальной
+-- копии с тем же checksum, после чего запись удаляется.
+-- file_content.max_bytes — лимит текста при сохранении (0 — неизвестен)
+ALTER TABLE file_content ADD COLUMN max_bytes INTEGER NOT NULL DEFAULT 0;
+
+CREATE TABLE content_cache_peer (
+    checksum TEXT PRIMARY KEY,
+    content TEXT NOT NULL,
+    source_device_id TEXT NOT NULL,
+    cached_at INTEGER DEFAULT (strftime('%s', 'now'))
+);
+INSERT INTO content_cache_peer (checksum, content, source_device_id, cached_at)
+SELECT checksum, content, source_device_id, cached_at
+FROM content_cache WHERE source_device_id IS NOT NULL;
+DROP TABLE content_cache;
+ALTER TABLE content_cache_peer RENAME TO content_cache;
+    )SQL"},
+
+    Migration{13, "Name-only FTS, directory names", R"SQL(
+-- Путь в files_fts дублировал files.relative_path дважды: хранимой копией
+-- FTS5 и токенами. Теперь FTS индексирует только имя и содержимое, а
+-- совпадение по пути ищется по именам каталогов (directories_fts) вместе
+-- с их подкаталогами. Триггеры files ссылаются на files_fts по имени,
+-- поэтому таблица пересоздаётся под тем же именем через временную копию
+CREATE TEMP TABLE fts_rows AS SELECT rowid AS id, name, content FROM files_fts;
+DROP TRIGGER IF EXISTS files_fts_insert;
+DROP TRIGGER IF EXISTS files_fts_delete;
+DROP TABLE files_fts;
+
+CREATE VIRTUAL TABLE files_fts USING fts5(
+    name,
+    content,
+    tokenize='unicode61 remove_diacritics 2'
+);
+INSERT INTO files_fts(rowid, name, content) SELECT id, name, content FROM fts_rows;
+DROP TABLE fts_rows;
+
+CREATE TRIGGER files_fts_insert AFTER INSERT ON files BEGIN
+    INSERT INTO files_fts(rowid, name, content) VALUES (new.id, new.name, '');
+END;
+
+CREATE TRIGGER files_fts_delete AFTER DELETE ON files BEGIN
+    DELETE FROM files_fts WHERE rowid = old.id;
+END;
+
+-- Имена каталогов: external content, текст хранится только в directories.
+-- Каталог не переименовывается (другое имя — другая строка), поэтому
+-- UPDATE-триггера нет: upsert DirectoryTree переписывает имя тем же значением
+CREATE VIRTUAL TABLE directories_fts USING fts5(
+    name,
+    content='directories',
+    content_rowid='id',
+    tokenize='unicode61 remove_diacritics 2'
+);
+INSERT INTO directories_fts(directories_fts) VALUES('rebuild');
+
+CREATE TRIGGER directories_fts_insert AFTER INSERT ON directories BEGIN
+    INSERT INTO directories_fts(rowid, name) VALUES (new.id, new.name);
+END;
+
+CREATE TRIGGER directories_fts_delete AFTER DELETE ON directories BEGIN
+    INSERT INTO directories_fts(directories_fts, rowid, name)
+    VALUES ('delete', old.id, old.name);
 END;
     )SQL"}
 };
@@ -0,0 +1,306 @@
+#include "familyvault/QueryMetrics.h"
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <optional>
+
+namespace FamilyVault {
+
+namespace {
+
+constexpr const char* kOverflowSql = "<other>";
+
+bool isIdentifierChar(char c) {
+    return std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '$';
+}
+
+bool isSpace(char c) {
+    return std::isspace(static_cast<unsigned char>(c)) != 0;
+}
+
+size_t bucketFor(int64_t elapsedUs) {
+    auto it = std::lower_bound(kLatencyBucketsUs.begin(), kLatencyBucketsUs.end(), elapsedUs);
+    return static_cast<size_t>(it - kLatencyBucketsUs.begin());
+}
+
+/// "?, ?, ?" → "?, ..." (списки IN переменной длины дают один ключ)
+std::string collapsePlaceholderLists(const std::string& sql) {
+    std::string out;
+    out.reserve(sql.size());
+
+    for (size_t i = 0; i < sql.size(); ++i) {
+        out += sql[i];
+        if (sql[i] != '?') continue;
+
+        size_t next = i + 1;
+        size_t lastItem = i;
+        while (true) {
+            size_t j = next;
+            while (j < sql.size() && sql[j] == ' ') ++j;
+            if (j >= sql.size() || sql[j] != ',') break;
+            ++j;
+            while (j < sql.size() && sql[j] == ' ') ++j;
+            if (j >= sql.size() || sql[j] != '?') break;
+            lastItem = j;
+            next = j + 1;
+        }
+        if (lastItem != i) {
+            out += ", ...";
+            i = lastItem;
+        }
+    }
+    return out;
+}
+
+} // namespace
+
+// ═══════════════════════════════════════════════════════════
+// StatementMetrics
+// ═══════════════════════════════════════════════════════════
+
+int64_t StatementMetrics::percentileUs(double p) const {
+    if (count == 0) return 0;
+
+    auto target = static_cast<int64_t>(std::ceil(p * static_cast<double>(count)));
+    target = std::clamp<int64_t>(target, 1, count);
+
+    int64_t seen = 0;
+    for (size_t i = 0; i < kLatencyBucketsUs.size(); ++i) {
+        seen += histogram[i];
+        if (seen >= target) return kLatencyBucketsUs[i];
+    }
+    return maxUs;
+}
+
+// ═══════════════════════════════════════════════════════════
+// QueryMetrics
+// ═══════════════════════════════════════════════════════════
+
+QueryMetrics::QueryMetrics(QueryMetricsOptions options)
+    : m_enabled(options.enabled)
+    , m_options(std::move(options)) {
+}
+
+QueryMetricsOptions QueryMetrics::options() const {
+    std::lock_guard lock(m_mutex);
+    return m_options;
+}
+
+void QueryMetrics::setOptions(const QueryMetricsOptions& options) {
+    std::lock_guard lock(m_mutex);
+    m_options = options;
+    m_enabled = options.enabled;
+    while (m_slowLog.size() > m_options.slowLogCapacity) {
+        m_slowLog.pop_front();
+    }
+}
+
+void QueryMetrics::record(std::string_view sql, int64_t elapsedUs, int64_t rows,
+                          const StatementCounters& counters, bool failed) {
+    std::optional<SlowQuery> slow;
+    {
+        std::unique_lock lock(m_mutex);
+
+        // Быстрый путь: тот же текст уже встречался (параметризованные запросы).
+        // Новый текст нормализуется без блокировки
+        StatementMetrics* found = nullptr;
+        auto raw = m_byRawSql.find(sql);
+        if (raw != m_byRawSql.end()) {
+            found = &m_statements[raw->second];
+        } else {
+            lock.unlock();
+            std::string normalized = normalizeSql(sql);
+            lock.lock();
+            found = &entryForLocked(sql, std::move(normalized));
+        }
+        slow = recordLocked(*found, elapsedUs, rows, counters, failed);
+    }
+
+    // Журнал — после снятия блокировки: запись лога не задерживает другие потоки
+    if (slow) {
+        spdlog::warn("Slow query: {} ms, {} rows: {}", slow->elapsedUs / 1000, slow->rows, slow->sql);
+    }
+}
+
+std::optional<SlowQuery> QueryMetrics::recordLocked(StatementMetrics& entry, int64_t elapsedUs,
+                                                    int64_t rows, const StatementCounters& counters,
+                                                    bool failed) {
+    ++m_total;
+    ++entry.count;
+    entry.rows += rows;
+    entry.totalUs += elapsedUs;
+    entry.maxUs = std::max(entry.maxUs, elapsedUs);
+    ++entry.histogram[bucketFor(elapsedUs)];
+    entry.counters.fullScanSteps += counters.fullScanSteps;
+    entry.counters.sorts += counters.sorts;
+    entry.counters.autoIndexes += counters.autoIndexes;
+    if (failed) ++entry.errors;
+
+    auto threshold = std::chrono::duration_cast<std::chrono::microseconds>(
+        m_options.slowQueryThreshold).count();
+    if (threshold <= 0 || elapsedUs < threshold) return std::nullopt;
+
+    ++m_slowQueries;
+    SlowQuery slow;
+    slow.sql = entry.sql;
+    slow.elapsedUs = elapsedUs;
+    slow.rows = rows;
+    slow.at = std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+
+    if (m_options.slowLogCapacity > 0) {
+        m_slowLog.push_back(slow);
+        if (m_slowLog.size() > m_options.slowLogCapacity) {
+            m_slowLog.pop_front();
+        }
+    }
+    return slow;
+}
+
+void QueryMetrics::recordCacheLookup(bool hit) {
+    (hit ? m_cacheHits : m_cacheMisses).fetch_add(1, std::memory_order_relaxed);
+}
+
+void QueryMetrics::recordLockWait(int64_t sleptUs, int64_t waitSoFarUs, bool newWait) {
+    std::lock_guard lock(m_mutex);
+    if (newWait) ++m_lockWaits;
+    m_lockWaitUs += sleptUs;
+    m_maxLockWaitUs = std::max(m_maxLockWaitUs, waitSoFarUs);
+}
+
+QueryMetricsSnapshot QueryMetrics::snapshot() const {
+    QueryMetricsSnapshot result;
+    result.cacheHits = m_cacheHits.load(std::memory_order_relaxed);
+    result.cacheMisses = m_cacheMisses.load(std::memory_order_relaxed);
+
+    std::lock_guard lock(m_mutex);
+    result.statements = m_total;
+    result.lockWaits = m_lockWaits;
+    result.lockWaitUs = m_lockWaitUs;
+    result.maxLockWaitUs = m_maxLockWaitUs;
+    result.slowQueries = m_slowQueries;
+    result.byStatement = m_statements;
+    result.slowLog.assign(m_slowLog.begin(), m_slowLog.end());
+
+    std::sort(result.byStatement.begin(), result.byStatement.end(),
+              [](const StatementMetrics& a, const StatementMetrics& b) {
+                  return a.totalUs > b.totalUs;
+              });
+    return result;
+}
+
+void QueryMetrics::reset() {
+    m_cacheHits = 0;
+    m_cacheMisses = 0;
+
+    std::lock_guard lock(m_mutex);
+    m_byRawSql.clear();
+    m_byNormalized.clear();
+    m_statements.clear();
+    m_slowLog.clear();
+    m_total = 0;
+    m_slowQueries = 0;
+    m_lockWaits = 0;
+    m_lockWaitUs = 0;
+    m_maxLockWaitUs = 0;
+}
+
+StatementMetrics& QueryMetrics::entryForLocked(std::string_view sql, std::string normalized) {
+    // Пока блокировка была снята, тот же текст мог записать другой поток
+    auto raw = m_byRawSql.find(sql);
+    if (raw != m_byRawSql.end()) {
+        return m_statements[raw->second];
+    }
+
+    auto it = m_byNormalized.find(normalized);
+    if (it == m_byNormalized.end()) {
+        if (m_statements.size() >= m_options.maxStatements) {
+            normalized = kOverflowSql;
+            it = m_byNormalized.find(std::string_view(kOverflowSql));
+        }
+        if (it == m_byNormalized.end()) {
+            StatementMetrics entry;
+            entry.sql = normalized;
+            m_statements.push_back(std::move(entry));
+            it = m_byNormalized.emplace(std::move(normalized), m_statements.size() - 1).first;
+        }
+    }
+
+    // Динамический SQL с литералами не должен раздувать карту исходных текстов
+    if (m_byRawSql.size() < m_options.maxStatements * 4) {
+        m_byRawSql.emplace(std::string(sql), it->second);
+    }
+    return m_statements[it->second];
+}
+
+std::string QueryMetrics::normalizeSql(std::string_view sql) {
+    std::string out;
+    out.reserve(sql.size());
+    bool pendingSpace = false;
+
+    auto emit = [&](char c) {
+        if (pendingSpace && !out.empty()) out += ' ';
+        pendingSpace = false;
+        out += c;
+    };
+
+    for (size_t i = 0; i < sql.size(); ++i) {
+        char c = sql[i];
+
+        if (isSpace(c)) {
+            pendingSpace = true;
+        } else if (c == '-' && i + 1 < sql.size() && sql[i + 1] == '-') {
+            while (i < sql.size() && sql[i] != '\n') ++i;
+            pendingSpace = true;
+        } else if (c == '/' && i + 1 < sql.size() && sql[i + 1] == '*') {
+            auto end = sql.find("*/", i + 2);
+            i = end == std::string_view::npos ? sql.size() : end + 1;
+            pendingSpace = true;
+        } else if (c == '\'') {
+            // Строковый литерал ('' внутри — экранированная кавычка)
+            ++i;
+            while (i < sql.size()) {
+                if (sql[i] == '\'') {
+                    if (i + 1 < sql.size() && sql[i + 1] == '\'') {
+                        i += 2;
+                        continue;
+                    }
+                    break;
+                }
+                ++i;
+            }
+            emit('?');
+        } else if (std::isdigit(static_cast<unsigned char>(c)) &&
+                   (out.empty() || pendingSpace || !isIdentifierChar(out.back()))) {
+            while (i + 1 < sql.size() &&
+                   (std::isalnum(static_cast<unsigned char>(sql[i + 1])) || sql[i + 1] == '.')) {
+                ++i;
+            }
+            emit('?');
+        } else if (isIdentifierChar(c) || c == '"' || c == '[' || c == '`') {
+            // Идентификатор целиком — цифры внутри (idx_files_2) не литералы
+            emit(c);
+            char close = c == '"' ? '"' : c == '[' ? ']' : c == '`' ? '`' : 0;
+            while (i + 1 < sql.size()) {
+                char n = sql[i + 1];
+                if (close ? n == close : !isIdentifierChar(n)) break;
+                out += n;
+                ++i;
+            }
+            if (close && i + 1 < sql.size()) {
+                out += close;
+                ++i;
+            }
+        } else {
+            emit(c);
+        }
+    }
+
+    while (!out.empty() && (out.back() == ';' || out.back() == ' ')) {
+        out.pop_back();
+    }
+    return collapsePlaceholderLists(out);
+}
+
+} // namespace FamilyVault
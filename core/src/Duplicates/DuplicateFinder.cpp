@@ -1,4 +1,5 @@
 #include "familyvault/DuplicateFinder.h"
+#include "familyvault/HotQueries.h"
 #include "familyvault/IndexManager.h"
 #include <spdlog/spdlog.h>
 #include <openssl/evp.h>
@@ -99,15 +100,7 @@ std::string DuplicateFinder::getFilePath(int64_t fileId) {
 std::vector<DuplicateGroup> DuplicateFinder::findLocalDuplicates() {
     // Находим группы файлов с одинаковым checksum
     auto groups = m_db->query<std::pair<std::string, int64_t>>(
-        R"SQL(
-        SELECT checksum, size
-        FROM files
-        WHERE checksum IS NOT NULL 
-          AND source_device_id IS NULL
-        GROUP BY checksum
-        HAVING COUNT(*) > 1
-        ORDER BY size * (COUNT(*) - 1) DESC
-        )SQL",
+        queries::LOCAL_DUPLICATE_GROUPS_SQL,
         [](sqlite3_stmt* stmt) {
             return std::make_pair(
                 Database::getString(stmt, 0),
@@ -126,31 +119,14 @@ std::vector<DuplicateGroup> DuplicateFinder::findLocalDuplicates() {
 
         // Локальные копии
         group.localCopies = m_db->query<FileRecord>(
-            R"SQL(
-            SELECT f.id, f.folder_id, f.relative_path, f.name, f.extension, f.size,
-                   f.mime_type, f.content_type, f.checksum, f.created_at, f.modified_at,
-                   f.indexed_at, COALESCE(f.visibility, wf.visibility) as visibility,
-                   f.source_device_id, f.is_remote, f.sync_version, f.last_modified_by
-            FROM files f
-            JOIN watched_folders wf ON f.folder_id = wf.id
-            WHERE f.checksum = ? AND f.source_device_id IS NULL
-            ORDER BY f.indexed_at
-            )SQL",
+            queries::LOCAL_DUPLICATE_COPIES_SQL,
             mapFileRecord,
             checksum
         );
 
         // Remote копии (информационно)
         group.remoteCopies = m_db->query<FileRecord>(
-            R"SQL(
-            SELECT f.id, f.folder_id, f.relative_path, f.name, f.extension, f.size,
-                   f.mime_type, f.content_type, f.checksum, f.created_at, f.modified_at,
-                   f.indexed_at, COALESCE(f.visibility, wf.visibility) as visibility,
-                   f.source_device_id, f.is_remote, f.sync_version, f.last_modified_by
-            FROM files f
-            JOIN watched_folders wf ON f.folder_id = wf.id
-            WHERE f.checksum = ? AND f.source_device_id IS NOT NULL
-            )SQL",
+            queries::REMOTE_DUPLICATE_COPIES_SQL,
             mapFileRecord,
             checksum
         );
@@ -1,10 +1,36 @@
 #include "familyvault/ContentIndexer.h"
 #include "familyvault/Database.h"
+#include "familyvault/CheckpointManager.h"
+#include "familyvault/MaintenanceScheduler.h"
+#include "familyvault/DuplicateFinder.h"
+#include "familyvault/HotQueries.h"
 #include <spdlog/spdlog.h>
+#include <algorithm>
+#include <bit>
 #include <chrono>
+#include <cstdio>
 
 namespace FamilyVault {
 
+namespace {
+
+/// Сколько хранится запись кэша, checksum которой нет ни у одного файла.
+/// При переезде файла старая запись files удаляется раньше, чем у новой
+/// появится checksum, — кэш не должен пропасть вместе с ней
+constexpr int64_t kOrphanCacheSeconds = 30 * 24 * 3600;
+
+/// Хеш текста документа (FNV-1a 64): стабилен между запусками и платформами
+int64_t textHash(std::string_view text) {
+    uint64_t hash = 14695981039346656037ull;
+    for (char c : text) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ull;
+    }
+    return static_cast<int64_t>(hash);
+}
+
+} // namespace
+
 // ═══════════════════════════════════════════════════════════
 // Constructor / Destructor
 // ═══════════════════════════════════════════════════════════
@@ -14,6 +40,15 @@ ContentIndexer::ContentIndexer(std::shared_ptr<Database> db,
     : m_db(std::move(db))
     , m_extractors(extractors ? std::move(extractors) : TextExtractorRegistry::createDefault())
 {
+    m_extractors->setMaxTextSize(static_cast<size_t>(m_maxTextSizeKB.load()) * 1024);
+    
+    // Все известные номера типов связываются сразу: выбор экстрактора при
+    // извлечении — чтение неизменяемой таблицы реестра
+    try {
+        classifyMimeTypes();
+    } catch (const std::exception& e) {
+        spdlog::warn("ContentIndexer: MIME classification failed: {}", e.what());
+    }
     spdlog::info("ContentIndexer created");
 }
 
@@ -32,11 +67,20 @@ void ContentIndexer::start() {
         return;
     }
     
-    m_stopRequested = false;
+    {
+        // Первый проход ищет работу, накопившуюся до запуска
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+        m_stopRequested = false;
+        m_workAvailable = true;
+    }
     m_running = true;
     m_processed = 0;
     m_failed = 0;
     
+    if (m_ingest) {
+        m_ingest->setListener([this] { onIngest(); });
+    }
+    
     m_worker = std::thread(&ContentIndexer::workerThread, this);
     spdlog::info("ContentIndexer: started background processing");
 }
@@ -46,7 +90,15 @@ void ContentIndexer::stop(bool wait) {
         return;
     }
     
-    m_stopRequested = true;
+    if (m_ingest) {
+        m_ingest->setListener(nullptr);
+    }
+    
+    {
+        // Под мьютексом: рабочий поток ждёт без таймаута и не должен пропустить сигнал
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+        m_stopRequested = true;
+    }
     m_queueCondition.notify_all();
     
     if (wait && m_worker.joinable()) {
@@ -66,58 +118,101 @@ bool ContentIndexer::isRunning() const {
 // Queue management
 // ═══════════════════════════════════════════════════════════
 
-void ContentIndexer::enqueueFile(int64_t fileId) {
+void ContentIndexer::enqueueFile(int64_t fileId, ContentPriority priority) {
+    auto cost = m_db->queryOne<int64_t>(
+        "SELECT mime_type, size FROM files WHERE id = ?",
+        [](sqlite3_stmt* stmt) {
+            return estimateCost(Database::getString(stmt, 0), Database::getInt64(stmt, 1));
+        },
+        fileId);
+    
     {
         std::lock_guard<std::mutex> lock(m_queueMutex);
-        m_queue.push(fileId);
+        pushLocked(fileId, priority, cost.value_or(0));
     }
     m_queueCondition.notify_one();
 }
 
+bool ContentIndexer::pushLocked(int64_t fileId, ContentPriority priority, int64_t cost) {
+    auto queued = m_queued.find(fileId);
+    if (queued != m_queued.end()) {
+        // Уже в очереди: повторная постановка может только поднять приоритет
+        QueueEntry entry = *queued->second;
+        if (priority < entry.priority) {
+            m_queue.erase(queued->second);
+            entry.priority = priority;
+            queued->second = m_queue.insert(entry).first;
+        }
+        return false;
+    }
+    
+    QueueEntry entry;
+    entry.priority = priority;
+    entry.costClass = std::bit_width(static_cast<uint64_t>(std::max<int64_t>(cost, 0)));
+    entry.seq = m_queueSeq++;
+    entry.fileId = fileId;
+    m_queued.emplace(fileId, m_queue.insert(entry).first);
+    return true;
+}
+
+int64_t ContentIndexer::estimateCost(const std::string& mimeType, int64_t size) {
+    // Множители — грубое отношение времени извлечения на байт к обычному тексту:
+    // PDF разбирается poppler постранично, офисные форматы — распаковка ZIP и XML
+    int64_t factor = 1;
+    if (mimeType == "application/pdf") {
+        factor = 8;
+    } else if (mimeType.starts_with("application/vnd.openxmlformats") ||
+               mimeType.starts_with("application/vnd.oasis.opendocument")) {
+        factor = 4;
+    } else if (mimeType == "text/html" || mimeType.ends_with("xml")) {
+        factor = 2;
+    }
+    return std::max<int64_t>(size, 0) * factor;
+}
+
 int ContentIndexer::enqueueUnprocessed() {
 #if !ENABLE_TEXT_EXTRACTION
     // Text extraction disabled - nothing to enqueue
     return 0;
 #else
-    // Находим файлы с поддерживаемыми MIME типами:
-    // 1. Без извлечённого контента
-    // 2. ИЛИ изменённые после извлечения (rescan case)
-    auto fileIds = m_db->query<int64_t>(R"SQL(
-        SELECT f.id FROM files f
-        LEFT JOIN file_content fc ON f.id = fc.file_id
-        WHERE f.mime_type IS NOT NULL
-          AND (
-              f.mime_type LIKE 'text/%'
-              OR f.mime_type = 'application/pdf'
-              OR f.mime_type = 'application/json'
-              OR f.mime_type LIKE 'application/vnd.openxmlformats%'
-              OR f.mime_type LIKE 'application/vnd.oasis.opendocument%'
-          )
-          AND (
-              fc.file_id IS NULL                    -- Never processed
-              OR f.modified_at > fc.extracted_at    -- Modified after extraction
-          )
-        ORDER BY f.indexed_at DESC
-        LIMIT ?
-    )SQL",
+    classifyMimeTypes();
+    
+    // Новые и изменённые файлы поддерживаемых типов помечены триггерами
+    // (extraction_pending) — обход частичного индекса, без JOIN с file_content
+    struct Candidate {
+        int64_t id;
+        int64_t cost;
+    };
+    auto candidates = m_db->query<Candidate>(queries::PENDING_EXTRACTION_SQL,
     [](sqlite3_stmt* stmt) {
-        return Database::getInt64(stmt, 0);
+        return Candidate{
+            Database::getInt64(stmt, 0),
+            estimateCost(Database::getString(stmt, 1), Database::getInt64(stmt, 2))
+        };
     },
     m_maxFilesPerSession);
     
+    // Порядок обработки задаёт очередь (дешёвые раньше), а не выборка.
+    // Стоящие в очереди и обрабатываемый сейчас файл повторно не добавляются
+    int added = 0;
     {
         std::lock_guard<std::mutex> lock(m_queueMutex);
-        for (int64_t id : fileIds) {
-            m_queue.push(id);
+        // Выборка упёрлась в лимит — остаток заберём, когда очередь опустеет
+        m_morePending = static_cast<int>(candidates.size()) >= m_maxFilesPerSession;
+        for (const auto& candidate : candidates) {
+            if (candidate.id == m_activeFileId) continue;
+            if (pushLocked(candidate.id, ContentPriority::Background, candidate.cost)) {
+                ++added;
+            }
         }
     }
     
-    if (!fileIds.empty()) {
+    if (added > 0) {
         m_queueCondition.notify_one();
     }
     
-    spdlog::info("ContentIndexer: enqueued {} unprocessed files", fileIds.size());
-    return static_cast<int>(fileIds.size());
+    spdlog::info("ContentIndexer: enqueued {} unprocessed files", added);
+    return added;
 #endif // ENABLE_TEXT_EXTRACTION
 }
 
@@ -125,22 +220,7 @@ int ContentIndexer::getPendingCount() const {
 #if !ENABLE_TEXT_EXTRACTION
     return 0;
 #else
-    auto count = m_db->queryScalar(R"SQL(
-        SELECT COUNT(*) FROM files f
-        LEFT JOIN file_content fc ON f.id = fc.file_id
-        WHERE f.mime_type IS NOT NULL
-          AND (
-              f.mime_type LIKE 'text/%'
-              OR f.mime_type = 'application/pdf'
-              OR f.mime_type = 'application/json'
-              OR f.mime_type LIKE 'application/vnd.openxmlformats%'
-              OR f.mime_type LIKE 'application/vnd.oasis.opendocument%'
-          )
-          AND (
-              fc.file_id IS NULL                    -- Never processed
-              OR f.modified_at > fc.extracted_at    -- Modified after extraction
-          )
-    )SQL");
+    auto count = m_db->queryScalar(queries::PENDING_EXTRACTION_COUNT_SQL);
     
     return static_cast<int>(count);
 #endif // ENABLE_TEXT_EXTRACTION
@@ -157,19 +237,11 @@ bool ContentIndexer::processFile(int64_t fileId) {
 void ContentIndexer::reindexAll(ProgressCallback onProgress) {
     spdlog::info("ContentIndexer: starting full reindex");
     
-    // Получаем все файлы с поддерживаемыми MIME типами
-    auto fileIds = m_db->query<int64_t>(R"SQL(
-        SELECT id FROM files
-        WHERE mime_type IS NOT NULL
-          AND (
-              mime_type LIKE 'text/%'
-              OR mime_type = 'application/pdf'
-              OR mime_type = 'application/json'
-              OR mime_type LIKE 'application/vnd.openxmlformats%'
-              OR mime_type LIKE 'application/vnd.oasis.opendocument%'
-          )
-        ORDER BY indexed_at DESC
-    )SQL",
+    classifyMimeTypes();
+    
+    // Получаем все файлы с поддерживаемыми MIME типами: номера типов
+    // из справочника, файлы — по idx_files_mime
+    auto fileIds = m_db->query<int64_t>(queries::EXTRACTABLE_FILES_SQL,
     [](sqlite3_stmt* stmt) {
         return Database::getInt64(stmt, 0);
     });
@@ -178,6 +250,9 @@ void ContentIndexer::reindexAll(ProgressCallback onProgress) {
     int processed = 0;
     int failed = 0;
     
+    CheckpointManager::BulkWrite bulkWrite;
+    if (m_checkpoints) bulkWrite = m_checkpoints->beginBulkWrite();
+    
     for (int64_t fileId : fileIds) {
         if (m_stopRequested.load()) {
             spdlog::info("ContentIndexer: reindex cancelled");
@@ -236,6 +311,33 @@ void ContentIndexer::setFileProcessedCallback(FileProcessedCallback cb) {
     m_fileProcessedCallback = std::move(cb);
 }
 
+void ContentIndexer::setCheckpointManager(std::shared_ptr<CheckpointManager> checkpoints) {
+    m_checkpoints = std::move(checkpoints);
+}
+
+void ContentIndexer::setMaintenanceScheduler(std::shared_ptr<MaintenanceScheduler> maintenance) {
+    m_maintenance = std::move(maintenance);
+}
+
+void ContentIndexer::setIngestSignal(std::shared_ptr<IngestSignal> ingest) {
+    m_ingest = std::move(ingest);
+}
+
+void ContentIndexer::setMaxTextSizeKB(int sizeKB) {
+    m_maxTextSizeKB.store(sizeKB);
+    // Лимит доходит до экстракторов: их собственный (1MB) больше не режет
+    // текст раньше настройки, а при меньшей настройке файл не дочитывается
+    m_extractors->setMaxTextSize(static_cast<size_t>(std::max(sizeKB, 0)) * 1024);
+}
+
+void ContentIndexer::onIngest() {
+    {
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+        m_workAvailable = true;
+    }
+    m_queueCondition.notify_one();
+}
+
 // ═══════════════════════════════════════════════════════════
 // Worker thread
 // ═══════════════════════════════════════════════════════════
@@ -243,6 +345,11 @@ void ContentIndexer::setFileProcessedCallback(FileProcessedCallback cb) {
 void ContentIndexer::workerThread() {
     spdlog::debug("ContentIndexer: worker thread started");
     
+    pruneContentCache();
+    
+    // Пока очередь не пуста — массовая запись, checkpoint откладывается до простоя
+    CheckpointManager::BulkWrite bulkWrite;
+    
     while (!m_stopRequested.load()) {
         int64_t fileId = 0;
         
@@ -250,8 +357,17 @@ void ContentIndexer::workerThread() {
         {
             std::unique_lock<std::mutex> lock(m_queueMutex);
             
-            m_queueCondition.wait_for(lock, std::chrono::seconds(1), [this] {
-                return m_stopRequested.load() || !m_queue.empty();
+            if (m_queue.empty() && bulkWrite.active()) {
+                // Очередь разобрана — массовая запись закончена
+                lock.unlock();
+                bulkWrite = CheckpointManager::BulkWrite();
+                lock.lock();
+            }
+            
+            // Без таймаута: в простое поток спит, пока не появится файл в очереди,
+            // сигнал сканирования (IngestSignal) или stop
+            m_queueCondition.wait(lock, [this] {
+                return m_stopRequested.load() || !m_queue.empty() || m_workAvailable;
             });
             
             if (m_stopRequested.load()) {
@@ -259,22 +375,37 @@ void ContentIndexer::workerThread() {
             }
             
             if (m_queue.empty()) {
-                // Очередь пуста — проверяем есть ли ещё необработанные файлы
+                // Сигнал о новой работе — одна выборка по частичному индексу
+                m_workAvailable = false;
                 lock.unlock();
-                int pending = getPendingCount();
-                if (pending > 0) {
-                    spdlog::debug("ContentIndexer: queue empty but {} files pending, re-enqueuing", pending);
-                    enqueueUnprocessed();
-                }
+                enqueueUnprocessed();
                 continue;
             }
             
-            fileId = m_queue.front();
-            m_queue.pop();
+            auto next = m_queue.begin();
+            fileId = next->fileId;
+            m_queued.erase(fileId);
+            m_queue.erase(next);
+            m_activeFileId = fileId;
+            
+            // Последний файл выборки, упёршейся в лимит: после него — следующая порция
+            if (m_queue.empty() && m_morePending) {
+                m_workAvailable = true;
+            }
+        }
+        
+        if (m_checkpoints && !bulkWrite.active()) {
+            bulkWrite = m_checkpoints->beginBulkWrite();
         }
         
-        // Обрабатываем файл
+        // Обрабатываем файл; до и после — активность (извлечение бывает долгим)
+        if (m_maintenance) m_maintenance->noteActivity();
         bool success = processFileInternal(fileId);
+        if (m_maintenance) m_maintenance->noteActivity();
+        {
+            std::lock_guard<std::mutex> lock(m_queueMutex);
+            m_activeFileId = 0;
+        }
         
         if (success) {
             m_processed++;
@@ -329,8 +460,15 @@ bool ContentIndexer::processFileInternal(int64_t fileId) {
             m_currentFile = fileInfo->fullPath;
         }
         
-        // Проверяем, можем ли извлечь текст
-        if (!m_extractors->canExtract(fileInfo->mimeType)) {
+        // Экстрактор выбирается по номеру типа; тип, появившийся после
+        // последней сверки, сначала связывается с реестром
+        bool byMimeId = fileInfo->mimeId > 0;
+        if (byMimeId && !isMimeClassified(fileInfo->mimeId)) {
+            classifyMimeTypes();
+        }
+        bool supported = byMimeId ? m_extractors->canExtract(fileInfo->mimeId)
+                                  : m_extractors->canExtract(fileInfo->mimeType);
+        if (!supported) {
             spdlog::debug("ContentIndexer: no extractor for MIME type '{}' (file {})", 
                          fileInfo->mimeType, fileId);
             // Сохраняем пустую запись чтобы не пытаться снова
@@ -343,18 +481,65 @@ bool ContentIndexer::processFileInternal(int64_t fileId) {
             return false;
         }
         
+        // Checksum ещё не вычислен (новый или изменённый файл) — считаем сами:
+        // чтение файла для SHA-256 дешевле любого извлечения, а результат
+        // нужен и кэшу, и поиску дубликатов
+        if (fileInfo->checksum.empty()) {
+            try {
+                fileInfo->checksum = DuplicateFinder::computeChecksum(fileInfo->fullPath);
+                m_db->execute("UPDATE files SET checksum = ? WHERE id = ?",
+                              fileInfo->checksum, fileId);
+            } catch (const std::exception& e) {
+                spdlog::debug("ContentIndexer: no checksum for file {}: {}", fileId, e.what());
+            }
+        }
+        
+        // Те же байты уже извлекались (копия, переименование, текст от пира)
+        if (!fileInfo->checksum.empty()) {
+            if (auto cached = loadCachedContent(fileInfo->checksum)) {
+                saveContent(fileId, *cached);
+                // Текст пира теперь в FTS — следующие копии возьмут его оттуда
+                m_db->execute("DELETE FROM content_cache WHERE checksum = ?", fileInfo->checksum);
+                spdlog::debug("ContentIndexer: reused {} cached chars for file {}",
+                             cached->text.length(), fileId);
+                {
+                    std::lock_guard<std::mutex> lock(m_statusMutex);
+                    m_currentFile.clear();
+                }
+                return !cached->isEmpty();
+            }
+        }
+        
         // Извлекаем текст
-        auto result = m_extractors->extract(fileInfo->fullPath, fileInfo->mimeType);
+        auto result = byMimeId ? m_extractors->extract(fileInfo->fullPath, fileInfo->mimeId)
+                               : m_extractors->extract(fileInfo->fullPath, fileInfo->mimeType);
         
         if (!result || result->isEmpty()) {
             spdlog::debug("ContentIndexer: no text extracted from file {}", fileId);
             // Всё равно сохраняем пустую запись чтобы не обрабатывать повторно
-            saveContent(fileId, ExtractionResult{
+            ExtractionResult empty{
                 .text = "",
                 .method = "empty",
                 .language = "",
                 .confidence = 0.0
-            });
+            };
+            // Копии того же файла найдут эту запись и не будут извлекаться заново
+            saveContent(fileId, empty);
+            return false;
+        }
+        
+        // Часть страниц не извлеклась: найденное доступно поиску, но файл
+        // считается ошибкой, а метод с суффиксом _partial не даёт копиям и
+        // пирам взять неполный текст — они извлекут его заново
+        if (result->isPartial()) {
+            spdlog::warn("ContentIndexer: partial extraction of file {}: {} pages failed",
+                        fileId, result->failedPages);
+            result->method += "_partial";
+            saveContent(fileId, *result);
+            {
+                std::lock_guard<std::mutex> lock(m_statusMutex);
+                m_currentFile.clear();
+            }
             return false;
         }
         
@@ -400,7 +585,8 @@ bool ContentIndexer::processFileInternal(int64_t fileId) {
 
 std::optional<ContentIndexer::FileInfo> ContentIndexer::getFileInfo(int64_t fileId) const {
     return m_db->queryOne<FileInfo>(R"SQL(
-        SELECT f.id, wf.path || '/' || f.relative_path as full_path, f.mime_type, f.size
+        SELECT f.id, wf.path || '/' || f.relative_path as full_path, f.mime_type, f.size,
+               f.checksum, COALESCE(f.mime_id, 0)
         FROM files f
         JOIN watched_folders wf ON f.folder_id = wf.id
         WHERE f.id = ?
@@ -411,6 +597,8 @@ std::optional<ContentIndexer::FileInfo> ContentIndexer::getFileInfo(int64_t file
         info.fullPath = Database::getString(stmt, 1);
         info.mimeType = Database::getString(stmt, 2);
         info.size = Database::getInt64(stmt, 3);
+        info.checksum = Database::getString(stmt, 4);
+        info.mimeId = Database::getInt64(stmt, 5);
         return info;
     },
     fileId);
@@ -424,6 +612,23 @@ void ContentIndexer::saveContent(int64_t fileId, const ExtractionResult& result)
         truncatedText = truncatedText.substr(0, maxTextSize);
     }
     
+    // FTS5 хранит документ целиком, поэтому и сравнивается документ целиком:
+    // тот же текст, что при прошлом сохранении, — запись FTS не переписываем
+    // (удаление и вставка документа в FTS5 дороже всего остального сохранения)
+    const int64_t hash = textHash(truncatedText);
+    bool unchanged = false;
+    if (!truncatedText.empty()) {
+        auto stored = m_db->queryOne<int64_t>(R"SQL(
+            SELECT fc.text_hash
+            FROM file_content fc
+            JOIN files_fts fts ON fts.rowid = fc.file_id
+            WHERE fc.file_id = ? AND fc.text_hash IS NOT NULL
+        )SQL",
+        [](sqlite3_stmt* stmt) { return Database::getInt64(stmt, 0); },
+        fileId);
+        unchanged = stored && *stored == hash;
+    }
+    
     // Сохраняем метаданные в file_content (текст идёт только в FTS)
     // Используем INSERT OR IGNORE + UPDATE вместо INSERT OR REPLACE (coding guidelines)
     m_db->execute(R"SQL(
@@ -434,15 +639,122 @@ void ContentIndexer::saveContent(int64_t fileId, const ExtractionResult& result)
     
     m_db->execute(R"SQL(
         UPDATE file_content 
-        SET extraction_method = ?, language = ?, extracted_at = strftime('%s', 'now')
+        SET extraction_method = ?, language = ?, extracted_at = strftime('%s', 'now'),
+            text_hash = ?, max_bytes = ?
         WHERE file_id = ?
     )SQL",
-    result.method, result.language, fileId);
+    result.method, result.language, hash, static_cast<int64_t>(maxTextSize), fileId);
+    
+    // Файл обработан (в том числе неудачно) — до следующего изменения в выборку не попадёт
+    m_db->execute("UPDATE files SET extraction_pending = 0 WHERE id = ? AND extraction_pending = 1",
+                  fileId);
+    
+    if (unchanged) {
+        spdlog::debug("ContentIndexer: text of file {} unchanged, FTS kept", fileId);
+        return;
+    }
     
     // Обновляем FTS вручную (без триггеров)
     updateFts(fileId, truncatedText);
 }
 
+std::optional<ExtractionResult> ContentIndexer::loadCachedContent(const std::string& checksum) const {
+    auto mapRow = [](sqlite3_stmt* stmt) {
+        ExtractionResult result;
+        result.text = Database::getString(stmt, 0);
+        result.method = Database::getString(stmt, 1);
+        result.language = Database::getString(stmt, 2);
+        return result;
+    };
+    
+    // Локальная копия: её текст уже лежит в files_fts, второй копии не храним
+    const int64_t maxTextSize = static_cast<int64_t>(m_maxTextSizeKB.load()) * 1024;
+    if (auto copy = m_db->queryOne<ExtractionResult>(queries::EXTRACTED_COPY_SQL, mapRow,
+                                                     checksum, maxTextSize)) {
+        return copy;
+    }
+    
+    // Текст, полученный от пира для этого checksum
+    return m_db->queryOne<ExtractionResult>(
+        "SELECT content, 'sync', '' FROM content_cache WHERE checksum = ?", mapRow, checksum);
+}
+
+void ContentIndexer::pruneContentCache() {
+    try {
+        m_db->execute(R"SQL(
+            DELETE FROM content_cache
+            WHERE cached_at < strftime('%s', 'now') - ?
+              AND NOT EXISTS (SELECT 1 FROM files f WHERE f.checksum = content_cache.checksum)
+        )SQL", kOrphanCacheSeconds);
+        if (int removed = m_db->changesCount(); removed > 0) {
+            spdlog::info("ContentIndexer: pruned {} orphaned cache entries", removed);
+        }
+    } catch (const std::exception& e) {
+        spdlog::warn("ContentIndexer: cache prune failed: {}", e.what());
+    }
+}
+
+void ContentIndexer::classifyMimeTypes() {
+#if ENABLE_TEXT_EXTRACTION
+    // Справочник мал и почти не растёт: после первой сверки читаются только новые строки.
+    // Первая сверка связывает с реестром все номера, дальше — только новые
+    struct MimeRow {
+        int64_t id;
+        std::string mimeType;
+        bool extractable;
+    };
+    std::lock_guard<std::mutex> lock(m_mimeMutex);
+    auto rows = m_db->query<MimeRow>(
+        "SELECT id, mime_type, extractable FROM mime_types WHERE id > ? ORDER BY id",
+        [](sqlite3_stmt* stmt) {
+            return MimeRow{
+                Database::getInt64(stmt, 0),
+                Database::getString(stmt, 1),
+                Database::getInt(stmt, 2) != 0
+            };
+        },
+        m_classifiedMimeId.load());
+    if (rows.empty()) return;
+    
+    std::vector<std::pair<int64_t, std::string>> types;
+    types.reserve(rows.size());
+    for (const auto& row : rows) {
+        types.emplace_back(row.id, row.mimeType);
+    }
+    auto supportedTypes = m_extractors->bindMimeIds(types);
+    
+    for (size_t i = 0; i < rows.size(); ++i) {
+        const auto& row = rows[i];
+        bool supported = supportedTypes[i];
+        if (supported != row.extractable) {
+            m_db->execute("UPDATE mime_types SET extractable = ? WHERE id = ?",
+                          supported ? 1 : 0, row.id);
+            if (supported) {
+                m_db->execute(R"SQL(
+                    UPDATE files SET extraction_pending = 1
+                    WHERE mime_id = ?
+                      AND NOT EXISTS (
+                          SELECT 1 FROM file_content fc
+                          WHERE fc.file_id = files.id AND fc.extracted_at >= files.modified_at
+                      )
+                )SQL", row.id);
+            } else {
+                m_db->execute(
+                    "UPDATE files SET extraction_pending = 0 WHERE mime_id = ? AND extraction_pending = 1",
+                    row.id);
+            }
+            spdlog::info("ContentIndexer: MIME type '{}' is {} extractable ({} files)",
+                        row.mimeType, supported ? "now" : "no longer", m_db->changesCount());
+        }
+    }
+    m_classifiedMimeId.store(rows.back().id);
+#endif // ENABLE_TEXT_EXTRACTION
+}
+
+bool ContentIndexer::isMimeClassified(int64_t mimeId) const {
+    return mimeId <= m_classifiedMimeId.load();
+}
+
 void ContentIndexer::updateFts(int64_t fileId, const std::string& content) {
     try {
         // Простой UPDATE для обычной (не contentless) FTS5 таблицы
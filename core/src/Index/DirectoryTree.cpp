@@ -0,0 +1,214 @@
+#include "familyvault/DirectoryTree.h"
+#include <spdlog/spdlog.h>
+
+namespace FamilyVault {
+
+DirectoryTree::DirectoryTree(std::shared_ptr<Database> db)
+    : m_db(std::move(db)) {
+}
+
+DirectoryTree::~DirectoryTree() = default;
+
+// ═══════════════════════════════════════════════════════════
+// Путь → ID
+// ═══════════════════════════════════════════════════════════
+
+int64_t DirectoryTree::resolve(int64_t folderId, std::string_view directoryPath) {
+    if (directoryPath.empty()) return 0;
+
+    std::lock_guard lock(m_mutex);
+    if (auto it = m_ids.find(cacheKey(folderId, directoryPath)); it != m_ids.end()) {
+        return it->second;
+    }
+
+    // Идём от корня: известные префиксы берём из кэша, недостающие создаём
+    int64_t parentId = 0;
+    size_t start = 0;
+    while (start <= directoryPath.size()) {
+        size_t end = directoryPath.find('/', start);
+        if (end == std::string_view::npos) end = directoryPath.size();
+
+        std::string_view prefix = directoryPath.substr(0, end);
+        auto it = m_ids.find(cacheKey(folderId, prefix));
+        if (it != m_ids.end()) {
+            parentId = it->second;
+        } else {
+            // DO UPDATE вместо DO NOTHING — чтобы RETURNING вернул ID существующей строки
+            auto id = m_db->queryOne<int64_t>(
+                R"SQL(
+                INSERT INTO directories (folder_id, parent_id, name) VALUES (?, ?, ?)
+                ON CONFLICT(folder_id, parent_id, name) DO UPDATE SET name = excluded.name
+                RETURNING id
+                )SQL",
+                [](sqlite3_stmt* stmt) { return Database::getInt64(stmt, 0); },
+                folderId, parentId, std::string(directoryPath.substr(start, end - start))
+            );
+            if (!id) {
+                throw DatabaseException("Failed to create directory: " + std::string(prefix));
+            }
+            parentId = *id;
+            rememberLocked(folderId, parentId, std::string(prefix));
+        }
+        start = end + 1;
+    }
+    return parentId;
+}
+
+std::optional<int64_t> DirectoryTree::find(int64_t folderId, std::string_view directoryPath) const {
+    if (directoryPath.empty()) return 0;
+
+    std::lock_guard lock(m_mutex);
+    if (auto it = m_ids.find(cacheKey(folderId, directoryPath)); it != m_ids.end()) {
+        return it->second;
+    }
+
+    int64_t parentId = 0;
+    size_t start = 0;
+    while (start <= directoryPath.size()) {
+        size_t end = directoryPath.find('/', start);
+        if (end == std::string_view::npos) end = directoryPath.size();
+
+        auto id = m_db->queryOne<int64_t>(
+            "SELECT id FROM directories WHERE folder_id = ? AND parent_id = ? AND name = ?",
+            [](sqlite3_stmt* stmt) { return Database::getInt64(stmt, 0); },
+            folderId, parentId, std::string(directoryPath.substr(start, end - start))
+        );
+        if (!id) return std::nullopt;
+
+        parentId = *id;
+        rememberLocked(folderId, parentId, std::string(directoryPath.substr(0, end)));
+        start = end + 1;
+    }
+    return parentId;
+}
+
+// ═══════════════════════════════════════════════════════════
+// ID → путь
+// ═══════════════════════════════════════════════════════════
+
+std::string DirectoryTree::path(int64_t directoryId) const {
+    if (directoryId == 0) return {};
+
+    std::lock_guard lock(m_mutex);
+    if (auto it = m_paths.find(directoryId); it != m_paths.end()) {
+        return it->second.second;
+    }
+    return loadPathLocked(directoryId);
+}
+
+std::string DirectoryTree::loadPathLocked(int64_t directoryId) const {
+    struct Node {
+        int64_t folderId;
+        int64_t parentId;
+        std::string name;
+    };
+    auto node = m_db->queryOne<Node>(
+        "SELECT folder_id, parent_id, name FROM directories WHERE id = ?",
+        [](sqlite3_stmt* stmt) {
+            return Node{Database::getInt64(stmt, 0), Database::getInt64(stmt, 1),
+                        Database::getString(stmt, 2)};
+        },
+        directoryId
+    );
+    if (!node) return {};
+
+    // Родитель почти всегда уже в кэше — соседние каталоги делят префикс
+    std::string result;
+    if (node->parentId != 0) {
+        auto it = m_paths.find(node->parentId);
+        result = it != m_paths.end() ? it->second.second : loadPathLocked(node->parentId);
+        result += '/';
+    }
+    result += node->name;
+
+    rememberLocked(node->folderId, directoryId, result);
+    return result;
+}
+
+std::vector<DirectoryEntry> DirectoryTree::children(int64_t folderId, int64_t parentId) const {
+    auto entries = m_db->query<DirectoryEntry>(
+        "SELECT id, name FROM directories WHERE folder_id = ? AND parent_id = ? ORDER BY name",
+        [folderId, parentId](sqlite3_stmt* stmt) {
+            DirectoryEntry entry;
+            entry.id = Database::getInt64(stmt, 0);
+            entry.folderId = folderId;
+            entry.parentId = parentId;
+            entry.name = Database::getString(stmt, 1);
+            return entry;
+        },
+        folderId, parentId
+    );
+
+    std::string base = path(parentId);
+    std::lock_guard lock(m_mutex);
+    for (auto& entry : entries) {
+        entry.path = base.empty() ? entry.name : base + "/" + entry.name;
+        rememberLocked(folderId, entry.id, entry.path);
+    }
+    return entries;
+}
+
+// ═══════════════════════════════════════════════════════════
+// Обслуживание
+// ═══════════════════════════════════════════════════════════
+
+int DirectoryTree::prune(int64_t folderId) {
+    // Удаление листьев открывает следующий уровень — повторяем до неподвижной точки
+    int total = 0;
+    while (true) {
+        m_db->execute(
+            R"SQL(
+            DELETE FROM directories
+            WHERE folder_id = ?1
+              AND NOT EXISTS (SELECT 1 FROM files f
+                              WHERE f.folder_id = ?1 AND f.directory_id = directories.id)
+              AND NOT EXISTS (SELECT 1 FROM directories c
+                              WHERE c.folder_id = ?1 AND c.parent_id = directories.id)
+            )SQL",
+            folderId
+        );
+        int deleted = m_db->changesCount();
+        if (deleted == 0) break;
+        total += deleted;
+    }
+
+    if (total > 0) {
+        forgetFolder(folderId);
+        spdlog::debug("Pruned {} empty directories in folder {}", total, folderId);
+    }
+    return total;
+}
+
+void DirectoryTree::forgetFolder(int64_t folderId) {
+    std::lock_guard lock(m_mutex);
+    std::string prefix = std::to_string(folderId) + "/";
+    std::erase_if(m_ids, [&prefix](const auto& item) {
+        return item.first.compare(0, prefix.size(), prefix) == 0;
+    });
+    std::erase_if(m_paths, [folderId](const auto& item) {
+        return item.second.first == folderId;
+    });
+}
+
+// ═══════════════════════════════════════════════════════════
+// Helpers
+// ═══════════════════════════════════════════════════════════
+
+std::string_view DirectoryTree::parentOf(std::string_view relativePath) {
+    size_t slash = relativePath.rfind('/');
+    return slash == std::string_view::npos ? std::string_view{} : relativePath.substr(0, slash);
+}
+
+std::string DirectoryTree::cacheKey(int64_t folderId, std::string_view path) {
+    std::string key = std::to_string(folderId);
+    key += '/';
+    key += path;
+    return key;
+}
+
+void DirectoryTree::rememberLocked(int64_t folderId, int64_t directoryId, std::string path) const {
+    m_ids[cacheKey(folderId, path)] = directoryId;
+    m_paths[directoryId] = {folderId, std::move(path)};
+}
+
+} // namespace FamilyVault
@@ -3,6 +3,10 @@
 #include <spdlog/spdlog.h>
 #include <filesystem>
 #include <algorithm>
+#include <array>
+#include <fstream>
+#include <future>
+#include <system_error>
 #ifdef _WIN32
 #include <windows.h>
 #endif
@@ -52,6 +56,34 @@ static fs::path utf8ToPath(const std::string& s) {
 #endif
 }
 
+// Файлы с неизвестным расширением копятся пачкой: их заголовки читаются
+// в отдельном потоке, пока обход продолжается (открытие файла на сетевом
+// диске медленнее обхода каталога на порядки)
+static constexpr size_t SNIFF_BATCH_SIZE = 64;
+
+struct SniffBatch {
+    std::vector<ScannedFile> files;
+    std::vector<fs::path> paths;
+};
+
+// MIME тип по первым байтам каждого файла пачки
+static std::vector<ScannedFile> sniffBatch(SniffBatch& batch) {
+    for (size_t i = 0; i < batch.files.size(); ++i) {
+        auto& file = batch.files[i];
+        try {
+            std::array<uint8_t, 16> header{};
+            std::ifstream stream(batch.paths[i], std::ios::binary);
+            stream.read(reinterpret_cast<char*>(header.data()), header.size());
+            file.mimeType = MimeTypeDetector::detectByHeader(header.data(),
+                                                             static_cast<size_t>(stream.gcount()));
+        } catch (...) {
+            file.mimeType = "application/octet-stream";
+        }
+        file.contentType = MimeTypeDetector::mimeToContentType(file.mimeType);
+    }
+    return std::move(batch.files);
+}
+
 // Системные директории для пропуска
 static const std::vector<std::string> SYSTEM_DIRS = {
     "$RECYCLE.BIN",
@@ -307,6 +339,41 @@ void FileScanner::scan(const std::string& rootPath,
     progress.isCountingPhase = false;
     fs::path root = utf8ToPath(rootPath);
 
+    auto deliver = [&](const ScannedFile& file) {
+        if (onFile) {
+            onFile(file);
+        }
+        progress.processedFiles++;
+        progress.totalSize += file.size;
+    };
+
+    // Не больше одной пачки в работе: следующая запускается после выдачи предыдущей
+    SniffBatch pending;
+    std::future<std::vector<ScannedFile>> sniffing;
+    auto collectSniffed = [&] {
+        if (!sniffing.valid()) return;
+        for (const auto& file : sniffing.get()) {
+            try {
+                deliver(file);
+            } catch (const std::exception& e) {
+                spdlog::debug("scan: callback failed for {}: {}", file.relativePath, e.what());
+            }
+        }
+    };
+    auto startSniffing = [&] {
+        collectSniffed();
+        auto batch = std::make_shared<SniffBatch>(std::move(pending));
+        pending = SniffBatch();
+        try {
+            sniffing = std::async(std::launch::async, [batch] { return sniffBatch(*batch); });
+        } catch (const std::system_error&) {
+            // Поток не создан — определяем тип здесь же
+            std::promise<std::vector<ScannedFile>> done;
+            done.set_value(sniffBatch(*batch));
+            sniffing = done.get_future();
+        }
+    };
+
     try {
         fs::recursive_directory_iterator it(root, fs::directory_options::skip_permission_denied);
         fs::recursive_directory_iterator end;
@@ -394,21 +461,18 @@ void FileScanner::scan(const std::string& rootPath,
                             file.createdAt = 0;
                         }
 
-                        // MIME тип
-                        try {
-                            file.mimeType = MimeTypeDetector::detect(pathToUtf8(entry.path()), ext);
-                        } catch (...) {
-                            file.mimeType = "application/octet-stream";
-                        }
-                        file.contentType = MimeTypeDetector::mimeToContentType(file.mimeType);
-
-                        // Callback
-                        if (onFile) {
-                            onFile(file);
+                        // MIME тип: по расширению сразу, иначе — по содержимому в пачке
+                        file.mimeType = MimeTypeDetector::detectByExtension(ext);
+                        if (file.mimeType == "application/octet-stream") {
+                            pending.files.push_back(std::move(file));
+                            pending.paths.push_back(entry.path());
+                            if (pending.files.size() >= SNIFF_BATCH_SIZE) {
+                                startSniffing();
+                            }
+                        } else {
+                            file.contentType = MimeTypeDetector::mimeToContentType(file.mimeType);
+                            deliver(file);
                         }
-
-                        progress.processedFiles++;
-                        progress.totalSize += file.size;
                     }
                 }
 
@@ -439,6 +503,16 @@ void FileScanner::scan(const std::string& rootPath,
         spdlog::error("Unknown error scanning {}", rootPath);
     }
 
+    // Остаток пачки; после отмены файлы без прочитанного заголовка не выдаются
+    try {
+        if (!pending.files.empty() && !cancelToken.isCancelled() && !m_cancelRequested) {
+            startSniffing();
+        }
+        collectSniffed();
+    } catch (const std::exception& e) {
+        spdlog::error("Error detecting MIME types in {}: {}", rootPath, e.what());
+    }
+
     // Финальный progress
     if (onProgress) {
         progress.currentFile = "";
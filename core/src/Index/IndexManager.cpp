@@ -1,22 +1,59 @@
 #include "familyvault/IndexManager.h"
 #include "familyvault/MimeTypeDetector.h"
+#include "familyvault/HotQueries.h"
 #include <spdlog/spdlog.h>
 #include <filesystem>
 #include <chrono>
+#include <tuple>
 
 namespace fs = std::filesystem;
 
 namespace FamilyVault {
 
+namespace {
+
+using FoldersByName = sql::Select<schema::Folder, "FROM watched_folders ORDER BY name">;
+using FolderById = sql::Select<schema::Folder, "FROM watched_folders WHERE id = ?">;
+
+using FileById = sql::Select<schema::LocalFile,
+    "FROM files f JOIN watched_folders wf ON f.folder_id = wf.id WHERE f.id = ?">;
+using FileByPath = sql::Select<schema::LocalFile,
+    "FROM files f JOIN watched_folders wf ON f.folder_id = wf.id "
+    "WHERE f.folder_id = ? AND f.relative_path = ?">;
+
+} // namespace
+
 IndexManager::IndexManager(std::shared_ptr<Database> db)
     : m_db(std::move(db))
-    , m_scanner(std::make_unique<FileScanner>()) {
+    , m_scanner(std::make_unique<FileScanner>())
+    , m_directories(std::make_unique<DirectoryTree>(m_db))
+    , m_mimeTypes(std::make_unique<MimeTypeTable>(m_db)) {
 }
 
 IndexManager::~IndexManager() {
     stopScan();
 }
 
+void IndexManager::setFacetIndex(std::shared_ptr<FacetIndex> facets) {
+    m_facets = std::move(facets);
+}
+
+void IndexManager::setSuggestIndex(std::shared_ptr<SuggestIndex> suggest) {
+    m_suggest = std::move(suggest);
+}
+
+void IndexManager::setMaintenanceScheduler(std::shared_ptr<MaintenanceScheduler> maintenance) {
+    m_maintenance = std::move(maintenance);
+}
+
+void IndexManager::setCheckpointManager(std::shared_ptr<CheckpointManager> checkpoints) {
+    m_checkpoints = std::move(checkpoints);
+}
+
+void IndexManager::setIngestSignal(std::shared_ptr<IngestSignal> ingest) {
+    m_ingest = std::move(ingest);
+}
+
 // ═══════════════════════════════════════════════════════════
 // Управление папками
 // ═══════════════════════════════════════════════════════════
@@ -69,39 +106,69 @@ int64_t IndexManager::addFolder(const std::string& path, const std::string& name
 }
 
 void IndexManager::removeFolder(int64_t folderId) {
+    // Имена нужны индексу автодополнения, чтобы уменьшить счётчики терминов
+    std::vector<std::pair<int64_t, std::string>> removedFiles;
+    if (m_suggest) {
+        removedFiles = m_db->query<std::pair<int64_t, std::string>>(
+            "SELECT id, name FROM files WHERE folder_id = ?",
+            [](sqlite3_stmt* stmt) {
+                return std::make_pair(Database::getInt64(stmt, 0), Database::getString(stmt, 1));
+            },
+            folderId
+        );
+    }
+
     // CASCADE удалит все файлы и file_content
     // Триггер files_fts_delete удалит записи из FTS
     m_db->execute("DELETE FROM watched_folders WHERE id = ?", folderId);
     spdlog::info("Removed folder id={}", folderId);
-    
-    // VACUUM чтобы освободить место на диске
-    try {
-        m_db->execute("VACUUM");
-        spdlog::info("Database vacuumed after folder removal");
-    } catch (const std::exception& e) {
-        spdlog::warn("VACUUM failed: {}", e.what());
+
+    m_directories->forgetFolder(folderId);
+
+    if (m_facets) {
+        m_facets->removeFolder(folderId);
+    }
+    for (const auto& [fileId, name] : removedFiles) {
+        m_suggest->removeFile(SuggestSource::Local, fileId, name);
+    }
+
+    // Освободившиеся страницы вернёт incremental_vacuum в фоне — без полного VACUUM,
+    // блокирующего соединение и удваивающего место на диске
+    if (m_maintenance) {
+        m_maintenance->requestPass();
     }
 }
 
-void IndexManager::optimizeDatabase() {
+void IndexManager::optimizeDatabase(MaintenanceScheduler::ProgressCallback onProgress) {
     spdlog::info("Starting database optimization...");
-    
-    // Rebuild FTS index
+
+    // Пересчёт file_stats (страховка от расхождения счётчиков с files)
     try {
-        m_db->execute("INSERT INTO files_fts(files_fts) VALUES('rebuild')");
-        spdlog::info("FTS index rebuilt");
+        Database::Transaction tx(*m_db);
+        m_db->execute("DELETE FROM file_stats");
+        m_db->execute(R"SQL(
+            INSERT INTO file_stats (folder_id, content_type, file_count, total_size)
+            SELECT folder_id, COALESCE(content_type, 0), COUNT(*), COALESCE(SUM(size), 0)
+            FROM files
+            GROUP BY folder_id, COALESCE(content_type, 0)
+        )SQL");
+        tx.commit();
+        spdlog::info("File stats recomputed");
     } catch (const std::exception& e) {
-        spdlog::warn("FTS rebuild failed: {}", e.what());
+        spdlog::warn("File stats recompute failed: {}", e.what());
     }
-    
-    // VACUUM
-    try {
-        m_db->execute("VACUUM");
-        spdlog::info("Database vacuumed");
-    } catch (const std::exception& e) {
-        spdlog::warn("VACUUM failed: {}", e.what());
+
+    // Полного VACUUM нет и для БД, созданных до миграции 6: он переписывает файл
+    // целиком и удваивает место на диске. Такие БД обходятся FTS merge и optimize,
+    // incremental_vacuum для них пропускается
+
+    // FTS merge вместо rebuild: сегменты сливаются порциями, соединение свободно между ними
+    if (m_maintenance) {
+        m_maintenance->runPass(onProgress);
+    } else {
+        MaintenanceScheduler(m_db).runPass(onProgress);
     }
-    
+
     spdlog::info("Database optimization completed");
 }
 
@@ -156,20 +223,11 @@ void IndexManager::setFolderVisibility(int64_t folderId, Visibility visibility)
 }
 
 std::vector<WatchedFolder> IndexManager::getFolders() const {
-    return m_db->query<WatchedFolder>(
-        "SELECT id, path, name, enabled, last_scan_at, file_count, total_size, created_at, visibility "
-        "FROM watched_folders ORDER BY name",
-        mapWatchedFolder
-    );
+    return m_db->select<FoldersByName>();
 }
 
 std::optional<WatchedFolder> IndexManager::getFolder(int64_t folderId) const {
-    return m_db->queryOne<WatchedFolder>(
-        "SELECT id, path, name, enabled, last_scan_at, file_count, total_size, created_at, visibility "
-        "FROM watched_folders WHERE id = ?",
-        mapWatchedFolder,
-        folderId
-    );
+    return m_db->selectOne<FolderById>(folderId);
 }
 
 // ═══════════════════════════════════════════════════════════
@@ -196,10 +254,15 @@ void IndexManager::scanFolder(int64_t folderId, ScanProgressCallback onProgress)
 
     m_cancelToken.reset();
 
+    // Пока идёт сканирование, WAL переносится фоновым потоком, а не писателем
+    CheckpointManager::BulkWrite bulkWrite;
+    if (m_checkpoints) bulkWrite = m_checkpoints->beginBulkWrite();
+
     // Сканируем файлы
     m_scanner->scan(
         folder->path,
         [this, folderId](const ScannedFile& file) {
+            if (m_maintenance) m_maintenance->noteActivity();
             upsertFile(folderId, file);
         },
         onProgress,
@@ -210,12 +273,18 @@ void IndexManager::scanFolder(int64_t folderId, ScanProgressCallback onProgress)
     // Удаляем файлы, которых больше нет
     if (!m_cancelToken.isCancelled()) {
         deleteRemovedFiles(folderId, scanStartTime);
+        m_directories->prune(folderId);
         updateFolderStats(folderId);
 
         // Обновляем время последнего сканирования
         m_db->execute("UPDATE watched_folders SET last_scan_at = ? WHERE id = ?",
                       scanStartTime, folderId);
     }
+
+    // Новые и изменённые файлы (даже прерванного сканирования) ждут извлечения текста
+    if (m_ingest) {
+        m_ingest->notify();
+    }
 }
 
 void IndexManager::scanAllFolders(ScanProgressCallback onProgress) {
@@ -244,34 +313,71 @@ bool IndexManager::isScanning() const {
 // ═══════════════════════════════════════════════════════════
 
 int64_t IndexManager::upsertFile(int64_t folderId, const ScannedFile& file) {
-    m_db->execute(
+    // Соседние файлы сканирования делят каталог — ID почти всегда из кэша
+    int64_t directoryId = m_directories->resolve(folderId, DirectoryTree::parentOf(file.relativePath));
+    int64_t mimeId = m_mimeTypes->intern(file.mimeType);
+
+    // RETURNING id: lastInsertId() не обновляется при ON CONFLICT DO UPDATE
+    auto fileId = m_db->queryOne<int64_t>(
         R"SQL(
-        INSERT INTO files (folder_id, relative_path, name, extension, size, mime_type, 
-                          content_type, created_at, modified_at, indexed_at)
-        VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, strftime('%s', 'now'))
+        INSERT INTO files (folder_id, directory_id, relative_path, name, extension, size, mime_type, 
+                          mime_id, content_type, created_at, modified_at, indexed_at)
+        VALUES (?, ?, ?, ?, ?, ?, ?, NULLIF(?, 0), ?, ?, ?, strftime('%s', 'now'))
         ON CONFLICT(folder_id, relative_path) DO UPDATE SET
+            -- Изменённый файл теряет checksum: по нему ищутся дубликаты и кэш текста
+            checksum = CASE WHEN files.size = excluded.size AND files.modified_at = excluded.modified_at
+                            THEN files.checksum END,
+            directory_id = excluded.directory_id,
             name = excluded.name,
             size = excluded.size,
             mime_type = excluded.mime_type,
+            mime_id = excluded.mime_id,
             content_type = excluded.content_type,
             modified_at = excluded.modified_at,
             indexed_at = strftime('%s', 'now')
+        RETURNING id
         )SQL",
+        [](sqlite3_stmt* stmt) { return Database::getInt64(stmt, 0); },
         folderId,
+        directoryId,
         file.relativePath,
         file.name,
         file.extension,
         file.size,
         file.mimeType,
+        mimeId,
         static_cast<int>(file.contentType),
         file.createdAt,
         file.modifiedAt
     );
 
-    return m_db->lastInsertId();
+    if (!fileId) {
+        return 0;
+    }
+
+    if (m_facets) {
+        m_facets->upsertFile(*fileId, folderId, file.contentType, file.extension, file.modifiedAt);
+    }
+    if (m_suggest) {
+        m_suggest->addFile(SuggestSource::Local, *fileId, file.name, file.modifiedAt);
+    }
+
+    return *fileId;
 }
 
 void IndexManager::deleteRemovedFiles(int64_t folderId, int64_t scanStartTime) {
+    // ID и имена собираем до удаления, чтобы обновить in-memory индексы
+    std::vector<std::pair<int64_t, std::string>> removedFiles;
+    if (m_facets || m_suggest) {
+        removedFiles = m_db->query<std::pair<int64_t, std::string>>(
+            "SELECT id, name FROM files WHERE folder_id = ? AND indexed_at < ?",
+            [](sqlite3_stmt* stmt) {
+                return std::make_pair(Database::getInt64(stmt, 0), Database::getString(stmt, 1));
+            },
+            folderId, scanStartTime
+        );
+    }
+
     // Файлы, которые не были обновлены в этом сканировании — удалены с диска
     m_db->execute(
         "DELETE FROM files WHERE folder_id = ? AND indexed_at < ?",
@@ -282,14 +388,28 @@ void IndexManager::deleteRemovedFiles(int64_t folderId, int64_t scanStartTime) {
     if (deleted > 0) {
         spdlog::info("Removed {} files that no longer exist", deleted);
     }
+
+    if (m_facets) {
+        RoaringBitmap removedIds;
+        for (const auto& [fileId, name] : removedFiles) {
+            if (RoaringBitmap::fits(fileId)) removedIds.add(static_cast<uint32_t>(fileId));
+        }
+        m_facets->removeFiles(removedIds);
+    }
+    if (m_suggest) {
+        for (const auto& [fileId, name] : removedFiles) {
+            m_suggest->removeFile(SuggestSource::Local, fileId, name);
+        }
+    }
 }
 
 void IndexManager::updateFolderStats(int64_t folderId) {
+    // file_stats поддерживается триггерами — суммируем несколько строк вместо скана files
     m_db->execute(
         R"SQL(
         UPDATE watched_folders SET
-            file_count = (SELECT COUNT(*) FROM files WHERE folder_id = ?),
-            total_size = (SELECT COALESCE(SUM(size), 0) FROM files WHERE folder_id = ?)
+            file_count = (SELECT COALESCE(SUM(file_count), 0) FROM file_stats WHERE folder_id = ?),
+            total_size = (SELECT COALESCE(SUM(total_size), 0) FROM file_stats WHERE folder_id = ?)
         WHERE id = ?
         )SQL",
         folderId, folderId, folderId
@@ -297,102 +417,77 @@ void IndexManager::updateFolderStats(int64_t folderId) {
 }
 
 std::optional<FileRecord> IndexManager::getFile(int64_t fileId) const {
-    return m_db->queryOne<FileRecord>(
-        R"SQL(
-        SELECT f.id, f.folder_id, f.relative_path, f.name, f.extension, f.size,
-               f.mime_type, f.content_type, f.checksum, f.created_at, f.modified_at,
-               f.indexed_at, COALESCE(f.visibility, wf.visibility) as visibility,
-               f.source_device_id, f.is_remote, f.sync_version, f.last_modified_by
-        FROM files f
-        JOIN watched_folders wf ON f.folder_id = wf.id
-        WHERE f.id = ?
-        )SQL",
-        mapFileRecord,
-        fileId
-    );
+    return m_db->selectOne<FileById>(fileId);
 }
 
 std::optional<FileRecord> IndexManager::getFileByPath(int64_t folderId,
                                                        const std::string& relativePath) const {
-    return m_db->queryOne<FileRecord>(
-        R"SQL(
-        SELECT f.id, f.folder_id, f.relative_path, f.name, f.extension, f.size,
-               f.mime_type, f.content_type, f.checksum, f.created_at, f.modified_at,
-               f.indexed_at, COALESCE(f.visibility, wf.visibility) as visibility,
-               f.source_device_id, f.is_remote, f.sync_version, f.last_modified_by
-        FROM files f
-        JOIN watched_folders wf ON f.folder_id = wf.id
-        WHERE f.folder_id = ? AND f.relative_path = ?
-        )SQL",
-        mapFileRecord,
-        folderId, relativePath
-    );
+    return m_db->selectOne<FileByPath>(folderId, relativePath);
 }
 
 std::vector<FileRecord> IndexManager::getRecentFiles(int limit) const {
-    return m_db->query<FileRecord>(
-        R"SQL(
-        SELECT f.id, f.folder_id, f.relative_path, f.name, f.extension, f.size,
-               f.mime_type, f.content_type, f.checksum, f.created_at, f.modified_at,
-               f.indexed_at, COALESCE(f.visibility, wf.visibility) as visibility,
-               f.source_device_id, f.is_remote, f.sync_version, f.last_modified_by
-        FROM files f
-        JOIN watched_folders wf ON f.folder_id = wf.id
-        ORDER BY f.indexed_at DESC
-        LIMIT ?
-        )SQL",
-        mapFileRecord,
-        limit
-    );
+    return m_db->select<queries::RecentFiles>(limit);
 }
 
 std::vector<FileRecord> IndexManager::getFilesByFolder(int64_t folderId, int limit, int offset) const {
-    return m_db->query<FileRecord>(
-        R"SQL(
-        SELECT f.id, f.folder_id, f.relative_path, f.name, f.extension, f.size,
-               f.mime_type, f.content_type, f.checksum, f.created_at, f.modified_at,
-               f.indexed_at, COALESCE(f.visibility, wf.visibility) as visibility,
-               f.source_device_id, f.is_remote, f.sync_version, f.last_modified_by
-        FROM files f
-        JOIN watched_folders wf ON f.folder_id = wf.id
-        WHERE f.folder_id = ?
-        ORDER BY f.name
-        LIMIT ? OFFSET ?
-        )SQL",
-        mapFileRecord,
-        folderId, limit, offset
-    );
+    return m_db->select<queries::FilesByFolder>(folderId, limit, offset);
 }
 
 std::vector<FileRecordCompact> IndexManager::getRecentFilesCompact(int limit) const {
-    return m_db->query<FileRecordCompact>(
-        R"SQL(
-        SELECT f.id, f.folder_id, f.relative_path, wf.path, f.name, f.extension, 
-               f.size, f.content_type, f.modified_at, f.is_remote
-        FROM files f
-        JOIN watched_folders wf ON f.folder_id = wf.id
-        ORDER BY f.indexed_at DESC
-        LIMIT ?
-        )SQL",
-        mapFileRecordCompact,
+    return getRecentFilesCompactBatch(limit).toRecords();
+}
+
+std::vector<FileRecordCompact> IndexManager::getFilesByFolderCompact(int64_t folderId, int limit, int offset) const {
+    return getFilesByFolderCompactBatch(folderId, limit, offset).toRecords();
+}
+
+FileRecordCompactBatch IndexManager::getRecentFilesCompactBatch(int limit) const {
+    FileRecordCompactBatch batch;
+    batch.rows = m_db->query<FileRecordCompactView>(
+        queries::RECENT_FILES_COMPACT_SQL,
+        [&batch](sqlite3_stmt* stmt) { return mapFileRecordCompactView(stmt, batch.arena); },
         limit
     );
+    return batch;
 }
 
-std::vector<FileRecordCompact> IndexManager::getFilesByFolderCompact(int64_t folderId, int limit, int offset) const {
-    return m_db->query<FileRecordCompact>(
-        R"SQL(
-        SELECT f.id, f.folder_id, f.relative_path, wf.path, f.name, f.extension, 
-               f.size, f.content_type, f.modified_at, f.is_remote
-        FROM files f
-        JOIN watched_folders wf ON f.folder_id = wf.id
-        WHERE f.folder_id = ?
-        ORDER BY f.name
-        LIMIT ? OFFSET ?
-        )SQL",
-        mapFileRecordCompact,
+FileRecordCompactBatch IndexManager::getFilesByFolderCompactBatch(int64_t folderId, int limit, int offset) const {
+    FileRecordCompactBatch batch;
+    batch.rows = m_db->query<FileRecordCompactView>(
+        queries::FILES_BY_FOLDER_COMPACT_SQL,
+        [&batch](sqlite3_stmt* stmt) { return mapFileRecordCompactView(stmt, batch.arena); },
         folderId, limit, offset
     );
+    return batch;
+}
+
+// ═══════════════════════════════════════════════════════════
+// Каталоги
+// ═══════════════════════════════════════════════════════════
+
+std::vector<DirectoryEntry> IndexManager::getSubdirectories(int64_t folderId, int64_t parentId) const {
+    return m_directories->children(folderId, parentId);
+}
+
+std::optional<int64_t> IndexManager::findDirectory(int64_t folderId,
+                                                   const std::string& directoryPath) const {
+    return m_directories->find(folderId, directoryPath);
+}
+
+std::vector<FileRecord> IndexManager::getFilesByDirectory(int64_t folderId, int64_t directoryId,
+                                                          int limit, int offset) const {
+    return m_db->select<queries::FilesByDirectory>(folderId, directoryId, limit, offset);
+}
+
+FileRecordCompactBatch IndexManager::getFilesByDirectoryCompactBatch(int64_t folderId, int64_t directoryId,
+                                                                     int limit, int offset) const {
+    FileRecordCompactBatch batch;
+    batch.rows = m_db->query<FileRecordCompactView>(
+        queries::FILES_BY_DIRECTORY_COMPACT_SQL,
+        [&batch](sqlite3_stmt* stmt) { return mapFileRecordCompactView(stmt, batch.arena); },
+        folderId, directoryId, limit, offset
+    );
+    return batch;
 }
 
 void IndexManager::setFileVisibility(int64_t fileId, std::optional<Visibility> visibility) {
@@ -406,9 +501,9 @@ void IndexManager::setFileVisibility(int64_t fileId, std::optional<Visibility> v
 
 void IndexManager::deleteFile(int64_t fileId, bool deleteFromDisk) {
     // Get file info before deleting from DB
-    auto result = m_db->queryOne<std::tuple<int64_t, std::string, std::string>>(
+    auto result = m_db->queryOne<std::tuple<int64_t, std::string, std::string, std::string>>(
         R"SQL(
-        SELECT f.folder_id, wf.path, f.relative_path
+        SELECT f.folder_id, wf.path, f.relative_path, f.name
         FROM files f
         JOIN watched_folders wf ON f.folder_id = wf.id
         WHERE f.id = ?
@@ -417,7 +512,8 @@ void IndexManager::deleteFile(int64_t fileId, bool deleteFromDisk) {
             return std::make_tuple(
                 Database::getInt64(stmt, 0),
                 Database::getString(stmt, 1),
-                Database::getString(stmt, 2)
+                Database::getString(stmt, 2),
+                Database::getString(stmt, 3)
             );
         },
         fileId
@@ -427,7 +523,7 @@ void IndexManager::deleteFile(int64_t fileId, bool deleteFromDisk) {
         throw std::runtime_error("File not found in database");
     }
 
-    auto [folderId, folderPath, relativePath] = *result;
+    auto [folderId, folderPath, relativePath, name] = *result;
 
     // Optionally delete from disk
     if (deleteFromDisk) {
@@ -442,6 +538,13 @@ void IndexManager::deleteFile(int64_t fileId, bool deleteFromDisk) {
     m_db->execute("DELETE FROM files WHERE id = ?", fileId);
     spdlog::info("Deleted file id={} from index", fileId);
 
+    if (m_facets) {
+        m_facets->removeFile(fileId);
+    }
+    if (m_suggest) {
+        m_suggest->removeFile(SuggestSource::Local, fileId, name);
+    }
+
     // Update folder stats
     updateFolderStats(folderId);
 }
@@ -454,31 +557,36 @@ IndexStats IndexManager::getStats() const {
     IndexStats stats;
 
     stats.totalFolders = m_db->queryScalar("SELECT COUNT(*) FROM watched_folders");
-    stats.totalFiles = m_db->queryScalar("SELECT COUNT(*) FROM files");
-    stats.totalSize = m_db->queryScalar("SELECT COALESCE(SUM(size), 0) FROM files");
-
-    stats.imageCount = m_db->queryScalar(
-        "SELECT COUNT(*) FROM files WHERE content_type = ?",
-        static_cast<int>(ContentType::Image));
-    stats.videoCount = m_db->queryScalar(
-        "SELECT COUNT(*) FROM files WHERE content_type = ?",
-        static_cast<int>(ContentType::Video));
-    stats.audioCount = m_db->queryScalar(
-        "SELECT COUNT(*) FROM files WHERE content_type = ?",
-        static_cast<int>(ContentType::Audio));
-    stats.documentCount = m_db->queryScalar(
-        "SELECT COUNT(*) FROM files WHERE content_type = ?",
-        static_cast<int>(ContentType::Document));
-    stats.archiveCount = m_db->queryScalar(
-        "SELECT COUNT(*) FROM files WHERE content_type = ?",
-        static_cast<int>(ContentType::Archive));
-    stats.otherCount = m_db->queryScalar(
-        "SELECT COUNT(*) FROM files WHERE content_type NOT IN (?, ?, ?, ?, ?)",
-        static_cast<int>(ContentType::Image),
-        static_cast<int>(ContentType::Video),
-        static_cast<int>(ContentType::Audio),
-        static_cast<int>(ContentType::Document),
-        static_cast<int>(ContentType::Archive));
+
+    // Одна выборка из file_stats (строк: папки × типы) вместо агрегатов по всей таблице files
+    auto perType = m_db->query<std::tuple<ContentType, int64_t, int64_t>>(
+        R"SQL(
+        SELECT content_type, SUM(file_count), SUM(total_size)
+        FROM file_stats
+        GROUP BY content_type
+        )SQL",
+        [](sqlite3_stmt* stmt) {
+            return std::make_tuple(
+                static_cast<ContentType>(Database::getInt(stmt, 0)),
+                Database::getInt64(stmt, 1),
+                Database::getInt64(stmt, 2)
+            );
+        }
+    );
+
+    for (const auto& [type, count, size] : perType) {
+        stats.totalFiles += count;
+        stats.totalSize += size;
+
+        switch (type) {
+            case ContentType::Image:    stats.imageCount += count; break;
+            case ContentType::Video:    stats.videoCount += count; break;
+            case ContentType::Audio:    stats.audioCount += count; break;
+            case ContentType::Document: stats.documentCount += count; break;
+            case ContentType::Archive:  stats.archiveCount += count; break;
+            default:                    stats.otherCount += count; break;
+        }
+    }
 
     return stats;
 }
@@ -487,36 +595,14 @@ IndexStats IndexManager::getStats() const {
 // Mappers
 // ═══════════════════════════════════════════════════════════
 
-FileRecord IndexManager::mapFileRecord(sqlite3_stmt* stmt) {
-    FileRecord r;
+FileRecordCompactView IndexManager::mapFileRecordCompactView(sqlite3_stmt* stmt, StringArena& arena) {
+    FileRecordCompactView r;
     r.id = Database::getInt64(stmt, 0);
     r.folderId = Database::getInt64(stmt, 1);
-    r.relativePath = Database::getString(stmt, 2);
-    r.name = Database::getString(stmt, 3);
-    r.extension = Database::getString(stmt, 4);
-    r.size = Database::getInt64(stmt, 5);
-    r.mimeType = Database::getString(stmt, 6);
-    r.contentType = static_cast<ContentType>(Database::getInt(stmt, 7));
-    r.checksum = Database::getStringOpt(stmt, 8);
-    r.createdAt = Database::getInt64(stmt, 9);
-    r.modifiedAt = Database::getInt64(stmt, 10);
-    r.indexedAt = Database::getInt64(stmt, 11);
-    r.visibility = static_cast<Visibility>(Database::getInt(stmt, 12));
-    r.sourceDeviceId = Database::getStringOpt(stmt, 13);
-    r.isRemote = Database::getInt(stmt, 14) != 0;
-    r.syncVersion = Database::getInt64(stmt, 15);
-    r.lastModifiedBy = Database::getStringOpt(stmt, 16);
-    return r;
-}
-
-FileRecordCompact IndexManager::mapFileRecordCompact(sqlite3_stmt* stmt) {
-    FileRecordCompact r;
-    r.id = Database::getInt64(stmt, 0);
-    r.folderId = Database::getInt64(stmt, 1);
-    r.relativePath = Database::getString(stmt, 2);
-    r.folderPath = Database::getString(stmt, 3);
-    r.name = Database::getString(stmt, 4);
-    r.extension = Database::getString(stmt, 5);
+    r.relativePath = arena.store(Database::getStringView(stmt, 2));
+    r.folderPath = arena.intern(Database::getStringView(stmt, 3));
+    r.name = arena.store(Database::getStringView(stmt, 4));
+    r.extension = arena.intern(Database::getStringView(stmt, 5));
     r.size = Database::getInt64(stmt, 6);
     r.contentType = static_cast<ContentType>(Database::getInt(stmt, 7));
     r.modifiedAt = Database::getInt64(stmt, 8);
@@ -525,18 +611,4 @@ FileRecordCompact IndexManager::mapFileRecordCompact(sqlite3_stmt* stmt) {
     return r;
 }
 
-WatchedFolder IndexManager::mapWatchedFolder(sqlite3_stmt* stmt) {
-    WatchedFolder f;
-    f.id = Database::getInt64(stmt, 0);
-    f.path = Database::getString(stmt, 1);
-    f.name = Database::getString(stmt, 2);
-    f.enabled = Database::getInt(stmt, 3) != 0;
-    f.lastScanAt = Database::getInt64(stmt, 4);
-    f.fileCount = Database::getInt64(stmt, 5);
-    f.totalSize = Database::getInt64(stmt, 6);
-    f.createdAt = Database::getInt64(stmt, 7);
-    f.defaultVisibility = static_cast<Visibility>(Database::getInt(stmt, 8));
-    return f;
-}
-
 } // namespace FamilyVault
@@ -0,0 +1,37 @@
+#include "familyvault/MimeTypeTable.h"
+
+namespace FamilyVault {
+
+MimeTypeTable::MimeTypeTable(std::shared_ptr<Database> db)
+    : m_db(std::move(db)) {
+}
+
+MimeTypeTable::~MimeTypeTable() = default;
+
+int64_t MimeTypeTable::intern(std::string_view mimeType) {
+    if (mimeType.empty()) return 0;
+
+    std::string key(mimeType);
+    std::lock_guard lock(m_mutex);
+    if (auto it = m_ids.find(key); it != m_ids.end()) {
+        return it->second;
+    }
+
+    // DO UPDATE вместо DO NOTHING — чтобы RETURNING вернул ID существующей строки
+    auto id = m_db->queryOne<int64_t>(
+        R"SQL(
+        INSERT INTO mime_types (mime_type) VALUES (?)
+        ON CONFLICT(mime_type) DO UPDATE SET mime_type = excluded.mime_type
+        RETURNING id
+        )SQL",
+        [](sqlite3_stmt* stmt) { return Database::getInt64(stmt, 0); },
+        key
+    );
+    if (!id) {
+        throw DatabaseException("Failed to intern MIME type: " + key);
+    }
+    m_ids.emplace(std::move(key), *id);
+    return *id;
+}
+
+} // namespace FamilyVault
@@ -2,6 +2,7 @@
 
 #include "familyvault/Network/IndexSyncManager.h"
 #include "familyvault/IndexManager.h"
+#include "familyvault/HotQueries.h"
 #include <nlohmann/json.hpp>
 #include <spdlog/spdlog.h>
 #include <chrono>
@@ -51,7 +52,6 @@ std::optional<RemoteFileRecord> parseRemoteFile(const std::string& jsonStr) {
         r.modifiedAt = j.value("modifiedAt", 0);
         r.checksum = j.value("checksum", "");
         r.sourceDeviceId = j.value("deviceId", "");
-        r.extractedText = j.value("extractedText", "");
         r.isDeleted = j.value("isDeleted", false);
         r.syncedAt = std::chrono::duration_cast<std::chrono::seconds>(
             Clock::now().time_since_epoch()).count();
@@ -72,9 +72,8 @@ RemoteFileRecord mapRemoteFileRecord(sqlite3_stmt* stmt) {
     r.size = Database::getInt64(stmt, 6);
     r.modifiedAt = Database::getInt64(stmt, 7);
     r.checksum = Database::getString(stmt, 8);
-    r.extractedText = Database::getString(stmt, 9);
-    r.syncedAt = Database::getInt64(stmt, 10);
-    r.isDeleted = Database::getInt(stmt, 11) != 0;
+    r.syncedAt = Database::getInt64(stmt, 9);
+    r.isDeleted = Database::getInt(stmt, 10) != 0;
     return r;
 }
 
@@ -192,16 +191,23 @@ public:
             auto j = json::parse(response.getJsonPayload());
             int64_t totalFiles = j.value("totalFiles", 0);
 
-            std::lock_guard<std::mutex> lock(m_progressMutex);
-            auto& progress = m_syncProgress[peerId];
-            progress.totalFiles = totalFiles;
-            
-            if (totalFiles == 0) {
-                progress.isComplete = true;
-                notifyComplete(peerId, 0);
+            {
+                std::lock_guard<std::mutex> lock(m_progressMutex);
+                auto& progress = m_syncProgress[peerId];
+                progress.totalFiles = totalFiles;
+                
+                if (totalFiles == 0) {
+                    progress.isComplete = true;
+                    notifyComplete(peerId, 0);
+                }
             }
 
             spdlog::info("IndexSync: Expecting {} files from {}", totalFiles, peerId);
+            
+            // Новых записей нет, но у локальных файлов могли появиться checksum
+            if (totalFiles == 0) {
+                requestContentText(peer);
+            }
         } catch (...) {
             spdlog::warn("IndexSync: Invalid sync response from {}", peerId);
         }
@@ -222,6 +228,7 @@ public:
         storeRemoteFile(*remoteFile);
 
         // Update progress
+        bool complete = false;
         {
             std::lock_guard<std::mutex> lock(m_progressMutex);
             auto& progress = m_syncProgress[peerId];
@@ -230,59 +237,127 @@ public:
 
             if (progress.receivedFiles >= progress.totalFiles) {
                 progress.isComplete = true;
+                complete = true;
                 setLastSyncTimestamp(peerId, std::chrono::duration_cast<std::chrono::seconds>(
                     Clock::now().time_since_epoch()).count());
                 notifyComplete(peerId, progress.receivedFiles);
             }
         }
+
+        if (complete) {
+            requestContentText(peer);
+        }
+    }
+
+    /// Запросить у пира текст совпавших checksum (пачками по SYNC_BATCH_SIZE)
+    void requestContentText(std::shared_ptr<PeerConnection> peer) {
+        if (!peer || !peer->isConnected()) return;
+
+        auto wanted = getWantedTextChecksums(peer->getPeerId());
+        for (size_t i = 0; i < wanted.size(); i += SYNC_BATCH_SIZE) {
+            auto end = wanted.begin() + std::min(wanted.size(), i + SYNC_BATCH_SIZE);
+            Message msg(MessageType::ContentTextRequest, generateRequestId());
+            msg.setJsonPayload(json{{"checksums", std::vector<std::string>(wanted.begin() + i, end)}}.dump());
+            peer->sendMessage(msg);
+        }
+        if (!wanted.empty()) {
+            spdlog::info("IndexSync: Requested text of {} files from {}",
+                         wanted.size(), peer->getPeerId());
+        }
+    }
+
+    void handleContentTextRequest(std::shared_ptr<PeerConnection> peer, const Message& request) {
+        if (!peer || !peer->isConnected()) return;
+
+        std::vector<std::string> checksums;
+        try {
+            checksums = json::parse(request.getJsonPayload())
+                            .value("checksums", std::vector<std::string>{});
+        } catch (...) {
+            spdlog::warn("IndexSync: Invalid text request from {}", peer->getPeerId());
+            return;
+        }
+        // Пачка больше той, что шлёт requestContentText, — не от нас
+        if (checksums.size() > static_cast<size_t>(SYNC_BATCH_SIZE)) {
+            checksums.resize(SYNC_BATCH_SIZE);
+        }
+
+        int sent = 0;
+        for (const auto& checksum : checksums) {
+            if (!peer->isConnected()) break;
+            std::string text = getSharedText(checksum);
+            if (text.empty()) continue;
+            Message response(MessageType::ContentTextResponse, request.requestId);
+            response.setJsonPayload(json{{"checksum", checksum}, {"text", text}}.dump());
+            peer->sendMessage(response);
+            sent++;
+        }
+        spdlog::debug("IndexSync: Sent text of {} of {} requested files to {}",
+                      sent, checksums.size(), peer->getPeerId());
+    }
+
+    void handleContentTextResponse(std::shared_ptr<PeerConnection> peer, const Message& response) {
+        if (!peer) return;
+
+        try {
+            auto j = json::parse(response.getJsonPayload());
+            storeReceivedText(j.value("checksum", ""), j.value("text", ""), peer->getPeerId());
+        } catch (...) {
+            spdlog::warn("IndexSync: Invalid text response from {}", peer->getPeerId());
+        }
     }
 
     std::vector<FileRecord> getLocalChangesSince(int64_t sinceTimestamp, int limit = 0, int offset = 0) const {
         // Only return Family visibility files (Private files never leave device!)
-        // Use COALESCE to inherit visibility from folder when file.visibility is NULL
-        std::string sql;
         if (limit > 0) {
-            sql = R"(
-                SELECT f.id, f.folder_id, f.relative_path, f.name, f.extension, f.size, f.mime_type,
-                       f.content_type, f.checksum, f.created_at, f.modified_at, f.indexed_at,
-                       COALESCE(f.visibility, wf.visibility) as visibility,
-                       f.source_device_id, f.is_remote, f.sync_version
-                FROM files f
-                JOIN watched_folders wf ON f.folder_id = wf.id
-                WHERE COALESCE(f.visibility, wf.visibility) = 1
-                  AND f.is_remote = 0
-                  AND f.indexed_at > ?
-                ORDER BY f.indexed_at ASC
-                LIMIT ? OFFSET ?
-            )";
-            return m_db->query<FileRecord>(sql, mapFileRecord, sinceTimestamp, limit, offset);
-        } else {
-            // No limit - return all (for internal use)
-            sql = R"(
-                SELECT f.id, f.folder_id, f.relative_path, f.name, f.extension, f.size, f.mime_type,
-                       f.content_type, f.checksum, f.created_at, f.modified_at, f.indexed_at,
-                       COALESCE(f.visibility, wf.visibility) as visibility,
-                       f.source_device_id, f.is_remote, f.sync_version
-                FROM files f
-                JOIN watched_folders wf ON f.folder_id = wf.id
-                WHERE COALESCE(f.visibility, wf.visibility) = 1
-                  AND f.is_remote = 0
-                  AND f.indexed_at > ?
-                ORDER BY f.indexed_at ASC
-            )";
-            return m_db->query<FileRecord>(sql, mapFileRecord, sinceTimestamp);
+            return m_db->query<FileRecord>(queries::LOCAL_CHANGES_PAGE_SQL, mapFileRecord,
+                                           sinceTimestamp, limit, offset);
         }
+        // No limit - return all (for internal use)
+        return m_db->query<FileRecord>(queries::LOCAL_CHANGES_SQL, mapFileRecord, sinceTimestamp);
     }
     
     int64_t countLocalChangesSince(int64_t sinceTimestamp) const {
-        return m_db->queryScalar(R"(
-            SELECT COUNT(*)
+        return m_db->queryScalar(queries::LOCAL_CHANGES_COUNT_SQL, sinceTimestamp);
+    }
+
+    std::vector<std::string> getWantedTextChecksums(const std::string& deviceId) const {
+        // Обход частичного индекса ожидающих файлов, remote_files — по checksum
+        return m_db->query<std::string>(R"(
+            SELECT DISTINCT f.checksum
             FROM files f
-            JOIN watched_folders wf ON f.folder_id = wf.id
-            WHERE COALESCE(f.visibility, wf.visibility) = 1
-              AND f.is_remote = 0
-              AND f.indexed_at > ?
-        )", sinceTimestamp);
+            WHERE f.extraction_pending = 1
+              AND f.source_device_id IS NULL
+              AND f.checksum IS NOT NULL AND f.checksum != ''
+              AND EXISTS (SELECT 1 FROM remote_files r
+                          WHERE r.checksum = f.checksum AND r.source_device_id = ?
+                            AND r.is_deleted = 0)
+              AND NOT EXISTS (SELECT 1 FROM content_cache c WHERE c.checksum = f.checksum)
+        )", [](sqlite3_stmt* stmt) { return Database::getString(stmt, 0); }, deviceId);
+    }
+
+    std::string getSharedText(const std::string& checksum) const {
+        if (checksum.empty()) return {};
+        auto text = m_db->queryOne<std::string>(queries::SHARED_TEXT_SQL,
+            [](sqlite3_stmt* stmt) { return Database::getString(stmt, 0); },
+            checksum);
+        return text.value_or("");
+    }
+
+    bool storeReceivedText(const std::string& checksum, const std::string& text,
+                           const std::string& deviceId) {
+        if (checksum.empty() || text.empty()) return false;
+        // Только для своего файла с тем же содержимым, который ещё ждёт
+        // извлечения: ContentIndexer возьмёт текст отсюда вместо извлечения.
+        // Собственное извлечение не перезаписывается
+        m_db->execute(R"(
+            INSERT OR IGNORE INTO content_cache (checksum, content, source_device_id)
+            SELECT ?, ?, ?
+            WHERE EXISTS (SELECT 1 FROM files
+                          WHERE checksum = ? AND source_device_id IS NULL
+                            AND extraction_pending = 1)
+        )", checksum, text, deviceId, checksum);
+        return m_db->changesCount() > 0;
     }
 
     int64_t getLastSyncTimestamp(const std::string& deviceId) const {
@@ -301,7 +376,7 @@ public:
     std::vector<RemoteFileRecord> getRemoteFiles(const std::string& deviceId) const {
         return m_db->query<RemoteFileRecord>(R"(
             SELECT id, remote_id, source_device_id, path, name, mime_type, size,
-                   modified_at, checksum, extracted_text, synced_at, is_deleted
+                   modified_at, checksum, synced_at, is_deleted
             FROM remote_files
             WHERE source_device_id = ? AND is_deleted = 0
             ORDER BY name ASC
@@ -311,7 +386,7 @@ public:
     std::vector<RemoteFileRecord> getAllRemoteFiles() const {
         return m_db->query<RemoteFileRecord>(R"(
             SELECT id, remote_id, source_device_id, path, name, mime_type, size,
-                   modified_at, checksum, extracted_text, synced_at, is_deleted
+                   modified_at, checksum, synced_at, is_deleted
             FROM remote_files
             WHERE is_deleted = 0
             ORDER BY source_device_id, name ASC
@@ -321,7 +396,7 @@ public:
     std::optional<RemoteFileRecord> getRemoteFile(int64_t localId) const {
         return m_db->queryOne<RemoteFileRecord>(R"(
             SELECT id, remote_id, source_device_id, path, name, mime_type, size,
-                   modified_at, checksum, extracted_text, synced_at, is_deleted
+                   modified_at, checksum, synced_at, is_deleted
             FROM remote_files
             WHERE id = ?
         )", mapRemoteFileRecord, localId);
@@ -331,12 +406,12 @@ public:
         std::string searchPattern = "%" + query + "%";
         return m_db->query<RemoteFileRecord>(R"(
             SELECT id, remote_id, source_device_id, path, name, mime_type, size,
-                   modified_at, checksum, extracted_text, synced_at, is_deleted
+                   modified_at, checksum, synced_at, is_deleted
             FROM remote_files
-            WHERE is_deleted = 0 AND (name LIKE ? OR extracted_text LIKE ?)
+            WHERE is_deleted = 0 AND name LIKE ?
             ORDER BY name ASC
             LIMIT ?
-        )", mapRemoteFileRecord, searchPattern, searchPattern, limit);
+        )", mapRemoteFileRecord, searchPattern, limit);
     }
 
     int64_t getRemoteFileCount() const {
@@ -412,7 +487,6 @@ private:
                 size INTEGER DEFAULT 0,
                 modified_at INTEGER DEFAULT 0,
                 checksum TEXT,
-                extracted_text TEXT,
                 synced_at INTEGER DEFAULT 0,
                 is_deleted INTEGER DEFAULT 0,
                 UNIQUE(source_device_id, remote_id)
@@ -429,6 +503,12 @@ private:
             ON remote_files(name)
         )");
 
+        // Запрос текста: есть ли у пира файл с checksum ожидающего локального
+        m_db->execute(R"(
+            CREATE INDEX IF NOT EXISTS idx_remote_files_checksum
+            ON remote_files(checksum)
+        )");
+
         // Create sync_state table
         m_db->execute(R"(
             CREATE TABLE IF NOT EXISTS sync_state (
@@ -450,8 +530,8 @@ private:
             m_db->execute(R"(
                 INSERT INTO remote_files 
                     (remote_id, source_device_id, path, name, mime_type, size, 
-                     modified_at, checksum, extracted_text, synced_at, is_deleted)
-                VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, 0)
+                     modified_at, checksum, synced_at, is_deleted)
+                VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, 0)
                 ON CONFLICT(source_device_id, remote_id) DO UPDATE SET
                     path = excluded.path,
                     name = excluded.name,
@@ -459,12 +539,11 @@ private:
                     size = excluded.size,
                     modified_at = excluded.modified_at,
                     checksum = excluded.checksum,
-                    extracted_text = excluded.extracted_text,
                     synced_at = excluded.synced_at,
                     is_deleted = 0
             )", file.remoteId, file.sourceDeviceId, file.path, file.name,
                 file.mimeType, file.size, file.modifiedAt, file.checksum,
-                file.extractedText, file.syncedAt);
+                file.syncedAt);
         }
     }
 
@@ -517,6 +596,27 @@ void IndexSyncManager::handleIndexDelta(std::shared_ptr<PeerConnection> peer, co
     m_impl->handleIndexDelta(std::move(peer), delta);
 }
 
+void IndexSyncManager::handleContentTextRequest(std::shared_ptr<PeerConnection> peer, const Message& request) {
+    m_impl->handleContentTextRequest(std::move(peer), request);
+}
+
+void IndexSyncManager::handleContentTextResponse(std::shared_ptr<PeerConnection> peer, const Message& response) {
+    m_impl->handleContentTextResponse(std::move(peer), response);
+}
+
+std::vector<std::string> IndexSyncManager::getWantedTextChecksums(const std::string& deviceId) const {
+    return m_impl->getWantedTextChecksums(deviceId);
+}
+
+std::string IndexSyncManager::getSharedText(const std::string& checksum) const {
+    return m_impl->getSharedText(checksum);
+}
+
+bool IndexSyncManager::storeReceivedText(const std::string& checksum, const std::string& text,
+                                         const std::string& deviceId) {
+    return m_impl->storeReceivedText(checksum, text, deviceId);
+}
+
 std::vector<FileRecord> IndexSyncManager::getLocalChangesSince(int64_t sinceTimestamp) const {
     return m_impl->getLocalChangesSince(sinceTimestamp);
 }
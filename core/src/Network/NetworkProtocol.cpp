@@ -26,6 +26,8 @@ const char* messageTypeName(MessageType type) {
         case MessageType::IndexSyncResponse: return "IndexSyncResponse";
         case MessageType::IndexDelta: return "IndexDelta";
         case MessageType::IndexDeltaAck: return "IndexDeltaAck";
+        case MessageType::ContentTextRequest: return "ContentTextRequest";
+        case MessageType::ContentTextResponse: return "ContentTextResponse";
         case MessageType::FileRequest: return "FileRequest";
         case MessageType::FileResponse: return "FileResponse";
         case MessageType::FileChunk: return "FileChunk";
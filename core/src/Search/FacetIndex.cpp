@@ -0,0 +1,366 @@
+#include "familyvault/FacetIndex.h"
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <mutex>
+
+namespace FamilyVault {
+
+FacetIndex::FacetIndex(std::shared_ptr<Database> db)
+    : m_db(std::move(db)) {
+}
+
+FacetIndex::~FacetIndex() = default;
+
+// ═══════════════════════════════════════════════════════════
+// Построение
+// ═══════════════════════════════════════════════════════════
+
+void FacetIndex::rebuild() {
+    auto startTime = std::chrono::steady_clock::now();
+
+    struct FileRow {
+        int64_t id;
+        int64_t folderId;
+        ContentType contentType;
+        std::string extension;
+        int64_t modifiedAt;
+    };
+
+    // Блокировка берётся до чтения: инкрементальные обновления, пришедшие
+    // во время перестройки, ждут её и применяются поверх, а не теряются.
+    // Все три таблицы читаются под одной блокировкой — запись, попавшая
+    // между запросами, тоже доходит до индекса своим обновлением.
+    // BEGIN здесь не годится: соединение общее, транзакция другого потока
+    // может быть уже открыта
+    std::unique_lock lock(m_mutex);
+
+    auto files = m_db->query<FileRow>(
+        "SELECT id, folder_id, content_type, extension, modified_at FROM files",
+        [](sqlite3_stmt* stmt) {
+            return FileRow{
+                Database::getInt64(stmt, 0),
+                Database::getInt64(stmt, 1),
+                static_cast<ContentType>(Database::getInt(stmt, 2)),
+                Database::getString(stmt, 3),
+                Database::getInt64(stmt, 4)
+            };
+        }
+    );
+
+    auto tags = m_db->query<std::pair<int64_t, TagEntry>>(
+        "SELECT id, name, source FROM tags",
+        [](sqlite3_stmt* stmt) {
+            TagEntry entry;
+            entry.name = Database::getString(stmt, 1);
+            entry.source = static_cast<TagSource>(Database::getInt(stmt, 2));
+            return std::make_pair(Database::getInt64(stmt, 0), std::move(entry));
+        }
+    );
+
+    auto fileTags = m_db->query<std::pair<int64_t, int64_t>>(
+        "SELECT file_id, tag_id FROM file_tags",
+        [](sqlite3_stmt* stmt) {
+            return std::make_pair(Database::getInt64(stmt, 0), Database::getInt64(stmt, 1));
+        }
+    );
+
+    m_allFiles.clear();
+    m_tags.clear();
+    m_tagIdsByName.clear();
+    m_contentTypes.clear();
+    m_extensions.clear();
+    m_years.clear();
+    m_folders.clear();
+    m_fileFacets.clear();
+    m_fileFacets.reserve(files.size());
+
+    for (const auto& f : files) {
+        if (!RoaringBitmap::fits(f.id)) {
+            spdlog::warn("FacetIndex: file id {} out of range, skipped", f.id);
+            continue;
+        }
+        auto id = static_cast<uint32_t>(f.id);
+        m_allFiles.add(id);
+        addFileAttributesLocked(id, f.folderId, f.contentType, f.extension, f.modifiedAt);
+    }
+
+    for (auto& [tagId, entry] : tags) {
+        m_tagIdsByName[entry.name] = tagId;
+        m_tags.emplace(tagId, std::move(entry));
+    }
+
+    for (const auto& [fileId, tagId] : fileTags) {
+        auto it = m_tags.find(tagId);
+        if (it != m_tags.end() && RoaringBitmap::fits(fileId)) {
+            it->second.files.add(static_cast<uint32_t>(fileId));
+        }
+    }
+
+    m_built = true;
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - startTime).count();
+    spdlog::info("FacetIndex built: {} files, {} tags in {} ms",
+                 m_allFiles.cardinality(), m_tags.size(), elapsed);
+}
+
+bool FacetIndex::isBuilt() const {
+    std::shared_lock lock(m_mutex);
+    return m_built;
+}
+
+// ═══════════════════════════════════════════════════════════
+// Инкрементальное обновление
+// ═══════════════════════════════════════════════════════════
+
+void FacetIndex::upsertFile(int64_t fileId, int64_t folderId, ContentType contentType,
+                            const std::string& extension, int64_t modifiedAt) {
+    if (!RoaringBitmap::fits(fileId)) return;
+    auto id = static_cast<uint32_t>(fileId);
+
+    std::unique_lock lock(m_mutex);
+    if (m_allFiles.contains(id)) {
+        removeFileAttributesLocked(id);
+    } else {
+        m_allFiles.add(id);
+    }
+    addFileAttributesLocked(id, folderId, contentType, extension, modifiedAt);
+}
+
+void FacetIndex::removeFile(int64_t fileId) {
+    if (!RoaringBitmap::fits(fileId)) return;
+    auto id = static_cast<uint32_t>(fileId);
+
+    std::unique_lock lock(m_mutex);
+    if (!m_allFiles.remove(id)) return;
+    removeFileAttributesLocked(id);
+    for (auto& [tagId, entry] : m_tags) {
+        entry.files.remove(id);
+    }
+}
+
+void FacetIndex::removeFiles(const RoaringBitmap& fileIds) {
+    if (fileIds.isEmpty()) return;
+
+    std::unique_lock lock(m_mutex);
+    for (uint32_t id : (fileIds & m_allFiles).toVector()) {
+        removeFileAttributesLocked(id);
+    }
+    m_allFiles -= fileIds;
+    for (auto& [tagId, entry] : m_tags) {
+        entry.files -= fileIds;
+    }
+}
+
+void FacetIndex::removeFolder(int64_t folderId) {
+    RoaringBitmap folderFiles = filesWith(FacetKind::Folder, std::to_string(folderId));
+    removeFiles(folderFiles);
+}
+
+void FacetIndex::registerTag(int64_t tagId, const std::string& name, TagSource source) {
+    std::unique_lock lock(m_mutex);
+    auto& entry = m_tags[tagId];
+    entry.name = name;
+    entry.source = source;
+    m_tagIdsByName[name] = tagId;
+}
+
+void FacetIndex::addFileTag(int64_t fileId, int64_t tagId) {
+    if (!RoaringBitmap::fits(fileId)) return;
+
+    std::unique_lock lock(m_mutex);
+    auto it = m_tags.find(tagId);
+    if (it != m_tags.end()) {
+        it->second.files.add(static_cast<uint32_t>(fileId));
+    }
+}
+
+void FacetIndex::removeFileTag(int64_t fileId, const std::string& tagName) {
+    if (!RoaringBitmap::fits(fileId)) return;
+
+    std::unique_lock lock(m_mutex);
+    auto idIt = m_tagIdsByName.find(tagName);
+    if (idIt == m_tagIdsByName.end()) return;
+    auto it = m_tags.find(idIt->second);
+    if (it != m_tags.end()) {
+        it->second.files.remove(static_cast<uint32_t>(fileId));
+    }
+}
+
+void FacetIndex::removeFileAttributesLocked(uint32_t fileId) {
+    auto record = m_fileFacets.find(fileId);
+    if (record == m_fileFacets.end()) return;
+
+    auto clear = [fileId](ValueMap& map, ValueMap::value_type* value) {
+        if (!value) return;
+        value->second.remove(fileId);
+        if (value->second.isEmpty()) map.erase(map.find(value->first));
+    };
+    const FileFacets& facets = record->second;
+    clear(m_contentTypes, facets.contentType);
+    clear(m_extensions, facets.extension);
+    clear(m_years, facets.year);
+    clear(m_folders, facets.folder);
+
+    m_fileFacets.erase(record);
+}
+
+void FacetIndex::addFileAttributesLocked(uint32_t fileId, int64_t folderId, ContentType contentType,
+                                         const std::string& extension, int64_t modifiedAt) {
+    auto put = [fileId](ValueMap& map, std::string value) {
+        auto& entry = *map.try_emplace(std::move(value)).first;
+        entry.second.add(fileId);
+        return &entry;
+    };
+
+    FileFacets facets;
+    facets.contentType = put(m_contentTypes, contentTypeToString(contentType));
+    facets.folder = put(m_folders, std::to_string(folderId));
+    if (!extension.empty()) {
+        facets.extension = put(m_extensions, extension);
+    }
+    if (modifiedAt > 0) {
+        std::string year = yearOf(modifiedAt);
+        if (!year.empty()) facets.year = put(m_years, std::move(year));
+    }
+    m_fileFacets[fileId] = facets;
+}
+
+// ═══════════════════════════════════════════════════════════
+// Запросы
+// ═══════════════════════════════════════════════════════════
+
+std::vector<Tag> FacetIndex::getAllTags() const {
+    std::shared_lock lock(m_mutex);
+
+    std::vector<Tag> result;
+    result.reserve(m_tags.size());
+    for (const auto& [id, entry] : m_tags) {
+        result.push_back(makeTag(id, entry));
+    }
+    std::sort(result.begin(), result.end(),
+              [](const Tag& a, const Tag& b) { return a.name < b.name; });
+    return result;
+}
+
+std::vector<Tag> FacetIndex::getPopularTags(int limit) const {
+    std::shared_lock lock(m_mutex);
+
+    std::vector<Tag> result;
+    for (const auto& [id, entry] : m_tags) {
+        if (!entry.files.isEmpty()) {
+            result.push_back(makeTag(id, entry));
+        }
+    }
+    std::sort(result.begin(), result.end(), [](const Tag& a, const Tag& b) {
+        if (a.fileCount != b.fileCount) return a.fileCount > b.fileCount;
+        return a.name < b.name;
+    });
+    if (limit >= 0 && result.size() > static_cast<size_t>(limit)) {
+        result.resize(limit);
+    }
+    return result;
+}
+
+int64_t FacetIndex::countFilesByTag(const std::string& tagName) const {
+    std::shared_lock lock(m_mutex);
+
+    auto idIt = m_tagIdsByName.find(tagName);
+    if (idIt == m_tagIdsByName.end()) return 0;
+    auto it = m_tags.find(idIt->second);
+    return it != m_tags.end() ? static_cast<int64_t>(it->second.files.cardinality()) : 0;
+}
+
+std::vector<FacetCount> FacetIndex::facetCounts(FacetKind kind, const RoaringBitmap* within,
+                                                int limit) const {
+    std::shared_lock lock(m_mutex);
+
+    std::vector<FacetCount> result;
+    auto count = [within](const RoaringBitmap& files) {
+        return static_cast<int64_t>(within ? files.andCardinality(*within) : files.cardinality());
+    };
+
+    if (kind == FacetKind::Tag) {
+        for (const auto& [id, entry] : m_tags) {
+            int64_t n = count(entry.files);
+            if (n > 0) result.push_back({entry.name, n});
+        }
+    } else if (const ValueMap* map = valueMap(kind)) {
+        for (const auto& [value, files] : *map) {
+            int64_t n = count(files);
+            if (n > 0) result.push_back({value, n});
+        }
+    }
+
+    std::sort(result.begin(), result.end(), [](const FacetCount& a, const FacetCount& b) {
+        if (a.count != b.count) return a.count > b.count;
+        return a.value < b.value;
+    });
+    if (limit > 0 && result.size() > static_cast<size_t>(limit)) {
+        result.resize(limit);
+    }
+    return result;
+}
+
+RoaringBitmap FacetIndex::filesWith(FacetKind kind, const std::string& value) const {
+    std::shared_lock lock(m_mutex);
+
+    if (kind == FacetKind::Tag) {
+        auto idIt = m_tagIdsByName.find(value);
+        if (idIt == m_tagIdsByName.end()) return {};
+        auto it = m_tags.find(idIt->second);
+        return it != m_tags.end() ? it->second.files : RoaringBitmap{};
+    }
+
+    const ValueMap* map = valueMap(kind);
+    if (!map) return {};
+    auto it = map->find(value);
+    return it != map->end() ? it->second : RoaringBitmap{};
+}
+
+int64_t FacetIndex::fileCount() const {
+    std::shared_lock lock(m_mutex);
+    return static_cast<int64_t>(m_allFiles.cardinality());
+}
+
+// ═══════════════════════════════════════════════════════════
+// Helpers
+// ═══════════════════════════════════════════════════════════
+
+const FacetIndex::ValueMap* FacetIndex::valueMap(FacetKind kind) const {
+    switch (kind) {
+        case FacetKind::ContentType: return &m_contentTypes;
+        case FacetKind::Extension:   return &m_extensions;
+        case FacetKind::Year:        return &m_years;
+        case FacetKind::Folder:      return &m_folders;
+        case FacetKind::Tag:
+        default:                     return nullptr;
+    }
+}
+
+std::string FacetIndex::yearOf(int64_t timestamp) {
+    // Локальное время — так же, как автотеги TagManager
+    std::time_t time = static_cast<std::time_t>(timestamp);
+    std::tm tmBuf{};
+
+#ifdef _WIN32
+    if (localtime_s(&tmBuf, &time) != 0) return "";
+#else
+    if (!localtime_r(&time, &tmBuf)) return "";
+#endif
+
+    return std::to_string(1900 + tmBuf.tm_year);
+}
+
+Tag FacetIndex::makeTag(int64_t id, const TagEntry& entry) {
+    Tag t;
+    t.id = id;
+    t.name = entry.name;
+    t.source = entry.source;
+    t.fileCount = static_cast<int64_t>(entry.files.cardinality());
+    return t;
+}
+
+} // namespace FamilyVault
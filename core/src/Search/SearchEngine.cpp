@@ -1,16 +1,54 @@
 #include "familyvault/SearchEngine.h"
+#include "familyvault/MaintenanceScheduler.h"
+#include "familyvault/RowSchemas.h"
 #include <spdlog/spdlog.h>
 #include <sstream>
 #include <algorithm>
+#include <cctype>
 
 namespace FamilyVault {
 
+namespace {
+
+// Быстрые фильтры: только локальные колонки, без NULL-заглушек облачных полей
+using FilesByExtension = sql::Select<schema::LocalFile,
+    "FROM files f JOIN watched_folders wf ON f.folder_id = wf.id "
+    "WHERE LOWER(f.extension) = ? ORDER BY f.modified_at DESC LIMIT ?">;
+using FilesByContentType = sql::Select<schema::LocalFile,
+    "FROM files f JOIN watched_folders wf ON f.folder_id = wf.id "
+    "WHERE f.content_type = ? ORDER BY f.modified_at DESC LIMIT ?">;
+using FilesByTag = sql::Select<schema::LocalFile,
+    "FROM files f JOIN watched_folders wf ON f.folder_id = wf.id "
+    "JOIN file_tags ft ON ft.file_id = f.id JOIN tags t ON ft.tag_id = t.id "
+    "WHERE t.name = ? ORDER BY f.modified_at DESC LIMIT ?">;
+
+/// Константа reciprocal rank fusion: вклад места r в своём источнике — 1 / (k + r)
+constexpr int kRankFusionK = 60;
+
+} // namespace
+
 SearchEngine::SearchEngine(std::shared_ptr<Database> db)
     : m_db(std::move(db)) {
 }
 
 SearchEngine::~SearchEngine() = default;
 
+void SearchEngine::setFacetIndex(std::shared_ptr<FacetIndex> facets) {
+    m_facets = std::move(facets);
+}
+
+void SearchEngine::setSuggestIndex(std::shared_ptr<SuggestIndex> suggest) {
+    m_suggest = std::move(suggest);
+}
+
+void SearchEngine::setMaintenanceScheduler(std::shared_ptr<MaintenanceScheduler> maintenance) {
+    m_maintenance = std::move(maintenance);
+}
+
+void SearchEngine::noteActivity() {
+    if (m_maintenance) m_maintenance->noteActivity();
+}
+
 std::string SearchEngine::escapeFtsQuery(const std::string& text) {
     // Экранируем специальные символы FTS5
     std::string result;
@@ -36,20 +74,81 @@ std::string SearchEngine::escapeFtsQuery(const std::string& text) {
     return result;
 }
 
-SearchQueryBuilt SearchEngine::buildSearchQuery(const SearchQuery& query, bool countOnly) {
+std::string SearchEngine::trigramPhrase(const std::string& text) {
+    // Фраза в кавычках: для trigram это «подстрока целиком», операторы FTS5 не действуют
+    std::string result;
+    result.reserve(text.size() + 2);
+    result += '"';
+    for (char c : text) {
+        if (c == '"') result += '"';
+        result += c;
+    }
+    result += '"';
+    return result;
+}
+
+bool SearchEngine::useSubstringMatch(const SearchQuery& query) {
+    // Trigram не находит ничего короче 3 символов (кодовых точек UTF-8)
+    size_t codepoints = 0;
+    bool hasSpace = false;
+    for (unsigned char c : query.text) {
+        if ((c & 0xC0) != 0x80) ++codepoints;
+        if (std::isspace(c)) hasSpace = true;
+    }
+    if (codepoints < 3) {
+        return false;
+    }
+
+    switch (query.matchMode) {
+        case TextMatchMode::Prefix:
+            return false;
+        case TextMatchMode::Substring:
+            return true;
+        case TextMatchMode::Auto:
+        default:
+            // Один термин — вероятно фрагмент имени файла; фразы ищем по токенам
+            return !hasSpace;
+    }
+}
+
+SearchQueryBuilt SearchEngine::buildSearchQuery(const SearchQuery& query, SearchQueryMode mode) {
+    // Все виды поиска (строки, счётчик, фасеты) строят запрос здесь
+    noteActivity();
+
     SearchQueryBuilt result;
     std::ostringstream sql;
     std::vector<SqlParam>& params = result.params;
 
-    if (countOnly) {
+    // bm25 разных индексов (токены, триграммы, каталоги, облако) несопоставимы: строки
+    // ранжируются местом в своём источнике (reciprocal rank fusion) во внешнем
+    // запросе — bm25 нельзя вызвать внутри оконной функции. Отрицательный score:
+    // меньше — лучше, как у bm25. Счётчику и списку ID ранг не нужен
+    const bool fuseRanks = mode == SearchQueryMode::Rows && !query.text.empty();
+    auto sourceColumn = [&sql, fuseRanks](int source) {
+        if (fuseRanks) sql << ", " << source << " as source ";
+    };
+
+    if (mode == SearchQueryMode::Count) {
         sql << "SELECT COUNT(*) FROM (";
+    } else if (mode == SearchQueryMode::LocalIds) {
+        sql << "SELECT id FROM (";
+    } else if (fuseRanks) {
+        sql << R"(
+            SELECT id, folder_id, relative_path, folder_path, name, extension, size,
+                   mime_type, content_type, checksum, created_at, modified_at,
+                   indexed_at, visibility, source_device_id, is_remote, sync_version,
+                   last_modified_by, cloud_account_id, cloud_id, web_view_url, thumbnail_url,
+        )";
+        sql << "-1.0 / (" << kRankFusionK
+            << " + ROW_NUMBER() OVER (PARTITION BY source ORDER BY combined.score)) as score, ";
+        sql << "snippet FROM (";
     }
 
     // ═══════════════════════════════════════════════════════════
     // Local Files Query
     // ═══════════════════════════════════════════════════════════
 
-    sql << R"(
+    static constexpr const char* kLocalColumns = R"(
         SELECT f.id, f.folder_id, f.relative_path, wf.path as folder_path, 
                f.name, f.extension, f.size,
                f.mime_type, f.content_type, f.checksum, f.created_at, f.modified_at,
@@ -59,10 +158,76 @@ SearchQueryBuilt SearchEngine::buildSearchQuery(const SearchQuery& query, bool c
                NULL as web_view_url, NULL as thumbnail_url
     )";
 
-    // Score
+    // Фильтры, общие для веток prefix и substring
+    auto appendLocalFilters = [&query, &params](std::vector<std::string>& conditions) {
+        if (query.contentType) {
+            conditions.push_back("f.content_type = ?");
+            params.push_back(static_cast<int>(*query.contentType));
+        }
+        if (query.extension) {
+            conditions.push_back("f.extension = ?");
+            params.push_back(*query.extension);
+        }
+        if (query.folderId) {
+            conditions.push_back("f.folder_id = ?");
+            params.push_back(*query.folderId);
+        }
+        if (query.dateFrom) {
+            conditions.push_back("f.modified_at >= ?");
+            params.push_back(*query.dateFrom);
+        }
+        if (query.dateTo) {
+            conditions.push_back("f.modified_at <= ?");
+            params.push_back(*query.dateTo);
+        }
+        if (query.minSize) {
+            conditions.push_back("f.size >= ?");
+            params.push_back(*query.minSize);
+        }
+        if (query.maxSize) {
+            conditions.push_back("f.size <= ?");
+            params.push_back(*query.maxSize);
+        }
+        if (query.visibility) {
+            conditions.push_back("COALESCE(f.visibility, wf.visibility) = ?");
+            params.push_back(static_cast<int>(*query.visibility));
+        }
+        if (!query.includeRemote) {
+            conditions.push_back("f.is_remote = 0");
+        }
+        for (const auto& tag : query.tags) {
+            conditions.push_back(
+                "EXISTS (SELECT 1 FROM file_tags ft JOIN tags t ON ft.tag_id = t.id "
+                "WHERE ft.file_id = f.id AND t.name = ?)"
+            );
+            params.push_back(tag);
+        }
+        for (const auto& tag : query.excludeTags) {
+            conditions.push_back(
+                "NOT EXISTS (SELECT 1 FROM file_tags ft JOIN tags t ON ft.tag_id = t.id "
+                "WHERE ft.file_id = f.id AND t.name = ?)"
+            );
+            params.push_back(tag);
+        }
+    };
+
+    auto appendWhere = [&sql](const std::vector<std::string>& conditions) {
+        if (!conditions.empty()) {
+            sql << " WHERE ";
+            for (size_t i = 0; i < conditions.size(); ++i) {
+                if (i > 0) sql << " AND ";
+                sql << conditions[i];
+            }
+        }
+    };
+
+    sql << kLocalColumns;
+
+    // Score; snippet по содержимому генерируется позже, только для страницы результатов
     if (!query.text.empty()) {
         sql << ", bm25(files_fts) as score ";
-        sql << ", snippet(files_fts, 2, '<b>', '</b>', '...', 32) as snippet ";
+        sql << ", NULL as snippet ";
+        sourceColumn(0);
     } else {
         sql << ", 0.0 as score ";
         sql << ", NULL as snippet ";
@@ -80,62 +245,64 @@ SearchQueryBuilt SearchEngine::buildSearchQuery(const SearchQuery& query, bool c
         localConditions.push_back("files_fts MATCH ?");
         params.push_back(escapeFtsQuery(query.text) + "*");
     }
-    if (query.contentType) {
-        localConditions.push_back("f.content_type = ?");
-        params.push_back(static_cast<int>(*query.contentType));
-    }
-    if (query.extension) {
-        localConditions.push_back("f.extension = ?");
-        params.push_back(*query.extension);
-    }
-    if (query.folderId) {
-        localConditions.push_back("f.folder_id = ?");
-        params.push_back(*query.folderId);
-    }
-    if (query.dateFrom) {
-        localConditions.push_back("f.modified_at >= ?");
-        params.push_back(*query.dateFrom);
-    }
-    if (query.dateTo) {
-        localConditions.push_back("f.modified_at <= ?");
-        params.push_back(*query.dateTo);
-    }
-    if (query.minSize) {
-        localConditions.push_back("f.size >= ?");
-        params.push_back(*query.minSize);
-    }
-    if (query.maxSize) {
-        localConditions.push_back("f.size <= ?");
-        params.push_back(*query.maxSize);
-    }
-    if (query.visibility) {
-        localConditions.push_back("COALESCE(f.visibility, wf.visibility) = ?");
-        params.push_back(static_cast<int>(*query.visibility));
-    }
-    if (!query.includeRemote) {
-        localConditions.push_back("f.is_remote = 0");
-    }
-    for (const auto& tag : query.tags) {
-        localConditions.push_back(
-            "EXISTS (SELECT 1 FROM file_tags ft JOIN tags t ON ft.tag_id = t.id "
-            "WHERE ft.file_id = f.id AND t.name = ?)"
-        );
-        params.push_back(tag);
-    }
-    for (const auto& tag : query.excludeTags) {
-        localConditions.push_back(
-            "NOT EXISTS (SELECT 1 FROM file_tags ft JOIN tags t ON ft.tag_id = t.id "
-            "WHERE ft.file_id = f.id AND t.name = ?)"
-        );
-        params.push_back(tag);
+    appendLocalFilters(localConditions);
+    appendWhere(localConditions);
+
+    // Подстрока в имени/пути (trigram): только то, что не нашёл префиксный поиск,
+    // чтобы совпадения по токенам сохранили bm25 и snippet по содержимому
+    const bool substringMatch = useSubstringMatch(query);
+    if (substringMatch) {
+        sql << " UNION ALL ";
+        sql << kLocalColumns;
+        sql << ", bm25(files_trigram) as score ";
+        sql << ", NULL as snippet ";
+        sourceColumn(1);
+        sql << " FROM files f ";
+        sql << " JOIN watched_folders wf ON f.folder_id = wf.id ";
+        sql << " JOIN files_trigram tri ON tri.rowid = f.id ";
+
+        std::vector<std::string> substringConditions;
+        substringConditions.push_back("files_trigram MATCH ?");
+        params.push_back(trigramPhrase(query.text));
+        substringConditions.push_back("f.id NOT IN (SELECT rowid FROM files_fts WHERE files_fts MATCH ?)");
+        params.push_back(escapeFtsQuery(query.text) + "*");
+        appendLocalFilters(substringConditions);
+        appendWhere(substringConditions);
     }
 
-    if (!localConditions.empty()) {
-        sql << " WHERE ";
-        for (size_t i = 0; i < localConditions.size(); ++i) {
-            if (i > 0) sql << " AND ";
-            sql << localConditions[i];
+    // Путь files_fts не индексирует: по токенам совпадают имена каталогов
+    // (directories_fts), их файлы и файлы подкаталогов. Только то, что не
+    // нашли ветки выше
+    if (!query.text.empty()) {
+        sql << " UNION ALL ";
+        sql << kLocalColumns;
+        sql << ", 0.0 as score ";
+        sql << ", NULL as snippet ";
+        sourceColumn(3);
+        sql << " FROM files f ";
+        sql << " JOIN watched_folders wf ON f.folder_id = wf.id ";
+
+        std::vector<std::string> directoryConditions;
+        directoryConditions.push_back(R"((f.folder_id, f.directory_id) IN (
+            WITH RECURSIVE matched(folder_id, id) AS (
+                SELECT d.folder_id, d.id FROM directories_fts
+                JOIN directories d ON d.id = directories_fts.rowid
+                WHERE directories_fts MATCH ?
+                UNION
+                SELECT d.folder_id, d.id FROM directories d
+                JOIN matched m ON d.folder_id = m.folder_id AND d.parent_id = m.id
+            )
+            SELECT folder_id, id FROM matched))");
+        params.push_back(escapeFtsQuery(query.text) + "*");
+        directoryConditions.push_back("f.id NOT IN (SELECT rowid FROM files_fts WHERE files_fts MATCH ?)");
+        params.push_back(escapeFtsQuery(query.text) + "*");
+        if (substringMatch) {
+            directoryConditions.push_back(
+                "f.id NOT IN (SELECT rowid FROM files_trigram WHERE files_trigram MATCH ?)");
+            params.push_back(trigramPhrase(query.text));
         }
+        appendLocalFilters(directoryConditions);
+        appendWhere(directoryConditions);
     }
 
     // ═══════════════════════════════════════════════════════════
@@ -167,6 +334,7 @@ SearchQueryBuilt SearchEngine::buildSearchQuery(const SearchQuery& query, bool c
         if (!query.text.empty()) {
             sql << ", bm25(cloud_files_fts) as score ";
             sql << ", snippet(cloud_files_fts, 0, '<b>', '</b>', '...', 32) as snippet ";
+            sourceColumn(2);
         } else {
             sql << ", 0.0 as score ";
             sql << ", NULL as snippet ";
@@ -209,18 +377,17 @@ SearchQueryBuilt SearchEngine::buildSearchQuery(const SearchQuery& query, bool c
             params.push_back(*query.maxSize);
         }
 
-        if (!cloudConditions.empty()) {
-            sql << " WHERE ";
-            for (size_t i = 0; i < cloudConditions.size(); ++i) {
-                if (i > 0) sql << " AND ";
-                sql << cloudConditions[i];
-            }
-        }
+        appendWhere(cloudConditions);
     }
 
-    if (countOnly) {
+    if (mode == SearchQueryMode::Count) {
         sql << ") as combined";
+    } else if (mode == SearchQueryMode::LocalIds) {
+        sql << ") as combined WHERE cloud_account_id IS NULL";
     } else {
+        if (fuseRanks) {
+            sql << ") as combined";
+        }
         sql << " ORDER BY ";
         switch (query.sortBy) {
             case SortBy::Name:
@@ -252,7 +419,7 @@ SearchQueryBuilt SearchEngine::buildSearchQuery(const SearchQuery& query, bool c
 }
 
 std::vector<SearchResult> SearchEngine::search(const SearchQuery& query) {
-    auto built = buildSearchQuery(query, false);
+    auto built = buildSearchQuery(query);
 
     spdlog::debug("Search SQL: {}", built.sql);
 
@@ -264,7 +431,7 @@ std::vector<SearchResult> SearchEngine::search(const SearchQuery& query) {
             // Column indices:
             // 0-21: FileRecord (mapFileRecord consumes these)
             // 22: score
-            // 23: snippet (only if text search is active)
+            // 23: snippet (cloud rows only; local snippets are filled per page below)
             
             // Check if we requested score/snippet (only for text search)
             if (!query.text.empty()) {
@@ -279,32 +446,97 @@ std::vector<SearchResult> SearchEngine::search(const SearchQuery& query) {
         built.params
     );
 
+    // Snippet только для возвращаемой страницы, одним запросом к FTS
+    if (!query.text.empty()) {
+        std::vector<int64_t> localIds;
+        for (const auto& r : results) {
+            if (!r.file.cloudAccountId) localIds.push_back(r.file.id);
+        }
+
+        auto snippets = generateSnippets(localIds, query.text);
+        for (auto& r : results) {
+            if (r.file.cloudAccountId) continue;
+            auto it = snippets.find(r.file.id);
+            if (it != snippets.end()) r.snippet = std::move(it->second);
+        }
+    }
+
     spdlog::info("Search '{}': {} results", query.text, results.size());
     return results;
 }
 
 std::vector<SearchResultCompact> SearchEngine::searchCompact(const SearchQuery& query) {
-    auto built = buildSearchQuery(query, false);
+    auto batch = searchCompactBatch(query);
+
+    std::vector<SearchResultCompact> results;
+    results.reserve(batch.size());
+    for (size_t i = 0; i < batch.size(); ++i) {
+        results.push_back({batch.rows[i].toRecord(), batch.scores[i]});
+    }
+    return results;
+}
+
+FileRecordCompactBatch SearchEngine::searchCompactBatch(const SearchQuery& query) {
+    auto built = buildSearchQuery(query);
 
-    return m_db->queryDynamic<SearchResultCompact>(
+    FileRecordCompactBatch batch;
+    batch.rows = m_db->queryDynamic<FileRecordCompactView>(
         built.sql,
-        [](sqlite3_stmt* stmt) {
-            return mapSearchResultCompact(stmt);
+        [&batch](sqlite3_stmt* stmt) {
+            batch.scores.push_back(Database::getDouble(stmt, 22));
+            return mapFileRecordCompactView(stmt, batch.arena);
         },
         built.params
     );
+    return batch;
 }
 
 int64_t SearchEngine::countResults(const SearchQuery& query) {
-    auto built = buildSearchQuery(query, true);
+    auto built = buildSearchQuery(query, SearchQueryMode::Count);
     return m_db->queryScalarDynamic(built.sql, built.params);
 }
 
+bool SearchEngine::isUnfiltered(const SearchQuery& query) {
+    return query.text.empty() && !query.contentType && !query.extension &&
+           !query.folderId && !query.dateFrom && !query.dateTo &&
+           !query.minSize && !query.maxSize && !query.visibility &&
+           query.includeRemote && query.tags.empty() && query.excludeTags.empty();
+}
+
+std::vector<FacetCount> SearchEngine::facetCounts(const SearchQuery& query, FacetKind kind, int limit) {
+    if (!m_facets || !m_facets->isBuilt()) {
+        spdlog::warn("facetCounts: facet index is not available");
+        return {};
+    }
+
+    // Без фильтров — счётчики по всему индексу, без SQL
+    if (isUnfiltered(query)) {
+        return m_facets->facetCounts(kind, nullptr, limit);
+    }
+
+    auto built = buildSearchQuery(query, SearchQueryMode::LocalIds);
+    auto ids = m_db->queryDynamic<uint32_t>(
+        built.sql,
+        [](sqlite3_stmt* stmt) {
+            return static_cast<uint32_t>(Database::getInt64(stmt, 0));
+        },
+        built.params
+    );
+
+    RoaringBitmap matches = RoaringBitmap::fromValues(ids);
+    return m_facets->facetCounts(kind, &matches, limit);
+}
+
 std::vector<std::string> SearchEngine::suggest(const std::string& prefix, int limit) {
     if (prefix.empty()) {
         return {};
     }
 
+    noteActivity();
+    if (m_suggest && m_suggest->isBuilt()) {
+        return m_suggest->suggest(prefix, limit);
+    }
+
     std::string escapedPrefix = escapeFtsQuery(prefix);
 
     // Suggest from both tables?
@@ -332,22 +564,49 @@ std::vector<std::string> SearchEngine::suggest(const std::string& prefix, int li
 }
 
 std::string SearchEngine::generateSnippet(int64_t fileId, const std::string& query) {
+    auto snippets = generateSnippets({fileId}, query);
+    auto it = snippets.find(fileId);
+    return it != snippets.end() ? it->second : "";
+}
+
+std::unordered_map<int64_t, std::string> SearchEngine::generateSnippets(
+    const std::vector<int64_t>& fileIds, const std::string& query) {
     // Only works for local files currently as we need to know the table
     // and this function assumes files_fts
-    auto result = m_db->queryOne<std::string>(
-        R"SQL(
-        SELECT snippet(files_fts, 2, '<b>', '</b>', '...', 32)
-        FROM files_fts
-        WHERE rowid = ? AND files_fts MATCH ?
-        )SQL",
-        [](sqlite3_stmt* stmt) {
-            return Database::getString(stmt, 0);
-        },
-        fileId,
-        escapeFtsQuery(query) + "*"
-    );
+    std::unordered_map<int64_t, std::string> result;
+    if (fileIds.empty() || query.empty()) {
+        return result;
+    }
 
-    return result.value_or("");
+    // Пачками, чтобы не упереться в лимит параметров SQLite
+    constexpr size_t kBatchSize = 500;
+    for (size_t start = 0; start < fileIds.size(); start += kBatchSize) {
+        size_t end = std::min(start + kBatchSize, fileIds.size());
+
+        std::ostringstream sql;
+        sql << "SELECT rowid, snippet(files_fts, 1, '<b>', '</b>', '...', 32) "
+               "FROM files_fts WHERE files_fts MATCH ? AND rowid IN (";
+        std::vector<SqlParam> params;
+        params.push_back(escapeFtsQuery(query) + "*");
+        for (size_t i = start; i < end; ++i) {
+            sql << (i > start ? ",?" : "?");
+            params.push_back(fileIds[i]);
+        }
+        sql << ")";
+
+        auto rows = m_db->queryDynamic<std::pair<int64_t, std::string>>(
+            sql.str(),
+            [](sqlite3_stmt* stmt) {
+                return std::make_pair(Database::getInt64(stmt, 0), Database::getString(stmt, 1));
+            },
+            params
+        );
+        for (auto& [id, snippet] : rows) {
+            result.emplace(id, std::move(snippet));
+        }
+    }
+
+    return result;
 }
 
 std::vector<FileRecord> SearchEngine::getByExtension(const std::string& ext, int limit) {
@@ -355,65 +614,15 @@ std::vector<FileRecord> SearchEngine::getByExtension(const std::string& ext, int
     std::transform(lowerExt.begin(), lowerExt.end(), lowerExt.begin(),
                    [](unsigned char c) { return std::tolower(c); });
 
-    return m_db->query<FileRecord>(
-        R"SQL(
-        SELECT f.id, f.folder_id, f.relative_path, wf.path as folder_path,
-               f.name, f.extension, f.size, f.mime_type, f.content_type,
-               f.checksum, f.created_at, f.modified_at, f.indexed_at,
-               COALESCE(f.visibility, wf.visibility) as visibility,
-               f.source_device_id, f.is_remote, f.sync_version, f.last_modified_by,
-               NULL, NULL, NULL, NULL
-        FROM files f
-        JOIN watched_folders wf ON f.folder_id = wf.id
-        WHERE LOWER(f.extension) = ?
-        ORDER BY f.modified_at DESC
-        LIMIT ?
-        )SQL",
-        mapFileRecord,
-        lowerExt, limit
-    );
+    return m_db->select<FilesByExtension>(lowerExt, limit);
 }
 
 std::vector<FileRecord> SearchEngine::getByContentType(ContentType type, int limit) {
-    return m_db->query<FileRecord>(
-        R"SQL(
-        SELECT f.id, f.folder_id, f.relative_path, wf.path as folder_path,
-               f.name, f.extension, f.size, f.mime_type, f.content_type,
-               f.checksum, f.created_at, f.modified_at, f.indexed_at,
-               COALESCE(f.visibility, wf.visibility) as visibility,
-               f.source_device_id, f.is_remote, f.sync_version, f.last_modified_by,
-               NULL, NULL, NULL, NULL
-        FROM files f
-        JOIN watched_folders wf ON f.folder_id = wf.id
-        WHERE f.content_type = ?
-        ORDER BY f.modified_at DESC
-        LIMIT ?
-        )SQL",
-        mapFileRecord,
-        static_cast<int>(type), limit
-    );
+    return m_db->select<FilesByContentType>(static_cast<int>(type), limit);
 }
 
 std::vector<FileRecord> SearchEngine::getByTag(const std::string& tag, int limit) {
-    return m_db->query<FileRecord>(
-        R"SQL(
-        SELECT f.id, f.folder_id, f.relative_path, wf.path as folder_path,
-               f.name, f.extension, f.size, f.mime_type, f.content_type,
-               f.checksum, f.created_at, f.modified_at, f.indexed_at,
-               COALESCE(f.visibility, wf.visibility) as visibility,
-               f.source_device_id, f.is_remote, f.sync_version, f.last_modified_by,
-               NULL, NULL, NULL, NULL
-        FROM files f
-        JOIN watched_folders wf ON f.folder_id = wf.id
-        JOIN file_tags ft ON ft.file_id = f.id
-        JOIN tags t ON ft.tag_id = t.id
-        WHERE t.name = ?
-        ORDER BY f.modified_at DESC
-        LIMIT ?
-        )SQL",
-        mapFileRecord,
-        tag, limit
-    );
+    return m_db->select<FilesByTag>(tag, limit);
 }
 
 SearchResult SearchEngine::mapSearchResult(sqlite3_stmt* stmt) {
@@ -423,32 +632,30 @@ SearchResult SearchEngine::mapSearchResult(sqlite3_stmt* stmt) {
     return r;
 }
 
-SearchResultCompact SearchEngine::mapSearchResultCompact(sqlite3_stmt* stmt) {
-    SearchResultCompact r;
-    r.file.id = Database::getInt64(stmt, 0);
-    r.file.folderId = Database::getInt64(stmt, 1);
-    r.file.relativePath = Database::getString(stmt, 2);
-    r.file.folderPath = Database::getString(stmt, 3);
-    r.file.name = Database::getString(stmt, 4);
-    r.file.extension = Database::getString(stmt, 5);
-    r.file.size = Database::getInt64(stmt, 6);
+FileRecordCompactView SearchEngine::mapFileRecordCompactView(sqlite3_stmt* stmt, StringArena& arena) {
+    FileRecordCompactView r;
+    r.id = Database::getInt64(stmt, 0);
+    r.folderId = Database::getInt64(stmt, 1);
+    r.relativePath = arena.store(Database::getStringView(stmt, 2));
+    r.folderPath = arena.intern(Database::getStringView(stmt, 3));
+    r.name = arena.store(Database::getStringView(stmt, 4));
+    r.extension = arena.intern(Database::getStringView(stmt, 5));
+    r.size = Database::getInt64(stmt, 6);
     // Skip column 7 (mime_type)
-    r.file.contentType = static_cast<ContentType>(Database::getInt(stmt, 8));
+    r.contentType = static_cast<ContentType>(Database::getInt(stmt, 8));
     // Skip columns 9-10 (checksum, created_at)
-    r.file.modifiedAt = Database::getInt64(stmt, 11);
+    r.modifiedAt = Database::getInt64(stmt, 11);
     // Skip columns 12-14 (indexed_at, visibility, source_device_id)
-    r.file.isRemote = Database::getInt(stmt, 15) != 0;
+    r.isRemote = Database::getInt(stmt, 15) != 0;
     // Skip columns 16-17 (sync_version, last_modified_by)
-    // 18-21 (cloud info)
-    r.score = Database::getDouble(stmt, 22);
+    // 18-21 (cloud info), 22 (score) читает вызывающий
     
     // Determine hasThumbnail
     // Use thumbnailUrl if available (col 21), or check contentType for local files
-    std::string thumbUrl = Database::getString(stmt, 21);
-    if (!thumbUrl.empty()) {
-        r.file.hasThumbnail = true;
+    if (!Database::getStringView(stmt, 21).empty()) {
+        r.hasThumbnail = true;
     } else {
-        r.file.hasThumbnail = r.file.contentType == ContentType::Image;
+        r.hasThumbnail = r.contentType == ContentType::Image;
     }
     
     return r;
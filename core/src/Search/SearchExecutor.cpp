@@ -0,0 +1,162 @@
+#include "familyvault/SearchExecutor.h"
+#include <spdlog/spdlog.h>
+
+namespace FamilyVault {
+
+namespace {
+
+/// Как часто SQLite проверяет отмену (инструкций VM). ~1000 — доли миллисекунды
+constexpr int kProgressInstructions = 1000;
+
+} // namespace
+
+SearchExecutor::SearchExecutor(const std::string& dbPath,
+                               std::shared_ptr<FacetIndex> facets,
+                               std::shared_ptr<SuggestIndex> suggest,
+                               std::shared_ptr<MaintenanceScheduler> maintenance)
+    : m_db(std::make_shared<Database>(dbPath))
+    , m_engine(m_db) {
+    m_engine.setFacetIndex(std::move(facets));
+    m_engine.setSuggestIndex(std::move(suggest));
+    m_engine.setMaintenanceScheduler(std::move(maintenance));
+
+    // Обработчик вызывается в потоке исполнителя — там же, где меняется m_activeCancelled
+    m_db->setProgressHandler(kProgressInstructions, [this]() {
+        return m_activeCancelled && m_activeCancelled->load(std::memory_order_relaxed);
+    });
+
+    m_worker = std::thread(&SearchExecutor::workerThread, this);
+}
+
+SearchExecutor::~SearchExecutor() {
+    cancelAll();
+    {
+        std::lock_guard lock(m_mutex);
+        m_stopRequested = true;
+    }
+    m_condition.notify_all();
+    if (m_worker.joinable()) {
+        m_worker.join();
+    }
+}
+
+// ═══════════════════════════════════════════════════════════
+// Очередь
+// ═══════════════════════════════════════════════════════════
+
+uint64_t SearchExecutor::submit(const SearchQuery& query, PageCallback callback) {
+    uint64_t id;
+    {
+        std::lock_guard lock(m_mutex);
+        id = m_nextId++;
+        m_queue.push_back(Request{id, query, std::move(callback),
+                                  std::make_shared<std::atomic<bool>>(false)});
+    }
+    m_condition.notify_one();
+    return id;
+}
+
+bool SearchExecutor::cancel(uint64_t requestId) {
+    std::lock_guard lock(m_mutex);
+    if (requestId == m_activeId && m_activeCancelled) {
+        m_activeCancelled->store(true);
+        return true;
+    }
+    for (auto& request : m_queue) {
+        if (request.id == requestId) {
+            request.cancelled->store(true);
+            return true;
+        }
+    }
+    return false;
+}
+
+void SearchExecutor::cancelAll() {
+    std::lock_guard lock(m_mutex);
+    if (m_activeCancelled) {
+        m_activeCancelled->store(true);
+    }
+    for (auto& request : m_queue) {
+        request.cancelled->store(true);
+    }
+}
+
+size_t SearchExecutor::pendingCount() const {
+    std::lock_guard lock(m_mutex);
+    return m_queue.size() + (m_activeCancelled ? 1 : 0);
+}
+
+// ═══════════════════════════════════════════════════════════
+// Выполнение
+// ═══════════════════════════════════════════════════════════
+
+void SearchExecutor::workerThread() {
+    while (true) {
+        Request request;
+        {
+            std::unique_lock lock(m_mutex);
+            m_condition.wait(lock, [this] { return m_stopRequested || !m_queue.empty(); });
+            if (m_queue.empty()) {
+                return;  // Остановка; очередь уже пуста
+            }
+            request = std::move(m_queue.front());
+            m_queue.pop_front();
+            m_activeId = request.id;
+            m_activeCancelled = request.cancelled;
+        }
+
+        SearchPage page = run(request);
+
+        // Запрос завершён до callback: cancel() из callback уже вернёт false
+        {
+            std::lock_guard lock(m_mutex);
+            m_activeId = 0;
+            m_activeCancelled.reset();
+        }
+
+        deliver(request, std::move(page));
+    }
+}
+
+SearchPage SearchExecutor::run(const Request& request) {
+    SearchPage page;
+    page.requestId = request.id;
+
+    // Отменённые в очереди не выполняются, но callback получают
+    if (request.cancelled->load()) {
+        page.status = SearchRequestStatus::Cancelled;
+        return page;
+    }
+
+    try {
+        page.results = m_engine.searchCompact(request.query);
+        page.status = SearchRequestStatus::Completed;
+    } catch (const std::exception& e) {
+        // Прерывание progress handler приходит как ошибка SQLite
+        if (request.cancelled->load()) {
+            page.status = SearchRequestStatus::Cancelled;
+        } else {
+            page.status = SearchRequestStatus::Failed;
+            page.error = e.what();
+            spdlog::warn("Async search {} failed: {}", request.id, e.what());
+        }
+    }
+
+    // Отмена после завершения запроса: результаты уже не нужны
+    if (page.status == SearchRequestStatus::Completed && request.cancelled->load()) {
+        page.status = SearchRequestStatus::Cancelled;
+        page.results.clear();
+    }
+    return page;
+}
+
+void SearchExecutor::deliver(const Request& request, SearchPage page) {
+    if (!request.callback) return;
+    try {
+        request.callback(page);
+    } catch (const std::exception& e) {
+        spdlog::error("Async search callback threw: {}", e.what());
+    }
+}
+
+} // namespace FamilyVault
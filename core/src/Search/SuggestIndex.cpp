@@ -0,0 +1,346 @@
+#include "familyvault/SuggestIndex.h"
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <mutex>
+#include <queue>
+
+namespace FamilyVault {
+
+namespace {
+
+/// Минимальная длина термина (в кодовых точках)
+constexpr size_t kMinTermLength = 2;
+
+/// Префиксы до этой длины (в кодовых точках) ранжируются по частоте заранее
+constexpr size_t kRankedPrefixLength = 2;
+
+/// Разделитель слов: любой ASCII символ кроме букв и цифр.
+/// Байты >= 0x80 (UTF-8) считаются частью слова.
+bool isSeparator(unsigned char c) {
+    return c < 0x80 && !std::isalnum(c);
+}
+
+size_t codepointCount(const std::string& text) {
+    size_t count = 0;
+    for (unsigned char c : text) {
+        if ((c & 0xC0) != 0x80) ++count;
+    }
+    return count;
+}
+
+/// Длина в байтах первых count кодовых точек
+size_t prefixBytes(const std::string& text, size_t count) {
+    size_t i = 0;
+    for (size_t seen = 0; i < text.size(); ++i) {
+        if ((static_cast<unsigned char>(text[i]) & 0xC0) != 0x80 && seen++ == count) break;
+    }
+    return i;
+}
+
+int64_t nowSeconds() {
+    return std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+SuggestIndex::SuggestIndex(std::shared_ptr<Database> db)
+    : m_db(std::move(db)) {
+}
+
+SuggestIndex::~SuggestIndex() = default;
+
+// ═══════════════════════════════════════════════════════════
+// Построение
+// ═══════════════════════════════════════════════════════════
+
+void SuggestIndex::rebuild() {
+    auto startTime = std::chrono::steady_clock::now();
+
+    struct NameRow {
+        int64_t id;
+        std::string name;
+        int64_t modifiedAt;
+    };
+    auto mapRow = [](sqlite3_stmt* stmt) {
+        return NameRow{
+            Database::getInt64(stmt, 0),
+            Database::getString(stmt, 1),
+            Database::getInt64(stmt, 2)
+        };
+    };
+
+    // Блокировка берётся до чтения, как в FacetIndex::rebuild: addFile/removeFile,
+    // пришедшие во время перестройки, ждут её и применяются поверх, а не
+    // теряются и не считаются дважды
+    std::unique_lock lock(m_mutex);
+
+    auto localFiles = m_db->query<NameRow>(
+        "SELECT id, name, COALESCE(modified_at, 0) FROM files", mapRow);
+    auto cloudFiles = m_db->query<NameRow>(
+        "SELECT id, name, COALESCE(modified_at, 0) FROM cloud_files", mapRow);
+
+    m_terms.clear();
+    m_byPrefix.clear();
+    m_localFiles.clear();
+    m_cloudFiles.clear();
+
+    for (const auto& f : localFiles) {
+        if (!RoaringBitmap::fits(f.id)) continue;
+        m_localFiles.add(static_cast<uint32_t>(f.id));
+        addTermsLocked(f.name, f.modifiedAt);
+    }
+    for (const auto& f : cloudFiles) {
+        if (!RoaringBitmap::fits(f.id)) continue;
+        m_cloudFiles.add(static_cast<uint32_t>(f.id));
+        addTermsLocked(f.name, f.modifiedAt);
+    }
+
+    m_built = true;
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - startTime).count();
+    spdlog::info("SuggestIndex built: {} terms from {} files in {} ms",
+                 m_terms.size(), localFiles.size() + cloudFiles.size(), elapsed);
+}
+
+bool SuggestIndex::isBuilt() const {
+    std::shared_lock lock(m_mutex);
+    return m_built;
+}
+
+// ═══════════════════════════════════════════════════════════
+// Инкрементальное обновление
+// ═══════════════════════════════════════════════════════════
+
+void SuggestIndex::addFile(SuggestSource source, int64_t fileId, const std::string& name,
+                           int64_t timestamp) {
+    if (!RoaringBitmap::fits(fileId)) return;
+    auto id = static_cast<uint32_t>(fileId);
+
+    std::unique_lock lock(m_mutex);
+    auto& files = filesOf(source);
+
+    if (!files.contains(id)) {
+        files.add(id);
+        addTermsLocked(name, timestamp);
+        return;
+    }
+
+    // Повторное сканирование: термины уже посчитаны, обновляем только свежесть
+    for (const auto& term : tokenize(name)) {
+        auto it = m_terms.find(term);
+        if (it != m_terms.end()) {
+            it->second.lastSeen = std::max(it->second.lastSeen, timestamp);
+        }
+    }
+}
+
+void SuggestIndex::removeFile(SuggestSource source, int64_t fileId, const std::string& name) {
+    if (!RoaringBitmap::fits(fileId)) return;
+
+    std::unique_lock lock(m_mutex);
+    if (!filesOf(source).remove(static_cast<uint32_t>(fileId))) return;
+
+    for (const auto& term : tokenize(name)) {
+        auto it = m_terms.find(term);
+        if (it == m_terms.end()) continue;
+        uint32_t count = it->second.fileCount;
+        rerankLocked(it->first, count, count - 1);
+        if (count <= 1) {
+            m_terms.erase(it);
+        } else {
+            --it->second.fileCount;
+        }
+    }
+}
+
+void SuggestIndex::addTermsLocked(const std::string& name, int64_t timestamp) {
+    for (auto& term : tokenize(name)) {
+        auto it = m_terms.try_emplace(std::move(term)).first;
+        auto& stats = it->second;
+        rerankLocked(it->first, stats.fileCount, stats.fileCount + 1);
+        ++stats.fileCount;
+        stats.lastSeen = std::max(stats.lastSeen, timestamp);
+    }
+}
+
+void SuggestIndex::rerankLocked(const std::string& term, uint32_t oldCount, uint32_t newCount) {
+    for (size_t length = 1; length <= kRankedPrefixLength; ++length) {
+        size_t bytes = prefixBytes(term, length);
+        std::string prefix = term.substr(0, bytes);
+        auto bucket = m_byPrefix.find(prefix);
+        if (bucket == m_byPrefix.end()) {
+            if (newCount == 0) continue;
+            bucket = m_byPrefix.try_emplace(std::move(prefix)).first;
+        }
+        if (oldCount > 0) {
+            bucket->second.erase(RankedTerm{oldCount, &term});
+        }
+        if (newCount > 0) {
+            bucket->second.insert(RankedTerm{newCount, &term});
+        } else if (bucket->second.empty()) {
+            m_byPrefix.erase(bucket);
+        }
+        // Термин короче следующего префикса — длиннее списков у него нет
+        if (bytes == term.size()) break;
+    }
+}
+
+RoaringBitmap& SuggestIndex::filesOf(SuggestSource source) {
+    return source == SuggestSource::Cloud ? m_cloudFiles : m_localFiles;
+}
+
+// ═══════════════════════════════════════════════════════════
+// Запросы
+// ═══════════════════════════════════════════════════════════
+
+std::vector<std::string> SuggestIndex::suggest(const std::string& prefix, int limit) const {
+    if (limit <= 0) return {};
+
+    // Дополняем последнее слово, начало запроса возвращаем как есть
+    size_t wordStart = prefix.size();
+    while (wordStart > 0 && !isSeparator(static_cast<unsigned char>(prefix[wordStart - 1]))) {
+        --wordStart;
+    }
+    std::string head = prefix.substr(0, wordStart);
+    std::string fragment = toLowerUtf8(prefix.substr(wordStart));
+    if (fragment.empty()) return {};
+
+    const int64_t now = nowSeconds();
+
+    // Лучшие limit кандидатов; на вершине кучи — худший из них
+    using Candidate = std::pair<double, const std::string*>;
+    auto better = [](const Candidate& a, const Candidate& b) {
+        if (a.first != b.first) return a.first > b.first;
+        return *a.second < *b.second;
+    };
+    std::priority_queue<Candidate, std::vector<Candidate>, decltype(better)> best(better);
+    auto offer = [&](double value, const std::string* term) {
+        Candidate candidate{value, term};
+        if (best.size() < static_cast<size_t>(limit)) {
+            best.push(candidate);
+        } else if (better(candidate, best.top())) {
+            best.pop();
+            best.push(candidate);
+        }
+    };
+
+    std::shared_lock lock(m_mutex);
+
+    if (codepointCount(fragment) <= kRankedPrefixLength) {
+        // Короткий префикс: термины по убыванию частоты, ранг не больше
+        // 2 * fileCount — дальше худшего из найденных обход не идёт
+        auto bucket = m_byPrefix.find(fragment);
+        if (bucket != m_byPrefix.end()) {
+            for (const auto& ranked : bucket->second) {
+                if (best.size() == static_cast<size_t>(limit) &&
+                    2.0 * ranked.fileCount < best.top().first) {
+                    break;
+                }
+                offer(score(m_terms.find(*ranked.term)->second, now), ranked.term);
+            }
+        }
+    } else {
+        // Префикс — непрерывный диапазон упорядоченного словаря
+        for (auto it = m_terms.lower_bound(fragment);
+             it != m_terms.end() && it->first.compare(0, fragment.size(), fragment) == 0;
+             ++it) {
+            offer(score(it->second, now), &it->first);
+        }
+    }
+
+    std::vector<Candidate> ranked;
+    ranked.reserve(best.size());
+    for (; !best.empty(); best.pop()) {
+        ranked.push_back(best.top());
+    }
+    std::sort(ranked.begin(), ranked.end(), better);
+
+    std::vector<std::string> result;
+    result.reserve(ranked.size());
+    for (const auto& candidate : ranked) {
+        result.push_back(head + *candidate.second);
+    }
+    return result;
+}
+
+size_t SuggestIndex::termCount() const {
+    std::shared_lock lock(m_mutex);
+    return m_terms.size();
+}
+
+// ═══════════════════════════════════════════════════════════
+// Helpers
+// ═══════════════════════════════════════════════════════════
+
+std::vector<std::string> SuggestIndex::tokenize(const std::string& name) {
+    // Расширение не подсказываем — по нему есть фасет
+    size_t dot = name.rfind('.');
+    std::string stem = toLowerUtf8(dot != std::string::npos && dot > 0 ? name.substr(0, dot) : name);
+
+    std::vector<std::string> terms;
+    size_t start = 0;
+    for (size_t i = 0; i <= stem.size(); ++i) {
+        if (i == stem.size() || isSeparator(static_cast<unsigned char>(stem[i]))) {
+            if (i > start) {
+                std::string term = stem.substr(start, i - start);
+                if (codepointCount(term) >= kMinTermLength) {
+                    terms.push_back(std::move(term));
+                }
+            }
+            start = i + 1;
+        }
+    }
+
+    std::sort(terms.begin(), terms.end());
+    terms.erase(std::unique(terms.begin(), terms.end()), terms.end());
+    return terms;
+}
+
+double SuggestIndex::score(const TermStats& stats, int64_t now) {
+    double ageDays = std::max<int64_t>(0, now - stats.lastSeen) / 86400.0;
+    return stats.fileCount * (1.0 + 1.0 / (1.0 + ageDays / 30.0));
+}
+
+std::string SuggestIndex::toLowerUtf8(const std::string& text) {
+    std::string result;
+    result.reserve(text.size());
+
+    for (size_t i = 0; i < text.size(); ++i) {
+        unsigned char c = static_cast<unsigned char>(text[i]);
+        if (c < 0x80) {
+            result += static_cast<char>(std::tolower(c));
+            continue;
+        }
+
+        // Кириллица: А-П (D0 90-9F) → а-п (D0 B0-BF), Р-Я (D0 A0-AF) → р-я (D1 80-8F), Ё → ё
+        if (c == 0xD0 && i + 1 < text.size()) {
+            unsigned char next = static_cast<unsigned char>(text[i + 1]);
+            if (next >= 0x90 && next <= 0x9F) {
+                result += static_cast<char>(0xD0);
+                result += static_cast<char>(next + 0x20);
+                ++i;
+                continue;
+            }
+            if (next >= 0xA0 && next <= 0xAF) {
+                result += static_cast<char>(0xD1);
+                result += static_cast<char>(next - 0x20);
+                ++i;
+                continue;
+            }
+            if (next == 0x81) {
+                result += static_cast<char>(0xD1);
+                result += static_cast<char>(0x91);
+                ++i;
+                continue;
+            }
+        }
+        result += static_cast<char>(c);
+    }
+    return result;
+}
+
+} // namespace FamilyVault
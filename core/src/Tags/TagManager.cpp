@@ -12,7 +12,26 @@ TagManager::TagManager(std::shared_ptr<Database> db)
 
 TagManager::~TagManager() = default;
 
+void TagManager::setFacetIndex(std::shared_ptr<FacetIndex> facets) {
+    m_facets = std::move(facets);
+}
+
+const FacetIndex* TagManager::builtFacets() const {
+    return (m_facets && m_facets->isBuilt()) ? m_facets.get() : nullptr;
+}
+
 int64_t TagManager::getOrCreateTag(const std::string& name, TagSource source) {
+    bool created = false;
+    int64_t tagId = findOrInsertTag(name, source, created);
+    if (created && m_facets) {
+        m_facets->registerTag(tagId, name, source);
+    }
+    return tagId;
+}
+
+int64_t TagManager::findOrInsertTag(const std::string& name, TagSource source, bool& created) {
+    created = false;
+
     // Пробуем найти существующий
     auto existing = m_db->queryOne<int64_t>(
         "SELECT id FROM tags WHERE name = ?",
@@ -27,6 +46,7 @@ int64_t TagManager::getOrCreateTag(const std::string& name, TagSource source) {
     // Создаём новый
     m_db->execute("INSERT INTO tags (name, source) VALUES (?, ?)",
                   name, static_cast<int>(source));
+    created = true;
     return m_db->lastInsertId();
 }
 
@@ -38,6 +58,10 @@ void TagManager::addTag(int64_t fileId, const std::string& tag, TagSource source
         "INSERT OR IGNORE INTO file_tags (file_id, tag_id) VALUES (?, ?)",
         fileId, tagId
     );
+
+    if (m_facets) {
+        m_facets->addFileTag(fileId, tagId);
+    }
 }
 
 void TagManager::removeTag(int64_t fileId, const std::string& tag) {
@@ -49,6 +73,10 @@ void TagManager::removeTag(int64_t fileId, const std::string& tag) {
         )SQL",
         fileId, tag
     );
+
+    if (m_facets) {
+        m_facets->removeFileTag(fileId, tag);
+    }
 }
 
 std::vector<std::string> TagManager::getFileTags(int64_t fileId) const {
@@ -153,6 +181,10 @@ void TagManager::generateAutoTags(int64_t fileId, const FileRecord& file) {
 }
 
 std::vector<Tag> TagManager::getAllTags() const {
+    if (auto* facets = builtFacets()) {
+        return facets->getAllTags();
+    }
+
     return m_db->query<Tag>(
         R"SQL(
         SELECT t.id, t.name, t.source, COUNT(ft.file_id) as file_count
@@ -166,6 +198,10 @@ std::vector<Tag> TagManager::getAllTags() const {
 }
 
 std::vector<Tag> TagManager::getPopularTags(int limit) const {
+    if (auto* facets = builtFacets()) {
+        return facets->getPopularTags(limit);
+    }
+
     return m_db->query<Tag>(
         R"SQL(
         SELECT t.id, t.name, t.source, COUNT(ft.file_id) as file_count
@@ -200,7 +236,10 @@ std::vector<Tag> TagManager::searchTags(const std::string& prefix) const {
 void TagManager::addTagToFiles(const std::vector<int64_t>& fileIds, const std::string& tag) {
     Database::Transaction tx(*m_db);
 
-    int64_t tagId = getOrCreateTag(tag, TagSource::User);
+    // Новый тег попадает в индекс фасетов только после commit: при откате
+    // строки тега нет, а индекс отвечает на getAllTags/getPopularTags
+    bool created = false;
+    int64_t tagId = findOrInsertTag(tag, TagSource::User, created);
 
     for (int64_t fileId : fileIds) {
         m_db->execute(
@@ -210,6 +249,15 @@ void TagManager::addTagToFiles(const std::vector<int64_t>& fileIds, const std::s
     }
 
     tx.commit();
+
+    if (m_facets) {
+        if (created) {
+            m_facets->registerTag(tagId, tag, TagSource::User);
+        }
+        for (int64_t fileId : fileIds) {
+            m_facets->addFileTag(fileId, tagId);
+        }
+    }
     spdlog::info("Added tag '{}' to {} files", tag, fileIds.size());
 }
 
@@ -228,6 +276,12 @@ void TagManager::removeTagFromFiles(const std::vector<int64_t>& fileIds, const s
     }
 
     tx.commit();
+
+    if (m_facets) {
+        for (int64_t fileId : fileIds) {
+            m_facets->removeFileTag(fileId, tag);
+        }
+    }
 }
 
 std::vector<FileRecord> TagManager::getFilesByTag(const std::string& tag, int limit, int offset) const {
@@ -271,6 +325,10 @@ std::vector<FileRecord> TagManager::getFilesByTag(const std::string& tag, int li
 }
 
 int64_t TagManager::countFilesByTag(const std::string& tag) const {
+    if (auto* facets = builtFacets()) {
+        return facets->countFilesByTag(tag);
+    }
+
     return m_db->queryScalar(
         "SELECT COUNT(*) FROM file_tags ft JOIN tags t ON ft.tag_id = t.id WHERE t.name = ?",
         tag
@@ -1,470 +1,379 @@
 #include "familyvault/TextExtractor.h"
+#include "familyvault/TextNormalizer.h"
+#include "familyvault/XmlStreamReader.h"
 #include <spdlog/spdlog.h>
 
 #include <zip.h>
-#include <pugixml.hpp>
 
 #include <algorithm>
-#include <sstream>
+#include <cstdlib>
 #include <vector>
 
 namespace FamilyVault {
 
-// ═══════════════════════════════════════════════════════════
-// OfficeTextExtractor
-// ═══════════════════════════════════════════════════════════
+namespace {
 
-OfficeTextExtractor::OfficeTextExtractor() = default;
-OfficeTextExtractor::~OfficeTextExtractor() = default;
+/// Размер порции распаковки: память на документ не зависит от размера записей
+constexpr size_t kInflateChunk = 64 * 1024;
 
-bool OfficeTextExtractor::canHandle(const std::string& mimeType) const {
-    static const std::vector<std::string> supported = {
-        // Microsoft Office OpenXML
-        "application/vnd.openxmlformats-officedocument.wordprocessingml.document",     // docx
-        "application/vnd.openxmlformats-officedocument.spreadsheetml.sheet",           // xlsx
-        "application/vnd.openxmlformats-officedocument.presentationml.presentation",   // pptx
-        // OpenDocument Format
-        "application/vnd.oasis.opendocument.text",          // odt
-        "application/vnd.oasis.opendocument.spreadsheet",   // ods
-        "application/vnd.oasis.opendocument.presentation",  // odp
-    };
-    
-    return std::find(supported.begin(), supported.end(), mimeType) != supported.end();
-}
+// ═══════════════════════════════════════════════════════════
+// ZIP-архив: открывается один раз на документ
+// ═══════════════════════════════════════════════════════════
 
-std::optional<ExtractionResult> OfficeTextExtractor::extract(const std::string& filePath) {
-    std::string ext = getExtension(filePath);
-    
-    if (ext == "docx") {
-        return extractDocx(filePath);
-    } else if (ext == "xlsx") {
-        return extractXlsx(filePath);
-    } else if (ext == "pptx") {
-        return extractPptx(filePath);
-    } else if (ext == "odt") {
-        return extractOdt(filePath);
-    } else if (ext == "ods") {
-        return extractOds(filePath);
-    } else if (ext == "odp") {
-        // ODP похож на ODS, используем тот же подход
-        return extractOds(filePath);
+class ZipArchive {
+public:
+    explicit ZipArchive(const std::string& path) {
+        int err = 0;
+        m_archive = zip_open(path.c_str(), ZIP_RDONLY, &err);
+        m_error = err;
     }
-    
-    spdlog::warn("OfficeTextExtractor: unknown extension '{}'", ext);
-    return std::nullopt;
-}
 
-std::string OfficeTextExtractor::getExtension(const std::string& filePath) const {
-    auto dotPos = filePath.rfind('.');
-    if (dotPos == std::string::npos) {
-        return "";
+    ~ZipArchive() {
+        if (m_archive) zip_discard(m_archive);
     }
-    std::string ext = filePath.substr(dotPos + 1);
-    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
-    return ext;
-}
 
-std::string OfficeTextExtractor::readZipEntry(const std::string& archivePath,
-                                              const std::string& entryName) {
-    int err = 0;
-    zip_t* archive = zip_open(archivePath.c_str(), ZIP_RDONLY, &err);
-    if (!archive) {
-        spdlog::warn("OfficeTextExtractor: failed to open archive '{}', error: {}", 
-                    archivePath, err);
-        return "";
-    }
-    
-    // RAII wrapper для автоматического закрытия архива
-    struct ZipGuard {
-        zip_t* archive;
-        ~ZipGuard() { if (archive) zip_close(archive); }
-    } guard{archive};
-    
-    // Находим файл в архиве
-    zip_int64_t index = zip_name_locate(archive, entryName.c_str(), 0);
-    if (index < 0) {
-        // Файл не найден - это может быть нормально (например, нет headers)
-        return "";
-    }
-    
-    // Получаем информацию о файле
-    zip_stat_t stat;
-    if (zip_stat_index(archive, index, 0, &stat) != 0) {
-        spdlog::warn("OfficeTextExtractor: failed to stat '{}' in '{}'", 
-                    entryName, archivePath);
-        return "";
-    }
-    
-    // Открываем файл для чтения
-    zip_file_t* file = zip_fopen_index(archive, index, 0);
-    if (!file) {
-        spdlog::warn("OfficeTextExtractor: failed to open '{}' in '{}'", 
-                    entryName, archivePath);
-        return "";
-    }
-    
-    // RAII для файла
-    struct FileGuard {
-        zip_file_t* file;
-        ~FileGuard() { if (file) zip_fclose(file); }
-    } fileGuard{file};
-    
-    // Читаем содержимое
-    std::string content;
-    content.resize(stat.size);
-    
-    zip_int64_t bytesRead = zip_fread(file, content.data(), stat.size);
-    if (bytesRead < 0 || static_cast<zip_uint64_t>(bytesRead) != stat.size) {
-        spdlog::warn("OfficeTextExtractor: failed to read '{}' from '{}'", 
-                    entryName, archivePath);
-        return "";
-    }
-    
-    return content;
-}
+    ZipArchive(const ZipArchive&) = delete;
+    ZipArchive& operator=(const ZipArchive&) = delete;
 
-std::string OfficeTextExtractor::extractTextFromXml(const std::string& xml,
-                                                    const std::vector<std::string>& textTags) {
-    pugi::xml_document doc;
-    pugi::xml_parse_result result = doc.load_string(xml.c_str());
-    
-    if (!result) {
-        spdlog::warn("OfficeTextExtractor: failed to parse XML: {}", result.description());
-        return "";
+    bool isOpen() const { return m_archive != nullptr; }
+    int error() const { return m_error; }
+
+    bool contains(const char* name) const {
+        return zip_name_locate(m_archive, name, 0) >= 0;
     }
-    
-    std::ostringstream text;
-    
-    // Рекурсивно обходим документ и собираем текст из указанных тегов
-    std::function<void(pugi::xml_node)> extractText = [&](pugi::xml_node node) {
-        for (pugi::xml_node child : node.children()) {
-            std::string nodeName = child.name();
-            
-            // Убираем namespace prefix
-            auto colonPos = nodeName.find(':');
-            if (colonPos != std::string::npos) {
-                nodeName = nodeName.substr(colonPos + 1);
-            }
-            
-            // Проверяем, является ли это текстовым узлом
-            bool isTextNode = false;
-            for (const auto& tag : textTags) {
-                if (nodeName == tag) {
-                    isTextNode = true;
-                    break;
-                }
-            }
-            
-            if (isTextNode) {
-                std::string nodeText = child.text().get();
-                if (!nodeText.empty()) {
-                    text << nodeText;
-                }
+
+    /// Записи вида <prefix><N>.xml по возрастанию N (slide1, slide2, ..., slide10)
+    std::vector<std::string> numberedEntries(std::string_view prefix) const {
+        std::vector<std::pair<long, std::string>> found;
+        zip_int64_t count = zip_get_num_entries(m_archive, 0);
+        for (zip_int64_t i = 0; i < count; ++i) {
+            const char* name = zip_get_name(m_archive, static_cast<zip_uint64_t>(i), 0);
+            if (!name) continue;
+            std::string_view entry(name);
+            if (!entry.starts_with(prefix) || !entry.ends_with(".xml")) continue;
+
+            std::string_view digits = entry.substr(prefix.size(), entry.size() - prefix.size() - 4);
+            if (digits.empty() || digits.size() > 9 ||
+                !std::all_of(digits.begin(), digits.end(), [](char c) { return c >= '0' && c <= '9'; })) {
+                continue;
             }
-            
-            // Рекурсивно обрабатываем детей
-            extractText(child);
-            
-            // Добавляем пробел после параграфа
-            if (nodeName == "p" || nodeName == "br" || nodeName == "row") {
-                text << " ";
+            found.emplace_back(std::strtol(std::string(digits).c_str(), nullptr, 10), std::string(entry));
+        }
+        std::sort(found.begin(), found.end());
+
+        std::vector<std::string> names;
+        names.reserve(found.size());
+        for (auto& [number, name] : found) names.push_back(std::move(name));
+        return names;
+    }
+
+    /// Распаковывать запись порциями в reader, пока sink не заполнен.
+    /// false — записи нет или она повреждена (прочитанное уже передано)
+    bool stream(const std::string& name, XmlStreamReader& reader, NormalizingSink& sink) {
+        zip_file_t* file = zip_fopen(m_archive, name.c_str(), 0);
+        if (!file) {
+            return false;
+        }
+
+        if (m_buffer.empty()) m_buffer.resize(kInflateChunk);
+        bool ok = true;
+        while (!sink.full()) {
+            zip_int64_t bytesRead = zip_fread(file, m_buffer.data(), m_buffer.size());
+            if (bytesRead < 0) {
+                spdlog::warn("OfficeTextExtractor: failed to read '{}'", name);
+                ok = false;
+                break;
             }
+            if (bytesRead == 0) break;
+            reader.feed(std::string_view(m_buffer.data(), static_cast<size_t>(bytesRead)));
         }
-    };
-    
-    extractText(doc);
-    return text.str();
-}
+        zip_fclose(file);
+
+        reader.finish();
+        sink.separator();
+        return ok;
+    }
+
+private:
+    zip_t* m_archive = nullptr;
+    int m_error = 0;
+    std::string m_buffer;
+};
 
 // ═══════════════════════════════════════════════════════════
-// DOCX
+// Обработчики XML
 // ═══════════════════════════════════════════════════════════
 
-std::optional<ExtractionResult> OfficeTextExtractor::extractDocx(const std::string& filePath) {
-    // Основной документ
-    std::string docXml = readZipEntry(filePath, "word/document.xml");
-    if (docXml.empty()) {
-        spdlog::warn("OfficeTextExtractor: no document.xml in DOCX '{}'", filePath);
-        return std::nullopt;
+/// Текст элементов <t>: w:t (DOCX), a:t (PPTX), <si><t> (общие строки XLSX).
+/// Абзацы, переносы и табуляции разделяют слова, соседние <w:r> — нет
+class RunTextHandler final : public XmlStreamReader::Handler {
+public:
+    enum Element { T, P, Br, Tab, Cr, Si };
+
+    explicit RunTextHandler(NormalizingSink& sink)
+        : m_sink(sink)
+        , m_reader({"t", "p", "br", "tab", "cr", "si"}, *this)
+    {
     }
-    
-    // Извлекаем текст из <w:t> элементов (Word text)
-    std::string text = extractTextFromXml(docXml, {"t"});
-    
-    // Опционально: headers и footers
-    // word/header1.xml, word/footer1.xml, etc.
-    for (int i = 1; i <= 3; ++i) {
-        std::string headerXml = readZipEntry(filePath, "word/header" + std::to_string(i) + ".xml");
-        if (!headerXml.empty()) {
-            text += " " + extractTextFromXml(headerXml, {"t"});
+
+    XmlStreamReader& reader() { return m_reader; }
+
+    void startElement(int id, const XmlStreamReader&) override {
+        if (id == T) {
+            ++m_textDepth;
+        } else if (id == Br || id == Tab || id == Cr) {
+            m_sink.separator();
         }
-        
-        std::string footerXml = readZipEntry(filePath, "word/footer" + std::to_string(i) + ".xml");
-        if (!footerXml.empty()) {
-            text += " " + extractTextFromXml(footerXml, {"t"});
+    }
+
+    void endElement(int id) override {
+        if (id == T) {
+            if (m_textDepth > 0) --m_textDepth;
+        } else if (id == P || id == Si) {
+            m_sink.separator();
         }
     }
-    
-    if (text.empty()) {
-        return std::nullopt;
+
+    void text(std::string_view text) override {
+        if (m_textDepth > 0) m_sink.append(text);
     }
-    
-    return ExtractionResult{
-        .text = std::move(text),
-        .method = "docx",
-        .language = "",
-        .confidence = 1.0
-    };
-}
 
-// ═══════════════════════════════════════════════════════════
-// XLSX
-// ═══════════════════════════════════════════════════════════
+private:
+    NormalizingSink& m_sink;
+    XmlStreamReader m_reader;
+    int m_textDepth = 0;
+};
 
-std::optional<ExtractionResult> OfficeTextExtractor::extractXlsx(const std::string& filePath) {
-    // Сначала читаем shared strings (общие строки)
-    std::string sharedStringsXml = readZipEntry(filePath, "xl/sharedStrings.xml");
-    
-    std::vector<std::string> sharedStrings;
-    if (!sharedStringsXml.empty()) {
-        pugi::xml_document ssDoc;
-        if (ssDoc.load_string(sharedStringsXml.c_str())) {
-            // Извлекаем все <si><t>...</t></si>
-            for (auto si : ssDoc.select_nodes("//si")) {
-                std::string str;
-                // Собираем все <t> внутри <si>
-                for (auto t : si.node().select_nodes(".//t")) {
-                    str += t.node().text().get();
-                }
-                sharedStrings.push_back(str);
+/// Значения ячеек листа XLSX, кроме ссылок на общие строки:
+/// числа и строки формул из <v>, встроенные строки из <is><t>
+class SheetHandler final : public XmlStreamReader::Handler {
+public:
+    enum Element { C, V, Is, T, Row };
+
+    explicit SheetHandler(NormalizingSink& sink)
+        : m_sink(sink)
+        , m_reader({"c", "v", "is", "t", "row"}, *this)
+    {
+    }
+
+    XmlStreamReader& reader() { return m_reader; }
+
+    void startElement(int id, const XmlStreamReader& reader) override {
+        switch (id) {
+            case C: {
+                auto type = reader.attribute("t");
+                m_inlineCell = type == "inlineStr";
+                m_valueCell = type.empty() || type == "n" || type == "str";
+                break;
             }
+            case V: m_inValue = m_valueCell; break;
+            case Is: m_inInline = m_inlineCell; break;
+            case T: m_inText = m_inInline; break;
         }
     }
-    
-    std::ostringstream allText;
-    
-    // Читаем листы (sheet1.xml, sheet2.xml, ...)
-    for (int sheetNum = 1; sheetNum <= 50; ++sheetNum) {
-        std::string sheetXml = readZipEntry(filePath, 
-            "xl/worksheets/sheet" + std::to_string(sheetNum) + ".xml");
-        
-        if (sheetXml.empty()) {
-            break;  // Больше листов нет
+
+    void endElement(int id) override {
+        switch (id) {
+            case C:
+                m_valueCell = m_inlineCell = false;
+                m_sink.separator();
+                break;
+            case V: m_inValue = false; break;
+            case Is: m_inInline = false; break;
+            case T: m_inText = false; break;
+            case Row: m_sink.separator(); break;
         }
-        
-        pugi::xml_document sheetDoc;
-        if (!sheetDoc.load_string(sheetXml.c_str())) {
-            continue;
+    }
+
+    void text(std::string_view text) override {
+        if (m_inValue || m_inText) m_sink.append(text);
+    }
+
+private:
+    NormalizingSink& m_sink;
+    XmlStreamReader m_reader;
+    bool m_valueCell = false;
+    bool m_inlineCell = false;
+    bool m_inValue = false;
+    bool m_inInline = false;
+    bool m_inText = false;
+};
+
+/// Весь текст внутри <office:body> (ODT, ODS, ODP): абзацы, заголовки
+/// и ячейки разделяют слова, <text:s/>, <text:tab/> и переносы — тоже
+class OdfHandler final : public XmlStreamReader::Handler {
+public:
+    enum Element { Body, P, H, S, Tab, LineBreak, TableCell };
+
+    explicit OdfHandler(NormalizingSink& sink)
+        : m_sink(sink)
+        , m_reader({"body", "p", "h", "s", "tab", "line-break", "table-cell"}, *this)
+    {
+    }
+
+    XmlStreamReader& reader() { return m_reader; }
+
+    void startElement(int id, const XmlStreamReader&) override {
+        if (id == Body) {
+            m_inBody = true;
+        } else if (id == S || id == Tab || id == LineBreak) {
+            m_sink.separator();
         }
-        
-        // Проходим по ячейкам
-        for (auto cell : sheetDoc.select_nodes("//c")) {
-            pugi::xml_node cellNode = cell.node();
-            std::string cellType = cellNode.attribute("t").as_string();
-            pugi::xml_node valueNode = cellNode.child("v");
-            
-            if (!valueNode) {
-                continue;
-            }
-            
-            std::string value = valueNode.text().get();
-            
-            if (cellType == "s") {
-                // Shared string - индекс в sharedStrings
-                try {
-                    int idx = std::stoi(value);
-                    if (idx >= 0 && idx < static_cast<int>(sharedStrings.size())) {
-                        allText << sharedStrings[idx] << " ";
-                    }
-                } catch (...) {}
-            } else if (cellType == "str" || cellType == "inlineStr") {
-                // Inline string
-                allText << value << " ";
-            } else if (cellType.empty() || cellType == "n") {
-                // Number or no type - оставляем число как есть
-                allText << value << " ";
-            }
+    }
+
+    void endElement(int id) override {
+        if (id == Body) {
+            m_inBody = false;
+        } else if (id == P || id == H || id == TableCell) {
+            m_sink.separator();
         }
-        
-        allText << "\n";
     }
-    
-    std::string text = allText.str();
-    if (text.empty()) {
-        return std::nullopt;
+
+    void text(std::string_view text) override {
+        if (m_inBody) m_sink.append(text);
     }
-    
-    return ExtractionResult{
-        .text = std::move(text),
-        .method = "xlsx",
-        .language = "",
-        .confidence = 1.0
-    };
-}
+
+private:
+    NormalizingSink& m_sink;
+    XmlStreamReader m_reader;
+    bool m_inBody = false;
+};
 
 // ═══════════════════════════════════════════════════════════
-// PPTX
+// Форматы
 // ═══════════════════════════════════════════════════════════
 
-std::optional<ExtractionResult> OfficeTextExtractor::extractPptx(const std::string& filePath) {
-    std::ostringstream allText;
-    
-    // Читаем слайды (slide1.xml, slide2.xml, ...)
-    for (int slideNum = 1; slideNum <= 200; ++slideNum) {
-        std::string slideXml = readZipEntry(filePath, 
-            "ppt/slides/slide" + std::to_string(slideNum) + ".xml");
-        
-        if (slideXml.empty()) {
-            break;  // Больше слайдов нет
-        }
-        
-        // Извлекаем текст из <a:t> элементов (Drawing text)
-        std::string slideText = extractTextFromXml(slideXml, {"t"});
-        if (!slideText.empty()) {
-            allText << slideText << "\n";
-        }
+bool extractDocx(ZipArchive& archive, NormalizingSink& sink, const std::string& filePath) {
+    RunTextHandler handler(sink);
+    if (!archive.stream("word/document.xml", handler.reader(), sink)) {
+        spdlog::warn("OfficeTextExtractor: no document.xml in DOCX '{}'", filePath);
+        return false;
     }
-    
-    // Также проверяем notes (заметки к слайдам)
-    for (int noteNum = 1; noteNum <= 200; ++noteNum) {
-        std::string noteXml = readZipEntry(filePath, 
-            "ppt/notesSlides/notesSlide" + std::to_string(noteNum) + ".xml");
-        
-        if (noteXml.empty()) {
-            break;
-        }
-        
-        std::string noteText = extractTextFromXml(noteXml, {"t"});
-        if (!noteText.empty()) {
-            allText << noteText << " ";
-        }
+    for (const auto& name : archive.numberedEntries("word/header")) {
+        archive.stream(name, handler.reader(), sink);
     }
-    
-    std::string text = allText.str();
-    if (text.empty()) {
-        return std::nullopt;
+    for (const auto& name : archive.numberedEntries("word/footer")) {
+        archive.stream(name, handler.reader(), sink);
     }
-    
-    return ExtractionResult{
-        .text = std::move(text),
-        .method = "pptx",
-        .language = "",
-        .confidence = 1.0
-    };
+    return true;
 }
 
-// ═══════════════════════════════════════════════════════════
-// ODT (OpenDocument Text)
-// ═══════════════════════════════════════════════════════════
+bool extractXlsx(ZipArchive& archive, NormalizingSink& sink) {
+    // Общие строки выводятся один раз подряд, а не по каждой ссылающейся
+    // ячейке: таблица строк не держится в памяти, повторы не раздувают индекс
+    RunTextHandler strings(sink);
+    if (archive.contains("xl/sharedStrings.xml")) {
+        archive.stream("xl/sharedStrings.xml", strings.reader(), sink);
+    }
 
-std::optional<ExtractionResult> OfficeTextExtractor::extractOdt(const std::string& filePath) {
-    // В ODF формате контент в content.xml
-    std::string contentXml = readZipEntry(filePath, "content.xml");
-    if (contentXml.empty()) {
-        spdlog::warn("OfficeTextExtractor: no content.xml in ODT '{}'", filePath);
-        return std::nullopt;
+    SheetHandler cells(sink);
+    for (const auto& name : archive.numberedEntries("xl/worksheets/sheet")) {
+        if (sink.full()) break;
+        archive.stream(name, cells.reader(), sink);
     }
-    
-    // Тексты в <text:p>, <text:h>, <text:span> и т.д.
-    // Используем простой подход - извлекаем весь текстовый контент
-    pugi::xml_document doc;
-    if (!doc.load_string(contentXml.c_str())) {
-        return std::nullopt;
+    return true;
+}
+
+bool extractPptx(ZipArchive& archive, NormalizingSink& sink) {
+    RunTextHandler handler(sink);
+    for (const auto& name : archive.numberedEntries("ppt/slides/slide")) {
+        if (sink.full()) break;
+        archive.stream(name, handler.reader(), sink);
     }
-    
-    std::ostringstream allText;
-    
-    // Рекурсивная функция для извлечения текста
-    std::function<void(pugi::xml_node)> extractText = [&](pugi::xml_node node) {
-        for (pugi::xml_node child : node.children()) {
-            std::string nodeName = child.name();
-            
-            // Проверяем namespace text:
-            if (nodeName.find("text:") == 0 || nodeName.find(":p") != std::string::npos ||
-                nodeName.find(":h") != std::string::npos || nodeName.find(":span") != std::string::npos) {
-                
-                // Это текстовый элемент
-                std::string nodeText = child.text().get();
-                if (!nodeText.empty()) {
-                    allText << nodeText;
-                }
-            }
-            
-            // Рекурсивно обрабатываем детей
-            extractText(child);
-            
-            // Добавляем пробел/перенос после параграфа
-            if (nodeName.find(":p") != std::string::npos || 
-                nodeName.find(":h") != std::string::npos) {
-                allText << "\n";
-            }
-        }
-    };
-    
-    extractText(doc);
-    
-    std::string text = allText.str();
-    if (text.empty()) {
-        return std::nullopt;
+    // Заметки к слайдам
+    for (const auto& name : archive.numberedEntries("ppt/notesSlides/notesSlide")) {
+        if (sink.full()) break;
+        archive.stream(name, handler.reader(), sink);
     }
-    
-    return ExtractionResult{
-        .text = std::move(text),
-        .method = "odt",
-        .language = "",
-        .confidence = 1.0
-    };
+    return true;
+}
+
+bool extractOdf(ZipArchive& archive, NormalizingSink& sink, const std::string& filePath) {
+    OdfHandler handler(sink);
+    if (!archive.stream("content.xml", handler.reader(), sink)) {
+        spdlog::warn("OfficeTextExtractor: no content.xml in '{}'", filePath);
+        return false;
+    }
+    return true;
 }
 
+} // namespace
+
 // ═══════════════════════════════════════════════════════════
-// ODS (OpenDocument Spreadsheet)
+// OfficeTextExtractor
 // ═══════════════════════════════════════════════════════════
 
-std::optional<ExtractionResult> OfficeTextExtractor::extractOds(const std::string& filePath) {
-    std::string contentXml = readZipEntry(filePath, "content.xml");
-    if (contentXml.empty()) {
-        spdlog::warn("OfficeTextExtractor: no content.xml in ODS '{}'", filePath);
+OfficeTextExtractor::OfficeTextExtractor() = default;
+OfficeTextExtractor::~OfficeTextExtractor() = default;
+
+bool OfficeTextExtractor::canHandle(const std::string& mimeType) const {
+    static constexpr std::string_view supported[] = {
+        // Microsoft Office OpenXML
+        "application/vnd.openxmlformats-officedocument.wordprocessingml.document",     // docx
+        "application/vnd.openxmlformats-officedocument.spreadsheetml.sheet",           // xlsx
+        "application/vnd.openxmlformats-officedocument.presentationml.presentation",   // pptx
+        // OpenDocument Format
+        "application/vnd.oasis.opendocument.text",          // odt
+        "application/vnd.oasis.opendocument.spreadsheet",   // ods
+        "application/vnd.oasis.opendocument.presentation",  // odp
+    };
+
+    return std::find(std::begin(supported), std::end(supported), mimeType) != std::end(supported);
+}
+
+std::optional<ExtractionResult> OfficeTextExtractor::extract(const std::string& filePath) {
+    std::string ext = getExtension(filePath);
+    // ODP устроен как ODS: текст в content.xml
+    std::string method = ext == "odp" ? "ods" : ext;
+    if (method != "docx" && method != "xlsx" && method != "pptx" &&
+        method != "odt" && method != "ods") {
+        spdlog::warn("OfficeTextExtractor: unknown extension '{}'", ext);
         return std::nullopt;
     }
-    
-    pugi::xml_document doc;
-    if (!doc.load_string(contentXml.c_str())) {
+
+    // Записи распаковываются порциями прямо в разбор XML и нормализацию:
+    // ни запись целиком, ни дерево документа в памяти не строятся,
+    // после лимита текста архив дальше не распаковывается
+    ZipArchive archive(filePath);
+    if (!archive.isOpen()) {
+        spdlog::warn("OfficeTextExtractor: failed to open archive '{}', error: {}",
+                    filePath, archive.error());
         return std::nullopt;
     }
-    
-    std::ostringstream allText;
-    
-    // В ODS данные в <table:table-cell><text:p>...</text:p></table:table-cell>
-    std::function<void(pugi::xml_node)> extractCells = [&](pugi::xml_node node) {
-        for (pugi::xml_node child : node.children()) {
-            std::string nodeName = child.name();
-            
-            // Ищем text:p внутри table:table-cell
-            if (nodeName.find(":p") != std::string::npos) {
-                std::string cellText = child.text().get();
-                if (!cellText.empty()) {
-                    allText << cellText << " ";
-                }
-            }
-            
-            extractCells(child);
-        }
-    };
-    
-    extractCells(doc);
-    
-    std::string text = allText.str();
-    if (text.empty()) {
+
+    NormalizingSink sink(m_maxTextSize.load());
+    bool ok;
+    if (method == "docx") {
+        ok = extractDocx(archive, sink, filePath);
+    } else if (method == "xlsx") {
+        ok = extractXlsx(archive, sink);
+    } else if (method == "pptx") {
+        ok = extractPptx(archive, sink);
+    } else {
+        ok = extractOdf(archive, sink, filePath);
+    }
+
+    std::string text = sink.finish();
+    if (!ok || text.empty()) {
         return std::nullopt;
     }
-    
+
     return ExtractionResult{
         .text = std::move(text),
-        .method = "ods",
+        .method = std::move(method),
         .language = "",
         .confidence = 1.0
     };
 }
 
-} // namespace FamilyVault
+std::string OfficeTextExtractor::getExtension(const std::string& filePath) const {
+    auto dotPos = filePath.rfind('.');
+    if (dotPos == std::string::npos) {
+        return "";
+    }
+    std::string ext = filePath.substr(dotPos + 1);
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+    return ext;
+}
 
+} // namespace FamilyVault
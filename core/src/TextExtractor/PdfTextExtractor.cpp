@@ -7,10 +7,46 @@
 #include <poppler/cpp/poppler-global.h>
 
 #include <algorithm>
+#include <atomic>
 #include <memory>
+#include <thread>
 
 namespace FamilyVault {
 
+namespace {
+
+/// Меньше страниц на поток не выгодно: каждый поток заново разбирает документ
+constexpr int kMinPagesPerThread = 8;
+
+/// Текст одной страницы; false — разбор страницы бросил исключение
+bool extractPage(poppler::document& doc, int index, std::string& text) {
+    try {
+        std::unique_ptr<poppler::page> page(doc.create_page(index));
+        if (page) {
+            poppler::byte_array textData = page->text().to_utf8();
+            text.assign(textData.begin(), textData.end());
+        }
+        return true;
+    } catch (const std::exception& e) {
+        spdlog::debug("PdfTextExtractor: page {} failed: {}", index + 1, e.what());
+        text.clear();
+        return false;
+    }
+}
+
+/// Извлекать страницы из общей очереди nextPage, пока она не кончится.
+/// poppler::document не потокобезопасен: у каждого потока свой экземпляр.
+/// Страница с ошибкой помечается в failed и не останавливает поток
+void extractPages(poppler::document& doc, std::atomic<int>& nextPage,
+                  std::vector<std::string>& pages, std::vector<char>& failed) {
+    const int pageCount = static_cast<int>(pages.size());
+    for (int i = nextPage++; i < pageCount; i = nextPage++) {
+        failed[i] = !extractPage(doc, i, pages[i]);
+    }
+}
+
+} // namespace
+
 // ═══════════════════════════════════════════════════════════
 // PdfTextExtractor
 // ═══════════════════════════════════════════════════════════
@@ -46,21 +82,59 @@ std::optional<ExtractionResult> PdfTextExtractor::extract(const std::string& fil
     // Ограничиваем количество страниц
     int pageLimit = std::min(totalPages, m_maxPages);
     
+    // Страницы разбираются параллельно: каждый поток открывает свой экземпляр
+    // документа и берёт следующую страницу из общей очереди, а текст
+    // собирается по порядку страниц
+    std::vector<std::string> pages(pageLimit);
+    std::vector<char> failed(pageLimit, 0);     // Каждый элемент пишет один поток
+    std::atomic<int> nextPage{0};
+    
+    int hardwareThreads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    int threadCount = std::clamp(pageLimit / kMinPagesPerThread, 1,
+                                 std::max(1, std::min(m_maxThreads, hardwareThreads)));
+    
+    {
+        // jthread дожидается потоков и при исключении в текущем потоке
+        std::vector<std::jthread> workers;
+        workers.reserve(threadCount - 1);
+        for (int t = 1; t < threadCount; ++t) {
+            workers.emplace_back([&filePath, &nextPage, &pages, &failed] {
+                try {
+                    std::unique_ptr<poppler::document> workerDoc(
+                        poppler::document::load_from_file(filePath));
+                    if (workerDoc && !workerDoc->is_locked()) {
+                        extractPages(*workerDoc, nextPage, pages, failed);
+                    }
+                } catch (const std::exception& e) {
+                    // Не открыл документ — его страницы доработают остальные
+                    spdlog::warn("PdfTextExtractor: worker failed on '{}': {}", filePath, e.what());
+                }
+            });
+        }
+        // Текущий поток работает с уже открытым документом и дорабатывает
+        // страницы, если какой-то поток не смог открыть файл
+        extractPages(*doc, nextPage, pages, failed);
+    }
+    
+    // Страницы с ошибкой — ещё одна попытка в текущем потоке; не вышло —
+    // результат частичный, и об этом знает вызывающий (failedPages)
+    int failedPages = 0;
+    for (int i = 0; i < pageLimit; ++i) {
+        if (failed[i] && !extractPage(*doc, i, pages[i])) {
+            ++failedPages;
+        }
+    }
+    if (failedPages > 0) {
+        spdlog::warn("PdfTextExtractor: {} of {} pages of '{}' failed, text is partial",
+                    failedPages, pageLimit, filePath);
+    }
+    
     std::string fullText;
     fullText.reserve(pageLimit * 2000); // Примерная оценка
     
     int totalChars = 0;
     
-    for (int i = 0; i < pageLimit; ++i) {
-        std::unique_ptr<poppler::page> page(doc->create_page(i));
-        if (!page) {
-            continue;
-        }
-        
-        // Извлекаем текст со страницы
-        poppler::byte_array textData = page->text().to_utf8();
-        std::string pageText(textData.begin(), textData.end());
-        
+    for (const auto& pageText : pages) {
         if (!pageText.empty()) {
             fullText += pageText;
             fullText += "\n\n";
@@ -85,7 +159,8 @@ std::optional<ExtractionResult> PdfTextExtractor::extract(const std::string& fil
             .text = std::move(fullText),
             .method = "pdf_sparse",  // Помечаем как sparse/scan
             .language = "",
-            .confidence = 0.3  // Низкая уверенность
+            .confidence = 0.3,  // Низкая уверенность
+            .failedPages = failedPages
         };
     }
     
@@ -125,7 +200,8 @@ std::optional<ExtractionResult> PdfTextExtractor::extract(const std::string& fil
         .text = std::move(cleanText),
         .method = "pdf",
         .language = "",
-        .confidence = 1.0
+        .confidence = 1.0,
+        .failedPages = failedPages
     };
 }
 
@@ -27,8 +27,26 @@ void TextExtractorRegistry::registerExtractor(std::shared_ptr<ITextExtractor> ex
         }
     }
     
-    m_extractors.push_back(std::move(extractor));
-    spdlog::debug("Registered text extractor: {}", m_extractors.back()->name());
+    spdlog::debug("Registered text extractor: {}", extractor->name());
+    
+    // Вставка после экстракторов не ниже приоритетом: при равном приоритете
+    // выигрывает зарегистрированный раньше
+    auto pos = std::find_if(m_extractors.begin(), m_extractors.end(),
+        [&](const auto& existing) { return existing->priority() < extractor->priority(); });
+    m_extractors.insert(pos, std::move(extractor));
+    rebuildDispatchLocked();
+}
+
+void TextExtractorRegistry::rebuildDispatchLocked() {
+    m_dispatch.clear();
+    for (const auto& mimeType : getSupportedMimeTypes()) {
+        for (const auto& extractor : m_extractors) {
+            if (extractor->canHandle(mimeType)) {
+                m_dispatch.emplace(mimeType, extractor.get());
+                break;
+            }
+        }
+    }
 }
 
 std::optional<ExtractionResult> TextExtractorRegistry::extract(
@@ -40,7 +58,21 @@ std::optional<ExtractionResult> TextExtractorRegistry::extract(
         spdlog::debug("No extractor found for MIME type: {}", mimeType);
         return std::nullopt;
     }
-    
+    return extractWith(extractor, filePath);
+}
+
+std::optional<ExtractionResult> TextExtractorRegistry::extract(const std::string& filePath,
+                                                               int64_t mimeId) {
+    auto extractor = findExtractor(mimeId);
+    if (!extractor) {
+        spdlog::debug("No extractor bound to MIME type id {}", mimeId);
+        return std::nullopt;
+    }
+    return extractWith(extractor, filePath);
+}
+
+std::optional<ExtractionResult> TextExtractorRegistry::extractWith(ITextExtractor* extractor,
+                                                                   const std::string& filePath) {
     spdlog::debug("Extracting text from '{}' using '{}'", filePath, extractor->name());
     
     try {
@@ -62,6 +94,47 @@ bool TextExtractorRegistry::canExtract(const std::string& mimeType) const {
     return findExtractor(mimeType) != nullptr;
 }
 
+bool TextExtractorRegistry::canExtract(int64_t mimeId) const {
+    return findExtractor(mimeId) != nullptr;
+}
+
+std::vector<bool> TextExtractorRegistry::bindMimeIds(
+    const std::vector<std::pair<int64_t, std::string>>& types)
+{
+    std::vector<bool> supported(types.size(), false);
+    
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const MimeIdTable* current = m_byMimeId.load(std::memory_order_acquire);
+    auto table = std::make_unique<MimeIdTable>(current ? *current : MimeIdTable{});
+    
+    for (size_t i = 0; i < types.size(); ++i) {
+        const auto& [mimeId, mimeType] = types[i];
+        if (mimeId <= 0) continue;
+        auto index = static_cast<size_t>(mimeId);
+        if (index >= table->size()) {
+            table->resize(index + 1, nullptr);
+        }
+        // Перебор canHandle для незнакомых типов — один раз здесь, не при извлечении
+        (*table)[index] = findExtractor(mimeType);
+        supported[i] = (*table)[index] != nullptr;
+    }
+    
+    m_byMimeId.store(table.get(), std::memory_order_release);
+    m_mimeIdTables.push_back(std::move(table));
+    return supported;
+}
+
+bool TextExtractorRegistry::bindMimeId(int64_t mimeId, const std::string& mimeType) {
+    return bindMimeIds({{mimeId, mimeType}}).front();
+}
+
+void TextExtractorRegistry::setMaxTextSize(size_t bytes) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const auto& extractor : m_extractors) {
+        extractor->setMaxTextSize(bytes);
+    }
+}
+
 std::vector<std::string> TextExtractorRegistry::getSupportedMimeTypes() const {
     // Возвращаем статический список известных поддерживаемых типов
     // В реальности каждый экстрактор сам определяет через canHandle()
@@ -93,25 +166,23 @@ std::string TextExtractorRegistry::getExtractorName(const std::string& mimeType)
     return extractor ? extractor->name() : "";
 }
 
-std::shared_ptr<ITextExtractor> TextExtractorRegistry::findExtractor(
-    const std::string& mimeType) const 
-{
-    std::lock_guard<std::mutex> lock(m_mutex);
-    
-    std::shared_ptr<ITextExtractor> best;
-    int bestPriority = -1000;
-    
+ITextExtractor* TextExtractorRegistry::findExtractor(const std::string& mimeType) const {
+    // Таблица и список не меняются после регистрации — чтение без блокировки
+    if (auto it = m_dispatch.find(mimeType); it != m_dispatch.end()) {
+        return it->second;
+    }
     for (const auto& extractor : m_extractors) {
         if (extractor->canHandle(mimeType)) {
-            int priority = extractor->priority();
-            if (priority > bestPriority) {
-                bestPriority = priority;
-                best = extractor;
-            }
+            return extractor.get();
         }
     }
-    
-    return best;
+    return nullptr;
+}
+
+ITextExtractor* TextExtractorRegistry::findExtractor(int64_t mimeId) const {
+    const MimeIdTable* table = m_byMimeId.load(std::memory_order_acquire);
+    auto index = static_cast<size_t>(mimeId);
+    return table && mimeId > 0 && index < table->size() ? (*table)[index] : nullptr;
 }
 
 std::unique_ptr<TextExtractorRegistry> TextExtractorRegistry::createDefault() {
@@ -0,0 +1,435 @@
+#include "familyvault/EncodingConverter.h"
+#include "SimdSupport.h"
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+
+namespace FamilyVault {
+
+namespace {
+
+/// Размер начального фрагмента для проверки UTF-8 при определении кодировки
+constexpr size_t kDetectSampleBytes = 4096;
+
+/// Эвристика CP1251: порог байтов кириллицы в первых kCp1251SampleBytes
+constexpr size_t kCp1251SampleBytes = 1000;
+constexpr int kCp1251Threshold = 50;
+
+constexpr uint32_t kReplacementCodePoint = 0xFFFD;
+
+// Таблица перекодировки CP1251 → Unicode для символов 0x80-0xFF
+constexpr uint16_t kCp1251ToUnicode[128] = {
+    0x0402, 0x0403, 0x201A, 0x0453, 0x201E, 0x2026, 0x2020, 0x2021,
+    0x20AC, 0x2030, 0x0409, 0x2039, 0x040A, 0x040C, 0x040B, 0x040F,
+    0x0452, 0x2018, 0x2019, 0x201C, 0x201D, 0x2022, 0x2013, 0x2014,
+    0x0098, 0x2122, 0x0459, 0x203A, 0x045A, 0x045C, 0x045B, 0x045F,
+    0x00A0, 0x040E, 0x045E, 0x0408, 0x00A4, 0x0490, 0x00A6, 0x00A7,
+    0x0401, 0x00A9, 0x0404, 0x00AB, 0x00AC, 0x00AD, 0x00AE, 0x0407,
+    0x00B0, 0x00B1, 0x0406, 0x0456, 0x0491, 0x00B5, 0x00B6, 0x00B7,
+    0x0451, 0x2116, 0x0454, 0x00BB, 0x0458, 0x0405, 0x0455, 0x0457,
+    0x0410, 0x0411, 0x0412, 0x0413, 0x0414, 0x0415, 0x0416, 0x0417,
+    0x0418, 0x0419, 0x041A, 0x041B, 0x041C, 0x041D, 0x041E, 0x041F,
+    0x0420, 0x0421, 0x0422, 0x0423, 0x0424, 0x0425, 0x0426, 0x0427,
+    0x0428, 0x0429, 0x042A, 0x042B, 0x042C, 0x042D, 0x042E, 0x042F,
+    0x0430, 0x0431, 0x0432, 0x0433, 0x0434, 0x0435, 0x0436, 0x0437,
+    0x0438, 0x0439, 0x043A, 0x043B, 0x043C, 0x043D, 0x043E, 0x043F,
+    0x0440, 0x0441, 0x0442, 0x0443, 0x0444, 0x0445, 0x0446, 0x0447,
+    0x0448, 0x0449, 0x044A, 0x044B, 0x044C, 0x044D, 0x044E, 0x044F
+};
+
+/// Готовая UTF-8 форма байта CP1251: записывается 4 байтами, длина в length
+struct Utf8Entry {
+    char bytes[3];
+    uint8_t length;
+};
+
+struct Cp1251Table {
+    Utf8Entry entries[256];
+};
+
+constexpr Cp1251Table makeCp1251Table() {
+    Cp1251Table table{};
+    for (int b = 0; b < 256; ++b) {
+        auto& e = table.entries[b];
+        uint32_t cp = b < 0x80 ? static_cast<uint32_t>(b) : kCp1251ToUnicode[b - 0x80];
+        if (cp < 0x80) {
+            e.bytes[0] = static_cast<char>(cp);
+            e.length = 1;
+        } else if (cp < 0x800) {
+            e.bytes[0] = static_cast<char>(0xC0 | (cp >> 6));
+            e.bytes[1] = static_cast<char>(0x80 | (cp & 0x3F));
+            e.length = 2;
+        } else {
+            e.bytes[0] = static_cast<char>(0xE0 | (cp >> 12));
+            e.bytes[1] = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            e.bytes[2] = static_cast<char>(0x80 | (cp & 0x3F));
+            e.length = 3;
+        }
+    }
+    return table;
+}
+
+constexpr Cp1251Table kCp1251 = makeCp1251Table();
+
+/// Запись результата с запасом: SIMD-ядра пишут блоками по 16 байт,
+/// полезная длина меньше записанной. Буфер out переиспользуется между
+/// фрагментами потоковой перекодировки
+class Utf8Writer {
+public:
+    Utf8Writer(std::string& out, size_t estimate) : m_out(out) {
+        if (m_out.size() < estimate + 32) m_out.resize(estimate + 32);
+    }
+
+    /// Указатель на место для записи не менее n байт
+    char* reserve(size_t n) {
+        if (m_length + n > m_out.size()) {
+            m_out.resize(std::max(m_out.size() * 2, m_length + n));
+        }
+        return m_out.data() + m_length;
+    }
+
+    void commit(const char* end) { m_length = static_cast<size_t>(end - m_out.data()); }
+
+    void finish() { m_out.resize(m_length); }
+
+private:
+    std::string& m_out;
+    size_t m_length = 0;
+};
+
+char* encodeCodePoint(char* out, uint32_t cp) {
+    if (cp < 0x80) {
+        *out++ = static_cast<char>(cp);
+    } else if (cp < 0x800) {
+        *out++ = static_cast<char>(0xC0 | (cp >> 6));
+        *out++ = static_cast<char>(0x80 | (cp & 0x3F));
+    } else if (cp < 0x10000) {
+        *out++ = static_cast<char>(0xE0 | (cp >> 12));
+        *out++ = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        *out++ = static_cast<char>(0x80 | (cp & 0x3F));
+    } else {
+        *out++ = static_cast<char>(0xF0 | (cp >> 18));
+        *out++ = static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+        *out++ = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        *out++ = static_cast<char>(0x80 | (cp & 0x3F));
+    }
+    return out;
+}
+
+uint16_t readUnit(const unsigned char* data, size_t index, bool bigEndian) {
+    const unsigned char* p = data + index * 2;
+    return bigEndian ? static_cast<uint16_t>((p[0] << 8) | p[1])
+                     : static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+/// UTF-16 [i, limit) → UTF-8; суррогатная пара на границе дочитывается
+size_t utf16Scalar(const unsigned char* data, size_t units, size_t i, size_t limit,
+                   bool bigEndian, Utf8Writer& out) {
+    char* dst = out.reserve((limit - i) * 3 + 4);
+    while (i < limit) {
+        uint32_t unit = readUnit(data, i++, bigEndian);
+        if (unit >= 0xD800 && unit <= 0xDFFF) {
+            uint32_t low = i < units ? readUnit(data, i, bigEndian) : 0;
+            if (unit <= 0xDBFF && low >= 0xDC00 && low <= 0xDFFF) {
+                unit = 0x10000 + ((unit - 0xD800) << 10) + (low - 0xDC00);
+                ++i;
+            } else {
+                unit = kReplacementCodePoint;
+            }
+        }
+        dst = encodeCodePoint(dst, unit);
+    }
+    out.commit(dst);
+    return i;
+}
+
+/// CP1251 [i, limit) → UTF-8 по таблице
+void cp1251Scalar(const unsigned char* data, size_t i, size_t limit, Utf8Writer& out) {
+    // +1: последняя запись 4 байт выходит на байт за длину символа
+    char* dst = out.reserve((limit - i) * 3 + 1);
+    for (; i < limit; ++i) {
+        const Utf8Entry& e = kCp1251.entries[data[i]];
+        std::memcpy(dst, &e, sizeof(e));
+        dst += e.length;
+    }
+    out.commit(dst);
+}
+
+#if FV_SIMD_X86
+
+/// Маски перестановки для упаковки 8 символов < U+0800: символ i занимает
+/// байты 2i, 2i+1; у ASCII (бит i маски) второй байт выбрасывается
+struct CompactTable {
+    alignas(16) uint8_t shuffle[256][16];
+};
+
+constexpr CompactTable makeCompactTable() {
+    CompactTable table{};
+    for (int mask = 0; mask < 256; ++mask) {
+        int k = 0;
+        for (int i = 0; i < 8; ++i) {
+            table.shuffle[mask][k++] = static_cast<uint8_t>(2 * i);
+            if (!((mask >> i) & 1)) {
+                table.shuffle[mask][k++] = static_cast<uint8_t>(2 * i + 1);
+            }
+        }
+        while (k < 16) table.shuffle[mask][k++] = 0x80;
+    }
+    return table;
+}
+
+constexpr CompactTable kCompact = makeCompactTable();
+
+/// 8 кодовых единиц < U+0800 → 8..16 байт UTF-8 (пишет 16 байт)
+FV_TARGET_AVX2 char* encodeBelow800(char* out, __m128i units) {
+    __m128i ascii = _mm_cmpeq_epi16(_mm_and_si128(units, _mm_set1_epi16(static_cast<short>(0xFF80))),
+                                    _mm_setzero_si128());
+    __m128i lead = _mm_or_si128(_mm_srli_epi16(units, 6), _mm_set1_epi16(0xC0));
+    __m128i trail = _mm_or_si128(_mm_and_si128(units, _mm_set1_epi16(0x3F)), _mm_set1_epi16(0x80));
+    __m128i twoByte = _mm_or_si128(lead, _mm_slli_epi16(trail, 8));
+    __m128i words = _mm_blendv_epi8(twoByte, units, ascii);
+
+    int mask = _mm_movemask_epi8(_mm_packs_epi16(ascii, _mm_setzero_si128()));
+    __m128i shuffle = _mm_load_si128(reinterpret_cast<const __m128i*>(kCompact.shuffle[mask]));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_shuffle_epi8(words, shuffle));
+    return out + 16 - std::popcount(static_cast<unsigned>(mask));
+}
+
+bool allZero16(__m128i v) {
+    return _mm_movemask_epi8(_mm_cmpeq_epi16(v, _mm_setzero_si128())) == 0xFFFF;
+}
+
+/// Блоки по 8 единиц: ASCII — упаковкой (SSE2), < U+0800 — перестановкой (AVX2-уровень)
+template <bool Compact>
+void utf16Blocks(const unsigned char* data, size_t units, bool bigEndian, Utf8Writer& out) {
+    size_t i = 0;
+    while (i + 8 <= units) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i * 2));
+        if (bigEndian) {
+            v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+        }
+
+        if (allZero16(_mm_and_si128(v, _mm_set1_epi16(static_cast<short>(0xFF80))))) {
+            char* dst = out.reserve(8);
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(dst), _mm_packus_epi16(v, v));
+            out.commit(dst + 8);
+            i += 8;
+            continue;
+        }
+        if constexpr (Compact) {
+            if (allZero16(_mm_and_si128(v, _mm_set1_epi16(static_cast<short>(0xF800))))) {
+                char* dst = out.reserve(16);
+                out.commit(encodeBelow800(dst, v));
+                i += 8;
+                continue;
+            }
+        }
+        i = utf16Scalar(data, units, i, i + 8, bigEndian, out);
+    }
+    utf16Scalar(data, units, i, units, bigEndian, out);
+}
+
+/// Блоки по 16 байт: ASCII копируется, текст из ASCII и букв А..я
+/// (0xC0..0xFF → U+0410..U+044F) кодируется перестановкой
+template <bool Compact>
+void cp1251Blocks(const unsigned char* data, size_t size, Utf8Writer& out) {
+    size_t i = 0;
+    while (i + 16 <= size) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        int high = _mm_movemask_epi8(v);
+        if (high == 0) {
+            char* dst = out.reserve(16);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), v);
+            out.commit(dst + 16);
+            i += 16;
+            continue;
+        }
+        if constexpr (Compact) {
+            __m128i letters = _mm_cmpeq_epi8(_mm_max_epu8(v, _mm_set1_epi8(static_cast<char>(0xC0))), v);
+            if (_mm_movemask_epi8(letters) == high) {
+                __m128i offset = _mm_set1_epi16(0x350);
+                __m128i threshold = _mm_set1_epi16(0xBF);
+                __m128i lo = _mm_unpacklo_epi8(v, _mm_setzero_si128());
+                __m128i hi = _mm_unpackhi_epi8(v, _mm_setzero_si128());
+                lo = _mm_add_epi16(lo, _mm_and_si128(_mm_cmpgt_epi16(lo, threshold), offset));
+                hi = _mm_add_epi16(hi, _mm_and_si128(_mm_cmpgt_epi16(hi, threshold), offset));
+
+                char* dst = out.reserve(32);
+                out.commit(encodeBelow800(encodeBelow800(dst, lo), hi));
+                i += 16;
+                continue;
+            }
+        }
+        cp1251Scalar(data, i, i + 16, out);
+        i += 16;
+    }
+    cp1251Scalar(data, i, size, out);
+}
+
+void utf16Sse2(const unsigned char* data, size_t units, bool bigEndian, Utf8Writer& out) {
+    utf16Blocks<false>(data, units, bigEndian, out);
+}
+
+FV_TARGET_AVX2_FLATTEN void utf16Avx2(const unsigned char* data, size_t units, bool bigEndian,
+                                      Utf8Writer& out) {
+    utf16Blocks<true>(data, units, bigEndian, out);
+}
+
+void cp1251Sse2(const unsigned char* data, size_t size, Utf8Writer& out) {
+    cp1251Blocks<false>(data, size, out);
+}
+
+FV_TARGET_AVX2_FLATTEN void cp1251Avx2(const unsigned char* data, size_t size, Utf8Writer& out) {
+    cp1251Blocks<true>(data, size, out);
+}
+
+#endif
+
+/// Начальный фрагмент, обрезанный до границы символа UTF-8
+std::string_view utf8Sample(std::string_view data) {
+    if (data.size() <= kDetectSampleBytes) return data;
+    size_t end = kDetectSampleBytes;
+    // Отступаем к началу последнего символа (не более 3 байт продолжения)
+    for (size_t back = 0; back < 3 && end > 0; ++back) {
+        if ((static_cast<unsigned char>(data[end]) & 0xC0) != 0x80) break;
+        --end;
+    }
+    return data.substr(0, end);
+}
+
+} // namespace
+
+// ═══════════════════════════════════════════════════════════
+// EncodingConverter
+// ═══════════════════════════════════════════════════════════
+
+TextEncoding EncodingConverter::detect(std::string_view data) {
+    if (data.size() < 2) {
+        return TextEncoding::Utf8;
+    }
+
+    auto b0 = static_cast<unsigned char>(data[0]);
+    auto b1 = static_cast<unsigned char>(data[1]);
+    if (b0 == 0xFF && b1 == 0xFE) return TextEncoding::Utf16Le;
+    if (b0 == 0xFE && b1 == 0xFF) return TextEncoding::Utf16Be;
+    if (data.size() >= 3 && b0 == 0xEF && b1 == 0xBB && static_cast<unsigned char>(data[2]) == 0xBF) {
+        return TextEncoding::Utf8Bom;
+    }
+
+    // Валидный UTF-8 в начале — остальное не проверяем: TextNormalizer
+    // всё равно проходит весь текст и заменяет битые последовательности
+    if (TextNormalizer::isValidUtf8(utf8Sample(data))) {
+        return TextEncoding::Utf8;
+    }
+
+    // Много байтов 0xC0-0xFF (А..я в CP1251) при невалидном UTF-8
+    int cyrillic = 0;
+    size_t sample = std::min(data.size(), kCp1251SampleBytes);
+    for (size_t i = 0; i < sample; ++i) {
+        if (static_cast<unsigned char>(data[i]) >= 0xC0) ++cyrillic;
+    }
+    return cyrillic > kCp1251Threshold ? TextEncoding::Cp1251 : TextEncoding::Utf8;
+}
+
+std::string EncodingConverter::toUtf8(std::string_view data, TextEncoding encoding) {
+    return toUtf8(data, encoding, TextNormalizer::detectedLevel());
+}
+
+std::string EncodingConverter::toUtf8(std::string_view data, TextEncoding encoding, SimdLevel level) {
+    std::string out;
+    data.remove_prefix(std::min(bomLength(encoding), data.size()));
+    decodeChunk(data, encoding, true, out, level);
+    return out;
+}
+
+size_t EncodingConverter::decodeChunk(std::string_view data, TextEncoding encoding, bool last,
+                                      std::string& out) {
+    return decodeChunk(data, encoding, last, out, TextNormalizer::detectedLevel());
+}
+
+size_t EncodingConverter::decodeChunk(std::string_view data, TextEncoding encoding, bool last,
+                                      std::string& out, SimdLevel level) {
+    level = std::min(level, TextNormalizer::detectedLevel());
+    const auto* bytes = reinterpret_cast<const unsigned char*>(data.data());
+
+    switch (encoding) {
+        case TextEncoding::Utf16Le:
+        case TextEncoding::Utf16Be: {
+            bool bigEndian = encoding == TextEncoding::Utf16Be;
+            size_t units = data.size() / 2;
+            // Старший суррогат в конце фрагмента ждёт пару из следующего
+            if (!last && units > 0) {
+                uint16_t lastUnit = readUnit(bytes, units - 1, bigEndian);
+                if (lastUnit >= 0xD800 && lastUnit <= 0xDBFF) --units;
+            }
+
+            // Кириллица — 2 байта UTF-8 на единицу, ASCII — 1
+            Utf8Writer writer(out, units * 2);
+            switch (level) {
+#if FV_SIMD_X86
+                case SimdLevel::Avx2: utf16Avx2(bytes, units, bigEndian, writer); break;
+                case SimdLevel::Sse2: utf16Sse2(bytes, units, bigEndian, writer); break;
+#endif
+                default: utf16Scalar(bytes, units, 0, units, bigEndian, writer); break;
+            }
+            writer.finish();
+            // Нечётный байт в конце файла отбрасывается
+            return last ? data.size() : units * 2;
+        }
+
+        case TextEncoding::Cp1251: {
+            Utf8Writer writer(out, data.size() * 2);
+            switch (level) {
+#if FV_SIMD_X86
+                case SimdLevel::Avx2: cp1251Avx2(bytes, data.size(), writer); break;
+                case SimdLevel::Sse2: cp1251Sse2(bytes, data.size(), writer); break;
+#endif
+                default: cp1251Scalar(bytes, 0, data.size(), writer); break;
+            }
+            writer.finish();
+            return data.size();
+        }
+
+        case TextEncoding::Utf8:
+        case TextEncoding::Utf8Bom:
+            break;
+    }
+    out.assign(data);
+    return data.size();
+}
+
+size_t EncodingConverter::bomLength(TextEncoding encoding) {
+    switch (encoding) {
+        case TextEncoding::Utf8Bom: return 3;
+        case TextEncoding::Utf16Le:
+        case TextEncoding::Utf16Be: return 2;
+        default: return 0;
+    }
+}
+
+void EncodingConverter::convertInPlace(std::string& data, TextEncoding encoding) {
+    switch (encoding) {
+        case TextEncoding::Utf8:
+            return;
+        case TextEncoding::Utf8Bom:
+            data.erase(0, std::min<size_t>(3, data.size()));
+            return;
+        default:
+            data = toUtf8(data, encoding);
+            return;
+    }
+}
+
+const char* EncodingConverter::name(TextEncoding encoding) {
+    switch (encoding) {
+        case TextEncoding::Utf8: return "utf-8";
+        case TextEncoding::Utf8Bom: return "utf-8-bom";
+        case TextEncoding::Utf16Le: return "utf-16le";
+        case TextEncoding::Utf16Be: return "utf-16be";
+        case TextEncoding::Cp1251: return "cp1251";
+    }
+    return "utf-8";
+}
+
+} // namespace FamilyVault
@@ -0,0 +1,220 @@
+#include "familyvault/MarkupStripper.h"
+#include "XmlEntities.h"
+#include <cstring>
+
+namespace FamilyVault {
+
+namespace {
+
+/// Имена тегов длиннее не интересны (script, style, ![cdata[)
+constexpr size_t kMaxName = 10;
+
+char asciiLower(char c) {
+    return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+bool isAsciiSpace(char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+/// Следующее состояние сопоставления с терминатором (префикс-функция на лету:
+/// терминаторы короче 10 байт)
+size_t advanceMatch(std::string_view terminator, size_t matched, char c) {
+    while (true) {
+        if (terminator[matched] == c) return matched + 1;
+        if (matched == 0) return 0;
+        size_t k = matched - 1;
+        while (k > 0 && terminator.substr(0, k) != terminator.substr(matched - k, k)) --k;
+        matched = k;
+    }
+}
+
+} // namespace
+
+// ═══════════════════════════════════════════════════════════
+// MarkupStripper
+// ═══════════════════════════════════════════════════════════
+
+MarkupStripper::MarkupStripper(Mode mode, NormalizingSink& sink)
+    : m_mode(mode)
+    , m_sink(sink)
+{
+}
+
+void MarkupStripper::feed(std::string_view chunk) {
+    const char* data = chunk.data();
+    size_t size = chunk.size();
+
+    while (size > 0 && !m_sink.full()) {
+        size_t used = 0;
+        switch (m_state) {
+            case State::Text:    used = feedText(data, size); break;
+            case State::Tag:     used = feedTag(data, size); break;
+            case State::Entity:  used = feedEntity(data, size); break;
+            case State::Comment: used = feedUntil(data, size, false); break;
+            case State::CData:   used = feedUntil(data, size, true); break;
+            case State::RawText: used = feedUntil(data, size, false); break;
+        }
+        data += used;
+        size -= used;
+    }
+}
+
+void MarkupStripper::finish() {
+    if (m_state == State::Entity) {
+        m_sink.append("&");
+        m_sink.append(m_buffer);
+    } else if (m_state == State::CData) {
+        m_sink.append(m_terminator.substr(0, m_matched));
+    }
+    m_state = State::Text;
+    m_buffer.clear();
+    m_matched = 0;
+}
+
+size_t MarkupStripper::feedText(const char* data, size_t size) {
+    const auto* tag = static_cast<const char*>(std::memchr(data, '<', size));
+    size_t limit = tag ? static_cast<size_t>(tag - data) : size;
+    const auto* amp = static_cast<const char*>(std::memchr(data, '&', limit));
+    size_t end = amp ? static_cast<size_t>(amp - data) : limit;
+
+    m_sink.append(std::string_view(data, end));
+    if (end == size) return size;
+
+    m_buffer.clear();
+    if (data[end] == '<') {
+        m_state = State::Tag;
+        m_nameDone = false;
+    } else {
+        m_state = State::Entity;
+    }
+    return end + 1;
+}
+
+size_t MarkupStripper::feedTag(const char* data, size_t size) {
+    size_t i = 0;
+    while (i < size && !m_nameDone) {
+        char c = data[i];
+        if (c == '>') {
+            closeTag();
+            return i + 1;
+        }
+        if (isAsciiSpace(c) || (c == '/' && !m_buffer.empty()) || m_buffer.size() >= kMaxName) {
+            m_nameDone = true;
+            break;
+        }
+        m_buffer += asciiLower(c);
+        ++i;
+        if (m_buffer[0] == '!') {
+            if (m_buffer == "!--") {
+                expect(State::Comment, "-->");
+                return i;
+            }
+            if (m_buffer == "![cdata[") {
+                expect(State::CData, "]]>");
+                return i;
+            }
+        }
+    }
+
+    // Атрибуты пропускаем целиком
+    const auto* end = static_cast<const char*>(std::memchr(data + i, '>', size - i));
+    if (!end) return size;
+    closeTag();
+    return static_cast<size_t>(end - data) + 1;
+}
+
+size_t MarkupStripper::feedEntity(const char* data, size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+        char c = data[i];
+        if (c == ';' && !m_buffer.empty()) {
+            emitEntity();
+            m_state = State::Text;
+            return i + 1;
+        }
+        bool nameChar = isEntityNameChar(c) || (c == '#' && m_buffer.empty());
+        if (!nameChar || m_buffer.size() >= kMaxEntityName) {
+            // Не сущность: '&' и прочитанное — обычный текст, c разберёт feedText
+            m_sink.append("&");
+            m_sink.append(m_buffer);
+            m_state = State::Text;
+            return i;
+        }
+        m_buffer += c;
+    }
+    return size;
+}
+
+size_t MarkupStripper::feedUntil(const char* data, size_t size, bool emit) {
+    size_t matchedBefore = m_matched;
+    bool found = false;
+    size_t i = 0;
+    while (i < size) {
+        if (m_matched == 0) {
+            const auto* start = static_cast<const char*>(std::memchr(data + i, m_terminator[0], size - i));
+            if (!start) {
+                i = size;
+                break;
+            }
+            i = static_cast<size_t>(start - data);
+        }
+        m_matched = advanceMatch(m_terminator, m_matched, asciiLower(data[i]));
+        ++i;
+        if (m_matched == m_terminator.size()) {
+            found = true;
+            break;
+        }
+    }
+
+    if (emit) {
+        // Выводим всё, кроме совпавшего начала терминатора: оно может
+        // оказаться текстом, если совпадение оборвётся в следующем фрагменте
+        size_t held = found ? m_terminator.size() : m_matched;
+        size_t keep = matchedBefore + i - held;
+        m_sink.append(m_terminator.substr(0, std::min(keep, matchedBefore)));
+        if (keep > matchedBefore) m_sink.append(std::string_view(data, keep - matchedBefore));
+    }
+
+    if (found) {
+        m_matched = 0;
+        if (m_state == State::RawText) {
+            // Закрывающий </script ...> дочитываем как обычный тег
+            m_state = State::Tag;
+            m_buffer.clear();
+            m_nameDone = true;
+        } else {
+            if (m_state == State::Comment) m_sink.separator();
+            m_state = State::Text;
+        }
+    }
+    return i;
+}
+
+void MarkupStripper::closeTag() {
+    m_sink.separator();
+    if (m_mode == Mode::Html && m_buffer == "script") {
+        expect(State::RawText, "</script");
+    } else if (m_mode == Mode::Html && m_buffer == "style") {
+        expect(State::RawText, "</style");
+    } else {
+        m_state = State::Text;
+    }
+}
+
+void MarkupStripper::emitEntity() {
+    std::string decoded;
+    // &nbsp;, &#160; и неизвестные сущности — граница слова
+    if (!decodeEntity(m_buffer, decoded) || decoded == "\xC2\xA0") {
+        m_sink.separator();
+    } else {
+        m_sink.append(decoded);
+    }
+}
+
+void MarkupStripper::expect(State state, std::string_view terminator) {
+    m_state = state;
+    m_terminator = terminator;
+    m_matched = 0;
+}
+
+} // namespace FamilyVault
@@ -1,17 +1,26 @@
 #include "familyvault/MimeTypeDetector.h"
 #include <algorithm>
-#include <fstream>
-#include <unordered_map>
-#include <cctype>
 #include <array>
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string_view>
 
 namespace FamilyVault {
 
+namespace {
+
 // ═══════════════════════════════════════════════════════════
 // Таблица расширений -> MIME
 // ═══════════════════════════════════════════════════════════
 
-static const std::unordered_map<std::string, std::string> EXTENSION_TO_MIME = {
+struct ExtensionMime {
+    std::string_view extension;
+    std::string_view mimeType;
+};
+
+constexpr ExtensionMime EXTENSION_TO_MIME[] = {
     // Images
     {"jpg", "image/jpeg"},
     {"jpeg", "image/jpeg"},
@@ -108,49 +117,144 @@ static const std::unordered_map<std::string, std::string> EXTENSION_TO_MIME = {
     {"iso", "application/x-iso9660-image"},
 };
 
+// Идеальный хеш расширений: зерно подбирается при компиляции так, что все
+// расширения таблицы попадают в разные слоты. Поиск — один хеш и одно
+// сравнение строк, без аллокаций и без обхода бакетов
+
+constexpr size_t kExtensionSlots = 2048;        // Степень двойки: ~25 слотов на запись, зерно находится за пару попыток
+constexpr size_t kMaxExtensionLength = 8;       // Длиннее — заведомо нет в таблице
+
+constexpr uint32_t extensionHash(std::string_view extension, uint32_t seed) {
+    uint32_t hash = 2166136261u ^ seed;         // FNV-1a
+    for (char c : extension) {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 16777619u;
+    }
+    return (hash ^ (hash >> 16)) & (kExtensionSlots - 1);
+}
+
+constexpr uint32_t findExtensionSeed() {
+    for (uint32_t seed = 1; seed < 10000; ++seed) {
+        bool used[kExtensionSlots] = {};
+        bool collision = false;
+        for (const auto& entry : EXTENSION_TO_MIME) {
+            uint32_t slot = extensionHash(entry.extension, seed);
+            if (used[slot]) {
+                collision = true;
+                break;
+            }
+            used[slot] = true;
+        }
+        if (!collision) return seed;
+    }
+    return 0;
+}
+
+constexpr uint32_t kExtensionSeed = findExtensionSeed();
+static_assert(kExtensionSeed != 0, "no collision-free seed for EXTENSION_TO_MIME");
+static_assert(std::size(EXTENSION_TO_MIME) < 255, "slot index must fit uint8_t");
+
+// Слот → номер записи + 1 (0 — пустой слот)
+constexpr auto EXTENSION_SLOTS = [] {
+    std::array<uint8_t, kExtensionSlots> slots{};
+    for (size_t i = 0; i < std::size(EXTENSION_TO_MIME); ++i) {
+        slots[extensionHash(EXTENSION_TO_MIME[i].extension, kExtensionSeed)] = static_cast<uint8_t>(i + 1);
+    }
+    return slots;
+}();
+
+static_assert([] {
+    for (const auto& entry : EXTENSION_TO_MIME) {
+        if (entry.extension.size() > kMaxExtensionLength) return false;
+    }
+    return true;
+}(), "extension longer than kMaxExtensionLength");
+
+/// MIME тип по расширению (без точки, любой регистр); пусто — неизвестно
+std::string_view lookupExtension(std::string_view extension) {
+    if (extension.empty() || extension.size() > kMaxExtensionLength) {
+        return {};
+    }
+    char lower[kMaxExtensionLength];
+    for (size_t i = 0; i < extension.size(); ++i) {
+        char c = extension[i];
+        lower[i] = (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+    }
+    std::string_view key(lower, extension.size());
+
+    uint8_t index = EXTENSION_SLOTS[extensionHash(key, kExtensionSeed)];
+    if (index == 0 || EXTENSION_TO_MIME[index - 1].extension != key) {
+        return {};
+    }
+    return EXTENSION_TO_MIME[index - 1].mimeType;
+}
+
 // ═══════════════════════════════════════════════════════════
 // Magic bytes для определения типа
 // ═══════════════════════════════════════════════════════════
 
-struct MagicSignature {
-    std::array<uint8_t, 16> bytes;
-    size_t length;
-    size_t offset;
-    const char* mimeType;
-};
+// Сигнатуры разветвляются по первому байту (корень префиксного дерева),
+// остаток сравнивается целиком: у сигнатур с общим первым байтом
+// (RIFF/Rar!, JPEG/MP3) различается уже второй байт
+
+constexpr size_t kHeaderSize = 16;      // Хватает самой длинной проверки (RIFF....WEBP)
+
+/// MIME тип по первым байтам файла; пусто — сигнатура не распознана
+std::string_view sniffHeader(const uint8_t* header, size_t size) {
+    if (size < 2) {
+        return {};
+    }
+    auto matches = [&](size_t offset, std::string_view signature) {
+        return size >= offset + signature.size() &&
+               std::memcmp(header + offset, signature.data(), signature.size()) == 0;
+    };
+
+    switch (header[0]) {
+        case 0xFF:
+            if (matches(1, "\xD8\xFF")) return "image/jpeg";
+            if (header[1] == 0xFB) return "audio/mpeg";     // MP3 frame sync
+            break;
+        case 0x89:
+            if (matches(1, "PNG\r\n\x1A\n")) return "image/png";
+            break;
+        case 'G':
+            if (matches(1, "IF8")) return "image/gif";
+            break;
+        case 'R':
+            // RIFF....WEBP — WebP, прочий RIFF считается AVI
+            if (matches(1, "IFF")) return matches(8, "WEBP") ? "image/webp" : "video/x-msvideo";
+            if (matches(1, "ar!\x1A\x07")) return "application/vnd.rar";
+            break;
+        case '%':
+            if (matches(1, "PDF")) return "application/pdf";
+            break;
+        case 'P':
+            // ZIP (также DOCX, XLSX, etc.)
+            if (matches(1, "K\x03\x04")) return "application/zip";
+            break;
+        case '7':
+            if (matches(1, "z\xBC\xAF\x27\x1C")) return "application/x-7z-compressed";
+            break;
+        case 'I':
+            if (matches(1, "D3")) return "audio/mpeg";     // MP3 (ID3)
+            break;
+        case 'B':
+            if (header[1] == 'M') return "image/bmp";
+            break;
+        case 0x1F:
+            if (header[1] == 0x8B) return "application/gzip";
+            break;
+        case 'M':
+            if (header[1] == 'Z') return "application/x-msdownload";   // EXE/DLL
+            break;
+    }
 
-static const std::array<MagicSignature, 15> MAGIC_SIGNATURES = {{
-    // JPEG
-    {{0xFF, 0xD8, 0xFF}, 3, 0, "image/jpeg"},
-    // PNG
-    {{0x89, 0x50, 0x4E, 0x47, 0x0D, 0x0A, 0x1A, 0x0A}, 8, 0, "image/png"},
-    // GIF
-    {{0x47, 0x49, 0x46, 0x38}, 4, 0, "image/gif"},
-    // WebP (RIFF....WEBP)
-    {{0x52, 0x49, 0x46, 0x46}, 4, 0, "image/webp"}, // Проверяем только RIFF
-    // PDF
-    {{0x25, 0x50, 0x44, 0x46}, 4, 0, "application/pdf"},
-    // ZIP (также DOCX, XLSX, etc.)
-    {{0x50, 0x4B, 0x03, 0x04}, 4, 0, "application/zip"},
-    // RAR
-    {{0x52, 0x61, 0x72, 0x21, 0x1A, 0x07}, 6, 0, "application/vnd.rar"},
-    // 7z
-    {{0x37, 0x7A, 0xBC, 0xAF, 0x27, 0x1C}, 6, 0, "application/x-7z-compressed"},
-    // MP3 (ID3)
-    {{0x49, 0x44, 0x33}, 3, 0, "audio/mpeg"},
-    // MP3 (frame sync)
-    {{0xFF, 0xFB}, 2, 0, "audio/mpeg"},
-    // MP4/M4A
-    {{0x66, 0x74, 0x79, 0x70}, 4, 4, "video/mp4"}, // "ftyp" at offset 4
-    // AVI
-    {{0x52, 0x49, 0x46, 0x46}, 4, 0, "video/x-msvideo"}, // RIFF
-    // BMP
-    {{0x42, 0x4D}, 2, 0, "image/bmp"},
-    // GZIP
-    {{0x1F, 0x8B}, 2, 0, "application/gzip"},
-    // EXE/DLL
-    {{0x4D, 0x5A}, 2, 0, "application/x-msdownload"},
-}};
+    // MP4/M4A: "ftyp" по смещению 4, первые байты — размер блока
+    if (matches(4, "ftyp")) return "video/mp4";
+    return {};
+}
+
+} // namespace
 
 // ═══════════════════════════════════════════════════════════
 // Реализация
@@ -168,19 +272,14 @@ std::string MimeTypeDetector::extractExtension(const std::string& filename) {
 }
 
 std::string MimeTypeDetector::detectByExtension(const std::string& extension) {
-    std::string ext = extension;
+    std::string_view ext = extension;
     // Убираем точку если есть
     if (!ext.empty() && ext[0] == '.') {
-        ext = ext.substr(1);
+        ext.remove_prefix(1);
     }
-    std::transform(ext.begin(), ext.end(), ext.begin(),
-                   [](unsigned char c) { return std::tolower(c); });
 
-    auto it = EXTENSION_TO_MIME.find(ext);
-    if (it != EXTENSION_TO_MIME.end()) {
-        return it->second;
-    }
-    return "application/octet-stream";
+    auto mime = lookupExtension(ext);
+    return mime.empty() ? "application/octet-stream" : std::string(mime);
 }
 
 std::string MimeTypeDetector::detectByContent(const std::string& filePath) {
@@ -189,45 +288,14 @@ std::string MimeTypeDetector::detectByContent(const std::string& filePath) {
         return "application/octet-stream";
     }
 
-    // Читаем первые 32 байта
-    std::array<uint8_t, 32> header{};
+    std::array<uint8_t, kHeaderSize> header{};
     file.read(reinterpret_cast<char*>(header.data()), header.size());
-    auto bytesRead = file.gcount();
-
-    if (bytesRead < 2) {
-        return "application/octet-stream";
-    }
-
-    // Проверяем сигнатуры
-    for (const auto& sig : MAGIC_SIGNATURES) {
-        if (sig.offset + sig.length > static_cast<size_t>(bytesRead)) {
-            continue;
-        }
-
-        bool matches = true;
-        for (size_t i = 0; i < sig.length; ++i) {
-            if (header[sig.offset + i] != sig.bytes[i]) {
-                matches = false;
-                break;
-            }
-        }
-
-        if (matches) {
-            // Специальная проверка для WebP (RIFF....WEBP)
-            if (std::string(sig.mimeType) == "image/webp") {
-                if (bytesRead >= 12 &&
-                    header[8] == 'W' && header[9] == 'E' &&
-                    header[10] == 'B' && header[11] == 'P') {
-                    return "image/webp";
-                }
-                // Это может быть AVI, продолжаем поиск
-                continue;
-            }
-            return sig.mimeType;
-        }
-    }
+    return detectByHeader(header.data(), static_cast<size_t>(file.gcount()));
+}
 
-    return "application/octet-stream";
+std::string MimeTypeDetector::detectByHeader(const uint8_t* data, size_t size) {
+    auto mime = sniffHeader(data, size);
+    return mime.empty() ? "application/octet-stream" : std::string(mime);
 }
 
 std::string MimeTypeDetector::detect(const std::string& filePath, const std::string& extension) {
@@ -247,4 +315,3 @@ ContentType MimeTypeDetector::mimeToContentType(const std::string& mimeType) {
 }
 
 } // namespace FamilyVault
-
@@ -0,0 +1,395 @@
+#include "familyvault/RoaringBitmap.h"
+#include <algorithm>
+#include <bit>
+
+namespace FamilyVault {
+
+namespace {
+
+inline uint16_t highBits(uint32_t value) { return static_cast<uint16_t>(value >> 16); }
+inline uint16_t lowBits(uint32_t value) { return static_cast<uint16_t>(value & 0xFFFF); }
+
+inline bool testBit(const std::vector<uint64_t>& bits, uint16_t low) {
+    return (bits[low >> 6] >> (low & 63)) & 1ULL;
+}
+
+} // namespace
+
+// ═══════════════════════════════════════════════════════════
+// Container
+// ═══════════════════════════════════════════════════════════
+
+bool RoaringBitmap::Container::contains(uint16_t low) const {
+    if (isBitset()) {
+        return testBit(bits, low);
+    }
+    return std::binary_search(array.begin(), array.end(), low);
+}
+
+bool RoaringBitmap::Container::add(uint16_t low) {
+    if (isBitset()) {
+        uint64_t mask = 1ULL << (low & 63);
+        if (bits[low >> 6] & mask) return false;
+        bits[low >> 6] |= mask;
+        ++cardinality;
+        return true;
+    }
+
+    auto it = std::lower_bound(array.begin(), array.end(), low);
+    if (it != array.end() && *it == low) return false;
+    array.insert(it, low);
+    ++cardinality;
+    normalize();
+    return true;
+}
+
+bool RoaringBitmap::Container::remove(uint16_t low) {
+    if (isBitset()) {
+        uint64_t mask = 1ULL << (low & 63);
+        if (!(bits[low >> 6] & mask)) return false;
+        bits[low >> 6] &= ~mask;
+        --cardinality;
+        normalize();
+        return true;
+    }
+
+    auto it = std::lower_bound(array.begin(), array.end(), low);
+    if (it == array.end() || *it != low) return false;
+    array.erase(it);
+    --cardinality;
+    return true;
+}
+
+void RoaringBitmap::Container::normalize() {
+    if (isBitset() && cardinality <= kArrayMaxSize) {
+        std::vector<uint16_t> values;
+        values.reserve(cardinality);
+        for (size_t w = 0; w < kBitsetWords; ++w) {
+            uint64_t word = bits[w];
+            while (word) {
+                int bit = std::countr_zero(word);
+                values.push_back(static_cast<uint16_t>(w * 64 + bit));
+                word &= word - 1;
+            }
+        }
+        array = std::move(values);
+        bits.clear();
+        bits.shrink_to_fit();
+    } else if (!isBitset() && cardinality > kArrayMaxSize) {
+        bits.assign(kBitsetWords, 0);
+        for (uint16_t low : array) {
+            bits[low >> 6] |= 1ULL << (low & 63);
+        }
+        array.clear();
+        array.shrink_to_fit();
+    }
+}
+
+uint64_t RoaringBitmap::andCardinality(const Container& a, const Container& b) {
+    if (a.isBitset() && b.isBitset()) {
+        uint64_t count = 0;
+        for (size_t w = 0; w < kBitsetWords; ++w) {
+            count += std::popcount(a.bits[w] & b.bits[w]);
+        }
+        return count;
+    }
+    if (a.isBitset() || b.isBitset()) {
+        const Container& arr = a.isBitset() ? b : a;
+        const Container& set = a.isBitset() ? a : b;
+        uint64_t count = 0;
+        for (uint16_t low : arr.array) {
+            count += testBit(set.bits, low) ? 1 : 0;
+        }
+        return count;
+    }
+
+    uint64_t count = 0;
+    auto i = a.array.begin();
+    auto j = b.array.begin();
+    while (i != a.array.end() && j != b.array.end()) {
+        if (*i < *j) {
+            ++i;
+        } else if (*j < *i) {
+            ++j;
+        } else {
+            ++count;
+            ++i;
+            ++j;
+        }
+    }
+    return count;
+}
+
+RoaringBitmap::Container RoaringBitmap::intersect(const Container& a, const Container& b) {
+    Container result;
+    result.key = a.key;
+
+    if (a.isBitset() && b.isBitset()) {
+        result.bits.resize(kBitsetWords);
+        for (size_t w = 0; w < kBitsetWords; ++w) {
+            result.bits[w] = a.bits[w] & b.bits[w];
+            result.cardinality += std::popcount(result.bits[w]);
+        }
+        result.normalize();
+        return result;
+    }
+    if (a.isBitset() || b.isBitset()) {
+        const Container& arr = a.isBitset() ? b : a;
+        const Container& set = a.isBitset() ? a : b;
+        for (uint16_t low : arr.array) {
+            if (testBit(set.bits, low)) result.array.push_back(low);
+        }
+        result.cardinality = static_cast<uint32_t>(result.array.size());
+        return result;
+    }
+
+    std::set_intersection(a.array.begin(), a.array.end(),
+                          b.array.begin(), b.array.end(),
+                          std::back_inserter(result.array));
+    result.cardinality = static_cast<uint32_t>(result.array.size());
+    return result;
+}
+
+RoaringBitmap::Container RoaringBitmap::unite(const Container& a, const Container& b) {
+    Container result;
+    result.key = a.key;
+
+    if (a.isBitset() || b.isBitset() || a.cardinality + b.cardinality > kArrayMaxSize) {
+        result.bits.assign(kBitsetWords, 0);
+        for (const Container* c : {&a, &b}) {
+            if (c->isBitset()) {
+                for (size_t w = 0; w < kBitsetWords; ++w) result.bits[w] |= c->bits[w];
+            } else {
+                for (uint16_t low : c->array) result.bits[low >> 6] |= 1ULL << (low & 63);
+            }
+        }
+        for (uint64_t word : result.bits) result.cardinality += std::popcount(word);
+        result.normalize();
+        return result;
+    }
+
+    std::set_union(a.array.begin(), a.array.end(),
+                   b.array.begin(), b.array.end(),
+                   std::back_inserter(result.array));
+    result.cardinality = static_cast<uint32_t>(result.array.size());
+    return result;
+}
+
+RoaringBitmap::Container RoaringBitmap::subtract(const Container& a, const Container& b) {
+    Container result;
+    result.key = a.key;
+
+    if (a.isBitset()) {
+        result.bits = a.bits;
+        if (b.isBitset()) {
+            for (size_t w = 0; w < kBitsetWords; ++w) result.bits[w] &= ~b.bits[w];
+        } else {
+            for (uint16_t low : b.array) result.bits[low >> 6] &= ~(1ULL << (low & 63));
+        }
+        for (uint64_t word : result.bits) result.cardinality += std::popcount(word);
+        result.normalize();
+        return result;
+    }
+
+    for (uint16_t low : a.array) {
+        if (!b.contains(low)) result.array.push_back(low);
+    }
+    result.cardinality = static_cast<uint32_t>(result.array.size());
+    return result;
+}
+
+// ═══════════════════════════════════════════════════════════
+// RoaringBitmap
+// ═══════════════════════════════════════════════════════════
+
+RoaringBitmap RoaringBitmap::fromValues(const std::vector<uint32_t>& values) {
+    std::vector<uint32_t> sorted = values;
+    std::sort(sorted.begin(), sorted.end());
+    sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+
+    RoaringBitmap bitmap;
+    for (uint32_t value : sorted) {
+        uint16_t key = highBits(value);
+        if (bitmap.m_containers.empty() || bitmap.m_containers.back().key != key) {
+            bitmap.m_containers.push_back(Container(key));
+        }
+        Container& c = bitmap.m_containers.back();
+        c.array.push_back(lowBits(value));
+        ++c.cardinality;
+    }
+    for (auto& c : bitmap.m_containers) {
+        c.normalize();
+    }
+    return bitmap;
+}
+
+std::vector<RoaringBitmap::Container>::iterator RoaringBitmap::findContainer(uint16_t key) {
+    return std::lower_bound(m_containers.begin(), m_containers.end(), key,
+                            [](const Container& c, uint16_t k) { return c.key < k; });
+}
+
+std::vector<RoaringBitmap::Container>::const_iterator RoaringBitmap::findContainer(uint16_t key) const {
+    return std::lower_bound(m_containers.begin(), m_containers.end(), key,
+                            [](const Container& c, uint16_t k) { return c.key < k; });
+}
+
+void RoaringBitmap::add(uint32_t value) {
+    uint16_t key = highBits(value);
+    auto it = findContainer(key);
+    if (it == m_containers.end() || it->key != key) {
+        it = m_containers.insert(it, Container(key));
+    }
+    it->add(lowBits(value));
+}
+
+bool RoaringBitmap::remove(uint32_t value) {
+    uint16_t key = highBits(value);
+    auto it = findContainer(key);
+    if (it == m_containers.end() || it->key != key) {
+        return false;
+    }
+    bool removed = it->remove(lowBits(value));
+    if (it->cardinality == 0) {
+        m_containers.erase(it);
+    }
+    return removed;
+}
+
+bool RoaringBitmap::contains(uint32_t value) const {
+    uint16_t key = highBits(value);
+    auto it = findContainer(key);
+    return it != m_containers.end() && it->key == key && it->contains(lowBits(value));
+}
+
+uint64_t RoaringBitmap::cardinality() const {
+    uint64_t total = 0;
+    for (const auto& c : m_containers) {
+        total += c.cardinality;
+    }
+    return total;
+}
+
+uint64_t RoaringBitmap::andCardinality(const RoaringBitmap& other) const {
+    uint64_t total = 0;
+    auto i = m_containers.begin();
+    auto j = other.m_containers.begin();
+    while (i != m_containers.end() && j != other.m_containers.end()) {
+        if (i->key < j->key) {
+            ++i;
+        } else if (j->key < i->key) {
+            ++j;
+        } else {
+            total += andCardinality(*i, *j);
+            ++i;
+            ++j;
+        }
+    }
+    return total;
+}
+
+RoaringBitmap& RoaringBitmap::operator|=(const RoaringBitmap& other) {
+    std::vector<Container> merged;
+    merged.reserve(m_containers.size() + other.m_containers.size());
+
+    auto i = m_containers.begin();
+    auto j = other.m_containers.begin();
+    while (i != m_containers.end() || j != other.m_containers.end()) {
+        if (j == other.m_containers.end() || (i != m_containers.end() && i->key < j->key)) {
+            merged.push_back(std::move(*i++));
+        } else if (i == m_containers.end() || j->key < i->key) {
+            merged.push_back(*j++);
+        } else {
+            merged.push_back(unite(*i, *j));
+            ++i;
+            ++j;
+        }
+    }
+
+    m_containers = std::move(merged);
+    return *this;
+}
+
+RoaringBitmap& RoaringBitmap::operator&=(const RoaringBitmap& other) {
+    std::vector<Container> result;
+
+    auto i = m_containers.begin();
+    auto j = other.m_containers.begin();
+    while (i != m_containers.end() && j != other.m_containers.end()) {
+        if (i->key < j->key) {
+            ++i;
+        } else if (j->key < i->key) {
+            ++j;
+        } else {
+            Container c = intersect(*i, *j);
+            if (c.cardinality > 0) result.push_back(std::move(c));
+            ++i;
+            ++j;
+        }
+    }
+
+    m_containers = std::move(result);
+    return *this;
+}
+
+RoaringBitmap& RoaringBitmap::operator-=(const RoaringBitmap& other) {
+    std::vector<Container> result;
+    result.reserve(m_containers.size());
+
+    auto j = other.m_containers.begin();
+    for (auto& c : m_containers) {
+        while (j != other.m_containers.end() && j->key < c.key) ++j;
+        if (j != other.m_containers.end() && j->key == c.key) {
+            Container diff = subtract(c, *j);
+            if (diff.cardinality > 0) result.push_back(std::move(diff));
+        } else {
+            result.push_back(std::move(c));
+        }
+    }
+
+    m_containers = std::move(result);
+    return *this;
+}
+
+bool RoaringBitmap::operator==(const RoaringBitmap& other) const {
+    if (m_containers.size() != other.m_containers.size()) return false;
+    for (size_t i = 0; i < m_containers.size(); ++i) {
+        const auto& a = m_containers[i];
+        const auto& b = other.m_containers[i];
+        if (a.key != b.key || a.cardinality != b.cardinality) return false;
+        if (andCardinality(a, b) != a.cardinality) return false;
+    }
+    return true;
+}
+
+std::vector<uint32_t> RoaringBitmap::toVector() const {
+    std::vector<uint32_t> values;
+    values.reserve(cardinality());
+    for (const auto& c : m_containers) {
+        uint32_t base = static_cast<uint32_t>(c.key) << 16;
+        if (c.isBitset()) {
+            for (size_t w = 0; w < kBitsetWords; ++w) {
+                uint64_t word = c.bits[w];
+                while (word) {
+                    int bit = std::countr_zero(word);
+                    values.push_back(base | static_cast<uint32_t>(w * 64 + bit));
+                    word &= word - 1;
+                }
+            }
+        } else {
+            for (uint16_t low : c.array) {
+                values.push_back(base | low);
+            }
+        }
+    }
+    return values;
+}
+
+size_t RoaringBitmap::memoryUsage() const {
+    size_t bytes = sizeof(*this) + m_containers.capacity() * sizeof(Container);
+    for (const auto& c : m_containers) {
+        bytes += c.array.capacity() * sizeof(uint16_t) + c.bits.capacity() * sizeof(uint64_t);
+    }
+    return bytes;
+}
+
+} // namespace FamilyVault
@@ -0,0 +1,24 @@
+// SimdSupport.h — Общие макросы для SIMD-ядер (x86-64: SSE2 базово, AVX2 по CPUID)
+// Только для core/src: ядра компилируются без глобальных -mavx2/-msse4
+
+#pragma once
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define FV_SIMD_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#else
+#define FV_SIMD_X86 0
+#endif
+
+// target на функции включает набор инструкций только для неё;
+// flatten встраивает в ядро общий цикл и классификаторы блоков
+#if defined(__GNUC__) || defined(__clang__)
+#define FV_TARGET_AVX2 __attribute__((target("avx2")))
+#define FV_TARGET_AVX2_FLATTEN __attribute__((target("avx2"), flatten))
+#else
+#define FV_TARGET_AVX2
+#define FV_TARGET_AVX2_FLATTEN
+#endif
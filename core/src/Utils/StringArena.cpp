@@ -0,0 +1,49 @@
+#include "familyvault/StringArena.h"
+#include <cstring>
+
+namespace FamilyVault {
+
+std::string_view StringArena::store(std::string_view text) {
+    if (text.empty()) return {};
+
+    if (text.size() > m_remaining) {
+        if (text.size() > kBlockSize / 4) {
+            // Длинная строка — отдельный блок, текущий остаётся для коротких
+            m_blocks.push_back(std::make_unique<char[]>(text.size()));
+            std::memcpy(m_blocks.back().get(), text.data(), text.size());
+            m_bytesUsed += text.size();
+            return {m_blocks.back().get(), text.size()};
+        }
+        m_blocks.push_back(std::make_unique<char[]>(kBlockSize));
+        m_cursor = m_blocks.back().get();
+        m_remaining = kBlockSize;
+    }
+
+    char* dest = m_cursor;
+    std::memcpy(dest, text.data(), text.size());
+    m_cursor += text.size();
+    m_remaining -= text.size();
+    m_bytesUsed += text.size();
+    return {dest, text.size()};
+}
+
+std::string_view StringArena::intern(std::string_view text) {
+    if (text.empty()) return {};
+
+    auto it = m_interned.find(text);
+    if (it != m_interned.end()) return *it;
+
+    std::string_view stored = store(text);
+    m_interned.insert(stored);
+    return stored;
+}
+
+void StringArena::clear() {
+    m_blocks.clear();
+    m_interned.clear();
+    m_cursor = nullptr;
+    m_remaining = 0;
+    m_bytesUsed = 0;
+}
+
+} // namespace FamilyVault
@@ -0,0 +1,431 @@
+#include "familyvault/TextNormalizer.h"
+#include "SimdSupport.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+namespace FamilyVault {
+
+namespace {
+
+constexpr char kReplacementChar[] = "\xEF\xBF\xBD";  // U+FFFD
+
+bool isAsciiSpace(unsigned char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+/// Длина валидной UTF-8 последовательности, начинающейся с p[0]; 0 — невалидна
+size_t utf8SequenceLength(const unsigned char* p, size_t available) {
+    unsigned char c = p[0];
+    if (c < 0x80) return 1;
+    if (c < 0xC2) return 0;  // Продолжение без начала или overlong 2-байтной формы
+
+    auto cont = [p](size_t i) { return (p[i] & 0xC0) == 0x80; };
+
+    if (c < 0xE0) {
+        return available >= 2 && cont(1) ? 2 : 0;
+    }
+    if (c < 0xF0) {
+        if (available < 3) return 0;
+        // E0: overlong, ED: суррогаты U+D800..U+DFFF
+        unsigned char lo = c == 0xE0 ? 0xA0 : 0x80;
+        unsigned char hi = c == 0xED ? 0x9F : 0xBF;
+        return p[1] >= lo && p[1] <= hi && cont(2) ? 3 : 0;
+    }
+    if (c < 0xF5) {
+        if (available < 4) return 0;
+        // F0: overlong, F4: выше U+10FFFF
+        unsigned char lo = c == 0xF0 ? 0x90 : 0x80;
+        unsigned char hi = c == 0xF4 ? 0x8F : 0xBF;
+        return p[1] >= lo && p[1] <= hi && cont(2) && cont(3) ? 4 : 0;
+    }
+    return 0;
+}
+
+/// Начало многобайтного символа, обрезанное концом текста (лимит размера файла)
+bool isTruncatedTail(const unsigned char* p, size_t available) {
+    unsigned char c = p[0];
+    size_t needed = c >= 0xF0 ? 4 : c >= 0xE0 ? 3 : 2;
+    if (c < 0xC2 || c > 0xF4 || available >= needed) return false;
+    for (size_t i = 1; i < available; ++i) {
+        if ((p[i] & 0xC0) != 0x80) return false;
+    }
+    return true;
+}
+
+int countTrailingZeros(uint32_t mask) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return static_cast<int>(index);
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+
+/// Приёмник результата: пробел откладывается до следующего текста,
+/// поэтому пробелы в начале и в конце не попадают в результат.
+/// Пишет в заранее выделенный буфер: результат не длиннее входа,
+/// кроме замен на U+FFFD (+2 байта на каждую).
+/// Продолжает запись с позиции length — так NormalizingSink пишет фрагменты
+class Emitter {
+public:
+    Emitter(std::string& out, size_t length, bool pendingSpace, size_t capacity)
+        : m_out(out), m_length(length), m_pendingSpace(pendingSpace) {
+        reserve(capacity);
+    }
+
+    void text(const unsigned char* data, size_t size) {
+        if (size == 0) return;
+        reserve(size + 1);
+        if (m_pendingSpace && m_length > 0) m_out[m_length++] = ' ';
+        m_pendingSpace = false;
+        std::memcpy(m_out.data() + m_length, data, size);
+        m_length += size;
+    }
+
+    void space() { m_pendingSpace = true; }
+
+    size_t length() const { return m_length; }
+    bool pendingSpace() const { return m_pendingSpace; }
+
+    void finish() { m_out.resize(m_length); }
+
+private:
+    std::string& m_out;
+    size_t m_length = 0;
+    bool m_pendingSpace = false;
+
+    void reserve(size_t extra) {
+        if (m_length + extra > m_out.size()) {
+            m_out.resize(std::max(m_out.size() * 2, m_length + extra));
+        }
+    }
+};
+
+/// Побайтовая обработка [i, limit); многобайтный символ может выйти за limit
+size_t scalarRun(const unsigned char* data, size_t size, size_t i, size_t limit, Emitter& out) {
+    size_t runStart = i;  // Начало участка без пробелов и ошибок
+    while (i < limit) {
+        unsigned char c = data[i];
+        if (c < 0x80) {
+            if (isAsciiSpace(c)) {
+                out.text(data + runStart, i - runStart);
+                out.space();
+                runStart = i + 1;
+            }
+            ++i;
+            continue;
+        }
+
+        size_t length = utf8SequenceLength(data + i, size - i);
+        if (length == 0 && isTruncatedTail(data + i, size - i)) {
+            out.text(data + runStart, i - runStart);
+            return size;
+        }
+        if (length == 0) {
+            out.text(data + runStart, i - runStart);
+            out.text(reinterpret_cast<const unsigned char*>(kReplacementChar), 3);
+            runStart = ++i;
+        } else {
+            i += length;
+        }
+    }
+    out.text(data + runStart, i - runStart);
+    return i;
+}
+
+/// Маски блока: бит на байт
+struct BlockMasks {
+    uint32_t whitespace;
+    uint32_t nonAscii;
+};
+
+/// Общий цикл для блочных ядер: чистый ASCII копируется блоком,
+/// ASCII с пробелами — участками между масками, остальное — скалярно
+template <typename Block>
+void runBlocks(const unsigned char* data, size_t size, Emitter& out) {
+    constexpr size_t kWidth = Block::kWidth;
+    constexpr uint32_t kFull = kWidth == 32 ? 0xFFFFFFFFu : (1u << kWidth) - 1;
+    constexpr size_t kScalarBlocks = 4;
+
+    size_t i = 0;
+    while (i + kWidth <= size) {
+        BlockMasks masks = Block::classify(data + i);
+
+        if (masks.nonAscii != 0) {
+            // Не-ASCII текст обычно идёт подряд (кириллица): скалярно сразу
+            // несколько блоков; последовательность на границе scalarRun дочитает
+            i = scalarRun(data, size, i, std::min(size, i + kWidth * kScalarBlocks), out);
+            continue;
+        }
+        if (masks.whitespace == 0) {
+            out.text(data + i, kWidth);
+            i += kWidth;
+            continue;
+        }
+
+        uint32_t text = ~masks.whitespace & kFull;
+        size_t pos = 0;
+        while (pos < kWidth) {
+            uint32_t restWs = masks.whitespace >> pos;
+            if (restWs == 0) {
+                out.text(data + i + pos, kWidth - pos);
+                break;
+            }
+            size_t wsAt = pos + countTrailingZeros(restWs);
+            out.text(data + i + pos, wsAt - pos);
+            out.space();
+
+            uint32_t restText = text >> wsAt;
+            if (restText == 0) break;
+            pos = wsAt + countTrailingZeros(restText);
+        }
+        i += kWidth;
+    }
+    scalarRun(data, size, i, size, out);
+}
+
+#if FV_SIMD_X86
+
+struct Sse2Block {
+    static constexpr size_t kWidth = 16;
+
+    static BlockMasks classify(const unsigned char* p) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        // \t..\r = 0x09..0x0D; байты >= 0x80 отрицательны и в диапазон не попадают
+        __m128i space = _mm_cmpeq_epi8(v, _mm_set1_epi8(' '));
+        __m128i control = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('\t' - 1)),
+                                        _mm_cmplt_epi8(v, _mm_set1_epi8('\r' + 1)));
+        return {static_cast<uint32_t>(_mm_movemask_epi8(_mm_or_si128(space, control))),
+                static_cast<uint32_t>(_mm_movemask_epi8(v))};
+    }
+};
+
+struct Avx2Block {
+    static constexpr size_t kWidth = 32;
+
+    FV_TARGET_AVX2 static BlockMasks classify(const unsigned char* p) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        __m256i space = _mm256_cmpeq_epi8(v, _mm256_set1_epi8(' '));
+        __m256i control = _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8('\t' - 1)),
+                                           _mm256_cmpgt_epi8(_mm256_set1_epi8('\r' + 1), v));
+        return {static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_or_si256(space, control))),
+                static_cast<uint32_t>(_mm256_movemask_epi8(v))};
+    }
+};
+
+void normalizeSse2(const unsigned char* data, size_t size, Emitter& out) {
+    runBlocks<Sse2Block>(data, size, out);
+}
+
+FV_TARGET_AVX2_FLATTEN void normalizeAvx2(const unsigned char* data, size_t size, Emitter& out) {
+    runBlocks<Avx2Block>(data, size, out);
+}
+
+SimdLevel detectCpu() {
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return SimdLevel::Sse2;
+    __cpuid(info, 1);
+    // OSXSAVE + AVX: ОС сохраняет регистры YMM
+    bool osYmm = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && (_xgetbv(0) & 6) == 6;
+    __cpuidex(info, 7, 0);
+    return osYmm && (info[1] & (1 << 5)) ? SimdLevel::Avx2 : SimdLevel::Sse2;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") ? SimdLevel::Avx2 : SimdLevel::Sse2;
+#endif
+}
+
+#else
+
+SimdLevel detectCpu() {
+    return SimdLevel::Scalar;
+}
+
+#endif
+
+void normalizeWith(SimdLevel level, const unsigned char* data, size_t size, Emitter& out) {
+    switch (level) {
+#if FV_SIMD_X86
+        case SimdLevel::Avx2:
+            normalizeAvx2(data, size, out);
+            break;
+        case SimdLevel::Sse2:
+            normalizeSse2(data, size, out);
+            break;
+#endif
+        default:
+            scalarRun(data, size, 0, size, out);
+            break;
+    }
+}
+
+/// Длина начала символа, обрезанного концом фрагмента (0 — конец на границе символа)
+size_t incompleteTail(const unsigned char* data, size_t size) {
+    for (size_t k = 1; k <= std::min<size_t>(3, size); ++k) {
+        unsigned char c = data[size - k];
+        if (c < 0x80) return 0;
+        if (c >= 0xC0) return isTruncatedTail(data + size - k, k) ? k : 0;
+    }
+    return 0;
+}
+
+size_t expectedLength(unsigned char lead) {
+    return lead >= 0xF0 ? 4 : lead >= 0xE0 ? 3 : 2;
+}
+
+} // namespace
+
+// ═══════════════════════════════════════════════════════════
+// TextNormalizer
+// ═══════════════════════════════════════════════════════════
+
+SimdLevel TextNormalizer::detectedLevel() {
+    static const SimdLevel level = detectCpu();
+    return level;
+}
+
+std::string TextNormalizer::normalize(std::string_view text) {
+    return normalize(text, detectedLevel());
+}
+
+std::string TextNormalizer::normalize(std::string_view text, SimdLevel level) {
+    if (static_cast<int>(level) > static_cast<int>(detectedLevel())) {
+        level = detectedLevel();
+    }
+
+    std::string result;
+    Emitter out(result, 0, false, text.size());
+    normalizeWith(level, reinterpret_cast<const unsigned char*>(text.data()), text.size(), out);
+    out.finish();
+    return result;
+}
+
+bool TextNormalizer::isValidUtf8(std::string_view text) {
+    const auto* data = reinterpret_cast<const unsigned char*>(text.data());
+    size_t size = text.size();
+    size_t i = 0;
+    while (i < size) {
+        // ASCII по 8 байт
+        if (i + 8 <= size) {
+            uint64_t word;
+            std::memcpy(&word, data + i, sizeof(word));
+            if ((word & 0x8080808080808080ull) == 0) {
+                i += 8;
+                continue;
+            }
+        }
+        size_t length = utf8SequenceLength(data + i, size - i);
+        if (length == 0) return false;
+        i += length;
+    }
+    return true;
+}
+
+// ═══════════════════════════════════════════════════════════
+// NormalizingSink
+// ═══════════════════════════════════════════════════════════
+
+NormalizingSink::NormalizingSink(size_t maxBytes, SimdLevel level)
+    : m_maxBytes(maxBytes)
+    , m_level(std::min(level, TextNormalizer::detectedLevel()))
+    , m_full(maxBytes == 0)
+{
+}
+
+void NormalizingSink::append(std::string_view text) {
+    // Кусок не длиннее оставшегося места: нормализация текст не удлиняет
+    // (кроме замен на U+FFFD), поэтому лимит превышается не больше чем на кусок
+    constexpr size_t kMinPiece = 64;
+
+    const auto* data = reinterpret_cast<const unsigned char*>(text.data());
+    size_t size = text.size();
+    while (size > 0 && !m_full) {
+        if (m_carryLength > 0) {
+            size_t used = completeCarry(data, size);
+            data += used;
+            size -= used;
+            continue;
+        }
+
+        size_t piece = std::min(size, std::max(kMinPiece, m_maxBytes - m_length));
+        size_t tail = incompleteTail(data, piece);
+
+        // Перед перенесённым символом может стоять оборванное начало другого:
+        // ядро приняло бы его за конец текста и отбросило, а это ошибка
+        size_t end = piece - tail;
+        size_t broken = 0;
+        if (tail > 0) {
+            while (size_t cut = incompleteTail(data, end)) {
+                end -= cut;
+                broken += cut;
+            }
+        }
+        run(data, end);
+        emitReplacements(broken);
+        std::memcpy(m_carry, data + piece - tail, tail);
+        m_carryLength = tail;
+        data += piece;
+        size -= piece;
+    }
+}
+
+void NormalizingSink::separator() {
+    // Символ, оборванный разметкой, — битая последовательность
+    dropCarry();
+    m_pendingSpace = true;
+}
+
+void NormalizingSink::dropCarry() {
+    emitReplacements(m_carryLength);
+    m_carryLength = 0;
+}
+
+void NormalizingSink::emitReplacements(size_t count) {
+    // Как в normalize: U+FFFD за начало символа и за каждый байт продолжения
+    for (size_t i = 0; i < count; ++i) {
+        run(reinterpret_cast<const unsigned char*>(kReplacementChar), 3);
+    }
+}
+
+size_t NormalizingSink::completeCarry(const unsigned char* data, size_t size) {
+    size_t needed = expectedLength(m_carry[0]);
+    size_t used = 0;
+    while (m_carryLength < needed && used < size && (data[used] & 0xC0) == 0x80) {
+        m_carry[m_carryLength++] = data[used++];
+    }
+    if (m_carryLength == needed) {
+        run(m_carry, m_carryLength);
+        m_carryLength = 0;
+    } else if (used < size) {
+        // Продолжение не пришло: последовательность битая
+        dropCarry();
+    }
+    return used;
+}
+
+void NormalizingSink::run(const unsigned char* data, size_t size) {
+    Emitter out(m_result, m_length, m_pendingSpace, size);
+    normalizeWith(m_level, data, size, out);
+    m_length = out.length();
+    m_pendingSpace = out.pendingSpace();
+    m_full = m_length >= m_maxBytes;
+}
+
+std::string NormalizingSink::finish() {
+    size_t length = m_length;
+    if (length > m_maxBytes) {
+        length = m_maxBytes;
+        // Не разрезаем символ и не оставляем пробел в конце
+        while (length > 0 && (static_cast<unsigned char>(m_result[length]) & 0xC0) == 0x80) --length;
+        while (length > 0 && m_result[length - 1] == ' ') --length;
+    }
+    m_result.resize(length);
+    m_carryLength = 0;
+    return std::move(m_result);
+}
+
+} // namespace FamilyVault
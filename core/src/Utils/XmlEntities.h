@@ -0,0 +1,76 @@
+// XmlEntities.h — Раскрытие сущностей XML/HTML (&amp;, &#1071;, &#x44F;)
+// Общая часть MarkupStripper и XmlStreamReader
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace FamilyVault {
+
+/// Имена сущностей длиннее не интересны (quot, #1114111, #x10FFFF)
+constexpr size_t kMaxEntityName = 10;
+
+inline bool isEntityNameChar(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9');
+}
+
+/// Дописать к out раскрытую сущность (name — без '&' и ';').
+/// false — сущность неизвестна или код символа невалиден, out не изменён
+inline bool decodeEntity(std::string_view name, std::string& out) {
+    struct NamedEntity {
+        std::string_view name;
+        char text;
+    };
+    static constexpr NamedEntity kEntities[] = {
+        {"lt", '<'}, {"gt", '>'}, {"amp", '&'}, {"quot", '"'}, {"apos", '\''},
+    };
+
+    if (name.empty()) return false;
+    if (name[0] != '#') {
+        for (const auto& entity : kEntities) {
+            if (entity.name == name) {
+                out += entity.text;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    std::string_view digits = name.substr(1);
+    bool hex = !digits.empty() && (digits[0] == 'x' || digits[0] == 'X');
+    if (hex) digits.remove_prefix(1);
+    if (digits.empty()) return false;
+
+    uint32_t cp = 0;
+    for (char c : digits) {
+        uint32_t digit;
+        if (c >= '0' && c <= '9') digit = static_cast<uint32_t>(c - '0');
+        else if (hex && c >= 'a' && c <= 'f') digit = static_cast<uint32_t>(c - 'a' + 10);
+        else if (hex && c >= 'A' && c <= 'F') digit = static_cast<uint32_t>(c - 'A' + 10);
+        else return false;
+        cp = cp * (hex ? 16 : 10) + digit;
+        if (cp > 0x10FFFF) return false;
+    }
+    if (cp == 0 || (cp >= 0xD800 && cp <= 0xDFFF)) return false;
+
+    if (cp < 0x80) {
+        out += static_cast<char>(cp);
+    } else if (cp < 0x800) {
+        out += static_cast<char>(0xC0 | (cp >> 6));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else if (cp < 0x10000) {
+        out += static_cast<char>(0xE0 | (cp >> 12));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (cp >> 18));
+        out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    }
+    return true;
+}
+
+} // namespace FamilyVault
@@ -0,0 +1,284 @@
+#include "familyvault/XmlStreamReader.h"
+#include "XmlEntities.h"
+#include <algorithm>
+#include <cstring>
+
+namespace FamilyVault {
+
+namespace {
+
+/// Длиннее тег не хранится: имя сохраняется, хвост атрибутов отбрасывается
+constexpr size_t kMaxTag = 64 * 1024;
+
+bool isXmlSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+std::string_view trimSpace(std::string_view text) {
+    while (!text.empty() && isXmlSpace(text.front())) text.remove_prefix(1);
+    while (!text.empty() && isXmlSpace(text.back())) text.remove_suffix(1);
+    return text;
+}
+
+std::string_view localName(std::string_view name) {
+    auto colon = name.rfind(':');
+    return colon == std::string_view::npos ? name : name.substr(colon + 1);
+}
+
+/// Позиция '>', закрывающего тег, начатый в from (кавычки значений учитываются);
+/// size — тег не закончен во фрагменте или это комментарий/CDATA
+size_t findTagEnd(const char* data, size_t from, size_t size) {
+    if (from < size && data[from] == '!') return size;
+    char quote = 0;
+    for (size_t i = from; i < size; ++i) {
+        char c = data[i];
+        if (quote) {
+            if (c == quote) quote = 0;
+        } else if (c == '>') {
+            return i;
+        } else if (c == '"' || c == '\'') {
+            quote = c;
+        }
+    }
+    return size;
+}
+
+} // namespace
+
+// ═══════════════════════════════════════════════════════════
+// XmlStreamReader
+// ═══════════════════════════════════════════════════════════
+
+XmlStreamReader::XmlStreamReader(std::initializer_list<std::string_view> names, Handler& handler)
+    : m_names(names.begin(), names.end())
+    , m_handler(handler)
+{
+}
+
+void XmlStreamReader::feed(std::string_view chunk) {
+    const char* data = chunk.data();
+    size_t size = chunk.size();
+
+    while (size > 0) {
+        size_t used = 0;
+        switch (m_state) {
+            case State::Text:    used = feedText(data, size); break;
+            case State::Tag:     used = feedTag(data, size); break;
+            case State::Entity:  used = feedEntity(data, size); break;
+            case State::Comment: used = feedUntil(data, size); break;
+            case State::CData:   used = feedUntil(data, size); break;
+        }
+        data += used;
+        size -= used;
+    }
+}
+
+void XmlStreamReader::finish() {
+    if (m_state == State::Entity) {
+        m_handler.text("&");
+        m_handler.text(m_buffer);
+    }
+    m_state = State::Text;
+    m_tag.clear();
+    m_buffer.clear();
+    m_quote = 0;
+    m_matched = 0;
+}
+
+std::string_view XmlStreamReader::attribute(std::string_view name) const {
+    std::string_view rest = m_attributes;
+    while (true) {
+        rest = trimSpace(rest);
+        auto nameEnd = std::min(rest.find('='), rest.size());
+        std::string_view attrName = trimSpace(rest.substr(0, nameEnd));
+        if (nameEnd == rest.size()) return {};
+
+        rest = trimSpace(rest.substr(nameEnd + 1));
+        if (rest.empty() || (rest[0] != '"' && rest[0] != '\'')) return {};
+        auto close = rest.find(rest[0], 1);
+        if (close == std::string_view::npos) return {};
+
+        std::string_view value = rest.substr(1, close - 1);
+        rest.remove_prefix(close + 1);
+        if (localName(attrName) == name) return value;
+    }
+}
+
+size_t XmlStreamReader::feedText(const char* data, size_t size) {
+    const auto* tag = static_cast<const char*>(std::memchr(data, '<', size));
+    size_t limit = tag ? static_cast<size_t>(tag - data) : size;
+    const auto* amp = static_cast<const char*>(std::memchr(data, '&', limit));
+    size_t end = amp ? static_cast<size_t>(amp - data) : limit;
+
+    if (end > 0) m_handler.text(std::string_view(data, end));
+    if (end == size) return size;
+
+    if (data[end] == '<') {
+        // Тег целиком во фрагменте разбирается на месте, без копии в m_tag
+        size_t close = findTagEnd(data, end + 1, size);
+        if (close != size) {
+            closeTag(std::string_view(data + end + 1, close - end - 1));
+            return close + 1;
+        }
+        m_state = State::Tag;
+        m_tag.clear();
+        m_quote = 0;
+    } else {
+        m_buffer.clear();
+        m_state = State::Entity;
+    }
+    return end + 1;
+}
+
+size_t XmlStreamReader::feedTag(const char* data, size_t size) {
+    size_t i = 0;
+    while (i < size) {
+        if (m_quote) {
+            // '>' внутри значения атрибута тег не закрывает
+            const auto* close = static_cast<const char*>(std::memchr(data + i, m_quote, size - i));
+            size_t end = close ? static_cast<size_t>(close - data) + 1 : size;
+            appendTag(data + i, end - i);
+            if (close) m_quote = 0;
+            i = end;
+            continue;
+        }
+
+        if (!m_tag.empty() && m_tag[0] == '!' && m_tag.size() < 8) {
+            // <!-- и <![CDATA[ распознаются посимвольно: их содержимое — не тег
+            char c = data[i++];
+            if (c == '>') {
+                closeTag(m_tag);
+                return i;
+            }
+            m_tag += c;
+            if (m_tag == "!--" || m_tag == "![CDATA[") {
+                m_state = m_tag[1] == '-' ? State::Comment : State::CData;
+                m_terminator = m_tag[1] == '-' ? '-' : ']';
+                m_matched = 0;
+                m_buffer.clear();
+                return i;
+            }
+            continue;
+        }
+
+        size_t end = i;
+        while (end < size && data[end] != '>' && data[end] != '"' && data[end] != '\'' &&
+               !(data[end] == '!' && m_tag.empty() && end == i)) {
+            ++end;
+        }
+        appendTag(data + i, end - i);
+        if (end == size) return size;
+
+        char c = data[end];
+        if (c == '>') {
+            closeTag(m_tag);
+            return end + 1;
+        }
+        if (c != '!') m_quote = c;
+        appendTag(&c, 1);
+        i = end + 1;
+    }
+    return size;
+}
+
+size_t XmlStreamReader::feedEntity(const char* data, size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+        char c = data[i];
+        if (c == ';' && !m_buffer.empty()) {
+            std::string decoded;
+            if (decodeEntity(m_buffer, decoded)) {
+                m_handler.text(decoded);
+            } else {
+                // Неизвестная сущность остаётся в тексте как есть
+                m_handler.text("&" + m_buffer + ";");
+            }
+            m_state = State::Text;
+            return i + 1;
+        }
+        bool nameChar = isEntityNameChar(c) || (c == '#' && m_buffer.empty());
+        if (!nameChar || m_buffer.size() >= kMaxEntityName) {
+            // Не сущность: '&' и прочитанное — обычный текст, c разберёт feedText
+            m_handler.text("&");
+            if (!m_buffer.empty()) m_handler.text(m_buffer);
+            m_state = State::Text;
+            return i;
+        }
+        m_buffer += c;
+    }
+    return size;
+}
+
+size_t XmlStreamReader::feedUntil(const char* data, size_t size) {
+    // Терминаторы "-->" и "]]>": два символа m_terminator подряд и '>'.
+    // Содержимое CDATA копируется в m_buffer: секции редкие и короткие
+    bool emit = m_state == State::CData;
+    m_buffer.clear();
+    for (size_t i = 0; i < size; ++i) {
+        char c = data[i];
+        if (c == m_terminator) {
+            if (m_matched < 2) {
+                ++m_matched;
+            } else if (emit) {
+                m_buffer += c;
+            }
+            continue;
+        }
+        if (c == '>' && m_matched == 2) {
+            if (!m_buffer.empty()) m_handler.text(m_buffer);
+            m_buffer.clear();
+            m_matched = 0;
+            m_state = State::Text;
+            return i + 1;
+        }
+        if (emit) {
+            m_buffer.append(m_matched, m_terminator);
+            m_buffer += c;
+        }
+        m_matched = 0;
+    }
+    if (!m_buffer.empty()) m_handler.text(m_buffer);
+    m_buffer.clear();
+    return size;
+}
+
+void XmlStreamReader::appendTag(const char* data, size_t size) {
+    if (m_tag.size() < kMaxTag) {
+        m_tag.append(data, std::min(size, kMaxTag - m_tag.size()));
+    }
+}
+
+void XmlStreamReader::closeTag(std::string_view tag) {
+    m_state = State::Text;
+    // <?xml ...?>, <!DOCTYPE ...> и пустой <> не несут текста
+    if (tag.empty() || tag[0] == '?' || tag[0] == '!') return;
+
+    bool closing = tag[0] == '/';
+    if (closing) tag.remove_prefix(1);
+    tag = trimSpace(tag);
+    bool selfClosing = !closing && !tag.empty() && tag.back() == '/';
+    if (selfClosing) tag.remove_suffix(1);
+
+    size_t nameEnd = 0;
+    while (nameEnd < tag.size() && !isXmlSpace(tag[nameEnd]) && tag[nameEnd] != '/') ++nameEnd;
+    int id = lookup(tag.substr(0, nameEnd));
+    if (id < 0) return;
+
+    if (closing) {
+        m_handler.endElement(id);
+        return;
+    }
+    m_attributes = tag.substr(nameEnd);
+    m_handler.startElement(id, *this);
+    m_attributes = {};
+    if (selfClosing) m_handler.endElement(id);
+}
+
+int XmlStreamReader::lookup(std::string_view name) const {
+    name = localName(name);
+    for (size_t i = 0; i < m_names.size(); ++i) {
+        if (m_names[i] == name) return static_cast<int>(i);
+    }
+    return -1;
+}
+
+} // namespace FamilyVault
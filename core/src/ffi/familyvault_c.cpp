@@ -6,6 +6,7 @@
 #include "familyvault/Database.h"
 #include "familyvault/IndexManager.h"
 #include "familyvault/SearchEngine.h"
+#include "familyvault/SearchExecutor.h"
 #include "familyvault/TagManager.h"
 #include "familyvault/DuplicateFinder.h"
 #include "familyvault/ContentIndexer.h"
@@ -13,11 +14,16 @@
 
 #include <nlohmann/json.hpp>
 #include <spdlog/spdlog.h>
+#include <algorithm>
+#include <chrono>
 #include <cstring>
 #include <cstdlib>
 #include <memory>
 #include <mutex>
 #include <atomic>
+#include <cstdint>
+#include <new>
+#include <stdexcept>
 
 using json = nlohmann::json;
 using namespace FamilyVault;
@@ -65,10 +71,32 @@ struct ManagerWrapper {
 };
 
 using IndexManagerWrapper = ManagerWrapper<IndexManager>;
-using SearchEngineWrapper = ManagerWrapper<SearchEngine>;
 using TagManagerWrapper = ManagerWrapper<TagManager>;
 using ContentIndexerWrapper = ManagerWrapper<ContentIndexer>;
 
+/// SearchEngine wrapper also owns the async executor (created on first async query)
+struct SearchEngineWrapper : ManagerWrapper<SearchEngine> {
+    std::unique_ptr<SearchExecutor> executor;
+    std::mutex executorMutex;
+
+    using ManagerWrapper<SearchEngine>::ManagerWrapper;
+
+    ~SearchEngineWrapper() {
+        executor.reset();  // Join worker before the holder is released
+    }
+
+    SearchExecutor* getExecutor() {
+        std::lock_guard lock(executorMutex);
+        if (!executor) {
+            executor = std::make_unique<SearchExecutor>(dbHolder->getDatabase()->path(),
+                                                        dbHolder->getFacetIndex(),
+                                                        dbHolder->getSuggestIndex(),
+                                                        dbHolder->getMaintenance());
+        }
+        return executor.get();
+    }
+};
+
 /// DuplicateFinder wrapper also stores optional IndexManager reference
 struct DuplicateFinderWrapper {
     std::unique_ptr<DuplicateFinder> finder;
@@ -100,6 +128,7 @@ static json fileRecordToJson(const FileRecord& f) {
     json j;
     j["id"] = f.id;
     j["folderId"] = f.folderId;
+    j["directoryId"] = f.directoryId;
     j["relativePath"] = f.relativePath;
     j["name"] = f.name;
     j["extension"] = f.extension;
@@ -149,6 +178,142 @@ static json searchResultCompactToJson(const SearchResultCompact& r) {
     return j;
 }
 
+static json fileRecordCompactToJson(const FileRecordCompactView& f) {
+    return {
+        {"id", f.id},
+        {"folderId", f.folderId},
+        {"relativePath", f.relativePath},
+        {"folderPath", f.folderPath},
+        {"name", f.name},
+        {"extension", f.extension},
+        {"size", f.size},
+        {"contentType", static_cast<int>(f.contentType)},
+        {"modifiedAt", f.modifiedAt},
+        {"isRemote", f.isRemote},
+        {"hasThumbnail", f.hasThumbnail}
+    };
+}
+
+/// JSON array пакета; score добавляется, если пакет — результат поиска
+static json compactBatchToJson(const FileRecordCompactBatch& batch) {
+    const bool withScore = batch.scores.size() == batch.rows.size() && !batch.scores.empty();
+    json arr = json::array();
+    for (size_t i = 0; i < batch.rows.size(); ++i) {
+        json j = fileRecordCompactToJson(batch.rows[i]);
+        if (withScore) j["score"] = batch.scores[i];
+        arr.push_back(std::move(j));
+    }
+    return arr;
+}
+
+/// Собрать FVFileColumns одним блоком malloc: заголовок, колонки, арена строк.
+/// Каждая колонка выровнена на 8 байт; без scores в пакете колонка score заполняется нулями.
+static FVFileColumns* buildFileColumns(const FileRecordCompactBatch& batch) {
+    const auto& rows = batch.rows;
+    const bool withScore = batch.scores.size() == rows.size();
+    const size_t n = rows.size();
+
+    size_t stringBytes = 0;
+    for (const auto& f : rows) {
+        stringBytes += f.relativePath.size() + f.folderPath.size()
+                     + f.name.size() + f.extension.size();
+    }
+    if (stringBytes > UINT32_MAX) {
+        throw std::length_error("Result strings exceed 4 GiB");
+    }
+
+    auto align = [](size_t v) { return (v + 7) & ~static_cast<size_t>(7); };
+
+    // Раскладка блока
+    size_t offset = align(sizeof(FVFileColumns));
+    auto reserve = [&](size_t bytes) {
+        size_t at = offset;
+        offset = align(offset + bytes);
+        return at;
+    };
+    const size_t idOffset = reserve(n * sizeof(int64_t));
+    const size_t folderIdOffset = reserve(n * sizeof(int64_t));
+    const size_t sizeOffset = reserve(n * sizeof(int64_t));
+    const size_t modifiedOffset = reserve(n * sizeof(int64_t));
+    const size_t scoreOffset = reserve(n * sizeof(double));
+    const size_t contentTypeOffset = reserve(n * sizeof(int32_t));
+    const size_t flagsOffset = reserve(n * sizeof(uint8_t));
+    const size_t stringColumnOffset[4] = {
+        reserve((n + 1) * sizeof(uint32_t)),
+        reserve((n + 1) * sizeof(uint32_t)),
+        reserve((n + 1) * sizeof(uint32_t)),
+        reserve((n + 1) * sizeof(uint32_t))
+    };
+    const size_t stringsOffset = reserve(stringBytes);
+    const size_t totalBytes = offset;
+
+    auto* base = static_cast<char*>(std::malloc(totalBytes));
+    if (!base) {
+        throw std::bad_alloc();
+    }
+
+    auto* id = reinterpret_cast<int64_t*>(base + idOffset);
+    auto* folderId = reinterpret_cast<int64_t*>(base + folderIdOffset);
+    auto* size = reinterpret_cast<int64_t*>(base + sizeOffset);
+    auto* modified = reinterpret_cast<int64_t*>(base + modifiedOffset);
+    auto* score = reinterpret_cast<double*>(base + scoreOffset);
+    auto* contentType = reinterpret_cast<int32_t*>(base + contentTypeOffset);
+    auto* flags = reinterpret_cast<uint8_t*>(base + flagsOffset);
+    uint32_t* stringOffsets[4];
+    for (int c = 0; c < 4; ++c) {
+        stringOffsets[c] = reinterpret_cast<uint32_t*>(base + stringColumnOffset[c]);
+    }
+    char* strings = base + stringsOffset;
+
+    // Арена по колонкам: сначала все relativePath, затем folderPath, name, extension
+    uint32_t cursor = 0;
+    for (int c = 0; c < 4; ++c) {
+        for (size_t i = 0; i < n; ++i) {
+            const FileRecordCompactView& f = rows[i];
+            std::string_view s = c == 0 ? f.relativePath
+                                 : c == 1 ? f.folderPath
+                                 : c == 2 ? f.name
+                                 : f.extension;
+            stringOffsets[c][i] = cursor;
+            if (!s.empty()) {
+                std::memcpy(strings + cursor, s.data(), s.size());
+            }
+            cursor += static_cast<uint32_t>(s.size());
+        }
+        stringOffsets[c][n] = cursor;
+    }
+
+    for (size_t i = 0; i < n; ++i) {
+        const FileRecordCompactView& f = rows[i];
+        id[i] = f.id;
+        folderId[i] = f.folderId;
+        size[i] = f.size;
+        modified[i] = f.modifiedAt;
+        score[i] = withScore ? batch.scores[i] : 0.0;
+        contentType[i] = static_cast<int32_t>(f.contentType);
+        flags[i] = static_cast<uint8_t>((f.isRemote ? FV_FILE_FLAG_REMOTE : 0)
+                                      | (f.hasThumbnail ? FV_FILE_FLAG_HAS_THUMBNAIL : 0));
+    }
+
+    auto* columns = new (base) FVFileColumns{};
+    columns->version = FV_FILE_COLUMNS_VERSION;
+    columns->row_count = static_cast<uint32_t>(n);
+    columns->total_bytes = totalBytes;
+    columns->id = id;
+    columns->folder_id = folderId;
+    columns->size = size;
+    columns->modified_at = modified;
+    columns->score = score;
+    columns->content_type = contentType;
+    columns->flags = flags;
+    columns->relative_path_offsets = stringOffsets[0];
+    columns->folder_path_offsets = stringOffsets[1];
+    columns->name_offsets = stringOffsets[2];
+    columns->extension_offsets = stringOffsets[3];
+    columns->strings = strings;
+    return columns;
+}
+
 static json watchedFolderToJson(const WatchedFolder& f) {
     return {
         {"id", f.id},
@@ -172,6 +337,13 @@ static json tagToJson(const Tag& t) {
     };
 }
 
+static json facetCountToJson(const FacetCount& f) {
+    return {
+        {"value", f.value},
+        {"count", f.count}
+    };
+}
+
 static SearchQuery parseSearchQuery(const std::string& jsonStr) {
     SearchQuery q;
     try {
@@ -212,6 +384,7 @@ static SearchQuery parseSearchQuery(const std::string& jsonStr) {
         q.offset = j.value("offset", 0);
         q.sortBy = static_cast<SortBy>(j.value("sortBy", 0));
         q.sortAsc = j.value("sortAsc", false);
+        q.matchMode = static_cast<TextMatchMode>(j.value("matchMode", 0));
     } catch (...) {
         // Возвращаем дефолтный query
     }
@@ -239,6 +412,7 @@ const char* fv_error_message(FVError error) {
         case FV_ERROR_AUTH_FAILED: return "Authentication failed";
         case FV_ERROR_NETWORK: return "Network error";
         case FV_ERROR_BUSY: return "Resource busy";
+        case FV_ERROR_CANCELLED: return "Cancelled";
         case FV_ERROR_INTERNAL:
         default: return "Internal error";
     }
@@ -261,6 +435,11 @@ void fv_free_string(char* str) {
     std::free(str);
 }
 
+void fv_free_columns(FVFileColumns* columns) {
+    // Заголовок — начало единственного блока malloc
+    std::free(columns);
+}
+
 // ═══════════════════════════════════════════════════════════
 // Database
 // ═══════════════════════════════════════════════════════════
@@ -320,6 +499,134 @@ int32_t fv_database_is_initialized(FVDatabase db) {
     return reinterpret_cast<DatabaseHolder*>(db)->isInitialized() ? 1 : 0;
 }
 
+FVError fv_database_run_maintenance(FVDatabase db, FVMaintenanceCallback cb, void* user_data) {
+    if (!db) {
+        setLastError(FV_ERROR_INVALID_ARGUMENT, "Null database handle");
+        return FV_ERROR_INVALID_ARGUMENT;
+    }
+
+    try {
+        auto* holder = reinterpret_cast<DatabaseHolder*>(db);
+        holder->getMaintenance()->runPass([cb, user_data](const MaintenanceProgress& p) {
+            if (cb) {
+                cb(static_cast<int32_t>(p.step), p.slicesDone, p.remaining,
+                   p.passComplete ? 1 : 0, user_data);
+            }
+        });
+        setLastError(FV_OK);
+        return FV_OK;
+    } catch (const std::exception& e) {
+        setLastError(FV_ERROR_DATABASE, e.what());
+        return FV_ERROR_DATABASE;
+    }
+}
+
+char* fv_database_wal_stats(FVDatabase db) {
+    if (!db) {
+        setLastError(FV_ERROR_INVALID_ARGUMENT, "Null database handle");
+        return nullptr;
+    }
+
+    try {
+        auto* holder = reinterpret_cast<DatabaseHolder*>(db);
+        auto stats = holder->getCheckpoints()->stats();
+
+        json j;
+        j["walBytes"] = stats.walBytes;
+        j["checkpoints"] = stats.checkpoints;
+        j["truncations"] = stats.truncations;
+        j["incomplete"] = stats.incomplete;
+        j["lastLatencyUs"] = stats.lastLatencyUs;
+        j["maxLatencyUs"] = stats.maxLatencyUs;
+        j["avgLatencyUs"] = stats.checkpoints > 0 ? stats.totalLatencyUs / stats.checkpoints : 0;
+        j["lastCheckpointAt"] = stats.lastCheckpointAt;
+        j["bulkActive"] = stats.bulkActive;
+
+        setLastError(FV_OK);
+        return alloc_string(j.dump());
+    } catch (const std::exception& e) {
+        setLastError(FV_ERROR_DATABASE, e.what());
+        return nullptr;
+    }
+}
+
+char* fv_database_query_metrics(FVDatabase db, int32_t reset) {
+    if (!db) {
+        setLastError(FV_ERROR_INVALID_ARGUMENT, "Null database handle");
+        return nullptr;
+    }
+
+    try {
+        auto* holder = reinterpret_cast<DatabaseHolder*>(db);
+        auto& metrics = holder->getDatabase()->queryMetrics();
+        auto snapshot = metrics.snapshot();
+        if (reset) {
+            metrics.reset();
+        }
+
+        json statements = json::array();
+        for (const auto& s : snapshot.byStatement) {
+            json j;
+            j["sql"] = s.sql;
+            j["count"] = s.count;
+            j["errors"] = s.errors;
+            j["rows"] = s.rows;
+            j["totalUs"] = s.totalUs;
+            j["maxUs"] = s.maxUs;
+            j["p50Us"] = s.percentileUs(0.5);
+            j["p95Us"] = s.percentileUs(0.95);
+            j["histogram"] = s.histogram;
+            j["fullScanSteps"] = s.counters.fullScanSteps;
+            j["sorts"] = s.counters.sorts;
+            j["autoIndexes"] = s.counters.autoIndexes;
+            statements.push_back(std::move(j));
+        }
+
+        json slowLog = json::array();
+        for (const auto& q : snapshot.slowLog) {
+            slowLog.push_back({{"sql", q.sql}, {"elapsedUs", q.elapsedUs},
+                               {"rows", q.rows}, {"at", q.at}});
+        }
+
+        json j;
+        j["statements"] = snapshot.statements;
+        j["cacheHits"] = snapshot.cacheHits;
+        j["cacheMisses"] = snapshot.cacheMisses;
+        j["lockWaits"] = snapshot.lockWaits;
+        j["lockWaitUs"] = snapshot.lockWaitUs;
+        j["maxLockWaitUs"] = snapshot.maxLockWaitUs;
+        j["slowQueries"] = snapshot.slowQueries;
+        j["histogramBoundsUs"] = kLatencyBucketsUs;
+        j["byStatement"] = std::move(statements);
+        j["slowLog"] = std::move(slowLog);
+
+        setLastError(FV_OK);
+        return alloc_string(j.dump());
+    } catch (const std::exception& e) {
+        setLastError(FV_ERROR_DATABASE, e.what());
+        return nullptr;
+    }
+}
+
+FVError fv_database_set_slow_query_threshold(FVDatabase db, int32_t threshold_ms) {
+    if (!db) {
+        setLastError(FV_ERROR_INVALID_ARGUMENT, "Null database handle");
+        return FV_ERROR_INVALID_ARGUMENT;
+    }
+
+    try {
+        auto& metrics = reinterpret_cast<DatabaseHolder*>(db)->getDatabase()->queryMetrics();
+        auto options = metrics.options();
+        options.slowQueryThreshold = std::chrono::milliseconds(std::max(threshold_ms, 0));
+        metrics.setOptions(options);
+        setLastError(FV_OK);
+        return FV_OK;
+    } catch (const std::exception& e) {
+        setLastError(FV_ERROR_DATABASE, e.what());
+        return FV_ERROR_DATABASE;
+    }
+}
+
 // ═══════════════════════════════════════════════════════════
 // Index Manager
 // ═══════════════════════════════════════════════════════════
@@ -333,6 +640,11 @@ FVIndexManager fv_index_create(FVDatabase db) {
     try {
         auto* holder = reinterpret_cast<DatabaseHolder*>(db);
         auto* mgr = new IndexManager(holder->getDatabase());
+        mgr->setFacetIndex(holder->getFacetIndex());
+        mgr->setSuggestIndex(holder->getSuggestIndex());
+        mgr->setMaintenanceScheduler(holder->getMaintenance());
+        mgr->setCheckpointManager(holder->getCheckpoints());
+        mgr->setIngestSignal(holder->getIngestSignal());
         auto* wrapper = new IndexManagerWrapper(mgr, holder);
         setLastError(FV_OK);
         return reinterpret_cast<FVIndexManager>(wrapper);
@@ -565,13 +877,9 @@ char* fv_index_get_recent_compact(FVIndexManager mgr, int32_t limit) {
     }
     
     try {
-        auto files = reinterpret_cast<IndexManagerWrapper*>(mgr)->get()->getRecentFilesCompact(limit);
-        json arr = json::array();
-        for (const auto& f : files) {
-            arr.push_back(fileRecordCompactToJson(f));
-        }
+        auto batch = reinterpret_cast<IndexManagerWrapper*>(mgr)->get()->getRecentFilesCompactBatch(limit);
         setLastError(FV_OK);
-        return alloc_string(arr.dump());
+        return alloc_string(compactBatchToJson(batch).dump());
     } catch (const std::exception& e) {
         setLastError(FV_ERROR_DATABASE, e.what());
         return nullptr;
@@ -586,10 +894,32 @@ char* fv_index_get_by_folder_compact(FVIndexManager mgr, int64_t folder_id,
     }
     
     try {
-        auto files = reinterpret_cast<IndexManagerWrapper*>(mgr)->get()->getFilesByFolderCompact(folder_id, limit, offset);
+        auto batch = reinterpret_cast<IndexManagerWrapper*>(mgr)->get()->getFilesByFolderCompactBatch(folder_id, limit, offset);
+        setLastError(FV_OK);
+        return alloc_string(compactBatchToJson(batch).dump());
+    } catch (const std::exception& e) {
+        setLastError(FV_ERROR_DATABASE, e.what());
+        return nullptr;
+    }
+}
+
+char* fv_index_get_directories(FVIndexManager mgr, int64_t folder_id, int64_t parent_id) {
+    if (!mgr) {
+        setLastError(FV_ERROR_INVALID_ARGUMENT, "Null index manager");
+        return nullptr;
+    }
+
+    try {
+        auto dirs = reinterpret_cast<IndexManagerWrapper*>(mgr)->get()->getSubdirectories(folder_id, parent_id);
         json arr = json::array();
-        for (const auto& f : files) {
-            arr.push_back(fileRecordCompactToJson(f));
+        for (const auto& d : dirs) {
+            arr.push_back({
+                {"id", d.id},
+                {"folderId", d.folderId},
+                {"parentId", d.parentId},
+                {"name", d.name},
+                {"path", d.path}
+            });
         }
         setLastError(FV_OK);
         return alloc_string(arr.dump());
@@ -599,6 +929,60 @@ char* fv_index_get_by_folder_compact(FVIndexManager mgr, int64_t folder_id,
     }
 }
 
+char* fv_index_get_by_directory_compact(FVIndexManager mgr, int64_t folder_id,
+                                        int64_t directory_id,
+                                        int32_t limit, int32_t offset) {
+    if (!mgr) {
+        setLastError(FV_ERROR_INVALID_ARGUMENT, "Null index manager");
+        return nullptr;
+    }
+
+    try {
+        auto batch = reinterpret_cast<IndexManagerWrapper*>(mgr)->get()->getFilesByDirectoryCompactBatch(
+            folder_id, directory_id, limit, offset);
+        setLastError(FV_OK);
+        return alloc_string(compactBatchToJson(batch).dump());
+    } catch (const std::exception& e) {
+        setLastError(FV_ERROR_DATABASE, e.what());
+        return nullptr;
+    }
+}
+
+FVFileColumns* fv_index_get_recent_columns(FVIndexManager mgr, int32_t limit) {
+    if (!mgr) {
+        setLastError(FV_ERROR_INVALID_ARGUMENT, "Null index manager");
+        return nullptr;
+    }
+
+    try {
+        auto batch = reinterpret_cast<IndexManagerWrapper*>(mgr)->get()->getRecentFilesCompactBatch(limit);
+        auto* columns = buildFileColumns(batch);
+        setLastError(FV_OK);
+        return columns;
+    } catch (const std::exception& e) {
+        setLastError(FV_ERROR_DATABASE, e.what());
+        return nullptr;
+    }
+}
+
+FVFileColumns* fv_index_get_by_folder_columns(FVIndexManager mgr, int64_t folder_id,
+                                              int32_t limit, int32_t offset) {
+    if (!mgr) {
+        setLastError(FV_ERROR_INVALID_ARGUMENT, "Null index manager");
+        return nullptr;
+    }
+
+    try {
+        auto batch = reinterpret_cast<IndexManagerWrapper*>(mgr)->get()->getFilesByFolderCompactBatch(folder_id, limit, offset);
+        auto* columns = buildFileColumns(batch);
+        setLastError(FV_OK);
+        return columns;
+    } catch (const std::exception& e) {
+        setLastError(FV_ERROR_DATABASE, e.what());
+        return nullptr;
+    }
+}
+
 char* fv_index_get_stats(FVIndexManager mgr) {
     if (!mgr) {
         setLastError(FV_ERROR_INVALID_ARGUMENT, "Null index manager");
@@ -689,6 +1073,9 @@ FVSearchEngine fv_search_create(FVDatabase db) {
     try {
         auto* holder = reinterpret_cast<DatabaseHolder*>(db);
         auto* engine = new SearchEngine(holder->getDatabase());
+        engine->setFacetIndex(holder->getFacetIndex());
+        engine->setSuggestIndex(holder->getSuggestIndex());
+        engine->setMaintenanceScheduler(holder->getMaintenance());
         auto* wrapper = new SearchEngineWrapper(engine, holder);
         setLastError(FV_OK);
         return reinterpret_cast<FVSearchEngine>(wrapper);
@@ -737,20 +1124,98 @@ char* fv_search_query_compact(FVSearchEngine engine, const char* query_json) {
     
     try {
         auto query = parseSearchQuery(query_json);
-        auto results = reinterpret_cast<SearchEngineWrapper*>(engine)->get()->searchCompact(query);
+        auto batch = reinterpret_cast<SearchEngineWrapper*>(engine)->get()->searchCompactBatch(query);
+        setLastError(FV_OK);
+        return alloc_string(compactBatchToJson(batch).dump());
+    } catch (const std::exception& e) {
+        setLastError(FV_ERROR_DATABASE, e.what());
+        return nullptr;
+    }
+}
 
-        json arr = json::array();
-        for (const auto& r : results) {
-            arr.push_back(searchResultCompactToJson(r));
-        }
+FVFileColumns* fv_search_query_columns(FVSearchEngine engine, const char* query_json) {
+    if (!engine) {
+        setLastError(FV_ERROR_INVALID_ARGUMENT, "Null search engine");
+        return nullptr;
+    }
+
+    try {
+        auto query = parseSearchQuery(query_json);
+        auto batch = reinterpret_cast<SearchEngineWrapper*>(engine)->get()->searchCompactBatch(query);
+        auto* columns = buildFileColumns(batch);
         setLastError(FV_OK);
-        return alloc_string(arr.dump());
+        return columns;
     } catch (const std::exception& e) {
         setLastError(FV_ERROR_DATABASE, e.what());
         return nullptr;
     }
 }
 
+int64_t fv_search_query_async(FVSearchEngine engine, const char* query_json,
+                              FVSearchResultCallback cb, void* user_data) {
+    if (!engine || !cb) {
+        setLastError(FV_ERROR_INVALID_ARGUMENT, "Null search engine or callback");
+        return -1;
+    }
+
+    try {
+        auto query = parseSearchQuery(query_json);
+        auto* executor = reinterpret_cast<SearchEngineWrapper*>(engine)->getExecutor();
+
+        uint64_t id = executor->submit(query, [cb, user_data](const SearchPage& page) {
+            auto requestId = static_cast<int64_t>(page.requestId);
+            switch (page.status) {
+                case SearchRequestStatus::Completed: {
+                    json arr = json::array();
+                    for (const auto& r : page.results) {
+                        arr.push_back(searchResultCompactToJson(r));
+                    }
+                    cb(requestId, FV_OK, arr.dump().c_str(), user_data);
+                    break;
+                }
+                case SearchRequestStatus::Cancelled:
+                    cb(requestId, FV_ERROR_CANCELLED, nullptr, user_data);
+                    break;
+                case SearchRequestStatus::Failed:
+                    cb(requestId, FV_ERROR_DATABASE, page.error.c_str(), user_data);
+                    break;
+            }
+        });
+
+        setLastError(FV_OK);
+        return static_cast<int64_t>(id);
+    } catch (const std::exception& e) {
+        setLastError(FV_ERROR_DATABASE, e.what());
+        return -1;
+    }
+}
+
+FVError fv_search_cancel(FVSearchEngine engine, int64_t request_id) {
+    if (!engine || request_id <= 0) {
+        setLastError(FV_ERROR_INVALID_ARGUMENT, "Null search engine or invalid request id");
+        return FV_ERROR_INVALID_ARGUMENT;
+    }
+
+    auto* wrapper = reinterpret_cast<SearchEngineWrapper*>(engine);
+    std::lock_guard lock(wrapper->executorMutex);
+    if (!wrapper->executor || !wrapper->executor->cancel(static_cast<uint64_t>(request_id))) {
+        setLastError(FV_ERROR_NOT_FOUND, "Search request not pending");
+        return FV_ERROR_NOT_FOUND;
+    }
+    setLastError(FV_OK);
+    return FV_OK;
+}
+
+void fv_search_cancel_all(FVSearchEngine engine) {
+    if (!engine) return;
+
+    auto* wrapper = reinterpret_cast<SearchEngineWrapper*>(engine);
+    std::lock_guard lock(wrapper->executorMutex);
+    if (wrapper->executor) {
+        wrapper->executor->cancelAll();
+    }
+}
+
 int64_t fv_search_count(FVSearchEngine engine, const char* query_json) {
     if (!engine) {
         setLastError(FV_ERROR_INVALID_ARGUMENT, "Null search engine");
@@ -788,6 +1253,33 @@ char* fv_search_suggest(FVSearchEngine engine, const char* prefix, int32_t limit
     }
 }
 
+char* fv_search_facets(FVSearchEngine engine, const char* query_json,
+                       int32_t kind, int32_t limit) {
+    if (!engine) {
+        setLastError(FV_ERROR_INVALID_ARGUMENT, "Null search engine");
+        return nullptr;
+    }
+    if (kind < static_cast<int32_t>(FacetKind::Tag) || kind > static_cast<int32_t>(FacetKind::Folder)) {
+        setLastError(FV_ERROR_INVALID_ARGUMENT, "Invalid facet kind");
+        return nullptr;
+    }
+    
+    try {
+        auto query = parseSearchQuery(query_json ? query_json : "{}");
+        auto facets = reinterpret_cast<SearchEngineWrapper*>(engine)->get()->facetCounts(
+            query, static_cast<FacetKind>(kind), limit);
+        json arr = json::array();
+        for (const auto& f : facets) {
+            arr.push_back(facetCountToJson(f));
+        }
+        setLastError(FV_OK);
+        return alloc_string(arr.dump());
+    } catch (const std::exception& e) {
+        setLastError(FV_ERROR_DATABASE, e.what());
+        return nullptr;
+    }
+}
+
 // ═══════════════════════════════════════════════════════════
 // Tag Manager
 // ═══════════════════════════════════════════════════════════
@@ -801,6 +1293,7 @@ FVTagManager fv_tags_create(FVDatabase db) {
     try {
         auto* holder = reinterpret_cast<DatabaseHolder*>(db);
         auto* mgr = new TagManager(holder->getDatabase());
+        mgr->setFacetIndex(holder->getFacetIndex());
         auto* wrapper = new TagManagerWrapper(mgr, holder);
         setLastError(FV_OK);
         return reinterpret_cast<FVTagManager>(wrapper);
@@ -1069,6 +1562,9 @@ FVContentIndexer fv_content_indexer_create(FVDatabase db) {
     try {
         auto* holder = reinterpret_cast<DatabaseHolder*>(db);
         auto* indexer = new ContentIndexer(holder->getDatabase());
+        indexer->setCheckpointManager(holder->getCheckpoints());
+        indexer->setMaintenanceScheduler(holder->getMaintenance());
+        indexer->setIngestSignal(holder->getIngestSignal());
         auto* wrapper = new ContentIndexerWrapper(indexer, holder);
         setLastError(FV_OK);
         return reinterpret_cast<FVContentIndexer>(wrapper);
@@ -1153,6 +1649,22 @@ int32_t fv_content_indexer_enqueue_unprocessed(FVContentIndexer indexer) {
     }
 }
 
+FVError fv_content_indexer_prioritize_file(FVContentIndexer indexer, int64_t file_id) {
+    if (!indexer) {
+        setLastError(FV_ERROR_INVALID_ARGUMENT, "Null content indexer");
+        return FV_ERROR_INVALID_ARGUMENT;
+    }
+    
+    try {
+        reinterpret_cast<ContentIndexerWrapper*>(indexer)->get()->prioritizeFile(file_id);
+        setLastError(FV_OK);
+        return FV_OK;
+    } catch (const std::exception& e) {
+        setLastError(FV_ERROR_DATABASE, e.what());
+        return FV_ERROR_DATABASE;
+    }
+}
+
 char* fv_content_indexer_get_status(FVContentIndexer indexer) {
     if (!indexer) {
         setLastError(FV_ERROR_INVALID_ARGUMENT, "Null content indexer");
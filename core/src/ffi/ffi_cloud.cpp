@@ -119,6 +119,7 @@ bool fv_cloud_account_remove(FVDatabase db, int64_t account_id) {
     try {
         auto* holder = reinterpret_cast<DatabaseHolder*>(db);
         CloudAccountManager manager(holder->getDatabase());
+        manager.setSuggestIndex(holder->getSuggestIndex());
         bool removed = manager.removeAccount(account_id);
         if (!removed) {
             setLastError(FV_ERROR_NOT_FOUND, "Cloud account not found");
@@ -286,6 +287,7 @@ bool fv_cloud_file_upsert(FVDatabase db, int64_t account_id, const char* file_js
     try {
         auto* holder = reinterpret_cast<DatabaseHolder*>(db);
         CloudAccountManager manager(holder->getDatabase());
+        manager.setSuggestIndex(holder->getSuggestIndex());
         
         json j = json::parse(file_json);
         CloudFile file;
@@ -343,6 +345,7 @@ bool fv_cloud_file_remove(FVDatabase db, int64_t account_id, const char* cloud_i
     try {
         auto* holder = reinterpret_cast<DatabaseHolder*>(db);
         CloudAccountManager manager(holder->getDatabase());
+        manager.setSuggestIndex(holder->getSuggestIndex());
         bool removed = manager.removeCloudFile(account_id, cloud_id);
         
         // It's okay if it doesn't exist, we just want it gone. 
@@ -367,6 +370,7 @@ bool fv_cloud_file_remove_all(FVDatabase db, int64_t account_id) {
     try {
         auto* holder = reinterpret_cast<DatabaseHolder*>(db);
         CloudAccountManager manager(holder->getDatabase());
+        manager.setSuggestIndex(holder->getSuggestIndex());
         bool removed = manager.removeAllCloudFiles(account_id);
         setLastError(FV_OK);
         return removed;
@@ -5,6 +5,11 @@
 
 #include "familyvault/familyvault_c.h"
 #include "familyvault/Database.h"
+#include "familyvault/FacetIndex.h"
+#include "familyvault/SuggestIndex.h"
+#include "familyvault/MaintenanceScheduler.h"
+#include "familyvault/CheckpointManager.h"
+#include "familyvault/IngestSignal.h"
 #include <string>
 #include <memory>
 #include <atomic>
@@ -37,11 +42,31 @@ class DatabaseHolder {
 public:
     explicit DatabaseHolder(const std::string& path)
         : m_database(std::make_shared<FamilyVault::Database>(path))
+        , m_facets(std::make_shared<FamilyVault::FacetIndex>(m_database))
+        , m_suggest(std::make_shared<FamilyVault::SuggestIndex>(m_database))
+        , m_maintenance(std::make_shared<FamilyVault::MaintenanceScheduler>(m_database))
+        , m_checkpoints(std::make_shared<FamilyVault::CheckpointManager>(m_database))
+        , m_ingest(std::make_shared<FamilyVault::IngestSignal>())
         , m_refCount(1)
         , m_initialized(false)
     {}
 
     std::shared_ptr<FamilyVault::Database> getDatabase() const { return m_database; }
+
+    /// Общий индекс фасетов для всех менеджеров этой БД
+    std::shared_ptr<FamilyVault::FacetIndex> getFacetIndex() const { return m_facets; }
+
+    /// Общий индекс автодополнения
+    std::shared_ptr<FamilyVault::SuggestIndex> getSuggestIndex() const { return m_suggest; }
+
+    /// Фоновое обслуживание БД (запускается после initialize)
+    std::shared_ptr<FamilyVault::MaintenanceScheduler> getMaintenance() const { return m_maintenance; }
+
+    /// WAL checkpoint в простое и во время массовой записи
+    std::shared_ptr<FamilyVault::CheckpointManager> getCheckpoints() const { return m_checkpoints; }
+
+    /// Сканирование IndexManager будит ContentIndexer
+    std::shared_ptr<FamilyVault::IngestSignal> getIngestSignal() const { return m_ingest; }
     
     void addRef() {
         m_refCount.fetch_add(1, std::memory_order_relaxed);
@@ -58,6 +83,10 @@ public:
     void initialize() {
         if (!m_initialized) {
             m_database->initialize();
+            m_facets->rebuild();
+            m_suggest->rebuild();
+            m_maintenance->start();
+            m_checkpoints->start();
             m_initialized = true;
         }
     }
@@ -66,6 +95,11 @@ public:
     
 private:
     std::shared_ptr<FamilyVault::Database> m_database;
+    std::shared_ptr<FamilyVault::FacetIndex> m_facets;
+    std::shared_ptr<FamilyVault::SuggestIndex> m_suggest;
+    std::shared_ptr<FamilyVault::MaintenanceScheduler> m_maintenance;
+    std::shared_ptr<FamilyVault::CheckpointManager> m_checkpoints;
+    std::shared_ptr<FamilyVault::IngestSignal> m_ingest;
     std::atomic<int> m_refCount;
     bool m_initialized;
 };
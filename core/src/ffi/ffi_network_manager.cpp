@@ -100,6 +100,18 @@ struct NetworkManagerWrapper {
                 // Ack received, can send next batch if needed
                 break;
             }
+            case MessageType::ContentTextRequest: {
+                if (!syncManager || !peer) break;
+                spdlog::debug("Sync: Received ContentTextRequest from {}", fromDeviceId);
+                syncManager->handleContentTextRequest(peer, msg);
+                break;
+            }
+            case MessageType::ContentTextResponse: {
+                if (!syncManager || !peer) break;
+                spdlog::debug("Sync: Received ContentTextResponse from {}", fromDeviceId);
+                syncManager->handleContentTextResponse(peer, msg);
+                break;
+            }
             
             // ═══════════════════════════════════════════════════════════
             // File Transfer Messages
@@ -0,0 +1,239 @@
+// test_checkpoint_manager.cpp — тесты WAL checkpoint вне пишущего потока
+
+#include <gtest/gtest.h>
+#include "familyvault/Database.h"
+#include "familyvault/CheckpointManager.h"
+#include "familyvault/familyvault_c.h"
+#include <nlohmann/json.hpp>
+#include <chrono>
+#include <filesystem>
+#include <thread>
+
+namespace fs = std::filesystem;
+using namespace FamilyVault;
+using json = nlohmann::json;
+
+class CheckpointManagerTest : public ::testing::Test {
+protected:
+    std::string testDbPath;
+    std::shared_ptr<Database> db;
+
+    void SetUp() override {
+        testDbPath = "test_checkpoint_" + std::to_string(std::rand()) + ".db";
+        db = std::make_shared<Database>(testDbPath);
+        db->initialize();
+        db->execute("CREATE TABLE ballast (data BLOB)");
+    }
+
+    void TearDown() override {
+        db.reset();
+        fs::remove(testDbPath);
+        fs::remove(testDbPath + "-wal");
+        fs::remove(testDbPath + "-shm");
+    }
+
+    /// Каждая вставка — отдельная транзакция по 4 страницы
+    void writeBallast(int rows) {
+        for (int i = 0; i < rows; ++i) {
+            db->execute("INSERT INTO ballast VALUES (zeroblob(16384))");
+        }
+    }
+
+    /// Ждать условия не дольше ~2 с
+    template<typename Predicate>
+    static bool waitFor(Predicate predicate) {
+        for (int i = 0; i < 100; ++i) {
+            if (predicate()) return true;
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
+        return predicate();
+    }
+};
+
+TEST_F(CheckpointManagerTest, BulkWriteDisablesAutocheckpoint) {
+    CheckpointOptions options;
+    options.autocheckpointPages = 16;
+    CheckpointManager manager(db, options);
+
+    db->walCheckpoint(WalCheckpointMode::Truncate);
+    {
+        auto bulk = manager.beginBulkWrite();
+        EXPECT_TRUE(manager.stats().bulkActive);
+        writeBallast(64);
+
+        // Писатель не переносил WAL: все кадры массовой записи ещё в WAL
+        auto probe = db->walCheckpoint(WalCheckpointMode::Passive);
+        EXPECT_GE(probe.logFrames, 64 * 4);
+        db->walCheckpoint(WalCheckpointMode::Truncate);
+    }
+    EXPECT_FALSE(manager.stats().bulkActive);
+
+    // После массовой записи autocheckpoint восстановлен (16 страниц)
+    writeBallast(64);
+    auto probe = db->walCheckpoint(WalCheckpointMode::Passive);
+    EXPECT_LT(probe.logFrames, 64 * 4);
+}
+
+TEST_F(CheckpointManagerTest, NestedBulkWritesAreCounted) {
+    CheckpointManager manager(db);
+
+    auto outer = manager.beginBulkWrite();
+    {
+        auto inner = manager.beginBulkWrite();
+        EXPECT_TRUE(manager.stats().bulkActive);
+    }
+    EXPECT_TRUE(manager.stats().bulkActive);
+
+    auto moved = std::move(outer);
+    EXPECT_FALSE(outer.active());
+    EXPECT_TRUE(moved.active());
+    moved = CheckpointManager::BulkWrite();
+    EXPECT_FALSE(manager.stats().bulkActive);
+}
+
+TEST_F(CheckpointManagerTest, CheckpointNowTruncatesWal) {
+    CheckpointManager manager(db);
+    writeBallast(32);
+    ASSERT_GT(manager.walSizeBytes(), 0);
+
+    EXPECT_TRUE(manager.checkpointNow());
+    EXPECT_EQ(manager.walSizeBytes(), 0);
+
+    auto stats = manager.stats();
+    EXPECT_EQ(stats.checkpoints, 2);
+    EXPECT_EQ(stats.truncations, 1);
+    EXPECT_EQ(stats.incomplete, 0);
+    EXPECT_GE(stats.maxLatencyUs, stats.lastLatencyUs);
+    EXPECT_GE(stats.totalLatencyUs, stats.maxLatencyUs);
+    EXPECT_GT(stats.lastCheckpointAt, 0);
+}
+
+TEST_F(CheckpointManagerTest, ReaderSnapshotLeavesCheckpointIncomplete) {
+    CheckpointManager manager(db);
+    writeBallast(8);
+
+    // Читатель держит снимок до следующей записи
+    Database reader(testDbPath);
+    reader.execute("BEGIN");
+    EXPECT_EQ(reader.queryScalar("SELECT COUNT(*) FROM ballast"), 8);
+    writeBallast(8);
+
+    EXPECT_FALSE(manager.checkpointNow());
+    EXPECT_EQ(manager.stats().incomplete, 1);
+    EXPECT_EQ(manager.stats().truncations, 0);
+
+    reader.execute("COMMIT");
+    EXPECT_TRUE(manager.checkpointNow());
+    EXPECT_EQ(manager.walSizeBytes(), 0);
+}
+
+TEST_F(CheckpointManagerTest, BackgroundCheckpointWaitsForBulkAndIdle) {
+    CheckpointOptions options;
+    options.pollInterval = std::chrono::milliseconds(10);
+    options.idleDelay = std::chrono::milliseconds(50);
+    options.passiveThresholdBytes = 1;
+    options.truncateThresholdBytes = 1;
+    CheckpointManager manager(db, options);
+    manager.start();
+    EXPECT_TRUE(manager.isRunning());
+
+    {
+        auto bulk = manager.beginBulkWrite();
+        writeBallast(16);
+        std::this_thread::sleep_for(std::chrono::milliseconds(150));
+        EXPECT_EQ(manager.stats().checkpoints, 0);
+        EXPECT_GT(manager.walSizeBytes(), 0);
+    }
+
+    EXPECT_TRUE(waitFor([&manager] { return manager.stats().truncations > 0; }));
+    EXPECT_EQ(manager.walSizeBytes(), 0);
+
+    manager.stop();
+    EXPECT_FALSE(manager.isRunning());
+}
+
+TEST_F(CheckpointManagerTest, ForceThresholdCheckpointsDuringBulk) {
+    CheckpointOptions options;
+    options.pollInterval = std::chrono::milliseconds(10);
+    options.forceThresholdBytes = 64 * 1024;
+    CheckpointManager manager(db, options);
+    manager.start();
+
+    auto bulk = manager.beginBulkWrite();
+    writeBallast(16);
+    EXPECT_TRUE(waitFor([&manager] { return manager.stats().checkpoints > 0; }));
+
+    // Во время массовой записи файл WAL не усекается
+    EXPECT_EQ(manager.stats().truncations, 0);
+}
+
+TEST_F(CheckpointManagerTest, IdleWalCheckpointedOnce) {
+    // WAL между порогами PASSIVE и TRUNCATE: после полного PASSIVE файл
+    // не уменьшается, но переносить больше нечего
+    CheckpointOptions options;
+    options.pollInterval = std::chrono::milliseconds(10);
+    options.idleDelay = std::chrono::milliseconds(0);
+    options.passiveThresholdBytes = 64 * 1024;
+    options.truncateThresholdBytes = 1LL << 30;
+    CheckpointManager manager(db, options);
+    writeBallast(16);
+    manager.start();
+
+    ASSERT_TRUE(waitFor([&manager] { return manager.stats().checkpoints > 0; }));
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    EXPECT_EQ(manager.stats().checkpoints, 1);
+    EXPECT_GE(manager.walSizeBytes(), options.passiveThresholdBytes);
+
+    // Новая запись — новые кадры, снова один checkpoint
+    writeBallast(1);
+    EXPECT_TRUE(waitFor([&manager] { return manager.stats().checkpoints > 1; }));
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    EXPECT_EQ(manager.stats().checkpoints, 2);
+}
+
+TEST_F(CheckpointManagerTest, CheckpointTimeoutDoesNotLeak) {
+    // Блокирующий checkpoint ждёт читателя не дольше своего срока
+    writeBallast(8);
+    Database reader(testDbPath);
+    reader.execute("BEGIN");
+    EXPECT_EQ(reader.queryScalar("SELECT COUNT(*) FROM ballast"), 8);
+    writeBallast(8);
+
+    auto startedAt = std::chrono::steady_clock::now();
+    auto result = db->walCheckpoint(WalCheckpointMode::Truncate, 50);
+    EXPECT_TRUE(result.busy);
+    EXPECT_LT(std::chrono::steady_clock::now() - startedAt, std::chrono::milliseconds(1000));
+
+    // Запросы соединения после checkpoint снова ждут общий busy_timeout:
+    // другой писатель держит блокировку 300 мс, вставка дожидается его
+    reader.execute("COMMIT");
+    Database writer(testDbPath);
+    writer.execute("BEGIN IMMEDIATE");
+    std::thread release([&writer] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(300));
+        writer.execute("COMMIT");
+    });
+    EXPECT_NO_THROW(writeBallast(1));
+    release.join();
+}
+
+TEST_F(CheckpointManagerTest, CApiReportsWalStats) {
+    FVError err = FV_OK;
+    FVDatabase handle = fv_database_open(testDbPath.c_str(), &err);
+    ASSERT_NE(handle, nullptr);
+    ASSERT_EQ(fv_database_initialize(handle), FV_OK);
+
+    char* str = fv_database_wal_stats(handle);
+    ASSERT_NE(str, nullptr);
+    auto j = json::parse(str);
+    fv_free_string(str);
+
+    for (const char* key : {"walBytes", "checkpoints", "truncations", "incomplete", "lastLatencyUs",
+                            "maxLatencyUs", "avgLatencyUs", "lastCheckpointAt", "bulkActive"}) {
+        EXPECT_TRUE(j.contains(key)) << key;
+    }
+    EXPECT_FALSE(j["bulkActive"].get<bool>());
+    EXPECT_EQ(fv_database_wal_stats(nullptr), nullptr);
+
+    fv_database_close(handle);
+}
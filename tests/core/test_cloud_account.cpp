@@ -160,9 +160,9 @@ TEST(CloudMigrationTest, Migration1CreatesFullSchema) {
         auto db = std::make_shared<Database>(testDbPath);
         db->initialize();
         
-        // Verify version 1 contains everything
-        auto currentVersion = db->queryScalar("SELECT MAX(version) FROM schema_version");
-        EXPECT_EQ(currentVersion, 1LL);
+        // Verify version 1 contains everything (later migrations add unrelated tables)
+        auto migration1Applied = db->queryScalar("SELECT COUNT(*) FROM schema_version WHERE version = 1");
+        EXPECT_EQ(migration1Applied, 1LL);
 
         // Verify cloud_accounts table exists
         auto accountTableExists = db->queryScalar(
@@ -6,8 +6,10 @@
 #include "familyvault/ContentIndexer.h"
 #include <filesystem>
 #include <fstream>
+#include <mutex>
 #include <thread>
 #include <chrono>
+#include <vector>
 
 namespace fs = std::filesystem;
 using namespace FamilyVault;
@@ -179,6 +181,50 @@ TEST_F(ContentIndexerTest, GetPendingCount) {
     EXPECT_GE(pending, 3);
 }
 
+TEST_F(ContentIndexerTest, DuplicateReusesCachedText) {
+    createTestFile(testFolderPath + "/copy/doc1.txt", "Hello World content for indexing");
+    indexTestFolder();
+
+    auto idOf = [this](const std::string& path) {
+        return db->queryScalar("SELECT id FROM files WHERE relative_path = ?", path);
+    };
+    if (!contentIndexer->processFile(idOf("doc1.txt"))) {
+        GTEST_SKIP() << "text extraction disabled";
+    }
+
+    // Второго экземпляра текста нет: копия берёт текст оригинала из FTS,
+    // не читая файл, — подменённый текст оригинала это показывает
+    EXPECT_EQ(db->queryScalar("SELECT COUNT(*) FROM content_cache"), 0);
+    db->execute("UPDATE files_fts SET content = 'served from copy' WHERE rowid = ?",
+                idOf("doc1.txt"));
+
+    int64_t copyId = idOf("copy/doc1.txt");
+    EXPECT_TRUE(contentIndexer->processFile(copyId));
+    EXPECT_EQ(db->queryScalar(
+        "SELECT COUNT(*) FROM files_fts WHERE rowid = ? AND content = 'served from copy'",
+        copyId), 1);
+}
+
+TEST_F(ContentIndexerTest, UnchangedTextKeepsFtsRow) {
+    indexTestFolder();
+
+    int64_t fileId = db->queryScalar("SELECT id FROM files WHERE relative_path = 'doc1.txt'");
+    if (!contentIndexer->processFile(fileId)) {
+        GTEST_SKIP() << "text extraction disabled";
+    }
+    EXPECT_EQ(db->queryScalar(
+        "SELECT COUNT(*) FROM file_content WHERE file_id = ? AND text_hash IS NOT NULL",
+        fileId), 1);
+
+    // Повторное извлечение того же текста не переписывает запись FTS:
+    // метка, поставленная в обход индексатора, остаётся на месте
+    db->execute("UPDATE files_fts SET content = 'kept as is' WHERE rowid = ?", fileId);
+    EXPECT_TRUE(contentIndexer->processFile(fileId));
+    EXPECT_EQ(db->queryScalar(
+        "SELECT COUNT(*) FROM files_fts WHERE rowid = ? AND content = 'kept as is'",
+        fileId), 1);
+}
+
 // ═══════════════════════════════════════════════════════════
 // Restart Tests (the bug we fixed!)
 // ═══════════════════════════════════════════════════════════
@@ -243,3 +289,109 @@ TEST_F(ContentIndexerTest, SequentialStartStop) {
 }
 
 
+
+// ═══════════════════════════════════════════════════════════
+// Queue Order Tests
+// ═══════════════════════════════════════════════════════════
+
+TEST_F(ContentIndexerTest, CostGrowsWithSizeAndFormat) {
+    EXPECT_LT(ContentIndexer::estimateCost("text/plain", 5 * 1024),
+              ContentIndexer::estimateCost("text/plain", 200 * 1024 * 1024));
+    EXPECT_LT(ContentIndexer::estimateCost("text/plain", 1024 * 1024),
+              ContentIndexer::estimateCost("application/pdf", 1024 * 1024));
+    EXPECT_LT(ContentIndexer::estimateCost("text/plain", 1024 * 1024),
+              ContentIndexer::estimateCost(
+                  "application/vnd.openxmlformats-officedocument.wordprocessingml.document",
+                  1024 * 1024));
+    EXPECT_EQ(ContentIndexer::estimateCost("text/plain", -1), 0);
+}
+
+TEST_F(ContentIndexerTest, QueueDeduplicatesFiles) {
+    indexTestFolder();
+    int64_t fileId = db->queryScalar("SELECT id FROM files WHERE relative_path = 'doc1.txt'");
+
+    contentIndexer->enqueueFile(fileId);
+    contentIndexer->enqueueFile(fileId);
+    contentIndexer->prioritizeFile(fileId);
+
+    EXPECT_EQ(contentIndexer->getStatus().pending, 1);
+}
+
+TEST_F(ContentIndexerTest, PrioritizedAndCheapFilesGoFirst) {
+    createTestFile(testFolderPath + "/scan.pdf", "%PDF-1.4\n" + std::string(256 * 1024, 'x'));
+    indexTestFolder();
+    auto idOf = [this](const std::string& path) {
+        return db->queryScalar("SELECT id FROM files WHERE relative_path = ?", path);
+    };
+
+    std::mutex mutex;
+    std::vector<int64_t> order;
+    contentIndexer->setDelayBetweenFiles(0);
+    contentIndexer->setFileProcessedCallback([&](int64_t fileId, bool) {
+        std::lock_guard<std::mutex> lock(mutex);
+        order.push_back(fileId);
+    });
+
+    // Большой PDF поставлен первым, но дорогой; doc3 нужен пользователю
+    contentIndexer->enqueueFile(idOf("scan.pdf"));
+    contentIndexer->enqueueFile(idOf("doc1.txt"));
+    contentIndexer->prioritizeFile(idOf("doc3.txt"));
+    contentIndexer->start();
+
+    for (int i = 0; i < 100; ++i) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (order.size() >= 3) break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    contentIndexer->stop(true);
+
+    ASSERT_GE(order.size(), 3u);
+    EXPECT_EQ(order[0], idOf("doc3.txt"));
+    EXPECT_EQ(order[1], idOf("doc1.txt"));
+    EXPECT_EQ(order[2], idOf("scan.pdf"));
+}
+
+TEST_F(ContentIndexerTest, ScanSignalWakesIdleWorker) {
+    auto ingest = std::make_shared<IngestSignal>();
+    indexManager->setIngestSignal(ingest);
+    contentIndexer->setIngestSignal(ingest);
+    contentIndexer->setDelayBetweenFiles(0);
+
+    // Рабочий поток уже простаивает: файлов нет, опроса БД тоже нет
+    contentIndexer->start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    indexTestFolder();
+
+    for (int i = 0; i < 100 && contentIndexer->getStatus().processed < 3; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    contentIndexer->stop(true);
+
+    int pending = contentIndexer->getPendingCount();
+    if (contentIndexer->getStatus().processed == 0 && pending == 0) {
+        GTEST_SKIP() << "text extraction disabled";
+    }
+    EXPECT_GE(contentIndexer->getStatus().processed, 3);
+    EXPECT_EQ(pending, 0);
+}
+
+TEST_F(ContentIndexerTest, RegistryDecidesExtractableMimeTypes) {
+    // YAML не попадает под начальные шаблоны справочника, но PlainTextExtractor его читает
+    createTestFile(testFolderPath + "/config.yaml", "key: searchable yaml value\n");
+    indexTestFolder();
+
+    auto pending = [this] {
+        return db->queryScalar("SELECT extraction_pending FROM files WHERE name = 'config.yaml'");
+    };
+    EXPECT_EQ(pending(), 0);
+
+    contentIndexer->enqueueUnprocessed();
+    if (contentIndexer->getPendingCount() == 0) {
+        GTEST_SKIP() << "text extraction disabled";
+    }
+    EXPECT_EQ(db->queryScalar(
+        "SELECT extractable FROM mime_types WHERE mime_type = 'application/x-yaml'"), 1);
+    EXPECT_EQ(pending(), 1);
+}
@@ -2,12 +2,40 @@
 
 #include <gtest/gtest.h>
 #include "familyvault/Database.h"
+#include "familyvault/TypedQuery.h"
 #include <filesystem>
 #include <fstream>
 
 namespace fs = std::filesystem;
 using namespace FamilyVault;
 
+namespace {
+
+struct NoteRow {
+    int64_t id = 0;
+    std::string title;
+    std::optional<int64_t> rating;
+    bool pinned = false;
+};
+
+using NoteSchema = sql::Schema<NoteRow,
+    sql::Column<"id", &NoteRow::id>,
+    sql::Column<"UPPER(title)", &NoteRow::title>,
+    sql::Column<"rating", &NoteRow::rating>,
+    sql::Column<"pinned", &NoteRow::pinned>>;
+
+using NotesByRating = sql::Select<NoteSchema,
+    "FROM notes WHERE rating >= ? OR title = '?' ORDER BY id">;
+using NoteById = sql::Select<NoteSchema, "FROM notes WHERE id = ?">;
+
+// Текст и число параметров вычисляются на этапе компиляции
+static_assert(NoteSchema::columnCount == 4);
+static_assert(NoteSchema::selectList.view() == "id, UPPER(title), rating, pinned");
+static_assert(NotesByRating::paramCount == 1);  // '?' в кавычках не считается
+static_assert(NoteById::sql() == "SELECT id, UPPER(title), rating, pinned FROM notes WHERE id = ?");
+
+} // namespace
+
 class DatabaseTest : public ::testing::Test {
 protected:
     std::string testDbPath;
@@ -158,5 +186,63 @@ TEST_F(DatabaseTest, TablesCreated) {
     EXPECT_TRUE(hasTable("file_tags"));
     EXPECT_TRUE(hasTable("image_metadata"));
     EXPECT_TRUE(hasTable("file_content"));
+    EXPECT_TRUE(hasTable("content_cache"));
+    EXPECT_TRUE(hasTable("mime_types"));
+}
+
+
+TEST_F(DatabaseTest, ProgressHandlerInterruptsQuery) {
+    Database db(testDbPath);
+
+    // Бесконечный рекурсивный CTE — завершится только по прерыванию
+    const std::string endless =
+        "WITH RECURSIVE n(x) AS (SELECT 1 UNION ALL SELECT x + 1 FROM n) "
+        "SELECT COUNT(*) FROM n";
+
+    int calls = 0;
+    db.setProgressHandler(100, [&calls]() { return ++calls >= 10; });
+    EXPECT_THROW(db.queryScalar(endless), DatabaseException);
+    EXPECT_GE(calls, 10);
+
+    // Без обработчика соединение работает как обычно
+    db.setProgressHandler(0, nullptr);
+    EXPECT_EQ(db.queryScalar("SELECT 42"), 42);
+}
+
+TEST_F(DatabaseTest, TypedSelectMapsSchemaColumns) {
+    Database db(testDbPath);
+    db.execute("CREATE TABLE notes (id INTEGER PRIMARY KEY, title TEXT, rating INTEGER, pinned INTEGER)");
+    db.execute("INSERT INTO notes VALUES (1, 'first', 5, 1), (2, 'second', NULL, 0), (3, 'third', 2, 0)");
+
+    auto rows = db.select<NotesByRating>(3);
+    ASSERT_EQ(rows.size(), 1u);
+    EXPECT_EQ(rows[0].id, 1);
+    EXPECT_EQ(rows[0].title, "FIRST");
+    EXPECT_EQ(rows[0].rating, 5);
+    EXPECT_TRUE(rows[0].pinned);
+
+    auto second = db.selectOne<NoteById>(2);
+    ASSERT_TRUE(second.has_value());
+    EXPECT_EQ(second->title, "SECOND");
+    EXPECT_FALSE(second->rating.has_value());
+    EXPECT_FALSE(second->pinned);
+
+    EXPECT_FALSE(db.selectOne<NoteById>(42).has_value());
 }
 
+TEST_F(DatabaseTest, TypedSelectReusesPreparedStatement) {
+    Database db(testDbPath);
+    db.execute("CREATE TABLE notes (id INTEGER PRIMARY KEY, title TEXT, rating INTEGER, pinned INTEGER)");
+    db.execute("INSERT INTO notes VALUES (1, 'first', 5, 1)");
+
+    EXPECT_EQ(db.cachedStatementCount(), 0u);
+    for (int i = 0; i < 5; ++i) {
+        EXPECT_TRUE(db.selectOne<NoteById>(1).has_value());
+    }
+    EXPECT_EQ(db.cachedStatementCount(), 1u);
+
+    // Привязки сбрасываются: следующий вызов не видит старых параметров
+    EXPECT_EQ(db.select<NotesByRating>(10).size(), 0u);
+    EXPECT_EQ(db.select<NotesByRating>(1).size(), 1u);
+    EXPECT_EQ(db.cachedStatementCount(), 2u);
+}
@@ -0,0 +1,205 @@
+// test_encoding_converter.cpp — тесты определения кодировки и перекодировки в UTF-8
+
+#include <gtest/gtest.h>
+#include "familyvault/EncodingConverter.h"
+#include <random>
+
+using namespace FamilyVault;
+
+namespace {
+
+const SimdLevel kAllLevels[] = {SimdLevel::Scalar, SimdLevel::Sse2, SimdLevel::Avx2};
+
+void appendUtf8(std::string& out, uint32_t cp) {
+    if (cp < 0x80) {
+        out += static_cast<char>(cp);
+    } else if (cp < 0x800) {
+        out += static_cast<char>(0xC0 | (cp >> 6));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else if (cp < 0x10000) {
+        out += static_cast<char>(0xE0 | (cp >> 12));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (cp >> 18));
+        out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    }
+}
+
+void appendUnit(std::string& out, uint16_t unit, bool bigEndian) {
+    char hi = static_cast<char>(unit >> 8);
+    char lo = static_cast<char>(unit & 0xFF);
+    out += bigEndian ? hi : lo;
+    out += bigEndian ? lo : hi;
+}
+
+/// UTF-16 с BOM из последовательности кодовых точек
+std::string utf16(const std::vector<uint32_t>& codePoints, bool bigEndian) {
+    std::string out;
+    appendUnit(out, 0xFEFF, bigEndian);
+    for (uint32_t cp : codePoints) {
+        if (cp >= 0x10000) {
+            appendUnit(out, static_cast<uint16_t>(0xD800 + ((cp - 0x10000) >> 10)), bigEndian);
+            appendUnit(out, static_cast<uint16_t>(0xDC00 + ((cp - 0x10000) & 0x3FF)), bigEndian);
+        } else {
+            appendUnit(out, static_cast<uint16_t>(cp), bigEndian);
+        }
+    }
+    return out;
+}
+
+std::string utf8(const std::vector<uint32_t>& codePoints) {
+    std::string out;
+    for (uint32_t cp : codePoints) appendUtf8(out, cp);
+    return out;
+}
+
+/// Смесь ASCII, кириллицы, BMP и символов вне BMP — длиннее нескольких блоков
+std::vector<uint32_t> mixedCodePoints(std::mt19937& rng, size_t count) {
+    std::vector<uint32_t> codePoints;
+    while (codePoints.size() < count) {
+        switch (rng() % 6) {
+            case 0: case 1: codePoints.push_back(0x20 + rng() % 0x5F); break;
+            case 2: case 3: codePoints.push_back(0x410 + rng() % 0x40); break;
+            case 4: codePoints.push_back(0x2000 + rng() % 0x100); break;
+            default: codePoints.push_back(0x1F600 + rng() % 0x40); break;
+        }
+        // Серии одного класса, чтобы блоки целиком попадали в быстрые ветки
+        if (rng() % 4 == 0) {
+            for (int i = 0; i < 20; ++i) codePoints.push_back(0x430 + rng() % 0x20);
+        }
+    }
+    return codePoints;
+}
+
+} // namespace
+
+TEST(EncodingConverterTest, DetectsByBomAndHeuristics) {
+    EXPECT_EQ(EncodingConverter::detect(""), TextEncoding::Utf8);
+    EXPECT_EQ(EncodingConverter::detect("plain ascii"), TextEncoding::Utf8);
+    EXPECT_EQ(EncodingConverter::detect("Привет, мир"), TextEncoding::Utf8);
+    EXPECT_EQ(EncodingConverter::detect("\xEF\xBB\xBFtext"), TextEncoding::Utf8Bom);
+    EXPECT_EQ(EncodingConverter::detect(std::string("\xFF\xFEh\0", 4)), TextEncoding::Utf16Le);
+    EXPECT_EQ(EncodingConverter::detect(std::string("\xFE\xFF\0h", 4)), TextEncoding::Utf16Be);
+
+    // «Привет» в CP1251, повторённый до порога эвристики
+    std::string cp1251;
+    for (int i = 0; i < 20; ++i) cp1251 += "\xCF\xF0\xE8\xE2\xE5\xF2 ";
+    EXPECT_EQ(EncodingConverter::detect(cp1251), TextEncoding::Cp1251);
+
+    // Невалидный UTF-8 без кириллицы остаётся UTF-8 (нормализатор заменит байты)
+    EXPECT_EQ(EncodingConverter::detect("abc\x80\x81 def"), TextEncoding::Utf8);
+}
+
+TEST(EncodingConverterTest, DetectIgnoresCharacterCutBySample) {
+    // Двухбайтный символ на границе проверяемого фрагмента не делает текст невалидным
+    std::string text(4095, 'a');
+    for (int i = 0; i < 100; ++i) text += "я";
+    EXPECT_EQ(EncodingConverter::detect(text), TextEncoding::Utf8);
+}
+
+TEST(EncodingConverterTest, ConvertInPlaceKeepsUtf8AndStripsBom) {
+    std::string text = "Семейный архив";
+    EncodingConverter::convertInPlace(text, TextEncoding::Utf8);
+    EXPECT_EQ(text, "Семейный архив");
+
+    std::string withBom = "\xEF\xBB\xBFСемейный архив";
+    EncodingConverter::convertInPlace(withBom, TextEncoding::Utf8Bom);
+    EXPECT_EQ(withBom, "Семейный архив");
+}
+
+TEST(EncodingConverterTest, ConvertsUtf16BothByteOrders) {
+    std::mt19937 rng(42);
+    for (size_t count : {0, 1, 7, 8, 9, 63, 500}) {
+        auto codePoints = mixedCodePoints(rng, count);
+        std::string expected = utf8(codePoints);
+        for (bool bigEndian : {false, true}) {
+            auto encoding = bigEndian ? TextEncoding::Utf16Be : TextEncoding::Utf16Le;
+            std::string input = utf16(codePoints, bigEndian);
+            for (auto level : kAllLevels) {
+                EXPECT_EQ(EncodingConverter::toUtf8(input, encoding, level), expected)
+                    << "count=" << count << " be=" << bigEndian << " level=" << static_cast<int>(level);
+            }
+        }
+    }
+}
+
+TEST(EncodingConverterTest, Utf16ReplacesLoneSurrogatesAndIgnoresOddByte) {
+    std::string input;
+    appendUnit(input, 0xFEFF, false);
+    appendUnit(input, 'a', false);
+    appendUnit(input, 0xDC00, false);  // Младший суррогат без старшего
+    appendUnit(input, 'b', false);
+    appendUnit(input, 0xD800, false);  // Старший суррогат без пары
+    appendUnit(input, 'c', false);
+    appendUnit(input, 0xD83D, false);  // Старший суррогат в конце
+    input += 'x';                       // Нечётный байт отбрасывается
+
+    for (auto level : kAllLevels) {
+        EXPECT_EQ(EncodingConverter::toUtf8(input, TextEncoding::Utf16Le, level),
+                  "a\xEF\xBF\xBD" "b\xEF\xBF\xBD" "c\xEF\xBF\xBD");
+    }
+}
+
+TEST(EncodingConverterTest, ConvertsEveryCp1251Byte) {
+    // Эталон: известные точки таблицы
+    EXPECT_EQ(EncodingConverter::toUtf8("\xC0\xFF\xA8\xB8\x88\xB9", TextEncoding::Cp1251),
+              "АяЁё€№");
+
+    // Все 256 байтов в разных позициях блока — результат одинаков на всех уровнях
+    std::string all;
+    for (int shift = 0; shift < 17; ++shift) {
+        for (int b = 0; b < 256; ++b) all += static_cast<char>((b + shift) & 0xFF);
+    }
+    std::string reference = EncodingConverter::toUtf8(all, TextEncoding::Cp1251, SimdLevel::Scalar);
+    for (auto level : kAllLevels) {
+        EXPECT_EQ(EncodingConverter::toUtf8(all, TextEncoding::Cp1251, level), reference);
+    }
+    EXPECT_TRUE(TextNormalizer::isValidUtf8(reference));
+}
+
+TEST(EncodingConverterTest, Cp1251LevelsAgreeOnRussianText) {
+    std::mt19937 rng(7);
+    std::string text;
+    while (text.size() < 10000) {
+        // Слова из букв А..я, пробелы, пунктуация и изредка Ё/№
+        int word = 2 + rng() % 10;
+        for (int i = 0; i < word; ++i) text += static_cast<char>(0xC0 + rng() % 64);
+        text += rng() % 9 == 0 ? "\xA8, " : rng() % 11 == 0 ? " \xB9" : " ";
+    }
+    std::string reference = EncodingConverter::toUtf8(text, TextEncoding::Cp1251, SimdLevel::Scalar);
+    EXPECT_TRUE(TextNormalizer::isValidUtf8(reference));
+    for (auto level : kAllLevels) {
+        EXPECT_EQ(EncodingConverter::toUtf8(text, TextEncoding::Cp1251, level), reference);
+    }
+}
+
+TEST(EncodingConverterTest, DecodeChunkCarriesSurrogatePairToNextChunk) {
+    std::mt19937 rng(3);
+    auto codePoints = mixedCodePoints(rng, 2000);
+    std::string expected = utf8(codePoints);
+
+    for (bool bigEndian : {false, true}) {
+        auto encoding = bigEndian ? TextEncoding::Utf16Be : TextEncoding::Utf16Le;
+        std::string input = utf16(codePoints, bigEndian);
+        std::string_view data(input);
+        data.remove_prefix(EncodingConverter::bomLength(encoding));
+
+        for (auto level : kAllLevels) {
+            // Нечётная длина фрагмента режет и кодовые единицы, и пары
+            std::string result;
+            std::string chunkOut;
+            std::string_view rest = data;
+            while (!rest.empty()) {
+                bool last = rest.size() <= 101;
+                size_t used = EncodingConverter::decodeChunk(rest.substr(0, 101), encoding, last,
+                                                             chunkOut, level);
+                result += chunkOut;
+                rest.remove_prefix(used);
+            }
+            EXPECT_EQ(result, expected) << "be=" << bigEndian << " level=" << static_cast<int>(level);
+        }
+    }
+}
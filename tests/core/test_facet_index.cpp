@@ -0,0 +1,296 @@
+// test_facet_index.cpp — тесты RoaringBitmap и FacetIndex
+
+#include <gtest/gtest.h>
+#include "familyvault/Database.h"
+#include "familyvault/IndexManager.h"
+#include "familyvault/TagManager.h"
+#include "familyvault/SearchEngine.h"
+#include "familyvault/FacetIndex.h"
+#include "familyvault/RoaringBitmap.h"
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include <chrono>
+
+namespace fs = std::filesystem;
+using namespace FamilyVault;
+
+// ═══════════════════════════════════════════════════════════
+// RoaringBitmap
+// ═══════════════════════════════════════════════════════════
+
+TEST(RoaringBitmapTest, AddContainsRemove) {
+    RoaringBitmap bm;
+    EXPECT_TRUE(bm.isEmpty());
+
+    bm.add(1);
+    bm.add(70000);   // Другой контейнер
+    bm.add(1);       // Дубликат
+
+    EXPECT_EQ(bm.cardinality(), 2u);
+    EXPECT_TRUE(bm.contains(1));
+    EXPECT_TRUE(bm.contains(70000));
+    EXPECT_FALSE(bm.contains(2));
+
+    EXPECT_TRUE(bm.remove(1));
+    EXPECT_FALSE(bm.remove(1));
+    EXPECT_EQ(bm.toVector(), std::vector<uint32_t>{70000});
+
+    bm.remove(70000);
+    EXPECT_TRUE(bm.isEmpty());
+}
+
+TEST(RoaringBitmapTest, DenseContainerRoundTrip) {
+    // Больше 4096 значений в одном контейнере — переход в битсет и обратно
+    RoaringBitmap bm;
+    for (uint32_t i = 0; i < 10000; ++i) bm.add(i * 2);
+    EXPECT_EQ(bm.cardinality(), 10000u);
+    EXPECT_TRUE(bm.contains(19998));
+    EXPECT_FALSE(bm.contains(19999));
+
+    for (uint32_t i = 0; i < 9000; ++i) bm.remove(i * 2);
+    EXPECT_EQ(bm.cardinality(), 1000u);
+    EXPECT_TRUE(bm.contains(18000));
+    EXPECT_FALSE(bm.contains(17998));
+}
+
+TEST(RoaringBitmapTest, SetOperations) {
+    std::vector<uint32_t> evens, threes;
+    for (uint32_t i = 0; i < 30000; i += 2) evens.push_back(i);
+    for (uint32_t i = 0; i < 30000; i += 3) threes.push_back(i);
+
+    auto a = RoaringBitmap::fromValues(evens);
+    auto b = RoaringBitmap::fromValues(threes);
+
+    auto both = a & b;
+    EXPECT_EQ(both.cardinality(), 5000u);   // Кратные 6
+    EXPECT_EQ(a.andCardinality(b), 5000u);
+    EXPECT_TRUE(both.contains(6));
+    EXPECT_FALSE(both.contains(4));
+
+    auto either = a | b;
+    EXPECT_EQ(either.cardinality(), 15000u + 10000u - 5000u);
+
+    auto onlyEven = a - b;
+    EXPECT_EQ(onlyEven.cardinality(), 10000u);
+    EXPECT_FALSE(onlyEven.contains(6));
+    EXPECT_TRUE(onlyEven.contains(4));
+
+    EXPECT_EQ(onlyEven | both, a);
+}
+
+TEST(RoaringBitmapTest, FitsRejectsOutOfRange) {
+    EXPECT_TRUE(RoaringBitmap::fits(0));
+    EXPECT_TRUE(RoaringBitmap::fits(UINT32_MAX));
+    EXPECT_FALSE(RoaringBitmap::fits(-1));
+    EXPECT_FALSE(RoaringBitmap::fits(static_cast<int64_t>(UINT32_MAX) + 1));
+}
+
+// ═══════════════════════════════════════════════════════════
+// FacetIndex
+// ═══════════════════════════════════════════════════════════
+
+class FacetIndexTest : public ::testing::Test {
+protected:
+    std::string testDbPath;
+    std::string testFolderPath;
+    std::shared_ptr<Database> db;
+    std::shared_ptr<FacetIndex> facets;
+    std::unique_ptr<IndexManager> indexManager;
+    std::unique_ptr<TagManager> tagManager;
+    std::unique_ptr<SearchEngine> searchEngine;
+    int64_t folderId = 0;
+
+    void SetUp() override {
+        testDbPath = "test_facets_" + std::to_string(std::rand()) + ".db";
+        testFolderPath = "test_facets_folder_" + std::to_string(std::rand());
+
+        fs::create_directories(testFolderPath);
+        createTestFile(testFolderPath + "/a.txt", "alpha");
+        createTestFile(testFolderPath + "/b.txt", "beta");
+        createTestFile(testFolderPath + "/c.jpg", "not really an image");
+
+        db = std::make_shared<Database>(testDbPath);
+        db->initialize();
+
+        facets = std::make_shared<FacetIndex>(db);
+        facets->rebuild();
+
+        indexManager = std::make_unique<IndexManager>(db);
+        tagManager = std::make_unique<TagManager>(db);
+        searchEngine = std::make_unique<SearchEngine>(db);
+        indexManager->setFacetIndex(facets);
+        tagManager->setFacetIndex(facets);
+        searchEngine->setFacetIndex(facets);
+
+        folderId = indexManager->addFolder(testFolderPath, "Facets");
+        indexManager->scanFolder(folderId);
+    }
+
+    void TearDown() override {
+        searchEngine.reset();
+        tagManager.reset();
+        indexManager.reset();
+        facets.reset();
+        db.reset();
+
+        if (fs::exists(testDbPath)) fs::remove(testDbPath);
+        fs::remove(testDbPath + "-wal");
+        fs::remove(testDbPath + "-shm");
+
+        if (fs::exists(testFolderPath)) {
+            fs::remove_all(testFolderPath);
+        }
+    }
+
+    void createTestFile(const std::string& path, const std::string& content) {
+        std::ofstream file(path);
+        file << content;
+    }
+
+    int64_t fileIdByName(const std::string& name) {
+        return db->queryScalar("SELECT id FROM files WHERE name = ?", name);
+    }
+
+    static int64_t countOf(const std::vector<FacetCount>& counts, const std::string& value) {
+        for (const auto& c : counts) {
+            if (c.value == value) return c.count;
+        }
+        return 0;
+    }
+};
+
+TEST_F(FacetIndexTest, TracksScannedFiles) {
+    EXPECT_EQ(facets->fileCount(), 3);
+
+    auto ext = facets->facetCounts(FacetKind::Extension);
+    EXPECT_EQ(countOf(ext, "txt"), 2);
+    EXPECT_EQ(countOf(ext, "jpg"), 1);
+    ASSERT_FALSE(ext.empty());
+    EXPECT_EQ(ext[0].value, "txt");  // Сортировка по убыванию счётчика
+
+    auto folders = facets->facetCounts(FacetKind::Folder);
+    EXPECT_EQ(countOf(folders, std::to_string(folderId)), 3);
+}
+
+TEST_F(FacetIndexTest, RebuildMatchesIncrementalState) {
+    tagManager->addTag(fileIdByName("a.txt"), "work");
+    tagManager->addTag(fileIdByName("b.txt"), "work");
+
+    auto incremental = facets->facetCounts(FacetKind::Tag);
+
+    FacetIndex fresh(db);
+    fresh.rebuild();
+    auto rebuilt = fresh.facetCounts(FacetKind::Tag);
+
+    ASSERT_EQ(incremental.size(), rebuilt.size());
+    for (size_t i = 0; i < rebuilt.size(); ++i) {
+        EXPECT_EQ(incremental[i].value, rebuilt[i].value);
+        EXPECT_EQ(incremental[i].count, rebuilt[i].count);
+    }
+    EXPECT_EQ(fresh.fileCount(), facets->fileCount());
+}
+
+TEST_F(FacetIndexTest, TagCountsFollowTagManager) {
+    int64_t a = fileIdByName("a.txt");
+    int64_t b = fileIdByName("b.txt");
+
+    tagManager->addTagToFiles({a, b}, "family");
+    tagManager->addTag(a, "vacation");
+
+    EXPECT_EQ(tagManager->countFilesByTag("family"), 2);
+    EXPECT_EQ(tagManager->countFilesByTag("vacation"), 1);
+
+    auto popular = tagManager->getPopularTags(1);
+    ASSERT_EQ(popular.size(), 1u);
+    EXPECT_EQ(popular[0].name, "family");
+    EXPECT_EQ(popular[0].fileCount, 2);
+
+    tagManager->removeTag(a, "family");
+    EXPECT_EQ(tagManager->countFilesByTag("family"), 1);
+
+    // Тег без файлов остаётся в списке всех тегов с нулевым счётчиком
+    tagManager->removeTag(a, "vacation");
+    auto all = tagManager->getAllTags();
+    auto it = std::find_if(all.begin(), all.end(), [](const Tag& t) { return t.name == "vacation"; });
+    ASSERT_NE(it, all.end());
+    EXPECT_EQ(it->fileCount, 0);
+}
+
+TEST_F(FacetIndexTest, RolledBackTagNotRegistered) {
+    // Несуществующий файл нарушает внешний ключ file_tags — транзакция откатывается
+    EXPECT_ANY_THROW(tagManager->addTagToFiles({fileIdByName("a.txt"), 999999}, "ghost"));
+    EXPECT_EQ(db->queryScalar("SELECT COUNT(*) FROM tags WHERE name = 'ghost'"), 0);
+
+    for (const auto& tag : tagManager->getAllTags()) {
+        EXPECT_NE(tag.name, "ghost");
+    }
+
+    tagManager->addTagToFiles({fileIdByName("a.txt")}, "ghost");
+    EXPECT_EQ(tagManager->countFilesByTag("ghost"), 1);
+}
+
+TEST_F(FacetIndexTest, DeletedFilesLeaveFacets) {
+    int64_t a = fileIdByName("a.txt");
+    tagManager->addTag(a, "doomed");
+
+    indexManager->deleteFile(a);
+
+    EXPECT_EQ(facets->fileCount(), 2);
+    EXPECT_EQ(countOf(facets->facetCounts(FacetKind::Extension), "txt"), 1);
+    EXPECT_EQ(tagManager->countFilesByTag("doomed"), 0);
+
+    indexManager->removeFolder(folderId);
+    EXPECT_EQ(facets->fileCount(), 0);
+    EXPECT_TRUE(facets->facetCounts(FacetKind::ContentType).empty());
+}
+
+TEST_F(FacetIndexTest, UpsertMovesFileBetweenValues) {
+    int64_t a = fileIdByName("a.txt");
+
+    // Смена расширения и папки: старые значения теряют файл, пустые исчезают
+    facets->upsertFile(a, 777, ContentType::Document, "pdf", 0);
+    auto ext = facets->facetCounts(FacetKind::Extension);
+    EXPECT_EQ(countOf(ext, "txt"), 1);
+    EXPECT_EQ(countOf(ext, "pdf"), 1);
+    EXPECT_EQ(countOf(facets->facetCounts(FacetKind::Folder), "777"), 1);
+
+    facets->upsertFile(a, 777, ContentType::Document, "", 0);
+    ext = facets->facetCounts(FacetKind::Extension);
+    EXPECT_EQ(countOf(ext, "pdf"), 0);
+    EXPECT_TRUE(facets->filesWith(FacetKind::Extension, "pdf").isEmpty());
+
+    RoaringBitmap batch;
+    batch.add(static_cast<uint32_t>(a));
+    facets->removeFiles(batch);
+    EXPECT_TRUE(facets->filesWith(FacetKind::Folder, "777").isEmpty());
+    EXPECT_EQ(facets->fileCount(), 2);
+}
+
+TEST_F(FacetIndexTest, RescanDropsRemovedFiles) {
+    // indexed_at хранится в секундах — повторное сканирование в ту же секунду ничего не удалит
+    std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+    fs::remove(testFolderPath + "/b.txt");
+    indexManager->scanFolder(folderId);
+
+    EXPECT_EQ(facets->fileCount(), 2);
+    EXPECT_EQ(countOf(facets->facetCounts(FacetKind::Extension), "txt"), 1);
+}
+
+TEST_F(FacetIndexTest, SearchFacetsRestrictedToQuery) {
+    tagManager->addTag(fileIdByName("a.txt"), "red");
+    tagManager->addTag(fileIdByName("c.jpg"), "red");
+
+    SearchQuery all;
+    EXPECT_EQ(countOf(searchEngine->facetCounts(all, FacetKind::Tag), "red"), 2);
+
+    SearchQuery onlyTxt;
+    onlyTxt.extension = "txt";
+    auto counts = searchEngine->facetCounts(onlyTxt, FacetKind::Tag);
+    EXPECT_EQ(countOf(counts, "red"), 1);
+
+    auto ext = searchEngine->facetCounts(onlyTxt, FacetKind::Extension);
+    ASSERT_EQ(ext.size(), 1u);
+    EXPECT_EQ(ext[0].value, "txt");
+    EXPECT_EQ(ext[0].count, 2);
+}
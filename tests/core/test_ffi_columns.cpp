@@ -0,0 +1,189 @@
+// test_ffi_columns.cpp — тесты колоночного буфера FVFileColumns
+// Колонки должны совпадать с JSON версией тех же вызовов
+
+#include <gtest/gtest.h>
+#include <nlohmann/json.hpp>
+#include "familyvault/familyvault_c.h"
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+namespace fs = std::filesystem;
+using json = nlohmann::json;
+
+namespace {
+
+std::string column(const FVFileColumns* c, const uint32_t* offsets, uint32_t row) {
+    return std::string(c->strings + offsets[row], offsets[row + 1] - offsets[row]);
+}
+
+void expectRowMatchesJson(const FVFileColumns* c, uint32_t row, const json& j) {
+    EXPECT_EQ(c->id[row], j["id"].get<int64_t>());
+    EXPECT_EQ(c->folder_id[row], j["folderId"].get<int64_t>());
+    EXPECT_EQ(c->size[row], j["size"].get<int64_t>());
+    EXPECT_EQ(c->modified_at[row], j["modifiedAt"].get<int64_t>());
+    EXPECT_EQ(c->content_type[row], j["contentType"].get<int32_t>());
+    EXPECT_EQ((c->flags[row] & FV_FILE_FLAG_REMOTE) != 0, j["isRemote"].get<bool>());
+    EXPECT_EQ((c->flags[row] & FV_FILE_FLAG_HAS_THUMBNAIL) != 0, j["hasThumbnail"].get<bool>());
+    EXPECT_EQ(column(c, c->relative_path_offsets, row), j["relativePath"].get<std::string>());
+    EXPECT_EQ(column(c, c->folder_path_offsets, row), j["folderPath"].get<std::string>());
+    EXPECT_EQ(column(c, c->name_offsets, row), j["name"].get<std::string>());
+    EXPECT_EQ(column(c, c->extension_offsets, row), j["extension"].get<std::string>());
+}
+
+} // namespace
+
+class FfiColumnsTest : public ::testing::Test {
+protected:
+    std::string testDbPath;
+    std::string testFolderPath;
+    FVDatabase db = nullptr;
+    FVIndexManager index = nullptr;
+    FVSearchEngine search = nullptr;
+    int64_t folderId = 0;
+
+    void SetUp() override {
+        testDbPath = "test_ffi_columns_" + std::to_string(std::rand()) + ".db";
+        testFolderPath = "test_ffi_columns_folder_" + std::to_string(std::rand());
+
+        fs::create_directories(testFolderPath + "/docs");
+        createTestFile(testFolderPath + "/report.txt", "quarterly report");
+        createTestFile(testFolderPath + "/docs/report_final.md", "final report");
+        createTestFile(testFolderPath + "/отчёт.txt", "report in russian");
+        createTestFile(testFolderPath + "/noext", "");
+
+        FVError err = FV_OK;
+        db = fv_database_open(testDbPath.c_str(), &err);
+        ASSERT_NE(db, nullptr);
+        ASSERT_EQ(fv_database_initialize(db), FV_OK);
+
+        index = fv_index_create(db);
+        search = fv_search_create(db);
+        ASSERT_NE(index, nullptr);
+        ASSERT_NE(search, nullptr);
+
+        folderId = fv_index_add_folder(index, testFolderPath.c_str(), "Columns", 0);
+        ASSERT_GT(folderId, 0);
+        ASSERT_EQ(fv_index_scan_folder(index, folderId, nullptr, nullptr), FV_OK);
+    }
+
+    void TearDown() override {
+        fv_search_destroy(search);
+        fv_index_destroy(index);
+        fv_database_close(db);
+
+        if (fs::exists(testDbPath)) fs::remove(testDbPath);
+        fs::remove(testDbPath + "-wal");
+        fs::remove(testDbPath + "-shm");
+        if (fs::exists(testFolderPath)) {
+            fs::remove_all(testFolderPath);
+        }
+    }
+
+    void createTestFile(const std::string& path, const std::string& content) {
+        std::ofstream file(path);
+        file << content;
+    }
+
+    static json takeJson(char* str) {
+        EXPECT_NE(str, nullptr);
+        json j = str ? json::parse(str) : json::array();
+        fv_free_string(str);
+        return j;
+    }
+};
+
+TEST_F(FfiColumnsTest, ByFolderMatchesJson) {
+    json expected = takeJson(fv_index_get_by_folder_compact(index, folderId, 100, 0));
+    FVFileColumns* columns = fv_index_get_by_folder_columns(index, folderId, 100, 0);
+    ASSERT_NE(columns, nullptr);
+
+    EXPECT_EQ(columns->version, static_cast<uint32_t>(FV_FILE_COLUMNS_VERSION));
+    ASSERT_EQ(columns->row_count, expected.size());
+    ASSERT_EQ(columns->row_count, 4u);
+    for (uint32_t i = 0; i < columns->row_count; ++i) {
+        expectRowMatchesJson(columns, i, expected[i]);
+        EXPECT_EQ(columns->score[i], 0.0);
+    }
+
+    fv_free_columns(columns);
+}
+
+TEST_F(FfiColumnsTest, RecentMatchesJson) {
+    json expected = takeJson(fv_index_get_recent_compact(index, 2));
+    FVFileColumns* columns = fv_index_get_recent_columns(index, 2);
+    ASSERT_NE(columns, nullptr);
+
+    ASSERT_EQ(columns->row_count, expected.size());
+    for (uint32_t i = 0; i < columns->row_count; ++i) {
+        expectRowMatchesJson(columns, i, expected[i]);
+    }
+
+    fv_free_columns(columns);
+}
+
+TEST_F(FfiColumnsTest, SearchCarriesScores) {
+    const char* query = R"({"text": "report", "limit": 10})";
+    json expected = takeJson(fv_search_query_compact(search, query));
+    FVFileColumns* columns = fv_search_query_columns(search, query);
+    ASSERT_NE(columns, nullptr);
+
+    ASSERT_FALSE(expected.empty());
+    ASSERT_EQ(columns->row_count, expected.size());
+    for (uint32_t i = 0; i < columns->row_count; ++i) {
+        expectRowMatchesJson(columns, i, expected[i]);
+        EXPECT_DOUBLE_EQ(columns->score[i], expected[i]["score"].get<double>());
+    }
+
+    fv_free_columns(columns);
+}
+
+TEST_F(FfiColumnsTest, LayoutIsSingleAlignedBlock) {
+    FVFileColumns* columns = fv_index_get_by_folder_columns(index, folderId, 100, 0);
+    ASSERT_NE(columns, nullptr);
+
+    auto begin = reinterpret_cast<uintptr_t>(columns);
+    auto end = begin + columns->total_bytes;
+    auto inside = [&](const void* p) {
+        auto addr = reinterpret_cast<uintptr_t>(p);
+        return addr >= begin && addr <= end;
+    };
+
+    for (const void* p : {static_cast<const void*>(columns->id),
+                          static_cast<const void*>(columns->folder_id),
+                          static_cast<const void*>(columns->size),
+                          static_cast<const void*>(columns->modified_at),
+                          static_cast<const void*>(columns->score),
+                          static_cast<const void*>(columns->content_type),
+                          static_cast<const void*>(columns->flags),
+                          static_cast<const void*>(columns->relative_path_offsets),
+                          static_cast<const void*>(columns->name_offsets),
+                          static_cast<const void*>(columns->strings)}) {
+        EXPECT_TRUE(inside(p));
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(p) % 8, 0u);
+    }
+
+    // Смещения строк монотонны и не выходят за арену
+    uint32_t n = columns->row_count;
+    EXPECT_EQ(columns->relative_path_offsets[0], 0u);
+    EXPECT_EQ(columns->folder_path_offsets[0], columns->relative_path_offsets[n]);
+    EXPECT_EQ(columns->name_offsets[0], columns->folder_path_offsets[n]);
+    EXPECT_EQ(columns->extension_offsets[0], columns->name_offsets[n]);
+    EXPECT_TRUE(inside(columns->strings + columns->extension_offsets[n]));
+
+    fv_free_columns(columns);
+}
+
+TEST_F(FfiColumnsTest, EmptyResultAndNullHandle) {
+    FVFileColumns* columns = fv_index_get_by_folder_columns(index, folderId + 1000, 100, 0);
+    ASSERT_NE(columns, nullptr);
+    EXPECT_EQ(columns->row_count, 0u);
+    EXPECT_EQ(columns->name_offsets[0], columns->name_offsets[columns->row_count]);
+    fv_free_columns(columns);
+
+    EXPECT_EQ(fv_index_get_recent_columns(nullptr, 10), nullptr);
+    EXPECT_EQ(fv_last_error(), FV_ERROR_INVALID_ARGUMENT);
+
+    fv_free_columns(nullptr);
+}
@@ -11,6 +11,7 @@
 #include <fstream>
 #include <thread>
 #include <chrono>
+#include <map>
 
 namespace fs = std::filesystem;
 using namespace FamilyVault;
@@ -437,6 +438,27 @@ TEST_F(FileScannerTest, DetectsImageContentType) {
     }
 }
 
+TEST_F(FileScannerTest, DetectsUnknownExtensionsByContent) {
+    // Больше одной пачки чтения заголовков, вперемешку с известными расширениями
+    for (int i = 0; i < 150; i++) {
+        createTestFile("blob" + std::to_string(i) + ".bin", i % 2 ? "%PDF-1.4" : "\x89PNG\r\n\x1A\n");
+        createTestFile("note" + std::to_string(i) + ".txt", "text");
+    }
+    createTestFile("noextension", "plain text");
+
+    std::map<std::string, ScannedFile> files;
+    scanner->scan(testFolderPath, [&files](const ScannedFile& f) {
+        files[f.name] = f;
+    });
+
+    ASSERT_EQ(files.size(), 301u);
+    EXPECT_EQ(files["blob0.bin"].mimeType, "image/png");
+    EXPECT_EQ(files["blob0.bin"].contentType, ContentType::Image);
+    EXPECT_EQ(files["blob149.bin"].mimeType, "application/pdf");
+    EXPECT_EQ(files["note7.txt"].mimeType, "text/plain");
+    EXPECT_EQ(files["noextension"].mimeType, "application/octet-stream");
+}
+
 TEST_F(FileScannerTest, DetectsVideoContentType) {
     createTestFile("movie.mp4", "video");
     createTestFile("clip.avi", "video");
@@ -5,6 +5,7 @@
 #include "familyvault/IndexManager.h"
 #include <filesystem>
 #include <fstream>
+#include <thread>
 
 namespace fs = std::filesystem;
 using namespace FamilyVault;
@@ -137,6 +138,76 @@ TEST_F(IndexManagerTest, GetFileByPath) {
     EXPECT_EQ(file->extension, "txt");
 }
 
+TEST_F(IndexManagerTest, RescanDropsChecksumOfChangedFile) {
+    int64_t folderId = indexManager->addFolder(testFolderPath, "Checksum Test");
+    indexManager->scanFolder(folderId);
+    db->execute("UPDATE files SET checksum = 'known'");
+
+    // Неизменённые файлы сохраняют checksum, изменённый — теряет
+    createTestFile(testFolderPath + "/test1.txt", "Hello World, edited");
+    indexManager->scanFolder(folderId);
+
+    auto checksumOf = [this](const std::string& name) {
+        return db->queryOne<std::string>(
+            "SELECT COALESCE(checksum, '') FROM files WHERE name = ?",
+            [](sqlite3_stmt* stmt) { return Database::getString(stmt, 0); }, name);
+    };
+    EXPECT_EQ(checksumOf("test1.txt"), std::optional<std::string>(""));
+    EXPECT_EQ(checksumOf("test2.jpg"), std::optional<std::string>("known"));
+}
+
+TEST_F(IndexManagerTest, ScanMarksPendingExtractionAndSignals) {
+    auto ingest = std::make_shared<IngestSignal>();
+    int signals = 0;
+    ingest->setListener([&signals] { ++signals; });
+    indexManager->setIngestSignal(ingest);
+
+    int64_t folderId = indexManager->addFolder(testFolderPath, "Pending Test");
+    indexManager->scanFolder(folderId);
+    EXPECT_EQ(signals, 1);
+
+    auto pending = [this](const std::string& name) {
+        return db->queryScalar("SELECT extraction_pending FROM files WHERE name = ?", name);
+    };
+    EXPECT_EQ(pending("test1.txt"), 1);
+    EXPECT_EQ(pending("test3.pdf"), 1);
+    EXPECT_EQ(pending("test2.jpg"), 0);
+
+    // Обработанный файл снова ждёт извлечения только после изменения
+    db->execute("UPDATE files SET extraction_pending = 0");
+    indexManager->scanFolder(folderId);
+    EXPECT_EQ(pending("test1.txt"), 0);
+
+    createTestFile(testFolderPath + "/test1.txt", "Hello World, edited");
+    indexManager->scanFolder(folderId);
+    EXPECT_EQ(pending("test1.txt"), 1);
+    EXPECT_EQ(pending("test3.pdf"), 0);
+    EXPECT_EQ(signals, 3);
+}
+
+TEST_F(IndexManagerTest, ScanInternsMimeTypes) {
+    int64_t folderId = indexManager->addFolder(testFolderPath, "Mime Test");
+    indexManager->scanFolder(folderId);
+    createTestFile(testFolderPath + "/notes.txt", "more text");
+    indexManager->scanFolder(folderId);
+
+    // Каждый файл ссылается на строку справочника со своим типом
+    EXPECT_EQ(db->queryScalar(
+        "SELECT COUNT(*) FROM files f LEFT JOIN mime_types m ON m.id = f.mime_id "
+        "WHERE m.mime_type IS NOT f.mime_type"), 0);
+    EXPECT_EQ(db->queryScalar(
+        "SELECT COUNT(DISTINCT mime_id) FROM files WHERE name IN ('test1.txt', 'notes.txt')"), 1);
+    EXPECT_EQ(db->queryScalar(
+        "SELECT COUNT(*) FROM mime_types WHERE mime_type = 'text/plain'"), 1);
+
+    auto extractable = [this](const std::string& mimeType) {
+        return db->queryScalar("SELECT extractable FROM mime_types WHERE mime_type = ?", mimeType);
+    };
+    EXPECT_EQ(extractable("text/plain"), 1);
+    EXPECT_EQ(extractable("application/pdf"), 1);
+    EXPECT_EQ(extractable("image/jpeg"), 0);
+}
+
 TEST_F(IndexManagerTest, SetFolderEnabled) {
     int64_t folderId = indexManager->addFolder(testFolderPath, "Enable Test");
 
@@ -161,3 +232,107 @@ TEST_F(IndexManagerTest, Stats) {
     EXPECT_GT(stats.totalSize, 0);
 }
 
+TEST_F(IndexManagerTest, StatsCountersMatchFilesTable) {
+    int64_t folderId = indexManager->addFolder(testFolderPath, "Counters Test");
+    indexManager->scanFolder(folderId);
+
+    auto expectCountersMatch = [this]() {
+        auto stats = indexManager->getStats();
+        EXPECT_EQ(stats.totalFiles, db->queryScalar("SELECT COUNT(*) FROM files"));
+        EXPECT_EQ(stats.totalSize, db->queryScalar("SELECT COALESCE(SUM(size), 0) FROM files"));
+        EXPECT_EQ(stats.documentCount, db->queryScalar(
+            "SELECT COUNT(*) FROM files WHERE content_type = ?",
+            static_cast<int>(ContentType::Document)));
+    };
+    expectCountersMatch();
+
+    // Изменение размера через UPDATE → счётчики следуют за триггером
+    db->execute("UPDATE files SET size = size + 100 WHERE name = 'test1.txt'");
+    expectCountersMatch();
+
+    auto file = indexManager->getFileByPath(folderId, "test1.txt");
+    ASSERT_TRUE(file.has_value());
+    indexManager->deleteFile(file->id);
+    expectCountersMatch();
+
+    auto folder = indexManager->getFolder(folderId);
+    ASSERT_TRUE(folder.has_value());
+    EXPECT_EQ(folder->fileCount, db->queryScalar("SELECT COUNT(*) FROM files WHERE folder_id = ?", folderId));
+
+    // Удаление папки каскадом удаляет файлы и обнуляет счётчики
+    indexManager->removeFolder(folderId);
+    EXPECT_EQ(db->queryScalar("SELECT COUNT(*) FROM file_stats"), 0);
+    EXPECT_EQ(indexManager->getStats().totalFiles, 0);
+}
+
+
+TEST_F(IndexManagerTest, CompactBatchSharesRepeatedStrings) {
+    int64_t folderId = indexManager->addFolder(testFolderPath, "Batch");
+    indexManager->scanFolder(folderId);
+
+    auto batch = indexManager->getFilesByFolderCompactBatch(folderId);
+    auto records = indexManager->getFilesByFolderCompact(folderId);
+    ASSERT_EQ(batch.size(), 3u);
+    ASSERT_EQ(records.size(), batch.size());
+    EXPECT_TRUE(batch.scores.empty());
+
+    // Путь папки хранится один раз на весь пакет
+    for (const auto& row : batch.rows) {
+        EXPECT_EQ(row.folderPath.data(), batch.rows[0].folderPath.data());
+    }
+
+    // Пакет можно переместить — view остаются валидными
+    FileRecordCompactBatch moved = std::move(batch);
+    for (size_t i = 0; i < records.size(); ++i) {
+        EXPECT_EQ(moved.rows[i].name, records[i].name);
+        EXPECT_EQ(moved.rows[i].relativePath, records[i].relativePath);
+        EXPECT_EQ(moved.rows[i].folderPath, records[i].folderPath);
+        EXPECT_EQ(moved.rows[i].extension, records[i].extension);
+        EXPECT_EQ(moved.rows[i].toRecord().id, records[i].id);
+    }
+}
+
+TEST_F(IndexManagerTest, DirectoryTreeBrowsing) {
+    createTestFile(testFolderPath + "/subdir/deep/test4.txt", "deep");
+    createTestFile(testFolderPath + "/other/test5.txt", "other");
+
+    int64_t folderId = indexManager->addFolder(testFolderPath, "Tree");
+    indexManager->scanFolder(folderId);
+
+    auto top = indexManager->getSubdirectories(folderId);
+    ASSERT_EQ(top.size(), 2u);
+    EXPECT_EQ(top[0].name, "other");
+    EXPECT_EQ(top[1].name, "subdir");
+    EXPECT_EQ(top[1].parentId, 0);
+
+    auto nested = indexManager->getSubdirectories(folderId, top[1].id);
+    ASSERT_EQ(nested.size(), 1u);
+    EXPECT_EQ(nested[0].path, "subdir/deep");
+    EXPECT_EQ(indexManager->findDirectory(folderId, "subdir/deep"), nested[0].id);
+    EXPECT_FALSE(indexManager->findDirectory(folderId, "subdir/missing").has_value());
+
+    // Корень папки — directory_id = 0, подкаталоги в выборку не попадают
+    auto rootFiles = indexManager->getFilesByDirectory(folderId, 0);
+    ASSERT_EQ(rootFiles.size(), 2u);
+    EXPECT_EQ(rootFiles[0].name, "test1.txt");
+    EXPECT_EQ(rootFiles[0].directoryId, 0);
+
+    auto deepFiles = indexManager->getFilesByDirectoryCompactBatch(folderId, nested[0].id);
+    ASSERT_EQ(deepFiles.size(), 1u);
+    EXPECT_EQ(deepFiles.rows[0].relativePath, "subdir/deep/test4.txt");
+
+    auto file = indexManager->getFileByPath(folderId, "subdir/test3.pdf");
+    ASSERT_TRUE(file.has_value());
+    EXPECT_EQ(file->directoryId, top[1].id);
+
+    // Каталог исчез с диска — после пересканирования пустые записи удаляются
+    fs::remove_all(testFolderPath + "/subdir");
+    std::this_thread::sleep_for(std::chrono::milliseconds(1100));  // indexed_at — секунды
+    indexManager->scanFolder(folderId);
+
+    auto after = indexManager->getSubdirectories(folderId);
+    ASSERT_EQ(after.size(), 1u);
+    EXPECT_EQ(after[0].name, "other");
+    EXPECT_EQ(db->queryScalar("SELECT COUNT(*) FROM directories WHERE folder_id = ?", folderId), 1);
+    EXPECT_FALSE(indexManager->findDirectory(folderId, "subdir/deep").has_value());
+}
@@ -219,5 +219,73 @@ TEST_F(IndexSyncManagerWithFilesTest, GetLocalChangesSince_WithIndexedFiles) {
     EXPECT_GE(changes.size(), 0); // Might be 0 if scan is async
 }
 
+// ═══════════════════════════════════════════════════════════
+// Извлечённый текст по checksum
+// ═══════════════════════════════════════════════════════════
+
+class IndexSyncTextTest : public IndexSyncManagerWithFilesTest {
+protected:
+    int64_t fileId = 0;
+
+    void SetUp() override {
+        IndexSyncManagerWithFilesTest::SetUp();
+        indexManager->scanFolder(indexManager->addFolder(testFolderPath));
+        fileId = db->queryScalar("SELECT id FROM files WHERE name = 'test1.txt'");
+        db->execute("UPDATE files SET checksum = 'sum-1' WHERE id = ?", fileId);
+    }
+
+    /// Файл извлечён локально: метаданные в file_content, текст в files_fts
+    void markExtracted(const std::string& method, const std::string& text) {
+        db->execute("UPDATE files SET extraction_pending = 0 WHERE id = ?", fileId);
+        db->execute("INSERT OR REPLACE INTO file_content (file_id, content, extraction_method) "
+                    "VALUES (?, '', ?)", fileId, method);
+        db->execute("UPDATE files_fts SET content = ? WHERE rowid = ?", text, fileId);
+    }
+};
+
+TEST_F(IndexSyncTextTest, ReceivedTextStoredOnlyForPendingLocalCopy) {
+    ASSERT_EQ(db->queryScalar("SELECT extraction_pending FROM files WHERE id = ?", fileId), 1);
 
+    EXPECT_FALSE(syncManager->storeReceivedText("sum-unknown", "peer text", "peer-1"));
+    EXPECT_TRUE(syncManager->storeReceivedText("sum-1", "peer text", "peer-1"));
+    EXPECT_EQ(db->queryScalar("SELECT COUNT(*) FROM content_cache"), 1);
 
+    // Записи пиров текст не хранят
+    EXPECT_EQ(db->queryScalar(
+        "SELECT COUNT(*) FROM pragma_table_info('remote_files') WHERE name = 'extracted_text'"), 0);
+
+    // Извлечённый локально файл текст пира не принимает
+    db->execute("DELETE FROM content_cache");
+    markExtracted("plain_text", "Hello World");
+    EXPECT_FALSE(syncManager->storeReceivedText("sum-1", "peer text", "peer-1"));
+}
+
+TEST_F(IndexSyncTextTest, WantedChecksumsMatchPendingFilesOfPeer) {
+    db->execute(R"(
+        INSERT INTO remote_files (remote_id, source_device_id, path, name, checksum)
+        VALUES (7, 'peer-1', 'a/test1.txt', 'test1.txt', 'sum-1'),
+               (8, 'peer-1', 'a/other.txt', 'other.txt', 'sum-other')
+    )");
+
+    EXPECT_EQ(syncManager->getWantedTextChecksums("peer-1"), std::vector<std::string>{"sum-1"});
+    EXPECT_TRUE(syncManager->getWantedTextChecksums("peer-2").empty());
+
+    // Текст уже получен — повторно не запрашивается
+    syncManager->storeReceivedText("sum-1", "peer text", "peer-1");
+    EXPECT_TRUE(syncManager->getWantedTextChecksums("peer-1").empty());
+}
+
+TEST_F(IndexSyncTextTest, SharedTextOnlyFromCompleteFamilyExtraction) {
+    EXPECT_EQ(syncManager->getSharedText("sum-1"), "");  // Ещё не извлечён
+
+    markExtracted("plain_text", "Hello World");
+    EXPECT_EQ(syncManager->getSharedText("sum-1"), "Hello World");
+
+    markExtracted("pdf_partial", "Hello");
+    EXPECT_EQ(syncManager->getSharedText("sum-1"), "");
+
+    markExtracted("plain_text", "Hello World");
+    db->execute("UPDATE files SET visibility = ? WHERE id = ?",
+                static_cast<int>(Visibility::Private), fileId);
+    EXPECT_EQ(syncManager->getSharedText("sum-1"), "");
+}
@@ -0,0 +1,271 @@
+// test_maintenance_scheduler.cpp — тесты фонового обслуживания БД порциями
+
+#include <gtest/gtest.h>
+#include "familyvault/Database.h"
+#include "familyvault/IndexManager.h"
+#include "familyvault/MaintenanceScheduler.h"
+#include "familyvault/SearchEngine.h"
+#include "familyvault/familyvault_c.h"
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+using namespace FamilyVault;
+
+class MaintenanceSchedulerTest : public ::testing::Test {
+protected:
+    std::string testDbPath;
+    std::shared_ptr<Database> db;
+
+    void SetUp() override {
+        testDbPath = "test_maintenance_" + std::to_string(std::rand()) + ".db";
+        db = std::make_shared<Database>(testDbPath);
+        db->initialize();
+        db->execute("INSERT INTO watched_folders (path, name) VALUES ('/tmp/m', 'm')");
+    }
+
+    void TearDown() override {
+        db.reset();
+        fs::remove(testDbPath);
+        fs::remove(testDbPath + "-wal");
+        fs::remove(testDbPath + "-shm");
+    }
+
+    /// Каждая вставка — своя транзакция: FTS копит много мелких сегментов
+    void insertFiles(int count) {
+        for (int i = 0; i < count; ++i) {
+            db->execute(
+                "INSERT INTO files (folder_id, relative_path, name, size) VALUES (1, ?, ?, 1)",
+                "doc_" + std::to_string(i) + ".txt", "report_" + std::to_string(i) + ".txt");
+        }
+    }
+
+    static std::vector<MaintenanceProgress> runPass(MaintenanceScheduler& scheduler) {
+        std::vector<MaintenanceProgress> steps;
+        scheduler.runPass([&steps](const MaintenanceProgress& p) { steps.push_back(p); });
+        return steps;
+    }
+
+    static int64_t slicesOf(const std::vector<MaintenanceProgress>& steps, MaintenanceStep step) {
+        int64_t count = 0;
+        for (const auto& p : steps) {
+            if (p.step == step) ++count;
+        }
+        return count;
+    }
+};
+
+TEST_F(MaintenanceSchedulerTest, NewDatabaseUsesIncrementalAutoVacuum) {
+    EXPECT_EQ(db->queryScalar("PRAGMA auto_vacuum"), 2);
+}
+
+TEST_F(MaintenanceSchedulerTest, PassRunsAllStepsInOrder) {
+    MaintenanceScheduler scheduler(db);
+    auto steps = runPass(scheduler);
+
+    ASSERT_FALSE(steps.empty());
+    EXPECT_TRUE(steps.back().passComplete);
+    EXPECT_EQ(steps.back().step, MaintenanceStep::Checkpoint);
+    for (size_t i = 1; i < steps.size(); ++i) {
+        EXPECT_LE(steps[i - 1].step, steps[i].step);
+        EXPECT_FALSE(steps[i - 1].passComplete);
+        EXPECT_EQ(steps[i].slicesDone, steps[i - 1].slicesDone + 1);
+    }
+}
+
+TEST_F(MaintenanceSchedulerTest, FtsMergeRunsInBoundedSlices) {
+    insertFiles(200);
+
+    MaintenanceOptions options;
+    options.mergePages = 1;
+    MaintenanceScheduler scheduler(db, options);
+
+    // Фрагментированный индекс сливается за несколько порций, повторный проход —
+    // по одной пустой порции на каждую FTS таблицу
+    auto first = runPass(scheduler);
+    auto second = runPass(scheduler);
+    EXPECT_GT(slicesOf(first, MaintenanceStep::FtsMerge), 3);
+    EXPECT_EQ(slicesOf(second, MaintenanceStep::FtsMerge), 3);
+
+    auto found = db->queryScalar("SELECT COUNT(*) FROM files_fts WHERE files_fts MATCH 'report_42'");
+    EXPECT_EQ(found, 1);
+    EXPECT_EQ(db->queryScalar("SELECT COUNT(*) FROM files_trigram WHERE files_trigram MATCH 'ort_19'"), 11);
+}
+
+TEST_F(MaintenanceSchedulerTest, IncrementalVacuumReturnsFreePages) {
+    db->execute("CREATE TABLE ballast (data BLOB)");
+    for (int i = 0; i < 64; ++i) {
+        db->execute("INSERT INTO ballast VALUES (zeroblob(16384))");
+    }
+    db->execute("DELETE FROM ballast");
+    int64_t freePages = db->queryScalar("PRAGMA freelist_count");
+    ASSERT_GT(freePages, 64);
+
+    MaintenanceOptions options;
+    options.vacuumPages = 16;
+    MaintenanceScheduler scheduler(db, options);
+    auto steps = runPass(scheduler);
+
+    // Остаток уменьшается от порции к порции
+    int64_t previous = freePages;
+    for (const auto& p : steps) {
+        if (p.step != MaintenanceStep::IncrementalVacuum) continue;
+        EXPECT_LT(p.remaining, previous);
+        previous = p.remaining;
+    }
+    EXPECT_GE(slicesOf(steps, MaintenanceStep::IncrementalVacuum), freePages / 16);
+    EXPECT_EQ(db->queryScalar("PRAGMA freelist_count"), 0);
+}
+
+TEST_F(MaintenanceSchedulerTest, MergeFailureDoesNotSkipRemainingTables) {
+    insertFiles(200);
+    db->execute("DROP TABLE cloud_files_fts");
+
+    MaintenanceOptions options;
+    options.mergePages = 1;
+    MaintenanceScheduler scheduler(db, options);
+
+    // Ошибка средней таблицы не мешает слить files_trigram в том же проходе:
+    // повторный проход — по одной порции на таблицу
+    runPass(scheduler);
+    auto second = runPass(scheduler);
+    EXPECT_EQ(slicesOf(second, MaintenanceStep::FtsMerge), 3);
+}
+
+TEST_F(MaintenanceSchedulerTest, LegacyDatabaseIsNotVacuumed) {
+    std::string legacyPath = "test_maintenance_legacy_" + std::to_string(std::rand()) + ".db";
+    {
+        // Файл БД до миграции 6: auto_vacuum = NONE
+        Database legacy(legacyPath);
+        legacy.execute("CREATE TABLE legacy (x)");
+        legacy.execute("PRAGMA auto_vacuum = NONE");
+        legacy.execute("VACUUM");
+    }
+
+    {
+        auto legacy = std::make_shared<Database>(legacyPath);
+        legacy->initialize();
+        EXPECT_EQ(legacy->queryScalar("PRAGMA auto_vacuum"), 0);
+
+        IndexManager manager(legacy);
+        manager.optimizeDatabase();
+        EXPECT_EQ(legacy->queryScalar("PRAGMA auto_vacuum"), 0);
+    }
+
+    fs::remove(legacyPath);
+    fs::remove(legacyPath + "-wal");
+    fs::remove(legacyPath + "-shm");
+}
+
+TEST_F(MaintenanceSchedulerTest, BackgroundPassWaitsForIdle) {
+    MaintenanceOptions options;
+    options.idleDelay = std::chrono::milliseconds(200);
+    options.slicePause = std::chrono::milliseconds(1);
+    MaintenanceScheduler scheduler(db, options);
+
+    std::atomic<bool> completed{false};
+    auto startedAt = std::chrono::steady_clock::now();
+    scheduler.setProgressCallback([&completed](const MaintenanceProgress& p) {
+        if (p.passComplete) completed = true;
+    });
+    scheduler.noteActivity();
+    scheduler.requestPass();
+    scheduler.start();
+    EXPECT_TRUE(scheduler.isRunning());
+
+    for (int i = 0; i < 200 && !completed; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    EXPECT_TRUE(completed);
+    EXPECT_GE(std::chrono::steady_clock::now() - startedAt, options.idleDelay);
+
+    scheduler.stop();
+    EXPECT_FALSE(scheduler.isRunning());
+}
+
+TEST_F(MaintenanceSchedulerTest, SearchDefersBackgroundPass) {
+    MaintenanceOptions options;
+    options.idleDelay = std::chrono::milliseconds(300);
+    options.slicePause = std::chrono::milliseconds(1);
+    auto scheduler = std::make_shared<MaintenanceScheduler>(db, options);
+
+    SearchEngine engine(db);
+    engine.setMaintenanceScheduler(scheduler);
+
+    std::atomic<int> slices{0};
+    std::atomic<bool> completed{false};
+    scheduler->setProgressCallback([&](const MaintenanceProgress& p) {
+        ++slices;
+        if (p.passComplete) completed = true;
+    });
+    scheduler->requestPass();
+    scheduler->start();
+
+    // Пока пользователь ищет чаще idleDelay, фоновые порции не идут
+    SearchQuery query;
+    query.text = "report";
+    for (int i = 0; i < 20; ++i) {
+        engine.countResults(query);
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+    EXPECT_EQ(slices.load(), 0);
+
+    for (int i = 0; i < 200 && !completed; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    EXPECT_TRUE(completed);
+    scheduler->stop();
+}
+
+TEST_F(MaintenanceSchedulerTest, SlicePauseDoesNotHoldSliceLock) {
+    insertFiles(50);
+
+    MaintenanceOptions options;
+    options.idleDelay = std::chrono::milliseconds(0);
+    options.slicePause = std::chrono::milliseconds(3000);
+    options.mergePages = 1;
+    MaintenanceScheduler scheduler(db, options);
+
+    std::atomic<bool> firstSlice{false};
+    scheduler.setProgressCallback([&firstSlice](const MaintenanceProgress&) { firstSlice = true; });
+    scheduler.requestPass();
+    scheduler.start();
+    for (int i = 0; i < 200 && !firstSlice; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    ASSERT_TRUE(firstSlice);
+
+    // Фоновый поток в паузе между порциями — синхронная порция не ждёт её конца
+    auto startedAt = std::chrono::steady_clock::now();
+    scheduler.runSlice();
+    EXPECT_LT(std::chrono::steady_clock::now() - startedAt, std::chrono::milliseconds(1000));
+    scheduler.stop();
+}
+
+TEST_F(MaintenanceSchedulerTest, CApiRunsPassWithProgress) {
+    FVError err = FV_OK;
+    FVDatabase handle = fv_database_open(testDbPath.c_str(), &err);
+    ASSERT_NE(handle, nullptr);
+    ASSERT_EQ(fv_database_initialize(handle), FV_OK);
+
+    struct Seen {
+        int slices = 0;
+        bool complete = false;
+    } seen;
+    auto callback = [](int32_t, int64_t, int64_t, int32_t passComplete, void* userData) {
+        auto* s = static_cast<Seen*>(userData);
+        ++s->slices;
+        s->complete = s->complete || passComplete != 0;
+    };
+
+    EXPECT_EQ(fv_database_run_maintenance(handle, callback, &seen), FV_OK);
+    EXPECT_GT(seen.slices, 0);
+    EXPECT_TRUE(seen.complete);
+    EXPECT_EQ(fv_database_run_maintenance(handle, nullptr, nullptr), FV_OK);
+    EXPECT_EQ(fv_database_run_maintenance(nullptr, nullptr, nullptr), FV_ERROR_INVALID_ARGUMENT);
+
+    fv_database_close(handle);
+}
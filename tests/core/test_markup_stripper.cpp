@@ -0,0 +1,129 @@
+// test_markup_stripper.cpp — тесты потоковой нормализации и удаления разметки
+
+#include <gtest/gtest.h>
+#include "familyvault/MarkupStripper.h"
+#include <random>
+
+using namespace FamilyVault;
+
+namespace {
+
+const SimdLevel kAllLevels[] = {SimdLevel::Scalar, SimdLevel::Sse2, SimdLevel::Avx2};
+
+/// Подать текст фрагментами заданной длины
+std::string sinkInChunks(std::string_view text, size_t chunk, SimdLevel level,
+                         size_t maxBytes = 1 << 20) {
+    NormalizingSink sink(maxBytes, level);
+    for (size_t i = 0; i < text.size(); i += chunk) {
+        sink.append(text.substr(i, chunk));
+    }
+    return sink.finish();
+}
+
+std::string strip(std::string_view markup, MarkupStripper::Mode mode, size_t chunk = 1 << 20) {
+    NormalizingSink sink(1 << 20);
+    MarkupStripper stripper(mode, sink);
+    for (size_t i = 0; i < markup.size(); i += chunk) {
+        stripper.feed(markup.substr(i, chunk));
+    }
+    stripper.finish();
+    return sink.finish();
+}
+
+std::string stripHtml(std::string_view html, size_t chunk = 1 << 20) {
+    return strip(html, MarkupStripper::Mode::Html, chunk);
+}
+
+} // namespace
+
+TEST(NormalizingSinkTest, MatchesNormalizeForAnyChunking) {
+    std::mt19937 rng(11);
+    static const char* pieces[] = {"word", " ", "\t\n", "Привет", "мир", "€", "😀", "\xFF", "\xE0\x80",
+                                   "\xD0", "  "};
+    std::string text;
+    while (text.size() < 3000) text += pieces[rng() % std::size(pieces)];
+    text += "\xF0\x9F";  // Обрезанный символ в конце
+
+    for (auto level : kAllLevels) {
+        std::string expected = TextNormalizer::normalize(text, level);
+        for (size_t chunk : {1, 2, 3, 5, 16, 31, 64, 1000, 5000}) {
+            EXPECT_EQ(sinkInChunks(text, chunk, level), expected)
+                << "chunk=" << chunk << " level=" << static_cast<int>(level);
+        }
+    }
+}
+
+TEST(NormalizingSinkTest, StopsAtLimitOnCharacterBoundary) {
+    std::string text;
+    for (int i = 0; i < 1000; ++i) text += "слово ";
+
+    std::string result = sinkInChunks(text, 100, SimdLevel::Avx2, 101);
+    EXPECT_LE(result.size(), 101u);
+    EXPECT_GT(result.size(), 90u);
+    EXPECT_TRUE(TextNormalizer::isValidUtf8(result));
+    EXPECT_NE(result.back(), ' ');
+    EXPECT_EQ(text.substr(0, result.size()), result);
+
+    NormalizingSink sink(10);
+    sink.append("0123456789abcdef");
+    EXPECT_TRUE(sink.full());
+    EXPECT_EQ(sink.finish(), "0123456789");
+}
+
+TEST(NormalizingSinkTest, SeparatorActsAsSpace) {
+    NormalizingSink sink(100);
+    sink.separator();
+    sink.append("one");
+    sink.separator();
+    sink.separator();
+    sink.append("two");
+    sink.separator();
+    EXPECT_EQ(sink.finish(), "one two");
+}
+
+TEST(MarkupStripperTest, StripsHtmlTagsScriptsAndComments) {
+    std::string html =
+        "<!DOCTYPE html><html><head><title>Семейный архив</title>"
+        "<style>body { color: red; }</style>"
+        "<script type=\"text/javascript\">if (a < b && c > d) alert('</p>');</script>"
+        "</head><body><!-- <p>скрыто</p> -->"
+        "<p>Hello&nbsp;HTML <b>World</b></p><br/>Tom &amp; Jerry &lt;3 &#1071; &#x44F;"
+        "<SCRIPT>hidden()</SCRIPT >visible</body></html>";
+    std::string expected = "Семейный архив Hello HTML World Tom & Jerry <3 Я я visible";
+
+    EXPECT_EQ(stripHtml(html), expected);
+    for (size_t chunk : {1, 2, 3, 7, 13}) {
+        EXPECT_EQ(stripHtml(html, chunk), expected) << "chunk=" << chunk;
+    }
+}
+
+TEST(MarkupStripperTest, KeepsTextThatOnlyLooksLikeMarkup) {
+    EXPECT_EQ(stripHtml("AT&T & co &unknown; &#xZZ; end"), "AT&T & co end");
+    EXPECT_EQ(stripHtml("tail &amp"), "tail &amp");
+    EXPECT_EQ(stripHtml("<p>unclosed <b"), "unclosed");
+}
+
+TEST(MarkupStripperTest, XmlKeepsCdataAndDecodesEntities) {
+    std::string xml =
+        "<?xml version=\"1.0\"?><doc><title>XML Test Document</title>"
+        "<data><![CDATA[a < b ]] c ]]]></data>"
+        "<script>kept in xml</script><note a=\"1\">R&amp;D</note></doc>";
+    std::string expected = "XML Test Document a < b ]] c ] kept in xml R&D";
+
+    for (size_t chunk : {1, 2, 4, 1000}) {
+        EXPECT_EQ(strip(xml, MarkupStripper::Mode::Xml, chunk), expected) << "chunk=" << chunk;
+    }
+}
+
+TEST(MarkupStripperTest, StopsFeedingWhenSinkIsFull) {
+    std::string html;
+    for (int i = 0; i < 10000; ++i) html += "<p>paragraph text</p>";
+
+    NormalizingSink sink(1000);
+    MarkupStripper stripper(MarkupStripper::Mode::Html, sink);
+    stripper.feed(html);
+    stripper.finish();
+    std::string text = sink.finish();
+    EXPECT_LE(text.size(), 1000u);
+    EXPECT_EQ(text.rfind("paragraph text paragraph text", 0), 0u);
+}
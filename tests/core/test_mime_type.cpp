@@ -81,3 +81,31 @@ TEST(MimeTypeDetectorTest, MimeToContentType) {
     EXPECT_EQ(MimeTypeDetector::mimeToContentType("application/octet-stream"), ContentType::Other);
 }
 
+
+TEST(MimeTypeDetectorTest, DetectByExtension_LongOrNonAscii) {
+    EXPECT_EQ(MimeTypeDetector::detectByExtension("jpegjpegjpeg"), "application/octet-stream");
+    EXPECT_EQ(MimeTypeDetector::detectByExtension("jp"), "application/octet-stream");
+    EXPECT_EQ(MimeTypeDetector::detectByExtension("\xD1\x82\xD1\x85\xD1\x82"), "application/octet-stream");
+    EXPECT_EQ(MimeTypeDetector::detectByExtension("SwIfT"), "text/x-swift");
+}
+
+TEST(MimeTypeDetectorTest, DetectByHeader) {
+    auto detect = [](std::string_view bytes) {
+        return MimeTypeDetector::detectByHeader(
+            reinterpret_cast<const uint8_t*>(bytes.data()), bytes.size());
+    };
+    EXPECT_EQ(detect("\xFF\xD8\xFF\xE0"), "image/jpeg");
+    EXPECT_EQ(detect("\xFF\xFB\x90"), "audio/mpeg");
+    EXPECT_EQ(detect("\x89PNG\r\n\x1A\n"), "image/png");
+    EXPECT_EQ(detect("%PDF-1.7"), "application/pdf");
+    EXPECT_EQ(detect(std::string_view("PK\x03\x04\x14\x00", 6)), "application/zip");
+    EXPECT_EQ(detect(std::string_view("RIFF\x24\x00\x00\x00WEBPVP8 ", 16)), "image/webp");
+    EXPECT_EQ(detect(std::string_view("RIFF\x24\x00\x00\x00" "AVI LIST", 16)), "video/x-msvideo");
+    EXPECT_EQ(detect(std::string_view("\x00\x00\x00\x18" "ftypmp42", 12)), "video/mp4");
+    EXPECT_EQ(detect("MZ\x90"), "application/x-msdownload");
+
+    // Обрезанные и незнакомые заголовки
+    EXPECT_EQ(detect("\x89PN"), "application/octet-stream");
+    EXPECT_EQ(detect("B"), "application/octet-stream");
+    EXPECT_EQ(detect("plain text"), "application/octet-stream");
+}
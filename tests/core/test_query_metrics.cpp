@@ -0,0 +1,226 @@
+// test_query_metrics.cpp — тесты метрик запросов и журнала медленных запросов
+
+#include <gtest/gtest.h>
+#include "familyvault/Database.h"
+#include "familyvault/IndexManager.h"
+#include "familyvault/QueryMetrics.h"
+#include "familyvault/familyvault_c.h"
+#include <nlohmann/json.hpp>
+#include <chrono>
+#include <filesystem>
+#include <thread>
+
+namespace fs = std::filesystem;
+using namespace FamilyVault;
+using json = nlohmann::json;
+
+class QueryMetricsTest : public ::testing::Test {
+protected:
+    std::string testDbPath;
+    std::shared_ptr<Database> db;
+
+    void SetUp() override {
+        testDbPath = "test_query_metrics_" + std::to_string(std::rand()) + ".db";
+        db = std::make_shared<Database>(testDbPath);
+        db->initialize();
+        db->execute("CREATE TABLE notes (id INTEGER PRIMARY KEY, title TEXT, body TEXT)");
+        db->queryMetrics().reset();
+    }
+
+    void TearDown() override {
+        db.reset();
+        fs::remove(testDbPath);
+        fs::remove(testDbPath + "-wal");
+        fs::remove(testDbPath + "-shm");
+    }
+
+    const StatementMetrics* find(const QueryMetricsSnapshot& snapshot, const std::string& sql) {
+        for (const auto& s : snapshot.byStatement) {
+            if (s.sql == sql) return &s;
+        }
+        return nullptr;
+    }
+};
+
+TEST_F(QueryMetricsTest, NormalizeSqlReplacesLiteralsAndLists) {
+    EXPECT_EQ(QueryMetrics::normalizeSql("SELECT  *\n  FROM files\tWHERE id = 42 AND name = 'it''s';"),
+              "SELECT * FROM files WHERE id = ? AND name = ?");
+    EXPECT_EQ(QueryMetrics::normalizeSql("SELECT id FROM files WHERE id IN (?, ?,?, ?) LIMIT 10"),
+              "SELECT id FROM files WHERE id IN (?, ...) LIMIT ?");
+    EXPECT_EQ(QueryMetrics::normalizeSql("SELECT f2.x1 FROM \"t 1\" f2 -- comment\n WHERE y = 1.5e3"),
+              "SELECT f2.x1 FROM \"t 1\" f2 WHERE y = ?");
+    EXPECT_EQ(QueryMetrics::normalizeSql("INSERT INTO t VALUES (?) /* note */"),
+              "INSERT INTO t VALUES (?)");
+}
+
+TEST_F(QueryMetricsTest, GroupsExecutionsByNormalizedSql) {
+    for (int i = 0; i < 5; ++i) {
+        db->execute("INSERT INTO notes (title, body) VALUES (?, ?)", "t" + std::to_string(i), "body");
+    }
+    // Литералы в динамическом SQL не плодят отдельные записи
+    db->queryScalar("SELECT COUNT(*) FROM notes WHERE id > 1");
+    db->queryScalar("SELECT COUNT(*) FROM notes WHERE id > 3");
+
+    auto snapshot = db->queryMetrics().snapshot();
+    auto* insert = find(snapshot, "INSERT INTO notes (title, body) VALUES (?, ...)");
+    ASSERT_NE(insert, nullptr);
+    EXPECT_EQ(insert->count, 5);
+    EXPECT_EQ(insert->errors, 0);
+
+    auto* count = find(snapshot, "SELECT COUNT(*) FROM notes WHERE id > ?");
+    ASSERT_NE(count, nullptr);
+    EXPECT_EQ(count->count, 2);
+    EXPECT_EQ(count->rows, 2);
+    EXPECT_EQ(snapshot.statements, 7);
+
+    int64_t inHistogram = 0;
+    for (auto n : insert->histogram) inHistogram += n;
+    EXPECT_EQ(inHistogram, insert->count);
+    EXPECT_GE(insert->maxUs, insert->totalUs / insert->count);
+    EXPECT_LE(insert->percentileUs(0.5), insert->percentileUs(0.95));
+}
+
+TEST_F(QueryMetricsTest, CountsRowsFullScansAndErrors) {
+    for (int i = 0; i < 20; ++i) {
+        db->execute("INSERT INTO notes (title, body) VALUES (?, 'x')", "note" + std::to_string(i));
+    }
+    auto titles = db->query<std::string>("SELECT title FROM notes WHERE body = ? ORDER BY title",
+                                         [](sqlite3_stmt* stmt) { return Database::getString(stmt, 0); },
+                                         "x");
+    ASSERT_EQ(titles.size(), 20u);
+    EXPECT_THROW(db->execute("INSERT INTO notes (id, title) VALUES (?, 'dup')", 1), DatabaseException);
+
+    auto snapshot = db->queryMetrics().snapshot();
+    auto* select = find(snapshot, "SELECT title FROM notes WHERE body = ? ORDER BY title");
+    ASSERT_NE(select, nullptr);
+    EXPECT_EQ(select->rows, 20);
+    EXPECT_GE(select->counters.fullScanSteps, 19);
+    EXPECT_EQ(select->counters.sorts, 1);
+
+    auto* failed = find(snapshot, "INSERT INTO notes (id, title) VALUES (?, ...)");
+    ASSERT_NE(failed, nullptr);
+    EXPECT_EQ(failed->errors, 1);
+}
+
+TEST_F(QueryMetricsTest, TypedQueriesReportStatementCacheHits) {
+    IndexManager manager(db);
+    manager.getFolders();
+    manager.getFolders();
+    manager.getFolders();
+
+    auto snapshot = db->queryMetrics().snapshot();
+    EXPECT_GE(snapshot.cacheMisses, 1);
+    EXPECT_GE(snapshot.cacheHits, 2);
+}
+
+TEST_F(QueryMetricsTest, SlowQueriesAreLoggedWithoutParameters) {
+    auto options = db->queryMetrics().options();
+    options.slowQueryThreshold = std::chrono::milliseconds(1);
+    options.slowLogCapacity = 2;
+    db->queryMetrics().setOptions(options);
+
+    for (int i = 0; i < 3; ++i) {
+        db->queryScalar("WITH RECURSIVE c(x) AS (SELECT 1 UNION ALL SELECT x + 1 FROM c WHERE x < ?) "
+                        "SELECT COUNT(*) FROM c", 300000);
+    }
+
+    auto snapshot = db->queryMetrics().snapshot();
+    EXPECT_GE(snapshot.slowQueries, 3);
+    ASSERT_EQ(snapshot.slowLog.size(), 2u);
+    EXPECT_NE(snapshot.slowLog.back().sql.find("WHERE x < ?"), std::string::npos);
+    EXPECT_GE(snapshot.slowLog.back().elapsedUs, 1000);
+    EXPECT_EQ(snapshot.slowLog.back().rows, 1);
+    EXPECT_GT(snapshot.slowLog.back().at, 0);
+}
+
+TEST_F(QueryMetricsTest, ConcurrentRecordsPastRawSqlLimit) {
+    QueryMetricsOptions options;
+    options.maxStatements = 4;
+    QueryMetrics metrics(options);
+
+    // 4 потока × 200 разных текстов: карта исходных SQL упирается в лимит,
+    // нормализация идёт без блокировки, счётчики не теряются
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&metrics, t] {
+            for (int i = 0; i < 200; ++i) {
+                std::string sql = "SELECT * FROM files WHERE id = " + std::to_string(t * 1000 + i);
+                metrics.record(sql, 10, 1, {}, false);
+                metrics.record("SELECT COUNT(*) FROM files", 10, 1, {}, false);
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+
+    auto snapshot = metrics.snapshot();
+    EXPECT_EQ(snapshot.statements, 1600);
+    ASSERT_EQ(snapshot.byStatement.size(), 2u);
+    for (const auto& entry : snapshot.byStatement) {
+        EXPECT_EQ(entry.count, 800) << entry.sql;
+    }
+}
+
+TEST_F(QueryMetricsTest, LockWaitIsMeasured) {
+    Database other(testDbPath);
+    other.execute("BEGIN IMMEDIATE");
+    other.execute("INSERT INTO notes (title) VALUES ('locked')");
+
+    std::thread committer([&other] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(80));
+        other.execute("COMMIT");
+    });
+    db->execute("INSERT INTO notes (title) VALUES ('waiting')");
+    committer.join();
+
+    auto snapshot = db->queryMetrics().snapshot();
+    EXPECT_EQ(snapshot.lockWaits, 1);
+    EXPECT_GE(snapshot.lockWaitUs, 40000);
+    EXPECT_EQ(snapshot.maxLockWaitUs, snapshot.lockWaitUs);
+}
+
+TEST_F(QueryMetricsTest, DisabledMetricsRecordNothing) {
+    auto options = db->queryMetrics().options();
+    options.enabled = false;
+    db->queryMetrics().setOptions(options);
+
+    db->execute("INSERT INTO notes (title) VALUES (?)", "quiet");
+    db->queryScalar("SELECT COUNT(*) FROM notes");
+    EXPECT_EQ(db->queryMetrics().snapshot().statements, 0);
+
+    options.enabled = true;
+    db->queryMetrics().setOptions(options);
+    db->queryScalar("SELECT COUNT(*) FROM notes");
+    EXPECT_EQ(db->queryMetrics().snapshot().statements, 1);
+}
+
+TEST_F(QueryMetricsTest, CApiReturnsSnapshotAndResets) {
+    FVError err = FV_OK;
+    FVDatabase handle = fv_database_open(testDbPath.c_str(), &err);
+    ASSERT_NE(handle, nullptr);
+    ASSERT_EQ(fv_database_initialize(handle), FV_OK);
+    EXPECT_EQ(fv_database_set_slow_query_threshold(handle, 0), FV_OK);
+
+    char* str = fv_database_query_metrics(handle, 1);
+    ASSERT_NE(str, nullptr);
+    auto j = json::parse(str);
+    fv_free_string(str);
+
+    EXPECT_GT(j["statements"].get<int64_t>(), 0);
+    EXPECT_EQ(j["histogramBoundsUs"].size(), kLatencyBucketsUs.size());
+    ASSERT_FALSE(j["byStatement"].empty());
+    const auto& first = j["byStatement"][0];
+    for (const char* key : {"sql", "count", "errors", "rows", "totalUs", "maxUs", "p50Us", "p95Us",
+                            "histogram", "fullScanSteps", "sorts", "autoIndexes"}) {
+        EXPECT_TRUE(first.contains(key)) << key;
+    }
+    EXPECT_TRUE(j["slowLog"].empty());
+
+    str = fv_database_query_metrics(handle, 0);
+    ASSERT_NE(str, nullptr);
+    EXPECT_EQ(json::parse(str)["statements"].get<int64_t>(), 0);
+    fv_free_string(str);
+
+    EXPECT_EQ(fv_database_query_metrics(nullptr, 0), nullptr);
+    EXPECT_EQ(fv_database_set_slow_query_threshold(nullptr, 10), FV_ERROR_INVALID_ARGUMENT);
+    fv_database_close(handle);
+}
@@ -0,0 +1,145 @@
+// test_query_plans.cpp — регрессия планов горячих запросов
+// EXPLAIN QUERY PLAN должен использовать составные индексы миграции 4:
+// изменение схемы или запроса не должно тихо вернуть полный скан или сортировку.
+// Проверяются те же строки, что выполняет код (HotQueries.h)
+
+#include <gtest/gtest.h>
+#include "familyvault/Database.h"
+#include "familyvault/HotQueries.h"
+#include <filesystem>
+#include <string>
+
+namespace fs = std::filesystem;
+using namespace FamilyVault;
+
+class QueryPlanTest : public ::testing::Test {
+protected:
+    std::string testDbPath;
+    std::unique_ptr<Database> db;
+
+    void SetUp() override {
+        testDbPath = "test_query_plans_" + std::to_string(std::rand()) + ".db";
+        db = std::make_unique<Database>(testDbPath);
+        db->initialize();
+    }
+
+    void TearDown() override {
+        db.reset();
+        fs::remove(testDbPath);
+        fs::remove(testDbPath + "-wal");
+        fs::remove(testDbPath + "-shm");
+    }
+
+    /// Все строки плана одной строкой (detail через '\n')
+    std::string plan(const std::string& sql) {
+        auto rows = db->query<std::string>(
+            "EXPLAIN QUERY PLAN " + sql,
+            [](sqlite3_stmt* stmt) { return Database::getString(stmt, 3); });
+        std::string result;
+        for (const auto& row : rows) {
+            result += row;
+            result += '\n';
+        }
+        return result;
+    }
+
+    static bool contains(const std::string& text, const std::string& part) {
+        return text.find(part) != std::string::npos;
+    }
+};
+
+TEST_F(QueryPlanTest, FilesByFolderUsesFolderNameIndex) {
+    for (const std::string& sql : {std::string(queries::FilesByFolder::sql()),
+                                  std::string(queries::FILES_BY_FOLDER_COMPACT_SQL)}) {
+        auto p = plan(sql);
+        EXPECT_TRUE(contains(p, "idx_files_folder_name (folder_id=?)")) << p;
+        EXPECT_FALSE(contains(p, "TEMP B-TREE")) << p;
+    }
+}
+
+TEST_F(QueryPlanTest, FilesByDirectoryIsRangeLookup) {
+    for (const std::string& sql : {std::string(queries::FilesByDirectory::sql()),
+                                  std::string(queries::FILES_BY_DIRECTORY_COMPACT_SQL)}) {
+        auto p = plan(sql);
+        EXPECT_TRUE(contains(p, "idx_files_directory (folder_id=? AND directory_id=?)")) << p;
+        EXPECT_FALSE(contains(p, "TEMP B-TREE")) << p;
+    }
+}
+
+TEST_F(QueryPlanTest, DuplicateGroupsReadOnlyCoveringIndex) {
+    auto p = plan(queries::LOCAL_DUPLICATE_GROUPS_SQL);
+
+    EXPECT_TRUE(contains(p, "COVERING INDEX idx_files_local_checksum")) << p;
+    EXPECT_FALSE(contains(p, "TEMP B-TREE FOR GROUP BY")) << p;
+}
+
+TEST_F(QueryPlanTest, DuplicateCopiesSeekChecksumAndSource) {
+    auto local = plan(queries::LOCAL_DUPLICATE_COPIES_SQL);
+    EXPECT_TRUE(contains(local, "idx_files_checksum_source (checksum=? AND source_device_id=?)"))
+        << local;
+
+    auto remote = plan(queries::REMOTE_DUPLICATE_COPIES_SQL);
+    EXPECT_TRUE(contains(remote, "idx_files_checksum_source (checksum=? AND source_device_id>?)"))
+        << remote;
+}
+
+TEST_F(QueryPlanTest, SyncChangesRangeScanIndexedAt) {
+    for (const char* sql : {queries::LOCAL_CHANGES_PAGE_SQL, queries::LOCAL_CHANGES_SQL}) {
+        auto p = plan(sql);
+        EXPECT_TRUE(contains(p, "idx_files_sync (is_remote=? AND indexed_at>?)")) << p;
+        EXPECT_FALSE(contains(p, "TEMP B-TREE")) << p;
+    }
+}
+
+TEST_F(QueryPlanTest, SyncCountIsCovered) {
+    auto p = plan(queries::LOCAL_CHANGES_COUNT_SQL);
+
+    EXPECT_TRUE(contains(p, "COVERING INDEX idx_files_sync (is_remote=? AND indexed_at>?)")) << p;
+}
+
+TEST_F(QueryPlanTest, RecentFilesUsesIndexedAt) {
+    for (const std::string& sql : {std::string(queries::RecentFiles::sql()),
+                                  std::string(queries::RECENT_FILES_COMPACT_SQL)}) {
+        auto p = plan(sql);
+        EXPECT_TRUE(contains(p, "idx_files_indexed")) << p;
+        EXPECT_FALSE(contains(p, "TEMP B-TREE")) << p;
+    }
+}
+
+TEST_F(QueryPlanTest, PendingExtractionReadsPartialIndex) {
+    auto batch = plan(queries::PENDING_EXTRACTION_SQL);
+    EXPECT_TRUE(contains(batch, "idx_files_extraction_pending")) << batch;
+    EXPECT_FALSE(contains(batch, "TEMP B-TREE")) << batch;
+
+    auto count = plan(queries::PENDING_EXTRACTION_COUNT_SQL);
+    EXPECT_TRUE(contains(count, "idx_files_extraction_pending")) << count;
+}
+
+TEST_F(QueryPlanTest, TextOfCopyFoundByChecksum) {
+    for (const char* sql : {queries::EXTRACTED_COPY_SQL, queries::SHARED_TEXT_SQL}) {
+        auto p = plan(sql);
+        EXPECT_TRUE(contains(p, "idx_files_checksum_source (checksum=? AND source_device_id=?)")) << p;
+        EXPECT_TRUE(contains(p, "SCAN fts VIRTUAL TABLE INDEX 0:=")) << p;  // По rowid
+        EXPECT_FALSE(contains(p, "SCAN f\n")) << p;
+    }
+}
+
+TEST_F(QueryPlanTest, ExtractableFilesFoundByMimeId) {
+    auto p = plan(queries::EXTRACTABLE_FILES_SQL);
+    EXPECT_TRUE(contains(p, "idx_files_mime (mime_id=?)")) << p;
+    EXPECT_FALSE(contains(p, "SCAN files")) << p;
+}
+
+TEST_F(QueryPlanTest, RedundantSingleColumnIndexesDropped) {
+    auto count = [&](const std::string& name) {
+        return db->queryScalar(
+            "SELECT COUNT(*) FROM sqlite_master WHERE type = 'index' AND name = ?", name);
+    };
+    EXPECT_EQ(count("idx_files_folder"), 0);
+    EXPECT_EQ(count("idx_files_checksum"), 0);
+    EXPECT_EQ(count("idx_files_source"), 0);
+    EXPECT_EQ(count("idx_files_folder_name"), 1);
+    EXPECT_EQ(count("idx_files_checksum_source"), 1);
+    EXPECT_EQ(count("idx_files_local_checksum"), 1);
+    EXPECT_EQ(count("idx_files_sync"), 1);
+}
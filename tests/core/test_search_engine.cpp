@@ -4,6 +4,9 @@
 #include "familyvault/Database.h"
 #include "familyvault/IndexManager.h"
 #include "familyvault/SearchEngine.h"
+#include "familyvault/SuggestIndex.h"
+#include <chrono>
+#include <cstdio>
 #include <filesystem>
 #include <fstream>
 
@@ -169,3 +172,223 @@ TEST_F(SearchEngineTest, SearchWithSizeFilter) {
     }
 }
 
+
+TEST_F(SearchEngineTest, SubstringMatchInsideFileName) {
+    createTestFile(testFolderPath + "/IMG_20230514.jpg", "\xFF\xD8\xFF");
+    auto folders = indexManager->getFolders();
+    ASSERT_FALSE(folders.empty());
+    indexManager->scanFolder(folders[0].id);
+
+    SearchQuery query;
+    query.text = "0514";
+
+    // Префиксный поиск по токенам не видит середину "20230514"
+    query.matchMode = TextMatchMode::Prefix;
+    EXPECT_EQ(searchEngine->countResults(query), 0);
+
+    query.matchMode = TextMatchMode::Auto;
+    auto results = searchEngine->search(query);
+    ASSERT_EQ(results.size(), 1u);
+    EXPECT_EQ(results[0].file.name, "IMG_20230514.jpg");
+    EXPECT_EQ(searchEngine->countResults(query), 1);
+}
+
+TEST_F(SearchEngineTest, SubstringMatchDoesNotDuplicatePrefixHits) {
+    SearchQuery query;
+    query.text = "photo";
+    query.matchMode = TextMatchMode::Substring;
+
+    auto results = searchEngine->search(query);
+    EXPECT_EQ(results.size(), 2u);  // vacation_photo.jpg, family_photo.png
+    EXPECT_EQ(searchEngine->countResults(query), 2);
+
+    // Фильтры применяются и к подстрочной ветке
+    query.text = "acation";
+    query.extension = "png";
+    EXPECT_EQ(searchEngine->countResults(query), 0);
+    query.extension = "jpg";
+    EXPECT_EQ(searchEngine->countResults(query), 1);
+}
+
+TEST_F(SearchEngineTest, SubstringHitsRankByPlaceNotRawBm25) {
+    createTestFile(testFolderPath + "/telephoto_lens.jpg", "\xFF\xD8\xFF");
+    auto folders = indexManager->getFolders();
+    ASSERT_FALSE(folders.empty());
+    indexManager->scanFolder(folders[0].id);
+
+    SearchQuery query;
+    query.text = "photo";
+    query.matchMode = TextMatchMode::Substring;
+
+    // Лучшая подстрочная находка стоит вровень с лучшей по токенам,
+    // а не там, куда её поставил bm25 другого индекса
+    auto results = searchEngine->search(query);
+    ASSERT_EQ(results.size(), 3u);
+    auto it = std::find_if(results.begin(), results.end(),
+        [](const SearchResult& r) { return r.file.name == "telephoto_lens.jpg"; });
+    ASSERT_NE(it, results.end());
+    EXPECT_LT(it - results.begin(), 2);
+    EXPECT_DOUBLE_EQ(it->score, -1.0 / 61);
+    EXPECT_DOUBLE_EQ(results[0].score, -1.0 / 61);
+    EXPECT_DOUBLE_EQ(results[2].score, -1.0 / 62);
+}
+
+TEST_F(SearchEngineTest, ShortQueriesStayOnPrefixIndex) {
+    SearchQuery query;
+    query.text = "24";   // Короче триграммы: только префиксы токенов ("2024")
+    query.matchMode = TextMatchMode::Substring;
+
+    EXPECT_EQ(searchEngine->countResults(query), 0);
+
+    query.text = "20";
+    EXPECT_EQ(searchEngine->countResults(query), 2);  // report_2024, budget_2024
+}
+
+TEST_F(SearchEngineTest, PathMatchesThroughDirectoryNames) {
+    fs::create_directories(testFolderPath + "/Trips/Крым 2019/day1");
+    createTestFile(testFolderPath + "/Trips/Крым 2019/sea.jpg", "\xFF\xD8\xFF");
+    createTestFile(testFolderPath + "/Trips/Крым 2019/day1/beach.jpg", "\xFF\xD8\xFF");
+    createTestFile(testFolderPath + "/Trips/crimea_map.png", "\x89PNG");
+    auto folders = indexManager->getFolders();
+    ASSERT_FALSE(folders.empty());
+    indexManager->scanFolder(folders[0].id);
+
+    // files_fts хранит только имя и содержимое: путь в нём не дублируется
+    EXPECT_EQ(db->queryScalar(
+        "SELECT COUNT(*) FROM pragma_table_info('files_fts') WHERE name = 'relative_path'"), 0);
+
+    // Каталог находится по токену имени, с файлами подкаталогов
+    SearchQuery query;
+    query.text = "кры";
+    query.matchMode = TextMatchMode::Prefix;
+    EXPECT_EQ(searchEngine->countResults(query), 2);  // sea.jpg, day1/beach.jpg
+
+    query.text = "trips";
+    EXPECT_EQ(searchEngine->countResults(query), 3);
+    auto results = searchEngine->search(query);
+    ASSERT_EQ(results.size(), 3u);
+    EXPECT_EQ(results[0].file.relativePath.rfind("Trips/", 0), 0u);
+
+    // Совпадение и по имени, и по каталогу — одна строка
+    query.text = "beach";
+    query.matchMode = TextMatchMode::Auto;
+    EXPECT_EQ(searchEngine->countResults(query), 1);
+
+    // Фильтры применяются и к ветке каталогов
+    query.text = "trips";
+    query.extension = "png";
+    EXPECT_EQ(searchEngine->countResults(query), 1);
+}
+
+// ═══════════════════════════════════════════════════════════
+// SuggestIndex
+// ═══════════════════════════════════════════════════════════
+
+TEST(SuggestIndexTokenizeTest, SplitsStemAndLowercases) {
+    auto terms = SuggestIndex::tokenize("Vacation_Photo-2024 (copy).JPG");
+    std::vector<std::string> expected = {"2024", "copy", "photo", "vacation"};
+    EXPECT_EQ(terms, expected);
+
+    // Кириллица приводится к нижнему регистру, однобуквенные слова отбрасываются
+    terms = SuggestIndex::tokenize("Отпуск в Ялте.png");
+    expected = {"отпуск", "ялте"};
+    EXPECT_EQ(terms, expected);
+}
+
+TEST_F(SearchEngineTest, SuggestCompletesTermsByFrequency) {
+    auto suggest = std::make_shared<SuggestIndex>(db);
+    suggest->rebuild();
+    indexManager->setSuggestIndex(suggest);
+    searchEngine->setSuggestIndex(suggest);
+
+    // "photo" в двух файлах, "phone" в одном
+    createTestFile(testFolderPath + "/phone_bill.pdf", "%PDF-1.4");
+    auto folders = indexManager->getFolders();
+    ASSERT_FALSE(folders.empty());
+    indexManager->scanFolder(folders[0].id);
+
+    auto suggestions = searchEngine->suggest("ph", 5);
+    ASSERT_EQ(suggestions.size(), 2u);
+    EXPECT_EQ(suggestions[0], "photo");
+    EXPECT_EQ(suggestions[1], "phone");
+
+    // Дополняется последнее слово, начало запроса сохраняется
+    suggestions = searchEngine->suggest("Family ph", 1);
+    ASSERT_EQ(suggestions.size(), 1u);
+    EXPECT_EQ(suggestions[0], "Family photo");
+
+    // Повторное сканирование не удваивает счётчики
+    indexManager->scanFolder(folders[0].id);
+    EXPECT_EQ(searchEngine->suggest("ph", 5)[0], "photo");
+
+    // Удалённый файл убирает свои термины
+    auto file = indexManager->getFileByPath(folders[0].id, "phone_bill.pdf");
+    ASSERT_TRUE(file.has_value());
+    indexManager->deleteFile(file->id);
+    suggestions = searchEngine->suggest("ph", 5);
+    ASSERT_EQ(suggestions.size(), 1u);
+    EXPECT_EQ(suggestions[0], "photo");
+    EXPECT_TRUE(searchEngine->suggest("bill", 5).empty());
+}
+
+TEST_F(SearchEngineTest, SuggestShortPrefixRanksByScore) {
+    SuggestIndex suggest(db);
+    int64_t now = std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    int64_t yearAgo = now - 365 * 86400;
+
+    // 200 старых терминов с частотой 1..7 и один свежий с частотой 4
+    int64_t fileId = 1;
+    for (int i = 0; i < 200; ++i) {
+        char term[8];
+        std::snprintf(term, sizeof(term), "pa%03d", i);
+        for (int n = 0; n <= i % 7; ++n) {
+            suggest.addFile(SuggestSource::Local, fileId++, std::string(term) + ".txt", yearAgo);
+        }
+    }
+    for (int n = 0; n < 4; ++n) {
+        suggest.addFile(SuggestSource::Local, fileId++, "pzrecent.txt", now);
+    }
+
+    // Свежесть важнее почти двукратной разницы в частоте
+    std::vector<std::string> expected = {"pzrecent", "pa006", "pa013"};
+    EXPECT_EQ(suggest.suggest("p", 3), expected);
+    expected = {"pa006", "pa013"};
+    EXPECT_EQ(suggest.suggest("pa", 2), expected);
+    EXPECT_EQ(suggest.suggest("pa0", 2), expected);
+
+    // Удаление меняет порядок в списке короткого префикса
+    suggest.removeFile(SuggestSource::Local, 22, "pa006.txt");  // первый файл pa006
+    expected = {"pzrecent", "pa013", "pa020"};
+    EXPECT_EQ(suggest.suggest("p", 3), expected);
+    EXPECT_EQ(suggest.suggest("pz", 5), std::vector<std::string>{"pzrecent"});
+}
+
+TEST_F(SearchEngineTest, SnippetsGeneratedForReturnedPage) {
+    // Содержимое, как его пишет ContentIndexer
+    auto ids = db->query<int64_t>(
+        "SELECT id FROM files ORDER BY id",
+        [](sqlite3_stmt* stmt) { return Database::getInt64(stmt, 0); });
+    ASSERT_GE(ids.size(), 3u);
+    for (int64_t id : ids) {
+        db->execute("UPDATE files_fts SET content = ? WHERE rowid = ?",
+                    std::string("quarterly figures mention the keyword zebracorn here"), id);
+    }
+
+    SearchQuery query;
+    query.text = "zebracorn";
+    query.limit = 2;
+
+    auto results = searchEngine->search(query);
+    ASSERT_EQ(results.size(), 2u);
+    for (const auto& r : results) {
+        EXPECT_NE(r.snippet.find("<b>zebracorn</b>"), std::string::npos) << r.snippet;
+    }
+
+    // Совпадение только по имени — в snippet по содержимому нечего подсвечивать
+    query.text = "budget";
+    query.limit = 10;
+    results = searchEngine->search(query);
+    ASSERT_EQ(results.size(), 1u);
+    EXPECT_EQ(results[0].snippet.find("<b>"), std::string::npos);
+}
@@ -0,0 +1,187 @@
+// test_search_executor.cpp — тесты асинхронного поиска (SearchExecutor и C API)
+
+#include <gtest/gtest.h>
+#include "familyvault/Database.h"
+#include "familyvault/IndexManager.h"
+#include "familyvault/SearchExecutor.h"
+#include "familyvault/familyvault_c.h"
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <map>
+#include <mutex>
+
+namespace fs = std::filesystem;
+using namespace FamilyVault;
+
+class SearchExecutorTest : public ::testing::Test {
+protected:
+    std::string testDbPath;
+    std::string testFolderPath;
+    std::shared_ptr<Database> db;
+
+    void SetUp() override {
+        testDbPath = "test_async_search_" + std::to_string(std::rand()) + ".db";
+        testFolderPath = "test_async_search_folder_" + std::to_string(std::rand());
+
+        fs::create_directories(testFolderPath);
+        createTestFile(testFolderPath + "/report_2024.pdf", "%PDF-1.4");
+        createTestFile(testFolderPath + "/vacation_photo.jpg", "\xFF\xD8\xFF");
+        createTestFile(testFolderPath + "/meeting_notes.txt", "Meeting notes");
+
+        db = std::make_shared<Database>(testDbPath);
+        db->initialize();
+        IndexManager indexManager(db);
+        int64_t folderId = indexManager.addFolder(testFolderPath, "Async");
+        indexManager.scanFolder(folderId);
+    }
+
+    void TearDown() override {
+        db.reset();
+
+        if (fs::exists(testDbPath)) fs::remove(testDbPath);
+        fs::remove(testDbPath + "-wal");
+        fs::remove(testDbPath + "-shm");
+
+        if (fs::exists(testFolderPath)) {
+            fs::remove_all(testFolderPath);
+        }
+    }
+
+    void createTestFile(const std::string& path, const std::string& content) {
+        std::ofstream file(path, std::ios::binary);
+        file.write(content.data(), content.size());
+    }
+
+    static SearchQuery textQuery(const std::string& text) {
+        SearchQuery query;
+        query.text = text;
+        return query;
+    }
+};
+
+TEST_F(SearchExecutorTest, DeliversResultsOnWorkerThread) {
+    SearchExecutor executor(testDbPath);
+
+    std::promise<SearchPage> delivered;
+    auto callerThread = std::this_thread::get_id();
+    std::thread::id callbackThread;
+
+    uint64_t id = executor.submit(textQuery("report"), [&](const SearchPage& page) {
+        callbackThread = std::this_thread::get_id();
+        delivered.set_value(page);
+    });
+
+    auto future = delivered.get_future();
+    ASSERT_EQ(future.wait_for(std::chrono::seconds(5)), std::future_status::ready);
+    SearchPage page = future.get();
+
+    EXPECT_EQ(page.requestId, id);
+    EXPECT_EQ(page.status, SearchRequestStatus::Completed);
+    ASSERT_EQ(page.results.size(), 1u);
+    EXPECT_EQ(page.results[0].file.name, "report_2024.pdf");
+    EXPECT_NE(callbackThread, callerThread);
+}
+
+TEST_F(SearchExecutorTest, CancelledQueuedRequestsReportCancelled) {
+    std::map<uint64_t, SearchRequestStatus> statuses;
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool releaseFirst = false;
+
+    auto record = [&](const SearchPage& page) {
+        std::lock_guard lock(mutex);
+        statuses[page.requestId] = page.status;
+        cv.notify_all();
+    };
+
+    {
+        SearchExecutor executor(testDbPath);
+
+        // Первый запрос держит поток, пока остальные стоят в очереди
+        uint64_t first = executor.submit(textQuery("report"), [&](const SearchPage& page) {
+            std::unique_lock lock(mutex);
+            cv.wait(lock, [&] { return releaseFirst; });
+            statuses[page.requestId] = page.status;
+        });
+        uint64_t stale = executor.submit(textQuery("vacation"), record);
+        uint64_t fresh = executor.submit(textQuery("meeting"), record);
+
+        EXPECT_TRUE(executor.cancel(stale));
+        EXPECT_FALSE(executor.cancel(9999));
+
+        {
+            std::lock_guard lock(mutex);
+            releaseFirst = true;
+        }
+        cv.notify_all();
+
+        std::unique_lock lock(mutex);
+        ASSERT_TRUE(cv.wait_for(lock, std::chrono::seconds(5), [&] { return statuses.size() == 3; }));
+        EXPECT_EQ(statuses[first], SearchRequestStatus::Completed);
+        EXPECT_EQ(statuses[stale], SearchRequestStatus::Cancelled);
+        EXPECT_EQ(statuses[fresh], SearchRequestStatus::Completed);
+    }
+}
+
+TEST_F(SearchExecutorTest, DestructorCancelsPendingRequests) {
+    std::atomic<int> cancelled{0};
+    std::atomic<int> delivered{0};
+    {
+        SearchExecutor executor(testDbPath);
+        for (int i = 0; i < 20; ++i) {
+            executor.submit(textQuery("report"), [&](const SearchPage& page) {
+                if (page.status == SearchRequestStatus::Cancelled) ++cancelled;
+                ++delivered;
+            });
+        }
+    }
+    // Каждый запрос получает ровно один callback, даже при уничтожении
+    EXPECT_EQ(delivered.load(), 20);
+    EXPECT_GT(cancelled.load(), 0);
+}
+
+// ═══════════════════════════════════════════════════════════
+// C API
+// ═══════════════════════════════════════════════════════════
+
+namespace {
+
+struct AsyncResult {
+    std::promise<std::pair<FVError, std::string>> promise;
+};
+
+void onSearchResult(int64_t, FVError status, const char* results_json, void* user_data) {
+    auto* result = static_cast<AsyncResult*>(user_data);
+    result->promise.set_value({status, results_json ? results_json : ""});
+}
+
+} // namespace
+
+TEST_F(SearchExecutorTest, CApiQueryAsync) {
+    FVError err = FV_OK;
+    FVDatabase handle = fv_database_open(testDbPath.c_str(), &err);
+    ASSERT_NE(handle, nullptr);
+    ASSERT_EQ(fv_database_initialize(handle), FV_OK);
+    FVSearchEngine engine = fv_search_create(handle);
+    ASSERT_NE(engine, nullptr);
+
+    AsyncResult result;
+    auto future = result.promise.get_future();
+    int64_t id = fv_search_query_async(engine, R"({"text": "meeting"})", onSearchResult, &result);
+    ASSERT_GT(id, 0);
+
+    ASSERT_EQ(future.wait_for(std::chrono::seconds(5)), std::future_status::ready);
+    auto [status, body] = future.get();
+    EXPECT_EQ(status, FV_OK);
+    EXPECT_NE(body.find("meeting_notes.txt"), std::string::npos);
+
+    EXPECT_EQ(fv_search_cancel(engine, id), FV_ERROR_NOT_FOUND);
+    EXPECT_EQ(fv_search_query_async(engine, R"({"text": "x"})", nullptr, nullptr), -1);
+    EXPECT_EQ(fv_last_error(), FV_ERROR_INVALID_ARGUMENT);
+
+    fv_search_destroy(engine);
+    EXPECT_EQ(fv_database_close(handle), FV_OK);
+}
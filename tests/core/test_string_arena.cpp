@@ -0,0 +1,34 @@
+// test_string_arena.cpp — тесты StringArena
+
+#include <gtest/gtest.h>
+#include "familyvault/StringArena.h"
+#include <string>
+
+using namespace FamilyVault;
+
+TEST(StringArenaTest, StoreAndIntern) {
+    StringArena arena;
+    EXPECT_TRUE(arena.store("").empty());
+
+    auto a = arena.intern("image/jpeg");
+    auto b = arena.intern(std::string("image/jpeg"));
+    EXPECT_EQ(a.data(), b.data());
+    EXPECT_EQ(a, "image/jpeg");
+
+    auto c = arena.store("image/jpeg");
+    EXPECT_NE(c.data(), a.data());
+    EXPECT_EQ(c, a);
+
+    // Длинная строка не занимает текущий блок
+    std::string big(64 * 1024, 'x');
+    auto stored = arena.store(big);
+    EXPECT_EQ(stored, big);
+    auto small = arena.store("tail");
+    EXPECT_EQ(small, "tail");
+    EXPECT_EQ(arena.blockCount(), 2u);
+    EXPECT_EQ(arena.bytesUsed(), 10u + 10u + big.size() + 4u);
+
+    arena.clear();
+    EXPECT_EQ(arena.bytesUsed(), 0u);
+    EXPECT_NE(arena.intern("image/jpeg").data(), nullptr);
+}
@@ -5,6 +5,7 @@
 #include "familyvault/TextExtractor.h"
 #include <filesystem>
 #include <fstream>
+#include <cstdio>
 #include <cstdlib>
 
 namespace fs = std::filesystem;
@@ -111,6 +112,59 @@ TEST_F(TextExtractorTest, RegistryCannotExtractUnknownType) {
     EXPECT_FALSE(registry->canExtract("audio/mpeg"));
 }
 
+TEST_F(TextExtractorTest, RegistryDispatchRespectsPriority) {
+    // Текстовый экстрактор с заданным приоритетом для всех text/*
+    class StubExtractor : public ITextExtractor {
+    public:
+        StubExtractor(std::string name, int priority) : m_name(std::move(name)), m_priority(priority) {}
+        std::string name() const override { return m_name; }
+        bool canHandle(const std::string& mimeType) const override {
+            return mimeType.starts_with("text/");
+        }
+        std::optional<ExtractionResult> extract(const std::string&) override { return std::nullopt; }
+        int priority() const override { return m_priority; }
+    private:
+        std::string m_name;
+        int m_priority;
+    };
+
+    auto registry = TextExtractorRegistry::createDefault();
+    registry->registerExtractor(std::make_shared<StubExtractor>("same_priority", 10));
+    // Известный тип (таблица) и неизвестный (перебор) — одинаковый выбор
+    EXPECT_EQ(registry->getExtractorName("text/plain"), "plain_text");
+    EXPECT_EQ(registry->getExtractorName("text/x-unlisted"), "plain_text");
+
+    registry->registerExtractor(std::make_shared<StubExtractor>("preferred", 30));
+    EXPECT_EQ(registry->getExtractorName("text/plain"), "preferred");
+    EXPECT_EQ(registry->getExtractorName("text/x-unlisted"), "preferred");
+    EXPECT_EQ(registry->getExtractorName("application/pdf"), "pdf");
+}
+
+TEST_F(TextExtractorTest, RegistryDispatchByMimeId) {
+    auto registry = TextExtractorRegistry::createDefault();
+    EXPECT_TRUE(registry->bindMimeId(3, "text/plain"));
+    EXPECT_FALSE(registry->bindMimeId(7, "image/jpeg"));
+    EXPECT_FALSE(registry->bindMimeId(0, "text/plain"));
+
+    EXPECT_TRUE(registry->canExtract(int64_t{3}));
+    EXPECT_FALSE(registry->canExtract(int64_t{7}));
+    EXPECT_FALSE(registry->canExtract(int64_t{5}));     // Не связан
+    EXPECT_FALSE(registry->canExtract(int64_t{100}));
+
+    auto path = createTempFile("by_id.txt", "Dispatched by mime id");
+    auto result = registry->extract(path, int64_t{3});
+    ASSERT_TRUE(result.has_value());
+    EXPECT_NE(result->text.find("Dispatched by mime id"), std::string::npos);
+    EXPECT_FALSE(registry->extract(path, int64_t{7}).has_value());
+
+    // Пакет публикует новую таблицу; прежние связи сохраняются
+    auto supported = registry->bindMimeIds({{9, "application/pdf"}, {10, "video/mp4"}});
+    EXPECT_EQ(supported, (std::vector<bool>{true, false}));
+    EXPECT_TRUE(registry->canExtract(int64_t{3}));
+    EXPECT_TRUE(registry->canExtract(int64_t{9}));
+    EXPECT_FALSE(registry->canExtract(int64_t{10}));
+}
+
 TEST_F(TextExtractorTest, RegistryExtractNonExistentFile) {
     auto registry = TextExtractorRegistry::createDefault();
     
@@ -332,6 +386,44 @@ TEST_F(TextExtractorTest, PlainTextExtractUtf16LE) {
     EXPECT_NE(result->text.find("Hello"), std::string::npos);
 }
 
+TEST_F(TextExtractorTest, PlainTextUtf16AcrossReadChunks) {
+    PlainTextExtractor extractor;
+    
+    // Больше фрагмента чтения (64KB): суррогатные пары попадают на стыки
+    std::string data = "\xFF\xFE";
+    const char16_t word[] = u"\u0416\U0001F600 ";
+    for (int i = 0; i < 30000; ++i) {
+        for (char16_t c : word) {
+            if (c == 0) break;
+            data.push_back(static_cast<char>(c & 0xFF));
+            data.push_back(static_cast<char>((c >> 8) & 0xFF));
+        }
+    }
+    std::string path = createTempFile("utf16_big.txt", data);
+    
+    auto result = extractor.extract(path);
+    
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(result->text.find("\xEF\xBF\xBD"), std::string::npos);  // Без U+FFFD
+    EXPECT_EQ(result->text.substr(0, 7), "\xD0\x96\xF0\x9F\x98\x80 ");
+}
+
+TEST_F(TextExtractorTest, PlainTextHonoursLargeTextLimit) {
+    auto registry = TextExtractorRegistry::createDefault();
+    registry->setMaxTextSize(3 * 1024 * 1024);
+    
+    // Лимит выше прежнего встроенного (1MB) не обрезается молча
+    std::string path = createLargeFile("large_text.txt", 2 * 1024 * 1024);
+    auto result = registry->extract(path, "text/plain");
+    ASSERT_TRUE(result.has_value());
+    EXPECT_GT(result->text.size(), 1024u * 1024u);
+    
+    registry->setMaxTextSize(1000);
+    result = registry->extract(path, "text/plain");
+    ASSERT_TRUE(result.has_value());
+    EXPECT_LE(result->text.size(), 1000u);
+}
+
 // ═══════════════════════════════════════════════════════════
 // PdfTextExtractor Tests
 // ═══════════════════════════════════════════════════════════
@@ -421,6 +513,64 @@ TEST_F(TextExtractorTest, PdfMaxPagesLimit) {
     }
 }
 
+/// Минимальный PDF из pageCount страниц с текстом "Page N" и корректной таблицей xref
+static std::string makeMultiPagePdf(int pageCount) {
+    std::vector<std::string> objects;
+    objects.push_back("<< /Type /Catalog /Pages 2 0 R >>");
+    std::string kids;
+    for (int page = 0; page < pageCount; ++page) {
+        kids += std::to_string(4 + page * 2) + " 0 R ";
+    }
+    objects.push_back("<< /Type /Pages /Kids [" + kids + "] /Count " + std::to_string(pageCount) + " >>");
+    objects.push_back("<< /Type /Font /Subtype /Type1 /BaseFont /Helvetica >>");
+    for (int page = 0; page < pageCount; ++page) {
+        std::string stream = "BT /F1 12 Tf 72 720 Td (Page " + std::to_string(page + 1) + ") Tj ET";
+        objects.push_back("<< /Type /Page /Parent 2 0 R /MediaBox [0 0 612 792] "
+                          "/Resources << /Font << /F1 3 0 R >> >> /Contents " +
+                          std::to_string(5 + page * 2) + " 0 R >>");
+        objects.push_back("<< /Length " + std::to_string(stream.size()) + " >>\nstream\n" +
+                          stream + "\nendstream");
+    }
+
+    std::string pdf = "%PDF-1.4\n";
+    std::vector<size_t> offsets;
+    for (size_t i = 0; i < objects.size(); ++i) {
+        offsets.push_back(pdf.size());
+        pdf += std::to_string(i + 1) + " 0 obj\n" + objects[i] + "\nendobj\n";
+    }
+    size_t xref = pdf.size();
+    pdf += "xref\n0 " + std::to_string(objects.size() + 1) + "\n0000000000 65535 f \n";
+    for (size_t offset : offsets) {
+        char entry[21];
+        std::snprintf(entry, sizeof(entry), "%010zu 00000 n \n", offset);
+        pdf += entry;
+    }
+    pdf += "trailer\n<< /Size " + std::to_string(objects.size() + 1) +
+           " /Root 1 0 R >>\nstartxref\n" + std::to_string(xref) + "\n%%EOF\n";
+    return pdf;
+}
+
+TEST_F(TextExtractorTest, PdfParallelPagesKeepOrder) {
+    std::string path = createTempFile("pages.pdf", makeMultiPagePdf(40));
+    
+    PdfTextExtractor sequential;
+    sequential.setMaxThreads(1);
+    PdfTextExtractor parallel;
+    parallel.setMaxThreads(4);
+    
+    auto expected = sequential.extract(path);
+    auto result = parallel.extract(path);
+    ASSERT_TRUE(expected.has_value());
+    ASSERT_TRUE(result.has_value());
+    
+    // Страницы собраны по порядку, ни одна не потеряна
+    EXPECT_EQ(result->text, expected->text);
+    EXPECT_LT(result->text.find("Page 9"), result->text.find("Page 10"));
+    EXPECT_LT(result->text.find("Page 39"), result->text.find("Page 40"));
+    EXPECT_EQ(result->failedPages, 0);
+    EXPECT_FALSE(result->isPartial());
+}
+
 // ═══════════════════════════════════════════════════════════
 // OfficeTextExtractor Tests - DOCX
 // ═══════════════════════════════════════════════════════════
@@ -0,0 +1,105 @@
+// test_text_normalizer.cpp — тесты нормализации текста (скалярное и SIMD-ядра)
+
+#include <gtest/gtest.h>
+#include "familyvault/TextNormalizer.h"
+#include <random>
+#include <regex>
+
+using namespace FamilyVault;
+
+namespace {
+
+const SimdLevel kAllLevels[] = {SimdLevel::Scalar, SimdLevel::Sse2, SimdLevel::Avx2};
+
+/// Прежняя реализация PlainTextExtractor: regex + trim
+std::string regexNormalize(const std::string& text) {
+    std::string result = std::regex_replace(text, std::regex(R"(\s+)"), " ");
+    auto start = result.find_first_not_of(' ');
+    if (start == std::string::npos) return "";
+    return result.substr(start, result.find_last_not_of(' ') - start + 1);
+}
+
+/// Текст длиннее блока AVX2, с пробелами на границах блоков
+std::string mixedText(std::mt19937& rng, size_t length, bool allowInvalid) {
+    static const char* pieces[] = {"word", " ", "\t\n", "  \r\n ", "Привет", "мир", "€", "😀",
+                                   "a", ",", "\f\v"};
+    std::string text;
+    while (text.size() < length) {
+        if (allowInvalid && rng() % 13 == 0) {
+            text += static_cast<char>(0x80 + rng() % 0x80);
+        } else {
+            text += pieces[rng() % std::size(pieces)];
+        }
+    }
+    return text;
+}
+
+} // namespace
+
+TEST(TextNormalizerTest, CollapsesWhitespaceAndTrims) {
+    for (auto level : kAllLevels) {
+        EXPECT_EQ(TextNormalizer::normalize("  hello \t\n world\r\n", level), "hello world");
+        EXPECT_EQ(TextNormalizer::normalize("", level), "");
+        EXPECT_EQ(TextNormalizer::normalize(" \n\t\v\f\r ", level), "");
+        EXPECT_EQ(TextNormalizer::normalize("one", level), "one");
+
+        std::string longText = std::string(40, ' ') + std::string(70, 'x') + "\n\n" +
+                               std::string(33, 'y') + std::string(50, '\t');
+        EXPECT_EQ(TextNormalizer::normalize(longText, level),
+                  std::string(70, 'x') + " " + std::string(33, 'y'));
+    }
+}
+
+TEST(TextNormalizerTest, KeepsValidMultibyteText) {
+    std::string text = "  Семейный   архив\n\n2024 — 😀 €  ";
+    for (auto level : kAllLevels) {
+        EXPECT_EQ(TextNormalizer::normalize(text, level), "Семейный архив 2024 — 😀 €");
+    }
+}
+
+TEST(TextNormalizerTest, ReplacesInvalidUtf8) {
+    const std::string fffd = "\xEF\xBF\xBD";
+    for (auto level : kAllLevels) {
+        EXPECT_EQ(TextNormalizer::normalize("a\xFF" "b", level), "a" + fffd + "b");
+        // Overlong, суррогат, выше U+10FFFF, одиночное продолжение
+        EXPECT_EQ(TextNormalizer::normalize("\xC0\x80", level), fffd + fffd);
+        EXPECT_EQ(TextNormalizer::normalize("\xED\xA0\x80 x", level), fffd + fffd + fffd + " x");
+        EXPECT_EQ(TextNormalizer::normalize("\xF4\x90\x80\x80", level), fffd + fffd + fffd + fffd);
+        EXPECT_EQ(TextNormalizer::normalize("x\x80y", level), "x" + fffd + "y");
+        // Обрыв в середине текста — ошибка, в конце — отбрасывается
+        EXPECT_EQ(TextNormalizer::normalize("\xD0 z", level), fffd + " z");
+        EXPECT_EQ(TextNormalizer::normalize("abc \xF0\x9F\x98", level), "abc");
+    }
+}
+
+TEST(TextNormalizerTest, MatchesRegexOnValidText) {
+    std::mt19937 rng(42);
+    for (int round = 0; round < 200; ++round) {
+        std::string text = mixedText(rng, rng() % 300, false);
+        std::string expected = regexNormalize(text);
+        for (auto level : kAllLevels) {
+            ASSERT_EQ(TextNormalizer::normalize(text, level), expected) << "round " << round;
+        }
+    }
+}
+
+TEST(TextNormalizerTest, SimdKernelsMatchScalarOnInvalidInput) {
+    std::mt19937 rng(7);
+    for (int round = 0; round < 500; ++round) {
+        std::string text = mixedText(rng, rng() % 200, true);
+        std::string scalar = TextNormalizer::normalize(text, SimdLevel::Scalar);
+        EXPECT_TRUE(TextNormalizer::isValidUtf8(scalar));
+        for (auto level : {SimdLevel::Sse2, SimdLevel::Avx2}) {
+            ASSERT_EQ(TextNormalizer::normalize(text, level), scalar) << "round " << round;
+        }
+    }
+}
+
+TEST(TextNormalizerTest, ValidatesUtf8) {
+    EXPECT_TRUE(TextNormalizer::isValidUtf8(""));
+    EXPECT_TRUE(TextNormalizer::isValidUtf8("plain ascii text that is longer than eight"));
+    EXPECT_TRUE(TextNormalizer::isValidUtf8("Привет, мир 😀"));
+    EXPECT_FALSE(TextNormalizer::isValidUtf8("abc\xFF"));
+    EXPECT_FALSE(TextNormalizer::isValidUtf8("\xE0\x80\x80"));
+    EXPECT_FALSE(TextNormalizer::isValidUtf8("12345678\xD0"));
+}
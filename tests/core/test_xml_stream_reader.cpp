@@ -0,0 +1,85 @@
+// test_xml_stream_reader.cpp — тесты потокового разбора XML
+
+#include <gtest/gtest.h>
+#include "familyvault/XmlStreamReader.h"
+
+using namespace FamilyVault;
+
+namespace {
+
+/// Записывает события в строку: "{имя " и "}" для элементов, текст как есть
+class TraceHandler : public XmlStreamReader::Handler {
+public:
+    static constexpr std::string_view kNames[] = {"p", "t", "c"};
+
+    void startElement(int id, const XmlStreamReader& reader) override {
+        trace += "{";
+        trace += kNames[id];
+        if (auto type = reader.attribute("t"); !type.empty()) {
+            trace += " t=";
+            trace += type;
+        }
+        trace += " ";
+    }
+
+    void endElement(int) override { trace += "}"; }
+
+    void text(std::string_view text) override { trace += text; }
+
+    std::string trace;
+};
+
+std::string parse(std::string_view xml, size_t chunk = 1 << 20) {
+    TraceHandler handler;
+    XmlStreamReader reader({"p", "t", "c"}, handler);
+    for (size_t i = 0; i < xml.size(); i += chunk) {
+        reader.feed(xml.substr(i, chunk));
+    }
+    reader.finish();
+    return handler.trace;
+}
+
+} // namespace
+
+TEST(XmlStreamReaderTest, ReportsKnownElementsByLocalName) {
+    std::string xml =
+        "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>"
+        "<w:document xmlns:w=\"urn:w\"><w:body><w:p w:rsidR=\"00A1\"><w:r><w:t>Привет</w:t></w:r>"
+        "<w:r><w:t xml:space=\"preserve\"> мир</w:t></w:r></w:p><w:p/></w:body></w:document>";
+    std::string expected = "{p {t Привет}{t  мир}}{p }";
+
+    for (size_t chunk : {1, 2, 3, 5, 16, 1000}) {
+        EXPECT_EQ(parse(xml, chunk), expected) << "chunk=" << chunk;
+    }
+}
+
+TEST(XmlStreamReaderTest, ReadsAttributesWithQuotesAndPrefixes) {
+    std::string xml =
+        "<row><c r=\"A1\" s='2' t=\"s\"><v>0</v></c>"
+        "<c r=\"B1\" x:t = 'inlineStr' note=\"a > b / c\"><is><t>x</t></is></c>"
+        "<c r=\"C1\"/></row>";
+    std::string expected = "{c t=s 0}{c t=inlineStr {t x}}{c }";
+
+    for (size_t chunk : {1, 4, 7, 1000}) {
+        EXPECT_EQ(parse(xml, chunk), expected) << "chunk=" << chunk;
+    }
+}
+
+TEST(XmlStreamReaderTest, DecodesEntitiesAndCdata) {
+    std::string xml =
+        "<t>R&amp;D &lt;3 &#1071;&#x44F; &unknown; AT&T</t>"
+        "<!-- <t>скрыто</t> --- -->"
+        "<t><![CDATA[a < b ]] c ]]]></t>";
+    std::string expected = "{t R&D <3 Яя &unknown; AT&T}{t a < b ]] c ]}";
+
+    for (size_t chunk : {1, 2, 3, 1000}) {
+        EXPECT_EQ(parse(xml, chunk), expected) << "chunk=" << chunk;
+    }
+}
+
+TEST(XmlStreamReaderTest, SurvivesMalformedInput) {
+    EXPECT_EQ(parse("<t>unclosed <p attr=\"never"), "{t unclosed ");
+    EXPECT_EQ(parse("text & more &amp"), "text & more &amp");
+    EXPECT_EQ(parse("</t><t></p>"), "}{t }");
+    EXPECT_EQ(parse(std::string(100000, '<')), "");
+}